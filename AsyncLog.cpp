@@ -0,0 +1,148 @@
+/**********************************************************************/
+/*! \file AsyncLog.cpp
+    \brief Diagnostics from time-critical threads without blocking them.
+*/
+/**********************************************************************/
+
+#include "AsyncLog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+
+thread_local AsyncLog::Cache AsyncLog::cache_ = { 0, 0 };
+
+// Log ids start at 1, so an empty cache matches none.
+static std::atomic<uint64_t> logs( 0 );
+
+AsyncLog :: AsyncLog( std::ostream &out, int64_t interval, size_t capacity )
+  : out_( out ), interval_( interval ), start_( MidiScheduler::now() ), capacity_( capacity ),
+    id_( ++logs ), dropped_( 0 ), flushRequests_( 0 ), flushes_( 0 ), stopping_( false )
+{
+  if ( capacity < 2 || ( capacity & ( capacity - 1 ) ) != 0 )
+    throw std::invalid_argument( "AsyncLog: the ring capacity must be a power of two" );
+  thread_ = std::thread( &AsyncLog::run, this );
+}
+
+AsyncLog :: ~AsyncLog( void )
+{
+  {
+    std::lock_guard<std::mutex> guard( lock_ );
+    stopping_ = true;
+  }
+  wake_.notify_one();
+  thread_.join();
+}
+
+AsyncLog::Format AsyncLog :: define( const std::string &format )
+{
+  std::lock_guard<std::mutex> guard( formatsLock_ );
+  if ( formats_.size() > 0xffff ) throw std::length_error( "AsyncLog: too many formats" );
+  formats_.push_back( format );
+  return static_cast<Format>( formats_.size() - 1 );
+}
+
+// A thread's first record for this log, or its first since it logged
+// to another: find or make its ring.
+AsyncLog::Ring *AsyncLog :: findRing( void )
+{
+  static thread_local std::vector<Cache> known;
+  for ( size_t i=0; i<known.size(); i++ ) {
+    if ( known[i].id != id_ ) continue;
+    cache_ = known[i];
+    return cache_.ring;
+  }
+  Ring *ring = new Ring( capacity_ );
+  {
+    std::lock_guard<std::mutex> guard( ringsLock_ );
+    rings_.push_back( std::unique_ptr<Ring>( ring ) );
+  }
+  cache_.id = id_;
+  cache_.ring = ring;
+  known.push_back( cache_ );
+  return ring;
+}
+
+void AsyncLog :: flush( void )
+{
+  std::unique_lock<std::mutex> guard( lock_ );
+  uint64_t request = ++flushRequests_;
+  wake_.notify_one();
+  flushed_.wait( guard, [this, request]() { return flushes_ >= request; } );
+}
+
+void AsyncLog :: run( void )
+{
+  std::unique_lock<std::mutex> guard( lock_ );
+  for ( ;; ) {
+    wake_.wait_for( guard, std::chrono::microseconds( interval_ ),
+                    [this]() { return stopping_ || flushRequests_ > flushes_; } );
+    uint64_t requests = flushRequests_;
+    bool stopping = stopping_;
+    guard.unlock();
+    drain();
+    guard.lock();
+    flushes_ = requests;
+    flushed_.notify_all();
+    if ( stopping ) return;
+  }
+}
+
+// Take every ring's records, put them in time order and write them.
+void AsyncLog :: drain( void )
+{
+  batch_.clear();
+  {
+    std::lock_guard<std::mutex> guard( ringsLock_ );
+    for ( size_t r=0; r<rings_.size(); r++ ) {
+      Ring &ring = *rings_[r];
+      uint64_t tail = ring.tail.load( std::memory_order_relaxed );
+      uint64_t head = ring.head.load( std::memory_order_acquire );
+      for ( ; tail != head; tail++ ) batch_.push_back( ring.records[tail & ring.mask] );
+      ring.tail.store( tail, std::memory_order_release );
+    }
+  }
+  if ( batch_.empty() ) return;
+
+  std::stable_sort( batch_.begin(), batch_.end(), []( const Record &a, const Record &b ) { return a.time < b.time; } );
+  text_.clear();
+  {
+    std::lock_guard<std::mutex> guard( formatsLock_ );
+    for ( size_t i=0; i<batch_.size(); i++ ) format( batch_[i] );
+  }
+  out_.write( text_.data(), (std::streamsize) text_.size() );
+  out_.flush();
+}
+
+// Append one record as a line: seconds since the log started, then
+// the format with its arguments.
+void AsyncLog :: format( const Record &record )
+{
+  char number[32];
+  snprintf( number, sizeof( number ), "%12.6f ", ( record.time - start_ ) * 1e-6 );
+  text_ += number;
+  if ( record.format >= formats_.size() ) {
+    text_ += "(unknown format)\n";
+    return;
+  }
+
+  const std::string &format = formats_[record.format];
+  unsigned int next = 0;
+  for ( size_t i=0; i<format.size(); i++ ) {
+    if ( format[i] != '{' || i + 1 >= format.size() || format[i + 1] != '}' || next >= record.count ) {
+      text_ += format[i];
+      continue;
+    }
+    const Argument &a = record.arguments[next];
+    switch ( ( record.types >> ( 2 * next ) ) & 3 ) {
+    case typeSigned: snprintf( number, sizeof( number ), "%lld", (long long) a.i ); text_ += number; break;
+    case typeUnsigned: snprintf( number, sizeof( number ), "%llu", (unsigned long long) a.u ); text_ += number; break;
+    case typeDouble: snprintf( number, sizeof( number ), "%g", a.d ); text_ += number; break;
+    default: text_ += a.s ? a.s : "(null)"; break;
+    }
+    next++;
+    i++;
+  }
+  text_ += '\n';
+}
@@ -0,0 +1,188 @@
+/**********************************************************************/
+/*! \file AsyncLog.h
+    \brief Diagnostics from time-critical threads without blocking them.
+
+    Printing with std::cout from the sensor or MIDI thread formats the
+    text on that thread and, at each std::endl, waits for the terminal.
+    An AsyncLog takes a fixed-size record instead: the time, a format
+    number and up to four arguments, copied into a ring that belongs to
+    the calling thread.  Logging takes no lock, allocates nothing once
+    the thread's ring exists and formats nothing.  A background thread
+    wakes every few milliseconds, takes the records from every ring,
+    puts them in time order and writes them to the stream as one batch.
+
+    Formats are registered once with define().  Each {} in a format is
+    replaced by the next argument: an integer, a floating-point number
+    or a string that lives as long as the log, such as a literal.
+
+    A thread's ring that is full drops the record rather than wait, and
+    dropped() counts them.
+
+    \code
+    AsyncLog log( file );
+    AsyncLog::Format fired = log.define( "rule {} fired for device {}" );
+    log.log( fired, rule, device );
+    \endcode
+*/
+/**********************************************************************/
+
+#ifndef ASYNCLOG_H
+#define ASYNCLOG_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "MidiScheduler.h"
+
+class AsyncLog
+{
+ public:
+  typedef uint16_t Format;
+
+  //! The most arguments a record holds.
+  static const unsigned int maxArguments = 4;
+
+  //! Write to \e out every \e interval microseconds, with rings of \e capacity records (a power of two) per thread.
+  AsyncLog( std::ostream &out, int64_t interval = 10000, size_t capacity = 1024 );
+
+  //! The destructor writes what is left and stops the background thread.
+  ~AsyncLog( void );
+
+  //! Register \e format and return its number for log().
+  Format define( const std::string &format );
+
+  //! Log \e arguments with \e format from this thread.  Never blocks.
+  template <class... Arguments>
+  void log( Format format, Arguments... arguments )
+  {
+    static_assert( sizeof...( Arguments ) <= maxArguments, "AsyncLog: too many arguments" );
+    Ring *ring = threadRing();
+    uint64_t head = ring->head.load( std::memory_order_relaxed );
+    if ( head - ring->tail.load( std::memory_order_acquire ) > ring->mask ) {
+      dropped_.fetch_add( 1, std::memory_order_relaxed );
+      return;
+    }
+    Record &record = ring->records[head & ring->mask];
+    record.time = MidiScheduler::now();
+    record.format = format;
+    record.count = static_cast<uint8_t>( sizeof...( Arguments ) );
+    record.types = 0;
+    store( record, 0, arguments... );
+    ring->head.store( head + 1, std::memory_order_release );
+  }
+
+  //! Wait until everything logged so far has been written.
+  void flush( void );
+
+  //! Records dropped because a ring was full.
+  uint64_t dropped( void ) const { return dropped_.load( std::memory_order_relaxed ); }
+
+ private:
+  enum { typeSigned, typeUnsigned, typeDouble, typeString };
+
+  union Argument {
+    int64_t i;
+    uint64_t u;
+    double d;
+    const char *s;
+  };
+
+  struct Record {
+    int64_t time;
+    Format format;
+    uint8_t count;
+    uint8_t types;   // two bits per argument
+    Argument arguments[maxArguments];
+  };
+
+  // One thread writes head, the background thread tail; each on its
+  // own cache line.
+  struct Ring {
+    explicit Ring( size_t capacity ) : records( capacity ), mask( capacity - 1 ), head( 0 ), tail( 0 ) {}
+    std::vector<Record> records;
+    uint64_t mask;
+    char padding0[64];
+    std::atomic<uint64_t> head;
+    char padding1[64];
+    std::atomic<uint64_t> tail;
+  };
+
+  std::ostream &out_;
+  int64_t interval_, start_;
+  size_t capacity_;
+  uint64_t id_;                  // tells this log's rings from another's
+
+  std::mutex ringsLock_, formatsLock_;
+  std::vector<std::unique_ptr<Ring> > rings_;
+  std::vector<std::string> formats_;
+  std::atomic<uint64_t> dropped_;
+
+  std::mutex lock_;
+  std::condition_variable wake_, flushed_;
+  uint64_t flushRequests_, flushes_;
+  bool stopping_;
+  std::thread thread_;
+
+  std::vector<Record> batch_;    // the background thread's
+  std::string text_;
+
+  // The last log this thread used, and its ring there.
+  struct Cache {
+    uint64_t id;
+    Ring *ring;
+  };
+  static thread_local Cache cache_;
+
+  Ring *threadRing( void ) { return cache_.id == id_ ? cache_.ring : findRing(); }
+  Ring *findRing( void );
+  void run( void );
+  void drain( void );
+  void format( const Record &record );
+
+  static void store( Record &, unsigned int ) {}
+
+  template <class T, class... Rest>
+  static void store( Record &record, unsigned int i, T value, Rest... rest )
+  {
+    set( record, i, value );
+    store( record, i + 1, rest... );
+  }
+
+  static void set( Record &record, unsigned int i, const char *value )
+  {
+    record.arguments[i].s = value;
+    record.types |= static_cast<uint8_t>( typeString << ( 2 * i ) );
+  }
+
+  template <class T>
+  static typename std::enable_if<std::is_floating_point<T>::value>::type set( Record &record, unsigned int i, T value )
+  {
+    record.arguments[i].d = value;
+    record.types |= static_cast<uint8_t>( typeDouble << ( 2 * i ) );
+  }
+
+  template <class T>
+  static typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type set( Record &record, unsigned int i, T value )
+  {
+    record.arguments[i].i = value;
+  }
+
+  template <class T>
+  static typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type set( Record &record, unsigned int i, T value )
+  {
+    record.arguments[i].u = value;
+    record.types |= static_cast<uint8_t>( typeUnsigned << ( 2 * i ) );
+  }
+
+  AsyncLog( const AsyncLog & );
+  AsyncLog &operator=( const AsyncLog & );
+};
+
+#endif
@@ -0,0 +1,41 @@
+/**********************************************************************/
+/*! \file BitScan.h
+    \brief Find and count the bits set in a 64-bit word.
+
+    The timer wheel's slot bitmaps, the note tracker's note sets and
+    the recording's bit reader all scan 64-bit words.  GCC and Clang
+    have single instructions for this; other compilers, such as MSVC
+    for the WinMM backend, get a plain loop.
+*/
+/**********************************************************************/
+
+#ifndef BITSCAN_H
+#define BITSCAN_H
+
+#include <stdint.h>
+
+//! The index of the lowest bit set in \e bits, which must not be 0.
+inline unsigned int bitLowest( uint64_t bits )
+{
+#if defined(__GNUC__)
+  return __builtin_ctzll( bits );
+#else
+  unsigned int bit = 0;
+  while ( !( bits & 1 ) ) { bits >>= 1; bit++; }
+  return bit;
+#endif
+}
+
+//! The number of bits set in \e bits.
+inline unsigned int bitCount( uint64_t bits )
+{
+#if defined(__GNUC__)
+  return __builtin_popcountll( bits );
+#else
+  unsigned int count = 0;
+  for ( ; bits; bits &= bits - 1 ) count++;
+  return count;
+#endif
+}
+
+#endif
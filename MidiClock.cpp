@@ -0,0 +1,157 @@
+/**********************************************************************/
+/*! \file MidiClock.cpp
+    \brief A MIDI clock master: timing clock, start, stop, continue and song position.
+*/
+/**********************************************************************/
+
+#include "MidiClock.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+// Song Position Pointer counts sixteenth notes, each six ticks.
+static const unsigned int ticksPerSixteenth = MidiClock::PPQN / 4;
+
+static double periodOf( double bpm )
+{
+  if ( !( bpm > 0.0 ) ) throw std::invalid_argument( "MidiClock: the tempo must be positive" );
+  return 60000000.0 / ( bpm * MidiClock::PPQN );
+}
+
+MidiClock :: MidiClock( RtMidiOut *out, MidiScheduler &scheduler, double bpm )
+  : out_( out ), scheduler_( scheduler ), queue_( 0 ), period_( periodOf( bpm ) ), anchor_( 0 ), anchorTick_( 0 ),
+    ticks_( 0 ), running_( false ), runs_( 0 ), next_( 0 )
+{
+}
+
+MidiClock :: ~MidiClock( void )
+{
+  std::lock_guard<std::mutex> guard( lock_ );
+  running_ = false;
+  scheduler_.cancel( next_ );
+}
+
+int64_t MidiClock :: tickTime( uint64_t ticks ) const
+{
+  return anchor_ + (int64_t) std::llround( (double) ( ticks - anchorTick_ ) * period_ );
+}
+
+int64_t MidiClock :: timeOfNext( unsigned int ticks, int64_t time ) const
+{
+  std::lock_guard<std::mutex> guard( lock_ );
+  if ( !running_ || ticks == 0 ) return std::numeric_limits<int64_t>::max();
+  double position = (double) anchorTick_ + std::max( 0.0, ( time - anchor_ ) / period_ );
+  return tickTime( (uint64_t) ( std::ceil( position / ticks ) * ticks ) );
+}
+
+void MidiClock :: setTempo( double bpm )
+{
+  std::lock_guard<std::mutex> guard( lock_ );
+  double period = periodOf( bpm );
+  if ( running_ ) {
+    // The next tick keeps its time; the ones after it move.
+    anchor_ = tickTime( ticks_ );
+    anchorTick_ = ticks_;
+  }
+  period_ = period;
+}
+
+double MidiClock :: getTempo( void ) const
+{
+  std::lock_guard<std::mutex> guard( lock_ );
+  return 60000000.0 / ( period_ * PPQN );
+}
+
+void MidiClock :: setQueue( MidiOutQueue *queue )
+{
+  std::lock_guard<std::mutex> guard( lock_ );
+  queue_ = queue;
+}
+
+void MidiClock :: sendByte( unsigned char status )
+{
+  sendMessage( &status, 1 );
+}
+
+void MidiClock :: sendMessage( const unsigned char *message, size_t size )
+{
+  if ( queue_ ) queue_->send( message, size );
+  else out_->sendMessage( message, size );
+}
+
+void MidiClock :: run( int64_t when )
+{
+  anchor_ = when ? when : MidiScheduler::now();
+  anchorTick_ = ticks_;
+  running_ = true;
+  unsigned int current = ++runs_;
+  next_ = scheduler_.schedule( anchor_, [this, current]() { tick( current ); } );
+}
+
+void MidiClock :: start( int64_t when )
+{
+  std::lock_guard<std::mutex> guard( lock_ );
+  if ( running_ ) scheduler_.cancel( next_ );
+  ticks_ = 0;
+  sendByte( 0xFA );
+  run( when );
+}
+
+void MidiClock :: stop( void )
+{
+  std::lock_guard<std::mutex> guard( lock_ );
+  if ( !running_ ) return;
+  running_ = false;
+  scheduler_.cancel( next_ );
+  sendByte( 0xFC );
+}
+
+void MidiClock :: resume( int64_t when )
+{
+  std::lock_guard<std::mutex> guard( lock_ );
+  if ( running_ ) return;
+  sendByte( 0xFB );
+  run( when );
+}
+
+void MidiClock :: setSongPosition( unsigned int position )
+{
+  std::lock_guard<std::mutex> guard( lock_ );
+  if ( running_ ) return;
+  position &= 0x3FFF;
+  ticks_ = (uint64_t) position * ticksPerSixteenth;
+  unsigned char message[3] = { 0xF2, static_cast<unsigned char>( position & 0x7F ), static_cast<unsigned char>( position >> 7 ) };
+  sendMessage( message, 3 );
+}
+
+unsigned int MidiClock :: getSongPosition( void ) const
+{
+  std::lock_guard<std::mutex> guard( lock_ );
+  return static_cast<unsigned int>( ticks_ / ticksPerSixteenth );
+}
+
+uint64_t MidiClock :: getTicks( void ) const
+{
+  std::lock_guard<std::mutex> guard( lock_ );
+  return ticks_;
+}
+
+bool MidiClock :: isRunning( void ) const
+{
+  std::lock_guard<std::mutex> guard( lock_ );
+  return running_;
+}
+
+// Send this tick and schedule the next from the anchor, not from now.
+// A tick already firing when the clock stopped, or from before a
+// restart, belongs to an old run and is dropped.
+void MidiClock :: tick( unsigned int current )
+{
+  std::lock_guard<std::mutex> guard( lock_ );
+  if ( !running_ || current != runs_ ) return;
+  sendByte( 0xF8 );
+  ticks_++;
+  next_ = scheduler_.schedule( tickTime( ticks_ ), [this, current]() { tick( current ); } );
+}
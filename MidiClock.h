@@ -0,0 +1,110 @@
+/**********************************************************************/
+/*! \file MidiClock.h
+    \brief A MIDI clock master: timing clock, start, stop, continue and song position.
+
+    A MidiClock sends the timing clock (0xF8) 24 times a quarter note
+    while it runs, with Start (0xFA), Stop (0xFC), Continue (0xFB) and
+    Song Position Pointer (0xF2) around it, so Live or a drum machine
+    can follow the C++ side's tempo.
+
+    Each tick's time is worked out from an absolute reference on the
+    MidiScheduler's clock: tick n is due at anchor + (n - anchorTick) *
+    period.  Nothing is accumulated from one tick to the next, so
+    lateness in sending one tick never moves the ones after it and the
+    clock does not drift.  A tempo change moves the anchor to the next
+    tick, so the ticks already sent keep their times.  Each tick is sent
+    from a scheduler event, which also schedules the next.
+
+    The clock's methods may be called from any thread; the ticks are
+    sent on whichever thread drives the scheduler (see MidiScheduler.h
+    for what that means for \e out).
+*/
+/**********************************************************************/
+
+#ifndef MIDICLOCK_H
+#define MIDICLOCK_H
+
+#include <mutex>
+#include <stdint.h>
+#include "MidiOutQueue.h"
+#include "MidiScheduler.h"
+#include "RtMidi.h"
+
+class MidiClock
+{
+ public:
+  //! Ticks per quarter note.
+  static const unsigned int PPQN = 24;
+
+  //! Create a stopped clock at \e bpm beats (quarter notes) per minute, sending to \e out.
+  MidiClock( RtMidiOut *out, MidiScheduler &scheduler, double bpm = 120.0 );
+
+  //! The destructor stops the ticks without sending Stop.  The scheduler must not be firing a tick meanwhile.
+  ~MidiClock( void );
+
+  //! Send through \e queue, which sends to the same output, in its real-time lane (0 for straight to the output).
+  /*!
+      The queue is not safe from other threads, so with one call the
+      clock's methods only from the thread that drives the scheduler.
+  */
+  void setQueue( MidiOutQueue *queue );
+
+  //! Change the tempo from the next tick.
+  void setTempo( double bpm );
+  double getTempo( void ) const;
+
+  //! Send Start and run from the top of the song, with the first tick at \e when (default now).
+  void start( int64_t when = 0 );
+
+  //! Send Stop.  The song position stays where the clock stopped.
+  void stop( void );
+
+  //! Send Continue and run on from the song position, with the next tick at \e when (default now).
+  void resume( int64_t when = 0 );
+
+  //! Move to \e position sixteenth notes (MIDI beats) from the top and send Song Position Pointer.  Only while stopped.
+  void setSongPosition( unsigned int position );
+
+  //! The song position in sixteenth notes, rounded down.
+  unsigned int getSongPosition( void ) const;
+
+  //! Ticks sent since the top of the song.
+  uint64_t getTicks( void ) const;
+
+  //! Whether the clock is running.
+  bool isRunning( void ) const;
+
+  //! The time, on MidiScheduler::now()'s clock, of the tick \e ticks from the top of the song at the current tempo.
+  /*!
+      The result is only meaningful while the clock runs, and for ticks
+      not yet sent.  MidiClock uses it for every tick it sends.
+  */
+  int64_t tickTime( uint64_t ticks ) const;
+
+  //! The time of the first tick at or after \e time whose count from the top of the song is a multiple of \e ticks, or INT64_MAX while stopped.
+  int64_t timeOfNext( unsigned int ticks, int64_t time ) const;
+
+ private:
+  RtMidiOut *out_;
+  MidiScheduler &scheduler_;
+  MidiOutQueue *queue_;
+  mutable std::mutex lock_;
+
+  double period_;           // microseconds per tick
+  int64_t anchor_;          // the time of tick anchorTick_
+  uint64_t anchorTick_;
+  uint64_t ticks_;          // ticks sent from the top of the song
+  bool running_;
+  unsigned int runs_;       // start() and resume() calls, to tell stale ticks
+  MidiScheduler::Handle next_;
+
+  void run( int64_t when );
+  void tick( unsigned int current );
+  void sendByte( unsigned char status );
+  void sendMessage( const unsigned char *message, size_t size );
+
+  MidiClock( const MidiClock & );
+  MidiClock &operator=( const MidiClock & );
+};
+
+#endif
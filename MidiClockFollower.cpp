@@ -0,0 +1,183 @@
+/**********************************************************************/
+/*! \file MidiClockFollower.cpp
+    \brief Follow an external MIDI clock: tempo and beat position from 0xF8, 0xFA, 0xFB, 0xFC and 0xF2.
+*/
+/**********************************************************************/
+
+#include "MidiClockFollower.h"
+#include "MidiClock.h"
+#include "MidiScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Intervals measured before the loop locks, and the outliers in a
+// row, or the gap in ticks, after which it starts again.
+static const size_t acquireIntervals = 4;
+static const unsigned int maximumRejected = 8;
+static const double maximumGap = 4.0;
+
+MidiClockFollower :: MidiClockFollower( double gain )
+  : gain_( gain ), periodGain_( gain * gain / ( 2.0 - gain ) ), period_( 0.0 ), predicted_( 0.0 ),
+    lastArrival_( 0 ), rejected_( 0 ), locked_( false ), running_( false ), position_( 0 ),
+    sequence_( 0 ), anchor_( 0 ), ticks_( 0 ), publishedPeriod_( 0.0 ),
+    publishedRunning_( false ), publishedLocked_( false ), outliers_( 0 )
+{
+}
+
+void MidiClockFollower :: attach( RtMidiIn *in )
+{
+  in->ignoreTypes( true, false, true );
+  in->setCallback( &MidiClockFollower::callback, this );
+}
+
+void MidiClockFollower :: callback( double /*deltatime*/, std::vector<unsigned char> *message, void *follower )
+{
+  if ( !message->empty() )
+    static_cast<MidiClockFollower *>( follower )->receive( &( *message )[0], message->size(), MidiScheduler::now() );
+}
+
+void MidiClockFollower :: receive( const unsigned char *message, size_t size, int64_t time )
+{
+  if ( size < 1 ) return;
+  switch ( message[0] ) {
+  case 0xF8:
+    tick( time );
+    break;
+  case 0xFA:
+    running_ = true;
+    position_ = 0;
+    publish( 0, position_ );
+    break;
+  case 0xFB:
+    running_ = true;
+    publish( 0, position_ );
+    break;
+  case 0xFC:
+    running_ = false;
+    publish( 0, position_ );
+    break;
+  case 0xF2:
+    if ( size < 3 || running_ ) break;
+    position_ = (uint64_t) ( ( message[1] & 0x7F ) | ( ( message[2] & 0x7F ) << 7 ) ) * ( MidiClock::PPQN / 4 );
+    publish( 0, position_ );
+    break;
+  default:
+    break;
+  }
+}
+
+// Until the loop locks, take the median of the first intervals as the
+// period.
+void MidiClockFollower :: acquire( int64_t time )
+{
+  if ( lastArrival_ ) intervals_.push_back( time - lastArrival_ );
+  if ( intervals_.size() < acquireIntervals ) return;
+  std::vector<int64_t> sorted( intervals_ );
+  std::sort( sorted.begin(), sorted.end() );
+  period_ = (double) sorted[sorted.size() / 2];
+  predicted_ = time + period_;
+  locked_ = period_ > 0.0;
+  rejected_ = 0;
+  intervals_.clear();
+}
+
+void MidiClockFollower :: tick( int64_t time )
+{
+  // A gap means the master paused: measure the tempo again.
+  if ( locked_ && time - lastArrival_ > maximumGap * period_ ) {
+    locked_ = false;
+    lastArrival_ = 0;
+  }
+
+  double estimate = (double) time;   // when this tick fell, by the loop
+  if ( !locked_ ) acquire( time );
+  else {
+    double error = time - predicted_;
+    if ( std::fabs( error ) > 0.5 * period_ ) {
+      // Still a tick, so count it, but at the time the loop expected.
+      outliers_.fetch_add( 1, std::memory_order_relaxed );
+      estimate = predicted_;
+      if ( ++rejected_ >= maximumRejected ) {
+        locked_ = false;
+        intervals_.clear();
+      }
+    }
+    else {
+      rejected_ = 0;
+      estimate = predicted_ + gain_ * error;
+      period_ += periodGain_ * error;
+    }
+    predicted_ = estimate + period_;
+  }
+  lastArrival_ = time;
+
+  if ( running_ ) publish( (int64_t) std::llround( estimate ), position_++ );
+  else publish( 0, position_ );
+}
+
+void MidiClockFollower :: publish( int64_t anchor, uint64_t ticks )
+{
+  uint32_t sequence = sequence_.load( std::memory_order_relaxed );
+  sequence_.store( sequence + 1, std::memory_order_relaxed );
+  std::atomic_thread_fence( std::memory_order_release );
+  anchor_.store( anchor, std::memory_order_relaxed );
+  ticks_.store( ticks, std::memory_order_relaxed );
+  publishedPeriod_.store( locked_ ? period_ : 0.0, std::memory_order_relaxed );
+  publishedRunning_.store( running_, std::memory_order_relaxed );
+  publishedLocked_.store( locked_, std::memory_order_relaxed );
+  sequence_.store( sequence + 2, std::memory_order_release );
+}
+
+// Read the published estimate, again if it changed meanwhile.
+MidiClockFollower::Snapshot MidiClockFollower :: snapshot( void ) const
+{
+  Snapshot result;
+  for ( ;; ) {
+    uint32_t sequence = sequence_.load( std::memory_order_acquire );
+    if ( sequence & 1 ) continue;
+    result.anchor = anchor_.load( std::memory_order_relaxed );
+    result.ticks = ticks_.load( std::memory_order_relaxed );
+    result.period = publishedPeriod_.load( std::memory_order_relaxed );
+    result.running = publishedRunning_.load( std::memory_order_relaxed );
+    result.locked = publishedLocked_.load( std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_acquire );
+    if ( sequence_.load( std::memory_order_relaxed ) == sequence ) return result;
+  }
+}
+
+MusicalTime MidiClockFollower :: at( int64_t time ) const
+{
+  Snapshot s = snapshot();
+  MusicalTime result;
+  result.running = s.running;
+  result.locked = s.locked;
+  double position = (double) s.ticks;
+  if ( s.running && s.anchor && s.period > 0.0 )
+    position += std::max( 0.0, std::min( 1.0, ( time - s.anchor ) / s.period ) );
+  result.beats = position / MidiClock::PPQN;
+  result.bpm = s.period > 0.0 ? 60000000.0 / ( s.period * MidiClock::PPQN ) : 0.0;
+  return result;
+}
+
+MusicalTime MidiClockFollower :: now( void ) const
+{
+  return at( MidiScheduler::now() );
+}
+
+int64_t MidiClockFollower :: timeOfBeat( double beats ) const
+{
+  Snapshot s = snapshot();
+  if ( !s.running || !s.anchor || s.period <= 0.0 ) return std::numeric_limits<int64_t>::max();
+  return s.anchor + (int64_t) std::llround( ( beats * MidiClock::PPQN - (double) s.ticks ) * s.period );
+}
+
+int64_t MidiClockFollower :: timeOfNext( unsigned int ticks, int64_t time ) const
+{
+  Snapshot s = snapshot();
+  if ( !s.running || !s.anchor || s.period <= 0.0 || ticks == 0 ) return std::numeric_limits<int64_t>::max();
+  double position = (double) s.ticks + std::max( 0.0, ( time - s.anchor ) / s.period );
+  double next = std::ceil( position / ticks ) * ticks;
+  return s.anchor + (int64_t) std::llround( ( next - (double) s.ticks ) * s.period );
+}
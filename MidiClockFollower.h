@@ -0,0 +1,112 @@
+/**********************************************************************/
+/*! \file MidiClockFollower.h
+    \brief Follow an external MIDI clock: tempo and beat position from 0xF8, 0xFA, 0xFB, 0xFC and 0xF2.
+
+    When Live is the clock master the gesture programs have no idea
+    where the beat is.  A MidiClockFollower takes the master's timing
+    clock from an RtMidiIn (or any caller of receive()) and keeps an
+    estimate of the tempo and of where each tick really fell, so any
+    thread can ask for the current musical time or for when a given
+    beat will come.
+
+    Tick arrival times jitter with the sender, the driver and the
+    operating system.  A phase-locked loop smooths them: each tick is
+    compared with the time the loop predicted for it, and a fraction
+    of the error corrects the phase (gain) and a smaller fraction the
+    period (gain squared over two less gain, a critically damped
+    alpha-beta filter).  An error of more than half a tick is treated
+    as an outlier and ignored; after eight in a row, or a gap of four
+    ticks, the loop starts again from the next intervals.
+
+    The estimate is published through a sequence lock: receive() is
+    the only writer, and at(), now() and timeOfBeat() read without
+    locking or waiting on it, retrying in the rare case that they
+    overlap an update.
+*/
+/**********************************************************************/
+
+#ifndef MIDICLOCKFOLLOWER_H
+#define MIDICLOCKFOLLOWER_H
+
+#include <atomic>
+#include <stdint.h>
+#include <vector>
+#include "RtMidi.h"
+
+//! A position in the followed song.
+struct MusicalTime
+{
+  double beats;     //!< quarter notes from the top of the song
+  double bpm;       //!< the estimated tempo, or 0 before the loop locks
+  bool running;     //!< between Start or Continue and Stop
+  bool locked;      //!< the loop has a tempo
+};
+
+class MidiClockFollower
+{
+ public:
+  //! Create a follower whose loop corrects \e gain of each tick's phase error.
+  MidiClockFollower( double gain = 0.15 );
+
+  //! Take clock messages from \e in: sets its callback and stops it ignoring timing messages.
+  void attach( RtMidiIn *in );
+
+  //! Handle one message that arrived at \e time (MidiScheduler::now()'s clock).  Call from one thread only.
+  void receive( const unsigned char *message, size_t size, int64_t time );
+
+  //! The musical time at \e time.  Safe from any thread; never blocks.
+  /*!
+      Between ticks the position moves on at the estimated tempo, but
+      never past the next tick until that tick arrives.
+  */
+  MusicalTime at( int64_t time ) const;
+
+  //! The musical time now.
+  MusicalTime now( void ) const;
+
+  //! When the song will reach \e beats, or INT64_MAX while stopped or not locked.
+  int64_t timeOfBeat( double beats ) const;
+
+  //! When the song next reaches a multiple of \e ticks at or after \e time, or INT64_MAX while stopped or not locked.
+  int64_t timeOfNext( unsigned int ticks, int64_t time ) const;
+
+  //! Ticks rejected as outliers so far.
+  uint64_t getOutliers( void ) const { return outliers_.load( std::memory_order_relaxed ); }
+
+ private:
+  // The loop, touched only by receive().
+  double gain_, periodGain_;
+  double period_;            // microseconds per tick
+  double predicted_;         // when the next tick should come
+  int64_t lastArrival_;
+  std::vector<int64_t> intervals_;  // while acquiring
+  unsigned int rejected_;    // outliers in a row
+  bool locked_, running_;
+  uint64_t position_;        // song position, in ticks, of the next tick while running
+
+  // The published estimate.
+  std::atomic<uint32_t> sequence_;
+  std::atomic<int64_t> anchor_;       // when the last counted tick fell, by the loop, or 0 for none yet
+  std::atomic<uint64_t> ticks_;       // its song position, or where the song stands when there is none
+  std::atomic<double> publishedPeriod_;  // 0 before the loop locks
+  std::atomic<bool> publishedRunning_, publishedLocked_;
+  std::atomic<uint64_t> outliers_;
+
+  struct Snapshot {
+    int64_t anchor;
+    uint64_t ticks;
+    double period;
+    bool running, locked;
+  };
+
+  Snapshot snapshot( void ) const;
+  void tick( int64_t time );
+  void acquire( int64_t time );
+  void publish( int64_t anchor, uint64_t ticks );
+  static void callback( double deltatime, std::vector<unsigned char> *message, void *follower );
+
+  MidiClockFollower( const MidiClockFollower & );
+  MidiClockFollower &operator=( const MidiClockFollower & );
+};
+
+#endif
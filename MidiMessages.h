@@ -0,0 +1,182 @@
+/**********************************************************************/
+/*! \file MidiMessages.h
+    \brief Compile-time typed MIDI 1.0 message builders.
+
+    Each builder is a small constexpr value type backed by a
+    std::array, so a message lives on the stack and can be handed
+    straight to RtMidiOut::send() or to the pointer/size form of
+    RtMidiOut::sendMessage().
+
+    Channels are numbered 1-16 and, like controller numbers, are
+    template arguments, so an out-of-range channel or controller is a
+    compile error.  Note numbers, velocities and controller values are
+    run-time arguments and are clamped to 0-127 (0-16383 for pitch
+    bend) instead of wrapping into the status bit.
+
+    \code
+    midiout->send( NoteOn<2>( note, 100 ) );
+    midiout->send( ControlChange<1, 7>( volume ) );
+    \endcode
+*/
+/**********************************************************************/
+
+#ifndef MIDIMESSAGES_H
+#define MIDIMESSAGES_H
+
+#include <array>
+#include <stddef.h>
+#include "MidiUmp.h"
+
+//! Clamp a run-time value into a 7-bit MIDI data byte.
+constexpr unsigned char midiClamp7( int value )
+{
+  return value < 0 ? 0 : value > 127 ? 127 : static_cast<unsigned char>( value );
+}
+
+//! Clamp a run-time value into a 14-bit MIDI value.
+constexpr unsigned int midiClamp14( int value )
+{
+  return value < 0 ? 0 : value > 16383 ? 16383 : static_cast<unsigned int>( value );
+}
+
+//! Whether a controller's messages must keep their order and each arrive: bank select, data entry, data increment and decrement, (N)RPN and the channel mode messages (120 and up).
+constexpr bool midiIsOrderedController( unsigned int controller )
+{
+  return controller == 0 || controller == 32 || controller == 6 || controller == 38 ||
+         ( controller >= 96 && controller <= 101 ) || controller >= 120;
+}
+
+//! Find the continuous control a MIDI 1.0 or MIDI 2.0 channel voice packet sets, and its value at 32 bits.
+/*!
+  \e control is the controller number (0-127), 128 for pitch bend or
+  129 for channel pressure.  A MIDI 1.0 value is scaled up with
+  midiUmpScaleUp(), so the same setting compares equal whichever kind
+  of packet carried it.  Returns false for every other packet,
+  including the controllers whose every message counts
+  (midiIsOrderedController()).
+*/
+inline bool midiUmpControl( const MidiUmp &packet, unsigned int &control, uint32_t &value )
+{
+  unsigned int type = packet.type();
+  if ( type != MidiUmp::MIDI1_VOICE && type != MidiUmp::MIDI2_VOICE ) return false;
+  bool wide = type == MidiUmp::MIDI2_VOICE;
+  uint32_t data1 = ( packet.word[0] >> 8 ) & 0x7F, data2 = packet.word[0] & 0x7F;
+  switch ( packet.status() ) {
+  case MidiUmp::CONTROL_CHANGE:
+    if ( midiIsOrderedController( data1 ) ) return false;
+    control = data1;
+    value = wide ? packet.word[1] : midiUmpScaleUp( data2, 7, 32 );
+    return true;
+  case MidiUmp::PITCH_BEND:
+    control = 128;
+    value = wide ? packet.word[1] : midiUmpScaleUp( data1 | data2 << 7, 14, 32 );
+    return true;
+  case MidiUmp::CHANNEL_PRESSURE:
+    control = 129;
+    value = wide ? packet.word[1] : midiUmpScaleUp( data1, 7, 32 );
+    return true;
+  default:
+    return false;
+  }
+}
+
+//! Build the packet that sets \e control (numbered as by midiUmpControl()) on \e channel (0-15) to the 32-bit \e value.
+/*!
+  \e header is the top byte of the first word of the packet that asked
+  for the value, its message type and group, so a MIDI 1.0 packet is
+  rebuilt as one, with the value reduced by midiUmpScaleDown().
+*/
+inline MidiUmp midiUmpControlPacket( unsigned int header, unsigned int channel, unsigned int control, uint32_t value )
+{
+  unsigned int group = header & 0x0F;
+  if ( ( header >> 4 ) == MidiUmp::MIDI2_VOICE ) {
+    if ( control == 128 ) return MidiUmp::pitchBend( channel, value, group );
+    if ( control == 129 ) return MidiUmp::channelPressure( channel, value, group );
+    return MidiUmp::controlChange( channel, control, value, group );
+  }
+  uint32_t word = (uint32_t) header << 24;
+  if ( control == 128 ) {
+    uint32_t bend = midiUmpScaleDown( value, 32, 14 );
+    word |= ( 0xE0u | channel ) << 16 | ( bend & 0x7F ) << 8 | bend >> 7;
+  }
+  else if ( control == 129 ) word |= ( 0xD0u | channel ) << 16 | midiUmpScaleDown( value, 32, 7 ) << 8;
+  else word |= ( 0xB0u | channel ) << 16 | control << 8 | midiUmpScaleDown( value, 32, 7 );
+  return MidiUmp( word );
+}
+
+//! A fixed-size MIDI 1.0 message.
+template <size_t N>
+struct MidiMessage
+{
+  std::array<unsigned char, N> bytes;
+
+  const unsigned char *data() const { return bytes.data(); }
+  static constexpr size_t size() { return N; }
+  constexpr unsigned char operator[]( size_t i ) const { return bytes[i]; }
+
+  //! Returns the message wrapped in a MIDI 1.0 Universal MIDI Packet.
+  MidiUmp ump( unsigned int group = 0 ) const { return MidiUmp::fromMidi1( bytes.data(), N, group ); }
+};
+
+//! Build a channel status byte from a 1-based channel number.
+template <unsigned int Channel>
+struct MidiChannel
+{
+  static_assert( Channel >= 1 && Channel <= 16, "MIDI channels are numbered 1-16" );
+  static constexpr unsigned char status( unsigned char type ) { return static_cast<unsigned char>( type | ( Channel - 1 ) ); }
+};
+
+template <unsigned int Channel>
+struct NoteOn : MidiMessage<3>
+{
+  constexpr NoteOn( int note, int velocity )
+    : MidiMessage<3>{ { { MidiChannel<Channel>::status( 0x90 ), midiClamp7( note ), midiClamp7( velocity ) } } } {}
+};
+
+template <unsigned int Channel>
+struct NoteOff : MidiMessage<3>
+{
+  constexpr NoteOff( int note, int velocity = 0 )
+    : MidiMessage<3>{ { { MidiChannel<Channel>::status( 0x80 ), midiClamp7( note ), midiClamp7( velocity ) } } } {}
+};
+
+template <unsigned int Channel>
+struct PolyPressure : MidiMessage<3>
+{
+  constexpr PolyPressure( int note, int pressure )
+    : MidiMessage<3>{ { { MidiChannel<Channel>::status( 0xA0 ), midiClamp7( note ), midiClamp7( pressure ) } } } {}
+};
+
+template <unsigned int Channel, unsigned int Controller>
+struct ControlChange : MidiMessage<3>
+{
+  static_assert( Controller <= 127, "MIDI controller numbers are 0-127" );
+  constexpr explicit ControlChange( int value )
+    : MidiMessage<3>{ { { MidiChannel<Channel>::status( 0xB0 ), static_cast<unsigned char>( Controller ), midiClamp7( value ) } } } {}
+};
+
+template <unsigned int Channel>
+struct ProgramChange : MidiMessage<2>
+{
+  constexpr explicit ProgramChange( int program )
+    : MidiMessage<2>{ { { MidiChannel<Channel>::status( 0xC0 ), midiClamp7( program ) } } } {}
+};
+
+template <unsigned int Channel>
+struct ChannelPressure : MidiMessage<2>
+{
+  constexpr explicit ChannelPressure( int pressure )
+    : MidiMessage<2>{ { { MidiChannel<Channel>::status( 0xD0 ), midiClamp7( pressure ) } } } {}
+};
+
+//! Pitch bend with a 14-bit value; 8192 is center.
+template <unsigned int Channel>
+struct PitchBend : MidiMessage<3>
+{
+  constexpr explicit PitchBend( int value )
+    : MidiMessage<3>{ { { MidiChannel<Channel>::status( 0xE0 ),
+                          static_cast<unsigned char>( midiClamp14( value ) & 0x7F ),
+                          static_cast<unsigned char>( midiClamp14( value ) >> 7 ) } } } {}
+};
+
+#endif
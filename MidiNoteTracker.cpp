@@ -0,0 +1,113 @@
+/**********************************************************************/
+/*! \file MidiNoteTracker.cpp
+    \brief Know which notes are sounding, so every note gets one note-off.
+*/
+/**********************************************************************/
+
+#include "MidiNoteTracker.h"
+#include "BitScan.h"
+
+MidiNoteTracker :: MidiNoteTracker( RtMidiOut *out )
+  : out_( out ), queue_( 0 ), dropped_( 0 ), retriggered_( 0 )
+{
+  for ( int channel=0; channel<16; channel++ ) {
+    sounding_[channel][0] = sounding_[channel][1] = 0;
+    for ( int note=0; note<128; note++ ) owners_[channel][note] = 0;
+  }
+}
+
+bool MidiNoteTracker :: send( const MidiUmp &packet, unsigned int owner )
+{
+  unsigned int type = packet.type();
+  if ( type == MidiUmp::MIDI1_VOICE || type == MidiUmp::MIDI2_VOICE ) {
+    unsigned int status = packet.status(), channel = packet.channel(), note = packet.index();
+    uint64_t &word = sounding_[channel][note >> 6], bit = (uint64_t) 1 << ( note & 63 );
+    // A note changes only once its message is on its way, so a note-on
+    // the queue refuses never earns a note-off.
+    if ( status == MidiUmp::NOTE_ON && ( type == MidiUmp::MIDI2_VOICE || ( packet.word[0] & 0x7F ) != 0 ) ) {
+      if ( word & bit ) {
+        if ( noteOff( channel, note ) ) word &= ~bit;
+        retriggered_++;
+      }
+      if ( !deliver( packet ) ) return false;
+      word |= bit;
+      owners_[channel][note] = static_cast<uint8_t>( owner );
+      return true;
+    }
+    if ( status == MidiUmp::NOTE_OFF || status == MidiUmp::NOTE_ON ) {
+      if ( !( word & bit ) ) {
+        dropped_++;
+        return false;
+      }
+      if ( !deliver( packet ) ) return false;
+      word &= ~bit;
+      return true;
+    }
+    if ( status == MidiUmp::CONTROL_CHANGE && ( note == 123 || note == 120 ) ) {
+      if ( !deliver( packet ) ) return false;
+      sounding_[channel][0] = sounding_[channel][1] = 0;
+      return true;
+    }
+  }
+  return deliver( packet );
+}
+
+bool MidiNoteTracker :: send( const unsigned char *message, size_t size, unsigned int owner )
+{
+  MidiUmp packet = size <= 3 ? MidiUmp::fromMidi1( message, size ) : MidiUmp();
+  if ( packet.type() != MidiUmp::UTILITY ) return send( packet, owner );
+
+  // Sysex and the like have no packet here.
+  if ( queue_ ) return queue_->send( message, size );
+  out_->sendMessage( message, size );
+  return true;
+}
+
+bool MidiNoteTracker :: noteOff( unsigned int channel, unsigned int note )
+{
+  return deliver( MidiUmp( (uint32_t) MidiUmp::MIDI1_VOICE << 28 | ( 0x80u | channel ) << 16 | note << 8 ) );
+}
+
+unsigned int MidiNoteTracker :: notesOff( void )
+{
+  return notesOff( true, 0 );
+}
+
+unsigned int MidiNoteTracker :: notesOff( unsigned int owner )
+{
+  return notesOff( false, owner );
+}
+
+// Walk only the bits that are set, lowest note first.
+unsigned int MidiNoteTracker :: notesOff( bool all, unsigned int owner )
+{
+  unsigned int count = 0;
+  for ( unsigned int channel=0; channel<16; channel++ ) {
+    for ( unsigned int w=0; w<2; w++ ) {
+      uint64_t bits = sounding_[channel][w];
+      while ( bits ) {
+        unsigned int note = w * 64 + bitLowest( bits );
+        bits &= bits - 1;
+        if ( !all && owners_[channel][note] != owner ) continue;
+        if ( !noteOff( channel, note ) ) continue;
+        sounding_[channel][w] &= ~( (uint64_t) 1 << ( note & 63 ) );
+        count++;
+      }
+    }
+  }
+  return count;
+}
+
+bool MidiNoteTracker :: isSounding( unsigned int channel, unsigned int note ) const
+{
+  if ( channel < 1 || channel > 16 || note > 127 ) return false;
+  return ( sounding_[channel - 1][note >> 6] >> ( note & 63 ) ) & 1;
+}
+
+unsigned int MidiNoteTracker :: sounding( void ) const
+{
+  unsigned int count = 0;
+  for ( int channel=0; channel<16; channel++ )
+    count += bitCount( sounding_[channel][0] ) + bitCount( sounding_[channel][1] );
+  return count;
+}
@@ -0,0 +1,109 @@
+/**********************************************************************/
+/*! \file MidiNoteTracker.h
+    \brief Know which notes are sounding, so every note gets one note-off.
+
+    A MidiNoteTracker sits in front of an RtMidiOut and keeps a bit per
+    note on each channel, 128 bits a channel, set by a note-on and
+    cleared by its note-off.  With that it can:
+
+    - drop a note-off for a note that is not sounding, which only
+      costs bandwidth and can cut off another source's note;
+    - turn a note-on for a note already sounding into a note-off and
+      the note-on, so the receiver never stacks two voices that one
+      note-off would leave half ended;
+    - end exactly the notes still sounding, on exit or when the device
+      that played them goes, with one note-off each, rather than a
+      note-off for all 2048 notes.
+
+    Each note remembers an owner given with its note-on, such as the
+    device that played it, so notesOff() can end one owner's notes and
+    leave the rest.  All Notes Off and All Sound Off (controllers 123
+    and 120) clear their channel's notes as they pass.  Other messages
+    pass straight through.
+
+    Messages go through as MidiUmp packets, MIDI 1.0 or MIDI 2.0 channel
+    voice alike, and reach the output with RtMidiOut::sendUmp().  A
+    MIDI 1.0 note-on with velocity 0 is a note-off; a MIDI 2.0 one is a
+    note-on, as it is once converted.  The note-offs the tracker sends
+    itself are MIDI 1.0 packets.
+
+    Like RtMidiOut, a tracker is used from one thread: the one that
+    drives the MidiScheduler the note-offs are timed with.
+
+    \code
+    MidiNoteTracker notes( midiout );
+    notes.send( NoteOn<1>( 60, 90 ), device );
+    notes.send( NoteOff<1>( 60, 0 ) );
+    notes.send( NoteOff<1>( 60, 0 ) );   // dropped
+    notes.notesOff( device );            // on unpair
+    \endcode
+*/
+/**********************************************************************/
+
+#ifndef MIDINOTETRACKER_H
+#define MIDINOTETRACKER_H
+
+#include <stdint.h>
+#include <type_traits>
+#include "MidiOutQueue.h"
+#include "RtMidi.h"
+
+class MidiNoteTracker
+{
+ public:
+  //! Send to \e out.
+  MidiNoteTracker( RtMidiOut *out );
+
+  //! Send through \e queue, which sends to the same output, rather than straight to the output (0 for straight).
+  void setQueue( MidiOutQueue *queue ) { queue_ = queue; }
+
+  //! Send \e packet, a note-on owned by \e owner (0-255).  Returns false if it was dropped, here or by the queue.
+  /*!
+      A note starts or ends sounding only once its message is sent or
+      queued, so a note-on the queue refuses gets no note-off.
+  */
+  bool send( const MidiUmp &packet, unsigned int owner = 0 );
+
+  //! Send a message as a MIDI 1.0 packet.  A message with no packet, such as sysex, passes as it is.
+  bool send( const unsigned char *message, size_t size, unsigned int owner = 0 );
+
+  //! Send a fixed-size message object (see MidiMessages.h).
+  template <class Message>
+  typename std::enable_if<std::is_class<Message>::value, bool>::type send( const Message &message, unsigned int owner = 0 ) { return send( message.data(), message.size(), owner ); }
+
+  //! Send a note-off for every note sounding.  Returns how many were sent; a note whose note-off the queue refuses stays sounding.
+  unsigned int notesOff( void );
+
+  //! Send a note-off for every note sounding that \e owner played.  Returns how many.
+  unsigned int notesOff( unsigned int owner );
+
+  //! Whether \e note is sounding on \e channel (1-16).
+  bool isSounding( unsigned int channel, unsigned int note ) const;
+
+  //! The number of notes sounding.
+  unsigned int sounding( void ) const;
+
+  //! Note-offs dropped for notes not sounding, and note-ons that ended the same note first.
+  uint64_t getDropped( void ) const { return dropped_; }
+  uint64_t getRetriggered( void ) const { return retriggered_; }
+
+ private:
+  RtMidiOut *out_;
+  MidiOutQueue *queue_;
+  uint64_t sounding_[16][2];    // bit n % 64 of word n / 64 for note n
+  uint8_t owners_[16][128];     // the owner of each note sounding
+  uint64_t dropped_, retriggered_;
+
+  bool deliver( const MidiUmp &packet ) {
+    if ( queue_ ) return queue_->send( packet );
+    out_->sendUmp( packet );
+    return true;
+  }
+  bool noteOff( unsigned int channel, unsigned int note );
+  unsigned int notesOff( bool all, unsigned int owner );
+
+  MidiNoteTracker( const MidiNoteTracker & );
+  MidiNoteTracker &operator=( const MidiNoteTracker & );
+};
+
+#endif
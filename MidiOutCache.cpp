@@ -0,0 +1,260 @@
+/**********************************************************************/
+/*! \file MidiOutCache.cpp
+    \brief Send continuous controllers only when their values change.
+*/
+/**********************************************************************/
+
+#include "MidiOutCache.h"
+#include "MidiMessages.h"
+
+#include <algorithm>
+
+// How far apart two values are in the bits \e mask keeps.
+static uint32_t distance( uint32_t a, uint32_t b, uint32_t mask )
+{
+  a &= mask;
+  b &= mask;
+  return a > b ? a - b : b - a;
+}
+
+MidiOutCache :: MidiOutCache( RtMidiOut *out, MidiScheduler &scheduler, int64_t stale )
+  : out_( out ), scheduler_( scheduler ), queue_( 0 ), tracker_( 0 ), stale_( stale ), wide_( false ), flushHandle_( 0 ), flushDue_( INT64_MAX ),
+    sent_( 0 ), suppressed_( 0 )
+{
+  for ( unsigned int i=0; i<16 * CONTROLS; i++ ) {
+    Slot &slot = slots_[i];
+    slot.time = 0;
+    slot.flushAt = 0;
+    slot.interval = 0;
+    slot.threshold = 0;
+    slot.sent = slot.held = 0;
+    slot.sentHeader = slot.heldHeader = 0;
+  }
+}
+
+MidiOutCache :: ~MidiOutCache( void )
+{
+  if ( flushHandle_ ) scheduler_.cancel( flushHandle_ );
+}
+
+void MidiOutCache :: setLimit( unsigned int channel, unsigned int control, unsigned int threshold, int64_t interval )
+{
+  if ( channel > 16 || control >= CONTROLS ) return;
+  unsigned int first = channel ? channel - 1 : 0, last = channel ? channel : 16;
+  uint64_t scaled = (uint64_t) threshold << ( control == PITCH_BEND ? 18 : 25 );
+  for ( unsigned int c=first; c<last; c++ ) {
+    Slot &slot = slots_[c * CONTROLS + control];
+    slot.threshold = static_cast<uint32_t>( std::min( scaled, (uint64_t) UINT32_MAX ) );
+    slot.interval = static_cast<int32_t>( std::max( (int64_t) 0, std::min( interval, (int64_t) INT32_MAX ) ) );
+  }
+}
+
+// The bits of a value the receiver tells apart.
+uint32_t MidiOutCache :: precision( unsigned int index ) const
+{
+  if ( wide_ ) return UINT32_MAX;
+  return index % CONTROLS == PITCH_BEND ? 0xFFFC0000u : 0xFE000000u;
+}
+
+bool MidiOutCache :: send( const MidiUmp &packet, int64_t due, unsigned int owner )
+{
+  // Find the control, if the packet is one the cache keeps.
+  unsigned int control;
+  uint32_t value;
+  if ( !midiUmpControl( packet, control, value ) ) {
+    if ( due ) later( due, packet, owner );
+    else deliver( packet, owner );
+    sent_++;
+    return true;
+  }
+
+  unsigned int index = packet.channel() * CONTROLS + control;
+  unsigned int header = packet.word[0] >> 24;
+  uint32_t mask = precision( index );
+  Slot &slot = slots_[index];
+  if ( slot.sentHeader && distance( value, slot.sent, mask ) == 0 ) {
+    // Back where the receiver already is: forget anything held.
+    if ( slot.heldHeader ) {
+      slot.heldHeader = 0;
+      heldSlots_.erase( std::find( heldSlots_.begin(), heldSlots_.end(), index ) );
+      suppressed_++;
+    }
+    suppressed_++;
+    return false;
+  }
+  if ( slot.heldHeader && distance( value, slot.held, mask ) == 0 ) {
+    suppressed_++;
+    return false;
+  }
+
+  if ( due ) {
+    // Counts as sent now, ahead of anything held.
+    if ( slot.heldHeader ) {
+      slot.heldHeader = 0;
+      heldSlots_.erase( std::find( heldSlots_.begin(), heldSlots_.end(), index ) );
+      suppressed_++;
+    }
+    slot.sent = value;
+    slot.sentHeader = static_cast<uint8_t>( header );
+    slot.time = due;
+    later( due, packet );
+    sent_++;
+    return true;
+  }
+
+  int64_t now = MidiScheduler::now();
+  if ( slot.sentHeader && ( distance( value, slot.sent, mask ) < slot.threshold || now - slot.time < slot.interval ) ) {
+    hold( index, value, header, now );
+    return false;
+  }
+  transmit( index, value, header, now );
+  return true;
+}
+
+bool MidiOutCache :: send( const unsigned char *message, size_t size, int64_t due, unsigned int owner )
+{
+  MidiUmp packet = size <= 3 ? MidiUmp::fromMidi1( message, size ) : MidiUmp();
+  if ( packet.type() != MidiUmp::UTILITY ) return send( packet, due, owner );
+
+  // Sysex and the like have no packet here.
+  if ( due ) {
+    std::vector<unsigned char> bytes( message, message + size );
+    scheduler_.schedule( due, [this, bytes]( void ) { deliver( bytes.data(), bytes.size() ); } );
+  }
+  else deliver( message, size );
+  sent_++;
+  return true;
+}
+
+// Keep \e value for later and make sure a flush will send it.
+void MidiOutCache :: hold( unsigned int index, uint32_t value, unsigned int header, int64_t now )
+{
+  Slot &slot = slots_[index];
+
+  // As soon as the interval allows, or after the stale time for a
+  // change under the threshold, but never later than first arranged.
+  int64_t due = slot.time + slot.interval;
+  if ( distance( value, slot.sent, precision( index ) ) < slot.threshold ) due = std::max( due, now + stale_ );
+  if ( slot.heldHeader ) {
+    slot.flushAt = std::min( slot.flushAt, due );
+    suppressed_++;
+  }
+  else {
+    slot.flushAt = due;
+    heldSlots_.push_back( static_cast<uint16_t>( index ) );
+  }
+  slot.held = value;
+  slot.heldHeader = static_cast<uint8_t>( header );
+  schedule( slot.flushAt );
+}
+
+void MidiOutCache :: transmit( unsigned int index, uint32_t value, unsigned int header, int64_t now )
+{
+  Slot &slot = slots_[index];
+  if ( slot.heldHeader ) {
+    if ( distance( value, slot.held, precision( index ) ) != 0 ) suppressed_++;
+    slot.heldHeader = 0;
+    heldSlots_.erase( std::find( heldSlots_.begin(), heldSlots_.end(), index ) );
+  }
+
+  deliver( midiUmpControlPacket( header, index / CONTROLS, index % CONTROLS, value ) );
+  slot.sent = value;
+  slot.sentHeader = static_cast<uint8_t>( header );
+  slot.time = now;
+  sent_++;
+}
+
+// The scheduled flush: send the held values that are due and arrange
+// the next flush for the rest.
+void MidiOutCache :: expire( void )
+{
+  flushHandle_ = 0;
+  flushDue_ = INT64_MAX;
+  int64_t now = MidiScheduler::now(), next = INT64_MAX;
+  for ( size_t i=0; i<heldSlots_.size(); ) {
+    unsigned int index = heldSlots_[i];
+    Slot &slot = slots_[index];
+    if ( slot.flushAt <= now ) transmit( index, slot.held, slot.heldHeader, now );
+    else {
+      next = std::min( next, slot.flushAt );
+      i++;
+    }
+  }
+  if ( next != INT64_MAX ) schedule( next );
+}
+
+void MidiOutCache :: schedule( int64_t due )
+{
+  if ( due >= flushDue_ ) return;
+  if ( flushHandle_ ) scheduler_.cancel( flushHandle_ );
+  flushHandle_ = scheduler_.schedule( due, [this]( void ) { expire(); } );
+  flushDue_ = due;
+}
+
+void MidiOutCache :: deliver( const MidiUmp &packet, unsigned int owner )
+{
+  if ( tracker_ ) tracker_->send( packet, owner );
+  else if ( queue_ ) queue_->send( packet );
+  else out_->sendUmp( packet );
+}
+
+void MidiOutCache :: deliver( const unsigned char *message, size_t size )
+{
+  if ( tracker_ ) tracker_->send( message, size );
+  else if ( queue_ ) queue_->send( message, size );
+  else out_->sendMessage( message, size );
+}
+
+MidiScheduler::Handle MidiOutCache :: later( int64_t due, const MidiUmp &packet, unsigned int owner )
+{
+  if ( !queue_ && !tracker_ ) return scheduler_.send( due, out_, packet );
+
+  // A one-word packet is packed into the callback, which then needs no
+  // allocation.  A MIDI 2.0 packet is bigger than the callback's own
+  // storage and is captured as it is.
+  if ( packet.size() == 1 ) {
+    uint64_t packed = packet.word[0] | (uint64_t) ( owner & 0xFF ) << 32;
+    return scheduler_.schedule( due, [this, packed]( void ) {
+        deliver( MidiUmp( static_cast<uint32_t>( packed ) ), static_cast<unsigned int>( packed >> 32 ) );
+      } );
+  }
+  return scheduler_.schedule( due, [this, packet, owner]( void ) { deliver( packet, owner ); } );
+}
+
+MidiScheduler::Handle MidiOutCache :: later( int64_t due, const unsigned char *message, size_t size, unsigned int owner )
+{
+  return later( due, size <= 3 ? MidiUmp::fromMidi1( message, size ) : MidiUmp(), owner );
+}
+
+void MidiOutCache :: flush( void )
+{
+  int64_t now = MidiScheduler::now();
+  while ( !heldSlots_.empty() ) {
+    const Slot &slot = slots_[heldSlots_.back()];
+    transmit( heldSlots_.back(), slot.held, slot.heldHeader, now );
+  }
+  if ( flushHandle_ ) scheduler_.cancel( flushHandle_ );
+  flushHandle_ = 0;
+  flushDue_ = INT64_MAX;
+}
+
+void MidiOutCache :: clear( void )
+{
+  suppressed_ += heldSlots_.size();
+  heldSlots_.clear();
+  for ( unsigned int i=0; i<16 * CONTROLS; i++ ) {
+    slots_[i].sentHeader = 0;
+    slots_[i].heldHeader = 0;
+  }
+  if ( flushHandle_ ) scheduler_.cancel( flushHandle_ );
+  flushHandle_ = 0;
+  flushDue_ = INT64_MAX;
+}
+
+int64_t MidiOutCache :: value( unsigned int channel, unsigned int control ) const
+{
+  if ( channel < 1 || channel > 16 || control >= CONTROLS ) return -1;
+  const Slot &slot = slots_[( channel - 1 ) * CONTROLS + control];
+  if ( slot.heldHeader ) return slot.held;
+  return slot.sentHeader ? (int64_t) slot.sent : -1;
+}
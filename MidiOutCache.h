@@ -0,0 +1,161 @@
+/**********************************************************************/
+/*! \file MidiOutCache.h
+    \brief Send continuous controllers only when their values change.
+
+    The mappings send a controller on every orientation event, 50 times
+    a second per armband, whether or not its value has moved.  A
+    MidiOutCache sits in front of an RtMidiOut and keeps the last value
+    sent of every controller on every channel (16 x 128), and of each
+    channel's pitch bend and channel pressure.  A value equal to the
+    last one sent is dropped.  Other messages pass straight through,
+    and so do the controllers whose every message counts, such as data
+    increment, the (N)RPN numbers and All Notes Off (see
+    midiIsOrderedController() in MidiMessages.h).
+
+    A controller may also be limited: a threshold drops changes smaller
+    than it, and an interval drops changes sooner than it after the
+    last one sent.  A value held back by a limit is not lost: the cache
+    keeps the latest, and a flush that the cache schedules on its
+    MidiScheduler sends it when the interval has passed, or after the
+    stale time for one held by the threshold, so the receiver always
+    ends up at the value last asked for.
+
+    With setTracker() every message goes on through a MidiNoteTracker,
+    and with setQueue() through a MidiOutQueue, which paces them to the
+    port and sends notes ahead of controllers.
+
+    Messages go through as MidiUmp packets, MIDI 1.0 or MIDI 2.0
+    channel voice alike, and reach the output with
+    RtMidiOut::sendUmp().  The cache keeps each control's value at 32
+    bits, a MIDI 1.0 value scaled up with midiUmpScaleUp(), and sends
+    it in the message type and group of the packet that asked for it.
+    Values are compared at the precision the receiver gets: by default
+    the 7 bits, 14 for pitch bend, that every RtMidi backend converts
+    to, so two values that differ only below that are a repeat; with
+    setWide() at the full 32 bits.
+
+    The cache sends on the thread that calls send() and, for the
+    flush, on the thread that drives the scheduler, so use it from the
+    thread that drives the scheduler, as with RtMidiOut itself.
+
+    \code
+    MidiOutCache cache( midiout, scheduler );
+    cache.setLimit( 1, 7, 2, 20000 );   // CC 7 on channel 1: steps of 2, 50 a second
+    cache.send( ControlChange<1, 7>( volume ) );
+    \endcode
+*/
+/**********************************************************************/
+
+#ifndef MIDIOUTCACHE_H
+#define MIDIOUTCACHE_H
+
+#include <stdint.h>
+#include <type_traits>
+#include <vector>
+#include "MidiNoteTracker.h"
+#include "MidiOutQueue.h"
+#include "MidiScheduler.h"
+#include "RtMidi.h"
+
+class MidiOutCache
+{
+ public:
+  //! Controls after the 128 controllers.
+  enum { PITCH_BEND = 128, CHANNEL_PRESSURE = 129, CONTROLS = 130 };
+
+  //! Send to \e out, flushing held values with \e scheduler at most \e stale microseconds after they were held.
+  MidiOutCache( RtMidiOut *out, MidiScheduler &scheduler, int64_t stale = 50000 );
+
+  //! The destructor cancels the pending flush without sending.
+  ~MidiOutCache( void );
+
+  //! Limit \e control (0-127, PITCH_BEND or CHANNEL_PRESSURE) on \e channel (1-16, or 0 for all) to changes of at least \e threshold, at least \e interval microseconds apart.
+  /*!
+      A pitch bend's threshold is in its 14-bit units and the others
+      in 7-bit units, whatever the precision compared.  0 and 0 leave
+      only the check for an unchanged value.
+  */
+  void setLimit( unsigned int channel, unsigned int control, unsigned int threshold, int64_t interval );
+
+  //! Compare values at the 32 bits a MIDI 2.0 receiver gets (true), rather than the 7 bits, 14 for pitch bend, of a MIDI 1.0 one.
+  void setWide( bool wide ) { wide_ = wide; }
+
+  //! Send through \e queue, which must send to the same output, rather than straight to the output (0 for straight).
+  void setQueue( MidiOutQueue *queue ) { queue_ = queue; }
+
+  //! Send through \e tracker, which must send to the same output or queue, as messages go (0 for none).
+  void setTracker( MidiNoteTracker *tracker ) { tracker_ = tracker; }
+
+  //! Send \e packet at time \e due (0 for now), unless it only repeats a value.  Returns false if it was dropped or held.
+  /*!
+      A packet for later is handed to the scheduler and counts as
+      sent at once, so a held value never overtakes it.  \e owner goes
+      to the tracker with a note-on.
+  */
+  bool send( const MidiUmp &packet, int64_t due = 0, unsigned int owner = 0 );
+
+  //! Send a message as a MIDI 1.0 packet, as above.  A message with no packet, such as sysex, passes the cache as it is.
+  bool send( const unsigned char *message, size_t size, int64_t due = 0, unsigned int owner = 0 );
+
+  //! Send a fixed-size message object (see MidiMessages.h).
+  template <class Message>
+  typename std::enable_if<std::is_class<Message>::value, bool>::type send( const Message &message, int64_t due = 0, unsigned int owner = 0 ) { return send( message.data(), message.size(), due, owner ); }
+
+  //! Send \e packet at time \e due as it is, past the cache but through the tracker and queue if there are any.  Returns the scheduler's handle, for MidiScheduler::cancel().
+  /*!
+      With a tracker or queue, the scheduler calls back into the cache,
+      so cancel what is pending before destroying it.
+  */
+  MidiScheduler::Handle later( int64_t due, const MidiUmp &packet, unsigned int owner = 0 );
+
+  //! Send a message of 1 to 3 bytes at time \e due as a MIDI 1.0 packet, as above.
+  MidiScheduler::Handle later( int64_t due, const unsigned char *message, size_t size, unsigned int owner = 0 );
+
+  //! Send every held value now.
+  void flush( void );
+
+  //! Forget the values sent, so the next value of each control is sent whatever it is.  Held values are dropped.
+  void clear( void );
+
+  //! The last value asked for of \e control on \e channel (1-16), sent or held, at 32 bits, or -1 for none.
+  int64_t value( unsigned int channel, unsigned int control ) const;
+
+  //! Messages that reached the output, and those asked for that never will: dropped, or held and then replaced.
+  uint64_t getSent( void ) const { return sent_; }
+  uint64_t getSuppressed( void ) const { return suppressed_; }
+
+ private:
+  struct Slot {
+    int64_t time;        // when the value was sent
+    int64_t flushAt;     // when the held value goes, if there is one
+    int32_t interval;
+    uint32_t threshold;
+    uint32_t sent, held;
+    uint8_t sentHeader, heldHeader;  // the type and group the value came with, or 0 for none
+  };
+
+  RtMidiOut *out_;
+  MidiScheduler &scheduler_;
+  MidiOutQueue *queue_;
+  MidiNoteTracker *tracker_;
+  int64_t stale_;
+  bool wide_;
+  Slot slots_[16 * CONTROLS];
+  std::vector<uint16_t> heldSlots_;  // the slots holding a value
+  MidiScheduler::Handle flushHandle_;
+  int64_t flushDue_;                 // INT64_MAX with none scheduled
+  uint64_t sent_, suppressed_;
+
+  uint32_t precision( unsigned int index ) const;
+  void hold( unsigned int index, uint32_t value, unsigned int header, int64_t now );
+  void transmit( unsigned int index, uint32_t value, unsigned int header, int64_t now );
+  void expire( void );
+  void schedule( int64_t due );
+  void deliver( const MidiUmp &packet, unsigned int owner = 0 );
+  void deliver( const unsigned char *message, size_t size );
+
+  MidiOutCache( const MidiOutCache & );
+  MidiOutCache &operator=( const MidiOutCache & );
+};
+
+#endif
@@ -0,0 +1,188 @@
+/**********************************************************************/
+/*! \file KeyboardController.cpp
+    \brief Play MIDI from the computer keyboard as keys arrive.
+*/
+/**********************************************************************/
+
+#include "KeyboardController.h"
+#include "MidiMessages.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <sys/select.h>
+#include <unistd.h>
+
+// How long a note sounds, in microseconds, and how far a key moves a controller.
+static const int64_t noteLength = 50000;
+static const int controllerStep = 3;
+
+RawTerminal :: RawTerminal( int fd )
+  : fd_( fd ), raw_( false )
+{
+  if ( !isatty( fd ) || tcgetattr( fd, &saved_ ) != 0 ) return;
+  struct termios raw = saved_;
+  raw.c_iflag &= ~( IXON | ICRNL | INLCR | IGNCR );
+  raw.c_lflag &= ~( ICANON | ECHO | IEXTEN );
+  raw.c_cc[VMIN] = 1;
+  raw.c_cc[VTIME] = 0;
+  raw_ = tcsetattr( fd, TCSANOW, &raw ) == 0;
+}
+
+RawTerminal :: ~RawTerminal( void )
+{
+  if ( raw_ ) tcsetattr( fd_, TCSANOW, &saved_ );
+}
+
+KeyboardController :: KeyboardController( RtMidiOut *out, MidiScheduler &scheduler, AsyncLog *log )
+  : out_( out ), scheduler_( scheduler ), log_( log ), keyFormat_( 0 ), display_( 0 ),
+    note_( 60 ), volume_( 100 ), modulation_( 100 ), quit_( false ), escapeLength_( 0 )
+{
+  for ( int i=0; i<128; i++ ) noteOffs_[i] = 0;
+  if ( log ) keyFormat_ = log->define( "key {}: note {} volume {} modulation {}" );
+  if ( pipe( wakeFds_ ) != 0 )
+    throw std::runtime_error( std::string( "KeyboardController: cannot create a pipe: " ) + strerror( errno ) );
+  for ( int i=0; i<2; i++ ) fcntl( wakeFds_[i], F_SETFL, fcntl( wakeFds_[i], F_GETFL ) | O_NONBLOCK );
+}
+
+KeyboardController :: ~KeyboardController( void )
+{
+  close( wakeFds_[0] );
+  close( wakeFds_[1] );
+}
+
+void KeyboardController :: stop( void )
+{
+  char byte = 0;
+  if ( write( wakeFds_[1], &byte, 1 ) < 0 ) {}
+}
+
+void KeyboardController :: run( int fd )
+{
+  quit_ = false;
+  bool stopped = false;
+  while ( !quit_ && !stopped ) {
+    scheduler_.advance( MidiScheduler::now() );
+
+    // Sleep until a key, a stop() or the next note-off.
+    fd_set readable;
+    FD_ZERO( &readable );
+    FD_SET( fd, &readable );
+    FD_SET( wakeFds_[0], &readable );
+    struct timeval timeout, *timeoutPointer = 0;
+    int64_t due = scheduler_.nextDue();
+    if ( due != INT64_MAX ) {
+      int64_t remaining = std::max( (int64_t) 0, due - MidiScheduler::now() );
+      timeout.tv_sec = remaining / 1000000;
+      timeout.tv_usec = remaining % 1000000;
+      timeoutPointer = &timeout;
+    }
+    int ready = select( std::max( fd, wakeFds_[0] ) + 1, &readable, 0, 0, timeoutPointer );
+    if ( ready < 0 ) {
+      if ( errno == EINTR ) continue;
+      throw std::runtime_error( std::string( "KeyboardController: select: " ) + strerror( errno ) );
+    }
+    if ( ready == 0 ) continue;
+
+    if ( FD_ISSET( fd, &readable ) ) {
+      unsigned char buffer[64];
+      ssize_t size = read( fd, buffer, sizeof( buffer ) );
+      if ( size <= 0 && !( size < 0 && ( errno == EINTR || errno == EAGAIN ) ) ) break;
+      if ( size > 0 ) feed( buffer, (size_t) size );
+    }
+    if ( FD_ISSET( wakeFds_[0], &readable ) ) {
+      char buffer[64];
+      while ( read( wakeFds_[0], buffer, sizeof( buffer ) ) > 0 ) {}
+      stopped = true;
+    }
+  }
+
+  // End the notes still sounding.
+  scheduler_.advance( MidiScheduler::now() + noteLength );
+  for ( int i=0; i<128; i++ ) noteOffs_[i] = 0;
+}
+
+// Arrows come as ESC [ C or ESC O C and the like; anything else after
+// an ESC ends the sequence and is read as a key.
+bool KeyboardController :: feed( const unsigned char *bytes, size_t size )
+{
+  for ( size_t i=0; i<size && !quit_; i++ ) {
+    unsigned char b = bytes[i];
+    if ( escapeLength_ == 0 ) {
+      if ( b == 0x1b ) escape_[escapeLength_++] = b;
+      else key( b );
+      continue;
+    }
+    if ( escapeLength_ == 1 && b != '[' && b != 'O' ) {
+      escapeLength_ = 0;
+      if ( b == 0x1b ) escape_[escapeLength_++] = b;
+      else key( b );
+      continue;
+    }
+    escape_[escapeLength_++] = b;
+    if ( escapeLength_ > 2 && b >= 0x40 && b <= 0x7e ) {
+      if ( escapeLength_ == 3 ) arrow( b );
+      escapeLength_ = 0;
+    }
+    else if ( escapeLength_ == sizeof( escape_ ) ) escapeLength_ = 0;
+  }
+  return !quit_;
+}
+
+void KeyboardController :: arrow( unsigned char final )
+{
+  if ( final == 'D' && note_ > 0 ) play( --note_ );
+  else if ( final == 'C' && note_ < 127 ) play( ++note_ );
+  else return;
+  if ( log_ ) log_->log( keyFormat_, final == 'D' ? "left" : "right", note_, volume_, modulation_ );
+  show();
+}
+
+void KeyboardController :: key( unsigned char key )
+{
+  switch ( key ) {
+  case 'a':
+  case 'd':
+    volume_ = std::max( 0, std::min( 127, volume_ + ( key == 'd' ? controllerStep : -controllerStep ) ) );
+    out_->send( ControlChange<1, 7>( volume_ ) );
+    break;
+  case 'z':
+  case 'c':
+    modulation_ = std::max( 0, std::min( 127, modulation_ + ( key == 'c' ? controllerStep : -controllerStep ) ) );
+    out_->send( ControlChange<1, 1>( modulation_ ) );
+    break;
+  case 'q':
+    quit_ = true;
+    return;
+  default:
+    return;
+  }
+  if ( log_ ) {
+    static const char *names[] = { "a", "d", "z", "c" };
+    log_->log( keyFormat_, names[key == 'a' ? 0 : key == 'd' ? 1 : key == 'z' ? 2 : 3], note_, volume_, modulation_ );
+  }
+  show();
+}
+
+// Play \e note now and schedule its note-off.  Playing a note again
+// before its note-off ends the first at once.
+void KeyboardController :: play( int note )
+{
+  MidiScheduler::Handle &handle = noteOffs_[note];
+  if ( handle && scheduler_.cancel( handle ) ) out_->send( NoteOff<1>( note, 80 ) );
+  out_->send( NoteOn<1>( note, 80 ) );
+  handle = scheduler_.send( MidiScheduler::now() + noteLength, out_, NoteOff<1>( note, 80 ) );
+}
+
+// After the MIDI has gone, so the terminal never delays it.
+void KeyboardController :: show( void )
+{
+  if ( !display_ ) return;
+  char line[80];
+  snprintf( line, sizeof( line ), "\rnote %3d   volume %3d   modulation %3d \033[K", note_, volume_, modulation_ );
+  *display_ << line << std::flush;
+}
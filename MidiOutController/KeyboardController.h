@@ -0,0 +1,93 @@
+/**********************************************************************/
+/*! \file KeyboardController.h
+    \brief Play MIDI from the computer keyboard as keys arrive.
+
+    midiout used ncurses' getch() with a timeout, in a loop that also
+    slept, so a key could wait for the loop to come round.  A
+    KeyboardController reads the terminal in raw mode and waits in
+    select() on it and on the note scheduler's next note-off at once:
+    a key is decoded and its MIDI sent as soon as the bytes arrive, and
+    each note's note-off is scheduled rather than slept, so fast
+    repeats are never held up.
+
+    \verbatim
+    left, right    play the note below or above the last
+    a, d           CC 7 (volume) down or up
+    z, c           CC 1 (modulation) down or up
+    q              quit
+    \endverbatim
+
+    Messages go to \e out on the thread that calls run(), which also
+    sends the note-offs, so the scheduler needs no thread of its own.
+*/
+/**********************************************************************/
+
+#ifndef KEYBOARDCONTROLLER_H
+#define KEYBOARDCONTROLLER_H
+
+#include <ostream>
+#include <stdint.h>
+#include <termios.h>
+#include "AsyncLog.h"
+#include "MidiScheduler.h"
+#include "RtMidi.h"
+
+//! Puts a terminal in raw mode until destroyed.  Does nothing if \e fd is not a terminal.
+class RawTerminal
+{
+ public:
+  RawTerminal( int fd );
+  ~RawTerminal( void );
+
+ private:
+  int fd_;
+  bool raw_;
+  struct termios saved_;
+};
+
+class KeyboardController
+{
+ public:
+  //! Play to \e out on channel 1, timing note-offs with \e scheduler and logging keys to \e log if given.
+  KeyboardController( RtMidiOut *out, MidiScheduler &scheduler, AsyncLog *log = 0 );
+  ~KeyboardController( void );
+
+  //! Write the note and controller values to \e display after each key (0 for none).
+  void setDisplay( std::ostream *display ) { display_ = display; }
+
+  //! Handle keys from \e fd and send note-offs as they fall due until q, the end of the input or stop().  Sends the note-offs still pending before returning.
+  void run( int fd );
+
+  //! Make run() return.  Safe from any thread.
+  void stop( void );
+
+  //! Decode and play \e size bytes of terminal input.  Returns false once q has been pressed.
+  bool feed( const unsigned char *bytes, size_t size );
+
+ private:
+  RtMidiOut *out_;
+  MidiScheduler &scheduler_;
+  AsyncLog *log_;
+  AsyncLog::Format keyFormat_;
+  std::ostream *display_;
+
+  int note_, volume_, modulation_;
+  bool quit_;
+  MidiScheduler::Handle noteOffs_[128];  // pending note-off per note, or 0
+
+  // An escape sequence read so far, which may span reads.
+  unsigned char escape_[8];
+  size_t escapeLength_;
+
+  int wakeFds_[2];
+
+  void key( unsigned char key );
+  void arrow( unsigned char final );
+  void play( int note );
+  void show( void );
+
+  KeyboardController( const KeyboardController & );
+  KeyboardController &operator=( const KeyboardController & );
+};
+
+#endif
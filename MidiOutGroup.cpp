@@ -0,0 +1,106 @@
+/**********************************************************************/
+/*! \file MidiOutGroup.cpp
+    \brief Send one MIDI stream to several destinations.
+*/
+/**********************************************************************/
+
+#include "MidiOutGroup.h"
+#include "MidiUmp.h"
+
+MidiOutGroup :: MidiOutGroup( const std::string clientName )
+  : clientName_( clientName ), destinationCount_( 0 )
+{
+}
+
+MidiOutGroup :: ~MidiOutGroup( void )
+{
+  for ( size_t i=0; i<outputs_.size(); ++i )
+    delete outputs_[i].out;
+}
+
+MidiOutGroup::Output &MidiOutGroup :: newOutput( RtMidiOut *out, const MidiOutFilter &filter )
+{
+  Output output;
+  output.out = out;
+  output.api = output.out->getCurrentApi();
+  output.filter = filter;
+  output.acceptsAll = ( filter == MidiOutFilter() );
+  outputs_.push_back( output );
+  return outputs_.back();
+}
+
+unsigned int MidiOutGroup :: addDestination( RtMidi::Api api, unsigned int portNumber,
+                                             const MidiOutFilter &filter, const std::string portName )
+{
+  // The outputs hold the API RtMidiOut picked, so let it pick one for
+  // UNSPECIFIED before comparing.
+  RtMidiOut *out = 0;
+  if ( api == RtMidi::UNSPECIFIED ) {
+    out = new RtMidiOut( api, clientName_ );
+    api = out->getCurrentApi();
+  }
+
+  // Share an output with a matching API and filter if the API lets
+  // one port feed several destinations.
+  for ( size_t i=0; i<outputs_.size(); ++i ) {
+    Output &output = outputs_[i];
+    if ( output.api == api && output.filter == filter && output.out->isPortOpen() &&
+         output.out->connectPort( portNumber ) ) {
+      delete out;
+      return destinationCount_++;
+    }
+  }
+
+  Output &output = newOutput( out ? out : new RtMidiOut( api, clientName_ ), filter );
+  try {
+    output.out->openPort( portNumber, portName );
+  }
+  catch ( RtMidiError & ) {
+    delete output.out;
+    outputs_.pop_back();
+    throw;
+  }
+  return destinationCount_++;
+}
+
+unsigned int MidiOutGroup :: addVirtualDestination( RtMidi::Api api, const std::string portName,
+                                                    const MidiOutFilter &filter )
+{
+  Output &output = newOutput( new RtMidiOut( api, clientName_ ), filter );
+  try {
+    output.out->openVirtualPort( portName );
+  }
+  catch ( RtMidiError & ) {
+    delete output.out;
+    outputs_.pop_back();
+    throw;
+  }
+  return destinationCount_++;
+}
+
+void MidiOutGroup :: sendMessage( const unsigned char *message, size_t size )
+{
+  if ( size == 0 ) return;
+  unsigned char status = message[0];
+  for ( size_t i=0; i<outputs_.size(); ++i ) {
+    const Output &output = outputs_[i];
+    if ( output.acceptsAll || output.filter.passes( status ) )
+      output.out->sendMessage( message, size );
+  }
+}
+
+void MidiOutGroup :: sendUmp( const MidiUmp &packet )
+{
+  unsigned char bytes[3];
+  size_t nBytes = midiUmpToMidi1( packet, bytes );
+  if ( nBytes == 0 ) return;
+
+  for ( size_t i=0; i<outputs_.size(); ++i ) {
+    const Output &output = outputs_[i];
+    if ( !output.acceptsAll && !output.filter.passes( bytes[0] ) ) continue;
+    if ( output.api == RtMidi::LINUX_ALSA )
+      output.out->sendUmp( packet );
+    else
+      output.out->sendMessage( bytes, nBytes );
+  }
+}
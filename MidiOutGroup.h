@@ -0,0 +1,147 @@
+/**********************************************************************/
+/*! \file MidiOutGroup.h
+    \brief Send one MIDI stream to several destinations.
+
+    A MidiOutGroup owns the outputs for a set of destinations, which
+    may be spread across APIs, and sends every message to each
+    destination whose filter passes it.  A message is built once by
+    the caller (or converted once from a MidiUmp) and the same bytes
+    are handed to every output.
+
+    Destinations with the same API and the same filter share one
+    output port when the API supports it (see
+    RtMidiOut::connectPort()).  On ALSA that is one sequencer port
+    with one subscription per destination, so adding a destination
+    adds no work on the sending thread.
+
+    \code
+    MidiOutGroup group;
+    group.addDestination( RtMidi::LINUX_ALSA, abletonPort );
+    group.addDestination( RtMidi::LINUX_ALSA, looperPort,
+                          MidiOutFilter( MidiOutFilter::ALL_CHANNELS, MidiOutFilter::CONTROL_CHANGE ) );
+    group.send( ControlChange<1, 7>( volume ) );
+    \endcode
+*/
+/**********************************************************************/
+
+#ifndef MIDIOUTGROUP_H
+#define MIDIOUTGROUP_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "RtMidi.h"
+
+//! Selects the messages that a group destination receives.
+/*!
+    A message passes if both its channel and its type are enabled.
+    System messages (status 0xF0 and above) have no channel and are
+    selected by the SYSTEM type bit alone.
+*/
+struct MidiOutFilter
+{
+  //! Message type bits.
+  enum Type {
+    NOTE_OFF         = 0x01,
+    NOTE_ON          = 0x02,
+    POLY_PRESSURE    = 0x04,
+    CONTROL_CHANGE   = 0x08,
+    PROGRAM_CHANGE   = 0x10,
+    CHANNEL_PRESSURE = 0x20,
+    PITCH_BEND       = 0x40,
+    SYSTEM           = 0x80,
+    ALL_TYPES        = 0xFF
+  };
+
+  static const uint16_t ALL_CHANNELS = 0xFFFF;
+
+  uint16_t channels; //!< bit n passes channel n+1
+  uint8_t types;     //!< Type bits
+
+  MidiOutFilter( uint16_t channelMask = ALL_CHANNELS, uint8_t typeMask = ALL_TYPES )
+    : channels( channelMask ), types( typeMask ) {}
+
+  //! A filter that passes every message type on one channel (1-16).
+  static MidiOutFilter channel( unsigned int channel ) { return MidiOutFilter( static_cast<uint16_t>( 1 << ( ( channel - 1 ) & 0x0F ) ) ); }
+
+  //! Returns true if a message starting with \e status passes.
+  bool passes( unsigned char status ) const
+  {
+    if ( status < 0x80 ) return true;
+    if ( status >= 0xF0 ) return ( types & SYSTEM ) != 0;
+    return ( ( types >> ( ( status >> 4 ) - 8 ) ) & ( channels >> ( status & 0x0F ) ) & 1 ) != 0;
+  }
+
+  bool operator==( const MidiOutFilter &other ) const { return channels == other.channels && types == other.types; }
+  bool operator!=( const MidiOutFilter &other ) const { return !( *this == other ); }
+};
+
+class MidiOutGroup
+{
+ public:
+
+  //! Create an empty group.  Outputs opened later use \e clientName.
+  MidiOutGroup( const std::string clientName = std::string( "RtMidi Output Group" ) );
+
+  //! The destructor closes every output.
+  ~MidiOutGroup( void );
+
+  //! Add a destination port and return its index.
+  /*!
+      If an output with the same API and filter is already open and
+      the API supports it, the destination is connected to that
+      output.  RtMidi::UNSPECIFIED stands for the API RtMidiOut would
+      pick, and shares an output of that API.  Otherwise a new output is opened.  An exception is
+      thrown if the port cannot be opened.
+  */
+  unsigned int addDestination( RtMidi::Api api, unsigned int portNumber,
+                               const MidiOutFilter &filter = MidiOutFilter(),
+                               const std::string portName = std::string( "RtMidi Output" ) );
+
+  //! Add a virtual output port as a destination and return its index (OS X, JACK, ALSA and loopback only).
+  unsigned int addVirtualDestination( RtMidi::Api api, const std::string portName,
+                                      const MidiOutFilter &filter = MidiOutFilter() );
+
+  //! Returns the number of destinations added so far.
+  unsigned int getDestinationCount( void ) const { return destinationCount_; }
+
+  //! Returns the number of output ports the destinations share.
+  unsigned int getOutputCount( void ) const { return static_cast<unsigned int>( outputs_.size() ); }
+
+  //! Send a message to every destination whose filter passes it.
+  void sendMessage( const unsigned char *message, size_t size );
+
+  //! Send a message held in a std::vector.
+  void sendMessage( std::vector<unsigned char> *message ) { sendMessage( message->empty() ? 0 : &message->at( 0 ), message->size() ); }
+
+  //! Send a fixed-size message object (see MidiMessages.h).
+  template <class Message>
+  void send( const Message &message ) { sendMessage( message.data(), message.size() ); }
+
+  //! Send a Universal MIDI Packet.
+  /*!
+      The packet is converted to MIDI 1.0 once to apply the filters.
+      Outputs that accept packets directly (ALSA) are given the packet
+      and the others are given the converted bytes.
+  */
+  void sendUmp( const MidiUmp &packet );
+
+ private:
+  struct Output {
+    RtMidiOut *out;
+    RtMidi::Api api;
+    MidiOutFilter filter;
+    bool acceptsAll;
+  };
+
+  std::string clientName_;
+  std::vector<Output> outputs_;
+  unsigned int destinationCount_;
+
+  Output &newOutput( RtMidiOut *out, const MidiOutFilter &filter );
+
+  MidiOutGroup( const MidiOutGroup & );
+  MidiOutGroup &operator=( const MidiOutGroup & );
+};
+
+#endif
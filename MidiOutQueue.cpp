@@ -0,0 +1,155 @@
+/**********************************************************************/
+/*! \file MidiOutQueue.cpp
+    \brief Pace output to a port's bandwidth, notes ahead of controllers.
+*/
+/**********************************************************************/
+
+#include "MidiOutQueue.h"
+#include "MidiMessages.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// The bucket holds a three-byte message and a byte to spare, so a pump
+// that wakes a little late does not lose the time.
+static const double maximumCredit = 4.0;
+
+MidiOutQueue :: MidiOutQueue( RtMidiOut *out, MidiScheduler &scheduler, unsigned int rate, size_t capacity )
+  : out_( out ), scheduler_( scheduler ), rate_( rate ), credit_( maximumCredit ), refilled_( MidiScheduler::now() ),
+    controlHead_( 0 ), controlCount_( 0 ), pumpHandle_( 0 ), pumpDue_( INT64_MAX ), sent_( 0 ), coalesced_( 0 ), dropped_( 0 )
+{
+  if ( capacity == 0 || ( capacity & ( capacity - 1 ) ) != 0 )
+    throw std::invalid_argument( "MidiOutQueue: the capacity must be a power of two" );
+  for ( int i=0; i<2; i++ ) {
+    rings_[i].packets.resize( capacity );
+    rings_[i].mask = capacity - 1;
+    rings_[i].head = rings_[i].tail = 0;
+  }
+  for ( unsigned int i=0; i<16 * CONTROLS_PER_CHANNEL; i++ ) {
+    controls_[i] = 0;
+    controlHeaders_[i] = 0;
+  }
+}
+
+MidiOutQueue :: ~MidiOutQueue( void )
+{
+  if ( pumpHandle_ ) scheduler_.cancel( pumpHandle_ );
+
+  // Past the budget, so no note is left hanging.
+  rate_ = 0;
+  pump();
+}
+
+bool MidiOutQueue :: send( const MidiUmp &packet )
+{
+  // A continuous controller replaces the value waiting, if there is one.
+  unsigned int control;
+  uint32_t value;
+  if ( midiUmpControl( packet, control, value ) ) {
+    unsigned int index = packet.channel() * CONTROLS_PER_CHANNEL + control;
+    if ( controlHeaders_[index] ) coalesced_++;
+    else controlOrder_[( controlHead_ + controlCount_++ ) % ( 16 * CONTROLS_PER_CHANNEL )] = static_cast<uint16_t>( index );
+    controls_[index] = value;
+    controlHeaders_[index] = static_cast<uint8_t>( packet.word[0] >> 24 );
+  }
+  else {
+    bool realtime = packet.type() == MidiUmp::SYSTEM && ( ( packet.word[0] >> 16 ) & 0xFF ) >= 0xF8;
+    Ring &ring = rings_[realtime ? REALTIME : NOTES];
+    if ( ring.head - ring.tail > ring.mask ) {
+      dropped_++;
+      return false;
+    }
+    ring.packets[ring.head & ring.mask] = packet;
+    ring.head++;
+  }
+  pump();
+  return true;
+}
+
+bool MidiOutQueue :: send( const unsigned char *message, size_t size )
+{
+  if ( size == 0 || size > 3 ) return false;
+  MidiUmp packet = MidiUmp::fromMidi1( message, size );
+  if ( packet.type() == MidiUmp::UTILITY ) return false;
+  return send( packet );
+}
+
+// The packet to send next, from the first lane with one, and its lane, or -1 for none.
+int MidiOutQueue :: next( MidiUmp &packet ) const
+{
+  for ( int lane=REALTIME; lane<=NOTES; lane++ ) {
+    const Ring &ring = rings_[lane];
+    if ( ring.head != ring.tail ) {
+      packet = ring.packets[ring.tail & ring.mask];
+      return lane;
+    }
+  }
+  if ( controlCount_ == 0 ) return -1;
+
+  unsigned int index = controlOrder_[controlHead_];
+  packet = midiUmpControlPacket( controlHeaders_[index], index / CONTROLS_PER_CHANNEL, index % CONTROLS_PER_CHANNEL, controls_[index] );
+  return CONTROLS;
+}
+
+void MidiOutQueue :: pop( int lane )
+{
+  if ( lane != CONTROLS ) {
+    rings_[lane].tail++;
+    return;
+  }
+  controlHeaders_[controlOrder_[controlHead_]] = 0;
+  controlHead_ = ( controlHead_ + 1 ) % ( 16 * CONTROLS_PER_CHANNEL );
+  controlCount_--;
+}
+
+void MidiOutQueue :: pump( void )
+{
+  int64_t now = MidiScheduler::now();
+  if ( rate_ ) {
+    credit_ = std::min( maximumCredit, credit_ + ( now - refilled_ ) * ( rate_ / 1000000.0 ) );
+    refilled_ = now;
+  }
+
+  MidiUmp packet;
+  int lane;
+  while ( ( lane = next( packet ) ) >= 0 ) {
+    unsigned char bytes[3];
+    size_t size = midiUmpToMidi1( packet, bytes );
+    if ( rate_ && credit_ < size ) {
+      schedule( now + (int64_t) std::ceil( ( size - credit_ ) * 1000000.0 / rate_ ) );
+      return;
+    }
+    out_->sendUmp( packet );
+    pop( lane );
+    if ( rate_ ) credit_ -= size;
+    sent_++;
+  }
+}
+
+void MidiOutQueue :: schedule( int64_t due )
+{
+  if ( due >= pumpDue_ ) return;
+  if ( pumpHandle_ ) scheduler_.cancel( pumpHandle_ );
+  pumpHandle_ = scheduler_.schedule( due, [this]( void ) {
+      pumpHandle_ = 0;
+      pumpDue_ = INT64_MAX;
+      pump();
+    } );
+  pumpDue_ = due;
+}
+
+void MidiOutQueue :: setRate( unsigned int rate )
+{
+  pump();
+  rate_ = rate;
+  refilled_ = MidiScheduler::now();
+  pump();
+}
+
+size_t MidiOutQueue :: pending( Lane lane ) const
+{
+  if ( lane == LANES ) return pending( REALTIME ) + pending( NOTES ) + pending( CONTROLS );
+  if ( lane == CONTROLS ) return controlCount_;
+  return rings_[lane].head - rings_[lane].tail;
+}
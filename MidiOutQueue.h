@@ -0,0 +1,125 @@
+/**********************************************************************/
+/*! \file MidiOutQueue.h
+    \brief Pace output to a port's bandwidth, notes ahead of controllers.
+
+    A DIN port carries 31,250 bits a second, ten bits a byte: 3125
+    bytes, about a thousand three-byte messages.  Two armbands
+    streaming several controllers each can ask for more than that, and
+    the driver queues the rest in order, so a note-on waits behind
+    every controller sent before it.  A MidiOutQueue keeps three lanes
+    in front of an RtMidiOut and sends from them no faster than a byte
+    budget:
+
+    - real-time messages (timing clock, start, stop and the like) go
+      first, so the clock keeps time;
+    - notes and every other message go next, in order;
+    - continuous controllers (control change, pitch bend and channel
+      pressure) go last.  A controller already waiting is updated in
+      place, so only its latest value is sent and the lane never holds
+      more than one message per controller.
+
+    The lanes hold MidiUmp packets, which go to the port with
+    RtMidiOut::sendUmp().  A controller waiting keeps its value at 32
+    bits, with the message type and group of the packet that last set
+    it, so a MIDI 2.0 value is not cut down before the port converts it.
+    A packet costs the bytes of its MIDI 1.0 form.
+
+    Controllers whose order matters, bank select, data entry, the
+    (N)RPN numbers and the channel mode messages (120 and up), go in
+    the notes lane with the notes around them.  Otherwise a controller
+    may be sent after a note asked for later.
+
+    The budget is a token bucket refilled at the given rate and never
+    holding much more than one message, so a burst goes out at the
+    link's speed rather than all at once into the driver's buffer.  When the
+    bucket runs dry the queue schedules itself on its MidiScheduler for
+    when the next message fits.  Use the queue from the thread that
+    drives the scheduler, as with RtMidiOut itself.
+
+    \code
+    MidiOutQueue queue( dinPort, scheduler, MidiOutQueue::DIN_RATE );
+    queue.send( ControlChange<1, 7>( volume ) );
+    queue.send( NoteOn<1>( 60, 90 ) );      // goes before any controllers waiting
+    \endcode
+*/
+/**********************************************************************/
+
+#ifndef MIDIOUTQUEUE_H
+#define MIDIOUTQUEUE_H
+
+#include <stdint.h>
+#include <vector>
+#include "MidiScheduler.h"
+#include "MidiUmp.h"
+#include "RtMidi.h"
+
+class MidiOutQueue
+{
+ public:
+  enum Lane { REALTIME, NOTES, CONTROLS, LANES };
+
+  //! Bytes a second on a DIN port.
+  static const unsigned int DIN_RATE = 3125;
+
+  //! Send to \e out at most \e rate bytes a second (0 for no limit), with room for \e capacity real-time and note messages waiting (a power of two).
+  MidiOutQueue( RtMidiOut *out, MidiScheduler &scheduler, unsigned int rate = DIN_RATE, size_t capacity = 256 );
+
+  //! The destructor sends the messages still waiting at once, whatever the budget.
+  ~MidiOutQueue( void );
+
+  //! Queue \e packet and send what the budget allows.  Returns false if its lane was full and it was dropped.
+  bool send( const MidiUmp &packet );
+
+  //! Queue a message of 1 to 3 bytes as a MIDI 1.0 packet.  Returns false as above, or if the bytes are not a message the queue takes.
+  bool send( const unsigned char *message, size_t size );
+
+  //! Queue a fixed-size message object (see MidiMessages.h).
+  template <class Message>
+  bool send( const Message &message ) { return send( message.data(), message.size() ); }
+
+  //! Send whatever the budget allows now.  The queue calls this itself.
+  void pump( void );
+
+  //! Change the budget to \e rate bytes a second (0 for no limit).
+  void setRate( unsigned int rate );
+
+  //! Messages waiting in \e lane, or in all of them for LANES.
+  size_t pending( Lane lane ) const;
+
+  //! Messages sent, controller values replaced by a later one while waiting, and messages dropped from a full lane.
+  uint64_t getSent( void ) const { return sent_; }
+  uint64_t getCoalesced( void ) const { return coalesced_; }
+  uint64_t getDropped( void ) const { return dropped_; }
+
+ private:
+  enum { CONTROLS_PER_CHANNEL = 130 };  // 128 controllers, pitch bend, channel pressure
+
+  // A ring of packets for the real-time and note lanes.
+  struct Ring {
+    std::vector<MidiUmp> packets;
+    size_t mask, head, tail;
+  };
+
+  RtMidiOut *out_;
+  MidiScheduler &scheduler_;
+  unsigned int rate_;
+  double credit_;               // bytes the budget allows now
+  int64_t refilled_;            // when credit_ was worked out
+  Ring rings_[2];               // REALTIME and NOTES
+  uint32_t controls_[16 * CONTROLS_PER_CHANNEL];        // the value waiting per controller
+  uint8_t controlHeaders_[16 * CONTROLS_PER_CHANNEL];   // the type and group it came with, or 0 for none
+  uint16_t controlOrder_[16 * CONTROLS_PER_CHANNEL];  // a ring of the controllers waiting, oldest first
+  size_t controlHead_, controlCount_;
+  MidiScheduler::Handle pumpHandle_;
+  int64_t pumpDue_;             // INT64_MAX with none scheduled
+  uint64_t sent_, coalesced_, dropped_;
+
+  int next( MidiUmp &packet ) const;
+  void pop( int lane );
+  void schedule( int64_t due );
+
+  MidiOutQueue( const MidiOutQueue & );
+  MidiOutQueue &operator=( const MidiOutQueue & );
+};
+
+#endif
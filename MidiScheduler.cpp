@@ -0,0 +1,340 @@
+/**********************************************************************/
+/*! \file MidiScheduler.cpp
+    \brief Send MIDI messages and run callbacks at a later time.
+*/
+/**********************************************************************/
+
+#include "MidiScheduler.h"
+#include "BitScan.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+
+static const int64_t never = std::numeric_limits<int64_t>::max();
+
+// The first bit set in a slot bitmap at or after \e from, or -1.
+static int firstOccupied( const uint64_t *bits, int words, int from )
+{
+  for ( int w=from / 64; w<words; w++ ) {
+    uint64_t word = bits[w];
+    if ( w == from / 64 ) word &= ~(uint64_t) 0 << ( from % 64 );
+    if ( !word ) continue;
+    return w * 64 + bitLowest( word );
+  }
+  return -1;
+}
+
+MidiScheduler :: MidiScheduler( int64_t resolution, size_t capacity )
+  : resolution_( resolution ), free_( -1 ), pending_( 0 ), scheduled_( 0 ), overflow_( -1 ),
+    running_( false ), stopping_( false ), spin_( 0 ), sleepUntil_( never )
+{
+  if ( resolution <= 0 ) throw std::invalid_argument( "MidiScheduler: the resolution must be positive" );
+  entries_.reserve( capacity );
+  current_ = now() / resolution_;
+  for ( int l=0; l<levels; l++ ) {
+    for ( int s=0; s<slots; s++ ) heads_[l][s] = -1;
+    for ( int w=0; w<words; w++ ) occupied_[l][w] = 0;
+  }
+  for ( int s=0; s<slots; s++ ) tails_[s] = -1;
+}
+
+MidiScheduler :: ~MidiScheduler( void )
+{
+  stop();
+}
+
+int64_t MidiScheduler :: now( void )
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+int32_t MidiScheduler :: allocate( void )
+{
+  if ( free_ < 0 ) {
+    Entry entry = Entry();
+    entry.generation = 1;
+    entry.level = -1;
+    entries_.push_back( entry );
+    return static_cast<int32_t>( entries_.size() - 1 );
+  }
+  int32_t index = free_;
+  free_ = entries_[index].next;
+  return index;
+}
+
+// Put an entry in the slot of the lowest level whose span from the
+// current tick reaches its tick: the level above which the two agree.
+void MidiScheduler :: file( int32_t index )
+{
+  Entry &entry = entries_[index];
+  int32_t *head = &overflow_;
+  entry.level = levels;
+  entry.slot = 0;
+  for ( int l=0; l<levels; l++ ) {
+    if ( ( ( entry.tick ^ current_ ) >> ( levelBits * ( l + 1 ) ) ) != 0 ) continue;
+    entry.level = static_cast<int16_t>( l );
+    entry.slot = static_cast<int16_t>( ( entry.tick >> ( levelBits * l ) ) & ( slots - 1 ) );
+    head = &heads_[l][entry.slot];
+    occupied_[l][entry.slot / 64] |= (uint64_t) 1 << ( entry.slot % 64 );
+    break;
+  }
+  if ( entry.level == 0 ) {
+    fileInOrder( index );
+    return;
+  }
+  entry.previous = -1;
+  entry.next = *head;
+  if ( *head >= 0 ) entries_[*head].previous = index;
+  *head = index;
+}
+
+// Whether entry \e a fires before entry \e b: the earlier, or of two
+// due together the first scheduled, so a note-off and a note-on for
+// one time keep their order.
+bool MidiScheduler :: firesBefore( int32_t a, int32_t b ) const
+{
+  const Entry &x = entries_[a], &y = entries_[b];
+  return x.due < y.due || ( x.due == y.due && x.order < y.order );
+}
+
+// Put a first-level entry in its slot's list in firing order, looking
+// from the end.
+void MidiScheduler :: fileInOrder( int32_t index )
+{
+  Entry &entry = entries_[index];
+  int32_t after = tails_[entry.slot];
+  while ( after >= 0 && firesBefore( index, after ) ) after = entries_[after].previous;
+  entry.previous = after;
+  entry.next = after >= 0 ? entries_[after].next : heads_[0][entry.slot];
+  if ( entry.next >= 0 ) entries_[entry.next].previous = index;
+  else tails_[entry.slot] = index;
+  if ( after >= 0 ) entries_[after].next = index;
+  else heads_[0][entry.slot] = index;
+}
+
+void MidiScheduler :: unlink( int32_t index )
+{
+  Entry &entry = entries_[index];
+  int32_t *head = entry.level == levels ? &overflow_ : &heads_[entry.level][entry.slot];
+  if ( entry.previous >= 0 ) entries_[entry.previous].next = entry.next;
+  else *head = entry.next;
+  if ( entry.next >= 0 ) entries_[entry.next].previous = entry.previous;
+  else if ( entry.level == 0 ) tails_[entry.slot] = entry.previous;
+  if ( *head < 0 && entry.level < levels )
+    occupied_[entry.level][entry.slot / 64] &= ~( (uint64_t) 1 << ( entry.slot % 64 ) );
+}
+
+MidiScheduler::Handle MidiScheduler :: insert( int32_t index, int64_t due )
+{
+  Entry &entry = entries_[index];
+  entry.due = due;
+  entry.order = scheduled_++;
+  entry.tick = std::max( current_, due / resolution_ );
+  file( index );
+  pending_++;
+
+  // Wake the timing thread if this comes before it meant to.
+  if ( running_ && due < sleepUntil_ ) wake_.notify_one();
+  return ( (Handle) entry.generation << 32 ) | (Handle) ( index + 1 );
+}
+
+MidiScheduler::Handle MidiScheduler :: schedule( int64_t due, const Callback &callback )
+{
+  std::lock_guard<std::mutex> guard( lock_ );
+  int32_t index = allocate();
+  entries_[index].out = 0;
+  entries_[index].callback = callback;
+  return insert( index, due );
+}
+
+MidiScheduler::Handle MidiScheduler :: send( int64_t due, RtMidiOut *out, const MidiUmp &packet )
+{
+  std::lock_guard<std::mutex> guard( lock_ );
+  int32_t index = allocate();
+  Entry &entry = entries_[index];
+  entry.out = out;
+  entry.packet = packet;
+  return insert( index, due );
+}
+
+MidiScheduler::Handle MidiScheduler :: send( int64_t due, RtMidiOut *out, const unsigned char *message, size_t size )
+{
+  if ( size < 1 || size > 3 ) throw std::invalid_argument( "MidiScheduler: a scheduled message is 1 to 3 bytes" );
+  return send( due, out, MidiUmp::fromMidi1( message, size ) );
+}
+
+bool MidiScheduler :: cancel( Handle handle )
+{
+  std::lock_guard<std::mutex> guard( lock_ );
+  int64_t index = (int64_t) ( handle & 0xffffffffu ) - 1;
+  if ( index < 0 || index >= (int64_t) entries_.size() ) return false;
+  Entry &entry = entries_[index];
+  if ( entry.level < 0 || entry.generation != ( handle >> 32 ) ) return false;
+
+  unlink( static_cast<int32_t>( index ) );
+  entry.callback = Callback();
+  entry.level = -1;
+  entry.generation++;
+  entry.next = free_;
+  free_ = static_cast<int32_t>( index );
+  pending_--;
+  return true;
+}
+
+// Move the events in the current slot of \e level down the wheel.
+void MidiScheduler :: cascade( int level )
+{
+  int32_t index;
+  if ( level == levels ) {
+    index = overflow_;
+    overflow_ = -1;
+  }
+  else {
+    int slot = static_cast<int>( ( current_ >> ( levelBits * level ) ) & ( slots - 1 ) );
+    index = heads_[level][slot];
+    heads_[level][slot] = -1;
+    occupied_[level][slot / 64] &= ~( (uint64_t) 1 << ( slot % 64 ) );
+  }
+  // In firing order, so each lands at the end of its new slot's list.
+  cascading_.clear();
+  for ( ; index >= 0; index = entries_[index].next ) cascading_.push_back( index );
+  std::sort( cascading_.begin(), cascading_.end(), [this]( int32_t a, int32_t b ) { return firesBefore( a, b ); } );
+  for ( size_t i=0; i<cascading_.size(); i++ ) file( cascading_[i] );
+}
+
+size_t MidiScheduler :: advance( int64_t now )
+{
+  std::unique_lock<std::mutex> guard( lock_ );
+  int64_t target = now / resolution_;
+  size_t fired = 0;
+
+  while ( current_ <= target ) {
+    if ( pending_ == 0 ) {
+      current_ = target + 1;
+      break;
+    }
+
+    // Where a level turns over, bring its next slot down, the highest
+    // level first.
+    for ( int l=levels; l>0; l-- )
+      if ( ( current_ & ( ( (int64_t) 1 << ( levelBits * l ) ) - 1 ) ) == 0 ) cascade( l );
+
+    // Fire the slot's events that are due from the front of its list,
+    // one at a time, unlocked, so a callback may schedule or cancel;
+    // anything it schedules for now joins the slot in order.  Only the
+    // last tick can hold events not yet due.
+    int32_t *head = &heads_[0][current_ & ( slots - 1 )];
+    for ( ;; ) {
+      int32_t index = *head;
+      if ( index < 0 || entries_[index].due > now ) break;
+      Entry &entry = entries_[index];
+      unlink( index );
+      RtMidiOut *out = entry.out;
+      MidiUmp packet = entry.packet;
+      Callback callback;
+      callback.swap( entry.callback );
+      entry.level = -1;
+      entry.generation++;
+      entry.next = free_;
+      free_ = index;
+      pending_--;
+      fired++;
+
+      guard.unlock();
+      if ( out ) out->sendUmp( packet );
+      else if ( callback ) callback();
+      guard.lock();
+      head = &heads_[0][current_ & ( slots - 1 )];
+    }
+    if ( *head >= 0 ) break;
+
+    // Skip the empty slots up to the next occupied one or the end of
+    // the first level, where the next cascade is due.
+    int slot = static_cast<int>( current_ & ( slots - 1 ) );
+    int next = slot + 1 < slots ? firstOccupied( occupied_[0], words, slot + 1 ) : -1;
+    int64_t base = current_ - slot;
+    current_ = std::min( target + 1, next >= 0 ? base + next : base + slots );
+  }
+  return fired;
+}
+
+int64_t MidiScheduler :: nextDueLocked( void ) const
+{
+  if ( pending_ == 0 ) return never;
+
+  // The first occupied slot of the first level holds the next event.
+  int slot = firstOccupied( occupied_[0], words, static_cast<int>( current_ & ( slots - 1 ) ) );
+  if ( slot >= 0 ) return entries_[heads_[0][slot]].due;
+
+  // Otherwise wake to cascade the first occupied slot above.
+  for ( int l=1; l<levels; l++ ) {
+    int shift = levelBits * l;
+    slot = firstOccupied( occupied_[l], words, static_cast<int>( ( current_ >> shift ) & ( slots - 1 ) ) );
+    if ( slot < 0 ) continue;
+    int64_t base = ( current_ >> ( shift + levelBits ) ) << ( shift + levelBits );
+    return std::max( current_, base + ( (int64_t) slot << shift ) ) * resolution_;
+  }
+  // Only overflow: when the top level next turns over.
+  int64_t span = (int64_t) 1 << ( levelBits * levels );
+  return ( ( current_ / span ) + 1 ) * span * resolution_;
+}
+
+int64_t MidiScheduler :: nextDue( void ) const
+{
+  std::lock_guard<std::mutex> guard( lock_ );
+  return nextDueLocked();
+}
+
+size_t MidiScheduler :: pending( void ) const
+{
+  std::lock_guard<std::mutex> guard( lock_ );
+  return pending_;
+}
+
+void MidiScheduler :: start( int64_t spin )
+{
+  std::lock_guard<std::mutex> guard( lock_ );
+  if ( running_ ) return;
+  spin_ = std::max( (int64_t) 0, spin );
+  running_ = true;
+  stopping_ = false;
+  thread_ = std::thread( &MidiScheduler::run, this );
+}
+
+void MidiScheduler :: stop( void )
+{
+  {
+    std::lock_guard<std::mutex> guard( lock_ );
+    if ( !running_ ) return;
+    stopping_ = true;
+    wake_.notify_one();
+  }
+  thread_.join();
+  std::lock_guard<std::mutex> guard( lock_ );
+  running_ = false;
+}
+
+void MidiScheduler :: run( void )
+{
+  std::unique_lock<std::mutex> guard( lock_ );
+  while ( !stopping_ ) {
+    int64_t due = nextDueLocked();
+    sleepUntil_ = due == never ? never : due - spin_;
+    if ( sleepUntil_ == never ) wake_.wait( guard );
+    else if ( sleepUntil_ > now() )
+      wake_.wait_until( guard, std::chrono::steady_clock::time_point( std::chrono::microseconds( sleepUntil_ ) ) );
+    sleepUntil_ = never;
+    if ( stopping_ ) break;
+    guard.unlock();
+
+    // Spin out what is left, watching for an earlier event, so the
+    // wake-up's latency is spent before the event is due.
+    int64_t limit = now() + spin_;
+    while ( spin_ && now() < std::min( limit, nextDue() ) ) {}
+
+    advance( now() );
+    guard.lock();
+  }
+}
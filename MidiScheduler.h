@@ -0,0 +1,163 @@
+/**********************************************************************/
+/*! \file MidiScheduler.h
+    \brief Send MIDI messages and run callbacks at a later time.
+
+    Note lengths used to be a sleep on the caller's thread between the
+    note-on and the note-off, so nothing else happened until the note
+    ended.  A MidiScheduler holds the note-off (or any delayed action)
+    instead and the caller returns at once.
+
+    Pending events are kept in a hierarchical timer wheel: four levels
+    of 256 slots, the first a tick apart (100 microseconds by default),
+    each of the others 256 times the span of the one below.  An event
+    goes into the slot of the lowest level that reaches its time and
+    moves down a level each time the wheel below turns over, so
+    schedule() and cancel() cost the same however many events are
+    pending.  Each event keeps its exact time: advance() never fires
+    one early, and nextDue() gives the first event's time, so a loop
+    that waits until then fires it as soon as it wakes.  Events fire
+    in time order, and those due at the same time in the order they
+    were scheduled.  A first-level slot keeps its list in that order,
+    placed from the end, where a new event almost always goes, so
+    firing a chord's worth of events from one tick costs the same per
+    event as firing one.
+
+    Something has to call advance(): the program's main loop, with
+    sensor::EventLoop::setScheduler() or by waiting until nextDue()
+    itself, or the scheduler's own timing thread, started with start().
+    Messages and callbacks are sent and run on that thread.  RtMidiOut
+    is not safe to send on from two threads at once, so a program that
+    also sends from its own thread should drive the scheduler from
+    that thread rather than start() it.  schedule(), send() and
+    cancel() may be called from any thread.
+
+    \code
+    MidiScheduler scheduler;
+    midiout->send( NoteOn<1>( 60, 90 ) );
+    scheduler.send( MidiScheduler::now() + 50000, midiout, NoteOff<1>( 60, 0 ) );
+    scheduler.start();
+    \endcode
+*/
+/**********************************************************************/
+
+#ifndef MIDISCHEDULER_H
+#define MIDISCHEDULER_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+#include "MidiUmp.h"
+#include "RtMidi.h"
+
+class MidiScheduler
+{
+ public:
+  typedef std::function<void( void )> Callback;
+
+  //! Identifies a pending event for cancel().  0 is never a handle.
+  typedef uint64_t Handle;
+
+  //! Create a scheduler with a tick of \e resolution microseconds and room for \e capacity events before it allocates.
+  MidiScheduler( int64_t resolution = 100, size_t capacity = 1024 );
+
+  //! The destructor stops the timing thread.  Events still pending are dropped.
+  ~MidiScheduler( void );
+
+  //! The scheduler's clock: microseconds of std::chrono::steady_clock.
+  static int64_t now( void );
+
+  //! Run \e callback at time \e due.
+  Handle schedule( int64_t due, const Callback &callback );
+
+  //! Send \e packet on \e out at time \e due, through RtMidiOut::sendUmp().  Needs no allocation once the scheduler has room.
+  Handle send( int64_t due, RtMidiOut *out, const MidiUmp &packet );
+
+  //! Send a message of 1 to 3 bytes on \e out at time \e due, as a MIDI 1.0 packet.
+  Handle send( int64_t due, RtMidiOut *out, const unsigned char *message, size_t size );
+
+  //! Send a fixed-size message object (see MidiMessages.h) at time \e due.
+  template <class Message>
+  Handle send( int64_t due, RtMidiOut *out, const Message &message ) { return send( due, out, message.data(), message.size() ); }
+
+  //! Forget a pending event.  Returns false if it has already fired or been cancelled.
+  bool cancel( Handle handle );
+
+  //! Fire every event due by time \e now.  Returns the number fired.
+  size_t advance( int64_t now );
+
+  //! When advance() next has something to do, or INT64_MAX if nothing is pending.
+  /*!
+      This is the first event's time, or earlier when that event is
+      still on an upper level of the wheel and must be moved down.
+  */
+  int64_t nextDue( void ) const;
+
+  //! The number of events pending.
+  size_t pending( void ) const;
+
+  //! Start a thread that calls advance() as events fall due.
+  /*!
+      With \e spin, the thread wakes that many microseconds before each
+      event and spins until it is due, trading that much CPU per event
+      for the operating system's wake-up latency.
+  */
+  void start( int64_t spin = 0 );
+
+  //! Stop the timing thread.  Pending events stay pending.
+  void stop( void );
+
+ private:
+  enum { levelBits = 8, slots = 1 << levelBits, levels = 4, words = slots / 64 };
+
+  struct Entry {
+    int64_t due;
+    int64_t tick;            // due / resolution_, or current_ if that has passed
+    uint64_t order;          // scheduled_ when it was scheduled
+    int32_t next, previous;  // in the slot's list; next links the free list
+    uint32_t generation;
+    int16_t level;           // levels for the overflow list, -1 when free
+    int16_t slot;
+    RtMidiOut *out;          // for the packet, or 0 for the callback
+    MidiUmp packet;
+    Callback callback;
+  };
+
+  int64_t resolution_;
+  std::vector<Entry> entries_;
+  int32_t free_;
+  size_t pending_;
+  uint64_t scheduled_;         // events ever scheduled
+
+  // current_ is the next tick advance() will process.
+  int64_t current_;
+  int32_t heads_[levels][slots];
+  int32_t tails_[slots];       // of the first level, whose lists are in firing order
+  uint64_t occupied_[levels][words];
+  int32_t overflow_;           // too far ahead for the wheel
+  std::vector<int32_t> cascading_;  // a slot's events being moved down
+
+  mutable std::mutex lock_;
+  std::condition_variable wake_;
+  std::thread thread_;
+  bool running_, stopping_;
+  int64_t spin_;
+  int64_t sleepUntil_;         // when the timing thread means to wake
+
+  int32_t allocate( void );
+  Handle insert( int32_t index, int64_t due );
+  void file( int32_t index );
+  void fileInOrder( int32_t index );
+  bool firesBefore( int32_t a, int32_t b ) const;
+  void unlink( int32_t index );
+  void cascade( int level );
+  int64_t nextDueLocked( void ) const;
+  void run( void );
+
+  MidiScheduler( const MidiScheduler & );
+  MidiScheduler &operator=( const MidiScheduler & );
+};
+
+#endif
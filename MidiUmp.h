@@ -0,0 +1,280 @@
+/**********************************************************************/
+/*! \class MidiUmp
+    \brief A fixed-size MIDI 2.0 Universal MIDI Packet.
+
+    MidiUmp is the internal representation between the mapping code
+    and the RtMidi output backends: the mappings build packets, and
+    MidiScheduler, MidiOutCache, MidiOutQueue and MidiNoteTracker carry
+    them to RtMidiOut::sendUmp() or MidiOutGroup::sendUmp(), so a
+    controller keeps its 32-bit value until the backend converts it.
+    Their byte forms wrap MIDI 1.0 messages with fromMidi1().  A packet
+    is one to four 32-bit words, as many as its message type takes (see
+    size()), held in a fixed array, so packets can be copied, queued
+    and compared without any heap allocation.
+
+    MIDI 2.0 channel voice packets (message type 0x4) carry 16-bit
+    velocities and 32-bit controller, pressure and pitch bend values,
+    including per-note controllers and per-note pitch bend.  MIDI 1.0
+    channel voice packets (message type 0x2) and system real-time
+    packets (message type 0x1) wrap the byte-oriented messages used
+    by the rest of RtMidi.
+
+    Backends that only speak MIDI 1.0 call midiUmpToMidi1() at the
+    output boundary.  Message type 0x1 and 0x2 packets convert
+    losslessly.  Type 0x4 values are reduced by the bit-shift rule of
+    the MIDI 2.0 translation specification, which is the exact inverse
+    of midiUmpScaleUp(), so any value that started out as a 7-bit or
+    14-bit MIDI 1.0 value comes back unchanged.
+*/
+/**********************************************************************/
+
+/*!
+  \file MidiUmp.h
+ */
+
+#ifndef MIDIUMP_H
+#define MIDIUMP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+//! Scale an unsigned value from \e srcBits to \e dstBits using the MIDI 2.0 min-center-max rule.
+/*!
+  The minimum, center and maximum source values map to the minimum,
+  center and maximum destination values, and the upper half is
+  filled by bit repetition.  A right shift by (dstBits - srcBits)
+  recovers the original value exactly.
+*/
+inline uint32_t midiUmpScaleUp( uint32_t srcValue, unsigned int srcBits, unsigned int dstBits )
+{
+  unsigned int scaleBits = dstBits - srcBits;
+  uint32_t shifted = srcValue << scaleBits;
+  uint32_t srcCenter = 1u << ( srcBits - 1 );
+  if ( srcValue <= srcCenter ) return shifted;
+
+  unsigned int repeatBits = srcBits - 1;
+  uint32_t repeatValue = srcValue & ( ( 1u << repeatBits ) - 1 );
+  if ( scaleBits > repeatBits ) repeatValue <<= scaleBits - repeatBits;
+  else repeatValue >>= repeatBits - scaleBits;
+  while ( repeatValue != 0 ) {
+    shifted |= repeatValue;
+    repeatValue >>= repeatBits;
+  }
+  return shifted;
+}
+
+//! Reduce an unsigned value from \e srcBits to \e dstBits (MIDI 2.0 translation rule).
+inline uint32_t midiUmpScaleDown( uint32_t srcValue, unsigned int srcBits, unsigned int dstBits )
+{
+  return srcValue >> ( srcBits - dstBits );
+}
+
+struct MidiUmp
+{
+  //! UMP message types used by RtMidi.
+  enum Type {
+    UTILITY      = 0x0, /*!< NOOP and jitter reduction timestamps (32 bits). */
+    SYSTEM       = 0x1, /*!< System common and real-time (32 bits). */
+    MIDI1_VOICE  = 0x2, /*!< MIDI 1.0 channel voice (32 bits). */
+    DATA64       = 0x3, /*!< 7-bit sysex data (64 bits). */
+    MIDI2_VOICE  = 0x4, /*!< MIDI 2.0 channel voice (64 bits). */
+    DATA128      = 0x5  /*!< 8-bit data and mixed data sets (128 bits). */
+  };
+
+  //! MIDI 2.0 channel voice status nibbles (upper nibble of the status byte).
+  enum Status {
+    PER_NOTE_RCC      = 0x00, /*!< Registered per-note controller. */
+    PER_NOTE_ACC      = 0x10, /*!< Assignable per-note controller. */
+    PER_NOTE_BEND     = 0x60, /*!< Per-note pitch bend. */
+    NOTE_OFF          = 0x80,
+    NOTE_ON           = 0x90,
+    POLY_PRESSURE     = 0xA0,
+    CONTROL_CHANGE    = 0xB0,
+    PROGRAM_CHANGE    = 0xC0,
+    CHANNEL_PRESSURE  = 0xD0,
+    PITCH_BEND        = 0xE0,
+    PER_NOTE_MANAGE   = 0xF0
+  };
+
+  uint32_t word[4];
+
+  // Default constructor: a 32-bit utility NOOP.
+  MidiUmp() { word[0] = word[1] = word[2] = word[3] = 0; }
+  MidiUmp( uint32_t word0, uint32_t word1 = 0, uint32_t word2 = 0, uint32_t word3 = 0 ) {
+    word[0] = word0; word[1] = word1; word[2] = word2; word[3] = word3;
+  }
+
+  //! Returns the message type (upper nibble of the first word).
+  unsigned int type( void ) const { return word[0] >> 28; }
+
+  //! Returns the UMP group (0-15).
+  unsigned int group( void ) const { return ( word[0] >> 24 ) & 0x0F; }
+
+  //! Returns the status byte with the channel nibble masked off (channel voice types only).
+  unsigned int status( void ) const { return ( word[0] >> 16 ) & 0xF0; }
+
+  //! Returns the 0-based channel number (channel voice types only).
+  unsigned int channel( void ) const { return ( word[0] >> 16 ) & 0x0F; }
+
+  //! Returns the first data field (note or controller number).
+  unsigned int index( void ) const { return ( word[0] >> 8 ) & 0x7F; }
+
+  //! Returns the number of 32-bit words used by this packet.
+  /*!
+    The counts are those of the UMP specification for all sixteen
+    message types, including the ones reserved so far, so a stream of
+    packets can be walked without knowing every type.
+  */
+  unsigned int size( void ) const {
+    static const unsigned char words[16] = { 1, 1, 1, 2, 2, 4, 1, 1, 2, 2, 2, 3, 3, 4, 4, 4 };
+    return words[type()];
+  }
+
+  bool operator==( const MidiUmp &other ) const {
+    for ( unsigned int i=0; i<size(); i++ )
+      if ( word[i] != other.word[i] ) return false;
+    return true;
+  }
+  bool operator!=( const MidiUmp &other ) const { return !( *this == other ); }
+
+  //! MIDI 2.0 note on with a 16-bit velocity.
+  static MidiUmp noteOn( unsigned int channel, unsigned int note, uint16_t velocity, unsigned int group = 0 ) {
+    return MidiUmp( voice( group, NOTE_ON, channel, note, 0 ), (uint32_t) velocity << 16 );
+  }
+
+  //! MIDI 2.0 note off with a 16-bit release velocity.
+  static MidiUmp noteOff( unsigned int channel, unsigned int note, uint16_t velocity = 0, unsigned int group = 0 ) {
+    return MidiUmp( voice( group, NOTE_OFF, channel, note, 0 ), (uint32_t) velocity << 16 );
+  }
+
+  //! MIDI 2.0 polyphonic pressure with a 32-bit value.
+  static MidiUmp polyPressure( unsigned int channel, unsigned int note, uint32_t value, unsigned int group = 0 ) {
+    return MidiUmp( voice( group, POLY_PRESSURE, channel, note, 0 ), value );
+  }
+
+  //! MIDI 2.0 control change with a 32-bit value.
+  static MidiUmp controlChange( unsigned int channel, unsigned int controller, uint32_t value, unsigned int group = 0 ) {
+    return MidiUmp( voice( group, CONTROL_CHANGE, channel, controller, 0 ), value );
+  }
+
+  //! MIDI 2.0 registered (\e assignable = false) or assignable per-note controller with a 32-bit value.
+  static MidiUmp perNoteController( unsigned int channel, unsigned int note, unsigned int controller,
+                                    uint32_t value, bool assignable = false, unsigned int group = 0 ) {
+    return MidiUmp( voice( group, assignable ? PER_NOTE_ACC : PER_NOTE_RCC, channel, note, controller ), value );
+  }
+
+  //! MIDI 2.0 per-note pitch bend (0x80000000 is center).
+  static MidiUmp perNotePitchBend( unsigned int channel, unsigned int note, uint32_t value, unsigned int group = 0 ) {
+    return MidiUmp( voice( group, PER_NOTE_BEND, channel, note, 0 ), value );
+  }
+
+  //! MIDI 2.0 program change without bank select.
+  static MidiUmp programChange( unsigned int channel, unsigned int program, unsigned int group = 0 ) {
+    return MidiUmp( voice( group, PROGRAM_CHANGE, channel, 0, 0 ), (uint32_t) ( program & 0x7F ) << 24 );
+  }
+
+  //! MIDI 2.0 channel pressure with a 32-bit value.
+  static MidiUmp channelPressure( unsigned int channel, uint32_t value, unsigned int group = 0 ) {
+    return MidiUmp( voice( group, CHANNEL_PRESSURE, channel, 0, 0 ), value );
+  }
+
+  //! MIDI 2.0 pitch bend with a 32-bit value (0x80000000 is center).
+  static MidiUmp pitchBend( unsigned int channel, uint32_t value, unsigned int group = 0 ) {
+    return MidiUmp( voice( group, PITCH_BEND, channel, 0, 0 ), value );
+  }
+
+  //! Wrap a MIDI 1.0 channel voice or system message (1 to 3 bytes) without changing it.
+  /*!
+    Returns a utility NOOP packet if the bytes do not form a short
+    MIDI 1.0 message (empty input, running status or sysex).
+  */
+  static MidiUmp fromMidi1( const unsigned char *bytes, size_t size, unsigned int group = 0 ) {
+    if ( size == 0 || bytes[0] < 0x80 || bytes[0] == 0xF0 ) return MidiUmp();
+    uint32_t type = bytes[0] >= 0xF0 ? SYSTEM : MIDI1_VOICE;
+    uint32_t w = ( type << 28 ) | ( ( group & 0x0F ) << 24 ) | ( (uint32_t) bytes[0] << 16 );
+    if ( size > 1 ) w |= (uint32_t) ( bytes[1] & 0x7F ) << 8;
+    if ( size > 2 ) w |= (uint32_t) ( bytes[2] & 0x7F );
+    return MidiUmp( w );
+  }
+
+ private:
+  static uint32_t voice( unsigned int group, unsigned int status, unsigned int channel,
+                         unsigned int data1, unsigned int data2 ) {
+    return ( (uint32_t) MIDI2_VOICE << 28 ) | ( ( group & 0x0F ) << 24 ) |
+      ( ( status | ( channel & 0x0F ) ) << 16 ) | ( ( data1 & 0x7F ) << 8 ) | ( data2 & 0xFF );
+  }
+};
+
+//! Return the number of MIDI 1.0 data bytes that follow a given status byte.
+inline unsigned int midi1DataBytes( unsigned char status )
+{
+  switch ( status & 0xF0 ) {
+  case 0xC0: case 0xD0: return 1;
+  case 0xF0:
+    if ( status == 0xF1 || status == 0xF3 ) return 1;
+    if ( status == 0xF2 ) return 2;
+    return 0;
+  default: return 2;
+  }
+}
+
+//! Convert a packet to a MIDI 1.0 byte message.
+/*!
+  Writes at most three bytes to \e bytes and returns the number
+  written.  Zero is returned for packets that have no MIDI 1.0
+  equivalent (utility packets, per-note controllers, per-note pitch
+  bend and per-note management), which callers should simply drop.
+*/
+inline size_t midiUmpToMidi1( const MidiUmp &ump, unsigned char *bytes )
+{
+  uint32_t w0 = ump.word[0];
+  uint32_t w1 = ump.word[1];
+  unsigned int type = ump.type();
+
+  if ( type == MidiUmp::SYSTEM || type == MidiUmp::MIDI1_VOICE ) {
+    unsigned char status = (unsigned char) ( w0 >> 16 );
+    if ( status < 0x80 || status == 0xF0 ) return 0;
+    bytes[0] = status;
+    unsigned int n = midi1DataBytes( status );
+    if ( n > 0 ) bytes[1] = (unsigned char) ( ( w0 >> 8 ) & 0x7F );
+    if ( n > 1 ) bytes[2] = (unsigned char) ( w0 & 0x7F );
+    return n + 1;
+  }
+
+  if ( type != MidiUmp::MIDI2_VOICE ) return 0;
+
+  unsigned char status = (unsigned char) ( ump.status() | ump.channel() );
+  unsigned char index = (unsigned char) ump.index();
+  switch ( ump.status() ) {
+  case MidiUmp::NOTE_ON: {
+    // A MIDI 1.0 velocity of zero means note off, so it is bumped to 1.
+    unsigned char velocity = (unsigned char) midiUmpScaleDown( w1 >> 16, 16, 7 );
+    bytes[0] = status; bytes[1] = index; bytes[2] = velocity ? velocity : 1;
+    return 3;
+  }
+  case MidiUmp::NOTE_OFF:
+    bytes[0] = status; bytes[1] = index;
+    bytes[2] = (unsigned char) midiUmpScaleDown( w1 >> 16, 16, 7 );
+    return 3;
+  case MidiUmp::POLY_PRESSURE:
+  case MidiUmp::CONTROL_CHANGE:
+    bytes[0] = status; bytes[1] = index;
+    bytes[2] = (unsigned char) midiUmpScaleDown( w1, 32, 7 );
+    return 3;
+  case MidiUmp::PROGRAM_CHANGE:
+    bytes[0] = status; bytes[1] = (unsigned char) ( ( w1 >> 24 ) & 0x7F );
+    return 2;
+  case MidiUmp::CHANNEL_PRESSURE:
+    bytes[0] = status; bytes[1] = (unsigned char) midiUmpScaleDown( w1, 32, 7 );
+    return 2;
+  case MidiUmp::PITCH_BEND: {
+    uint32_t bend = midiUmpScaleDown( w1, 32, 14 );
+    bytes[0] = status; bytes[1] = (unsigned char) ( bend & 0x7F ); bytes[2] = (unsigned char) ( bend >> 7 );
+    return 3;
+  }
+  default:
+    return 0;
+  }
+}
+
+#endif
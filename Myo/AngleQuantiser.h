@@ -0,0 +1,246 @@
+/**********************************************************************/
+/*! \file AngleQuantiser.h
+    \brief Roll, pitch and yaw buckets from comparisons, without inverse trig.
+
+    The mappings never use an angle as a number, only its bucket, and
+    often only whether the bucket is above a threshold (pitch_w > 80).
+    A bucket boundary is a fixed angle, so it can be tested directly
+    on the atan2() and asin() arguments the programs compute from the
+    quaternion:
+
+    - pitch is asin(t), which increases with t, so pitch is at least
+      the boundary angle b exactly when t >= sin(b);
+    - roll and yaw are atan2(y, x).  Within one half-plane (y > 0 or
+      y < 0) the angle is at least b exactly when the cross product
+      cos(b) y - sin(b) x is not negative.
+
+    The sines and cosines of the boundaries are tables generated at
+    compile time for each bucket count, and a bucket is found by a
+    binary search of its table (7 multiply-compares for 127 buckets).
+    TriggerEngine's quaternion update() tests a mapping's thresholds
+    this way, so a mapping that reads the orientation only through
+    thresholds (liveloop's pitch > 80) never buckets the angles.
+    A test that lands within quantiserGuard of a boundary, where the
+    programs' own float rounding decides, is settled with libm, so the
+    results always equal AngleBucketer::exactBuckets().
+*/
+/**********************************************************************/
+
+#ifndef ANGLEQUANTISER_H
+#define ANGLEQUANTISER_H
+
+#include <cmath>
+#include "OrientationMath.h"
+
+namespace sensor {
+
+//! Distance from a bucket boundary, in radians, inside which libm decides.
+const float quantiserGuard = 2e-6f;
+
+namespace detail {
+
+const double tablePi = 3.14159265358979323846;
+
+// Taylor series, accurate to double precision for |x| <= pi.
+constexpr double sinSeries( double x2, double term, int n, double sum )
+{
+  return n > 41 ? sum : sinSeries( x2, -term * x2 / ( ( n + 1 ) * ( n + 2 ) ), n + 2, sum + term );
+}
+
+constexpr double tableSin( double x ) { return sinSeries( x * x, x, 1, 0.0 ); }
+constexpr double tableCos( double x ) { return sinSeries( x * x, 1.0, 0, 0.0 ); }
+
+template <int... I> struct IndexList {};
+template <int N, int... I> struct MakeIndexList : MakeIndexList<N - 1, N - 1, I...> {};
+template <int... I> struct MakeIndexList<0, I...> { typedef IndexList<I...> type; };
+
+// Boundary k (1 to Steps) of roll and yaw is -pi + 2 pi k / Steps,
+// stored at index k - 1.
+template <int Steps, typename = typename MakeIndexList<Steps>::type> struct CircularTable;
+
+template <int Steps, int... I> struct CircularTable<Steps, IndexList<I...> > {
+  static constexpr float cosine[Steps] = { float( tableCos( -tablePi + 2.0 * tablePi * ( I + 1 ) / Steps ) )... };
+  static constexpr float sine[Steps] = { float( tableSin( -tablePi + 2.0 * tablePi * ( I + 1 ) / Steps ) )... };
+  // Boundaries below zero, which are the ones a negative angle is tested against.
+  static const int negative = ( Steps - 1 ) / 2;
+};
+
+template <int Steps, int... I> constexpr float CircularTable<Steps, IndexList<I...> >::cosine[Steps];
+template <int Steps, int... I> constexpr float CircularTable<Steps, IndexList<I...> >::sine[Steps];
+
+// Boundary k (1 to Steps) of pitch is -pi/2 + pi k / Steps; the table
+// holds its sine, and the distance in sine that corresponds to
+// quantiserGuard radians there (plus the rounding of the table).
+template <int Steps, typename = typename MakeIndexList<Steps>::type> struct PitchTable;
+
+template <int Steps, int... I> struct PitchTable<Steps, IndexList<I...> > {
+  static constexpr float sine[Steps] = { float( tableSin( -tablePi / 2.0 + tablePi * ( I + 1 ) / Steps ) )... };
+  static constexpr float guard[Steps] = {
+    float( quantiserGuard * tableCos( -tablePi / 2.0 + tablePi * ( I + 1 ) / Steps ) + 1.2e-7 )... };
+};
+
+template <int Steps, int... I> constexpr float PitchTable<Steps, IndexList<I...> >::sine[Steps];
+template <int Steps, int... I> constexpr float PitchTable<Steps, IndexList<I...> >::guard[Steps];
+
+// The searches below halve the range a fixed number of times and
+// move with arithmetic rather than branches: which way a search goes
+// depends on the data and would be mispredicted half the time.
+
+// The bucket of atan2(y, x), or -1 if libm must decide.  A positive
+// angle is at least every negative boundary, so only the boundaries
+// in the angle's own half-plane are searched.  y = 0 is left to libm
+// because atan2 tells -0 from +0.
+template <int Steps>
+inline int circularBucket( float y, float x )
+{
+  typedef CircularTable<Steps> Table;
+  int upper = y > 0.0f;
+  int first = upper * Table::negative;
+  int count = upper ? Steps - 1 - Table::negative : Table::negative;
+  float guard = quantiserGuard * ( std::fabs( x ) + std::fabs( y ) );
+  int close = y == 0.0f;
+  if ( count == 0 ) return close ? -1 : first;
+
+  // Boundaries [first, first + count) are reached by a prefix of them.
+  int base = first;
+  while ( count > 1 ) {
+    int half = count / 2;
+    float c = Table::cosine[base + half] * y - Table::sine[base + half] * x;
+    close |= std::fabs( c ) < guard;
+    base += ( c >= 0.0f ) * half;
+    count -= half;
+  }
+  float c = Table::cosine[base] * y - Table::sine[base] * x;
+  close |= std::fabs( c ) < guard;
+  return close ? -1 : base + ( c >= 0.0f );
+}
+
+// Whether atan2(y, x) reaches boundary k: 1 if so, 0 if not, -1 if
+// libm must decide.
+template <int Steps>
+inline int circularAtLeast( int k, float y, float x )
+{
+  typedef CircularTable<Steps> Table;
+  float c = Table::cosine[k - 1] * y - Table::sine[k - 1] * x;
+  if ( y == 0.0f || std::fabs( c ) < quantiserGuard * ( std::fabs( x ) + std::fabs( y ) ) ) return -1;
+  return 2 * k >= Steps ? ( y > 0.0f && c >= 0.0f ) : ( y > 0.0f || c >= 0.0f );
+}
+
+// The bucket of asin(t), or -1 if libm must decide.
+template <int Steps>
+inline int pitchBucket( float t )
+{
+  typedef PitchTable<Steps> Table;
+  int base = 0, count = Steps, close = 0;
+  while ( count > 1 ) {
+    int half = count / 2;
+    float d = t - Table::sine[base + half];
+    close |= std::fabs( d ) < Table::guard[base + half];
+    base += ( d >= 0.0f ) * half;
+    count -= half;
+  }
+  float d = t - Table::sine[base];
+  close |= std::fabs( d ) < Table::guard[base];
+  return close ? -1 : base + ( d >= 0.0f );
+}
+
+} // namespace detail
+
+//! Roll, pitch and yaw buckets for bucket counts fixed at compile time.
+/*!
+    Gives the same buckets as AngleBucketer with the same steps.  The
+    threshold tests rollAtLeast<K>() and so on answer "is the bucket at
+    least K" with a single table comparison.
+*/
+template <int RollSteps, int PitchSteps, int YawSteps>
+class AngleQuantiser
+{
+ public:
+  AngleQuantiser( void ) : exact_( steps() ) {}
+
+  //! The three buckets of \e q.
+  AngleBuckets buckets( const Quaternion &q ) const
+  {
+    float x = q.x(), y = q.y(), z = q.z(), w = q.w();
+    AngleBuckets b;
+    b.roll = detail::circularBucket<RollSteps>( 2.0f * ( w * x + y * z ), 1.0f - 2.0f * ( x * x + y * y ) );
+    b.pitch = detail::pitchBucket<PitchSteps>( sinPitch( q ) );
+    b.yaw = detail::circularBucket<YawSteps>( 2.0f * ( w * z + x * y ), 1.0f - 2.0f * ( y * y + z * z ) );
+    return ( b.roll < 0 || b.pitch < 0 || b.yaw < 0 ) ? exact_.exactBuckets( q ) : b;
+  }
+
+  //! Whether the roll bucket of \e q is at least \e K (1 to RollSteps).
+  template <int K> bool rollAtLeast( const Quaternion &q ) const
+  {
+    static_assert( K >= 1 && K <= RollSteps, "threshold out of range" );
+    return rollAtLeast( K, q );
+  }
+
+  //! Whether the pitch bucket of \e q is at least \e K (1 to PitchSteps).
+  template <int K> bool pitchAtLeast( const Quaternion &q ) const
+  {
+    static_assert( K >= 1 && K <= PitchSteps, "threshold out of range" );
+    return pitchAtLeast( K, q );
+  }
+
+  //! Whether the yaw bucket of \e q is at least \e K (1 to YawSteps).
+  template <int K> bool yawAtLeast( const Quaternion &q ) const
+  {
+    static_assert( K >= 1 && K <= YawSteps, "threshold out of range" );
+    return yawAtLeast( K, q );
+  }
+
+  //! \name The same tests for a threshold \e k known only at run time (1 to the axis's steps)
+  //@{
+  bool rollAtLeast( int k, const Quaternion &q ) const
+  {
+    float x = q.x(), y = q.y(), z = q.z(), w = q.w();
+    int r = detail::circularAtLeast<RollSteps>( k, 2.0f * ( w * x + y * z ), 1.0f - 2.0f * ( x * x + y * y ) );
+    return r < 0 ? exact_.exactBuckets( q ).roll >= k : r != 0;
+  }
+
+  bool pitchAtLeast( int k, const Quaternion &q ) const
+  {
+    typedef detail::PitchTable<PitchSteps> Table;
+    float d = sinPitch( q ) - Table::sine[k - 1];
+    if ( std::fabs( d ) < Table::guard[k - 1] ) return exact_.exactBuckets( q ).pitch >= k;
+    return d >= 0.0f;
+  }
+
+  bool yawAtLeast( int k, const Quaternion &q ) const
+  {
+    float x = q.x(), y = q.y(), z = q.z(), w = q.w();
+    int r = detail::circularAtLeast<YawSteps>( k, 2.0f * ( w * z + x * y ), 1.0f - 2.0f * ( y * y + z * z ) );
+    return r < 0 ? exact_.exactBuckets( q ).yaw >= k : r != 0;
+  }
+  //@}
+
+  //! Whether bucket \e axis (0 roll, 1 pitch, 2 yaw, as TriggerEngine::Axis) of \e q is at least \e k, for any \e k.
+  bool atLeast( int axis, int k, const Quaternion &q ) const
+  {
+    int top = axis == 0 ? RollSteps : axis == 1 ? PitchSteps : YawSteps;
+    if ( k <= 0 ) return true;
+    if ( k > top ) return false;
+    return axis == 0 ? rollAtLeast( k, q ) : axis == 1 ? pitchAtLeast( k, q ) : yawAtLeast( k, q );
+  }
+
+  //! The steps the tables were generated for.
+  static AngleSteps steps( void )
+  {
+    AngleSteps s = { RollSteps, PitchSteps, YawSteps };
+    return s;
+  }
+
+ private:
+  static float sinPitch( const Quaternion &q )
+  {
+    float t = 2.0f * ( q.w() * q.y() - q.z() * q.x() );
+    return t < -1.0f ? -1.0f : ( t > 1.0f ? 1.0f : t );
+  }
+
+  AngleBucketer exact_;
+};
+
+} // namespace sensor
+
+#endif
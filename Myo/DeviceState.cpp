@@ -0,0 +1,112 @@
+/**********************************************************************/
+/*! \file DeviceState.cpp
+    \brief The state of every armband, as a structure of arrays.
+*/
+/**********************************************************************/
+
+#include "DeviceState.h"
+
+namespace sensor {
+
+DeviceStateTable :: DeviceStateTable( AngleSteps steps )
+  : bucketer_( steps )
+{
+}
+
+unsigned int DeviceStateTable :: slot( Device *device )
+{
+  unsigned int index = device->id() - 1;
+  if ( index >= x_.size() ) {
+    size_t n = index + 1;
+    x_.resize( n, 0.0f );
+    y_.resize( n, 0.0f );
+    z_.resize( n, 0.0f );
+    w_.resize( n, 1.0f );
+    // The buckets of the identity rotation, until the first sweep.
+    AngleBuckets level = bucketer_.exactBuckets( Quaternion() );
+    roll_.resize( n, level.roll );
+    pitch_.resize( n, level.pitch );
+    yaw_.resize( n, level.yaw );
+    pose_.resize( n, Pose::unknown );
+    arm_.resize( n, armUnknown );
+    unlocked_.resize( n, 0 );
+    changed_.resize( n, 0 );
+    pending_.resize( n, 0 );
+    latches_.resize( n, 0 );
+  }
+  return index;
+}
+
+unsigned int DeviceStateTable :: sweep( void )
+{
+  unsigned int n = size(), changed = 0;
+  if ( n == 0 ) return 0;
+  bucketer_.buckets( &x_[0], &y_[0], &z_[0], &w_[0], n, &roll_[0], &pitch_[0], &yaw_[0] );
+  for ( unsigned int i=0; i<n; i++ ) {
+    changed += pending_[i];
+    changed_[i] = pending_[i];
+    pending_[i] = 0;
+  }
+  return changed;
+}
+
+bool DeviceStateTable :: sweep( unsigned int id )
+{
+  unsigned int i = id - 1;
+  AngleBuckets b = bucketer_.buckets( Quaternion( x_[i], y_[i], z_[i], w_[i] ) );
+  roll_[i] = b.roll;
+  pitch_[i] = b.pitch;
+  yaw_[i] = b.yaw;
+  changed_[i] = pending_[i];
+  pending_[i] = 0;
+  return changed_[i] != 0;
+}
+
+unsigned int DeviceStateTable :: deviceOnArm( Arm arm ) const
+{
+  for ( unsigned int i=0; i<size(); i++ )
+    if ( arm_[i] == arm ) return i + 1;
+  return 0;
+}
+
+void DeviceStateTable :: onPair( Device *device, uint64_t /*timestamp*/ )
+{
+  slot( device );
+}
+
+void DeviceStateTable :: onArmSync( Device *device, uint64_t /*timestamp*/, Arm arm, XDirection /*xDirection*/ )
+{
+  arm_[slot( device )] = static_cast<uint8_t>( arm );
+}
+
+void DeviceStateTable :: onArmUnsync( Device *device, uint64_t /*timestamp*/ )
+{
+  arm_[slot( device )] = armUnknown;
+}
+
+void DeviceStateTable :: onUnlock( Device *device, uint64_t /*timestamp*/ )
+{
+  unlocked_[slot( device )] = 1;
+}
+
+void DeviceStateTable :: onLock( Device *device, uint64_t /*timestamp*/ )
+{
+  unlocked_[slot( device )] = 0;
+}
+
+void DeviceStateTable :: onPose( Device *device, uint64_t /*timestamp*/, Pose pose )
+{
+  pose_[slot( device )] = static_cast<uint16_t>( pose.type() );
+}
+
+void DeviceStateTable :: onOrientationData( Device *device, uint64_t /*timestamp*/, const Quaternion &rotation )
+{
+  unsigned int i = slot( device );
+  x_[i] = rotation.x();
+  y_[i] = rotation.y();
+  z_[i] = rotation.z();
+  w_[i] = rotation.w();
+  pending_[i] = 1;
+}
+
+} // namespace sensor
@@ -0,0 +1,91 @@
+/**********************************************************************/
+/*! \file DeviceState.h
+    \brief The state of every armband, as a structure of arrays.
+
+    The collectors kept each armband's state in members named for a
+    role (currentPoseLeft, currentPoseRight, leftMyo, rightMyo) and in
+    globals, which fixed the number of armbands at two.  A
+    DeviceStateTable listens to a source and keeps the state of any
+    number of devices in parallel arrays indexed by Device::id():
+    orientation, roll/pitch/yaw buckets, pose, arm, lock state and a
+    word of trigger latches for the mapping to use.
+
+    Events only store what they carry.  sweep() then buckets the
+    orientation of the whole ensemble at once, with the batch kernel
+    of AngleBucketer, once per frame rather than once per event.
+*/
+/**********************************************************************/
+
+#ifndef DEVICESTATE_H
+#define DEVICESTATE_H
+
+#include <stdint.h>
+#include <vector>
+#include "OrientationMath.h"
+#include "SensorSource.h"
+
+namespace sensor {
+
+class DeviceStateTable : public Listener
+{
+ public:
+  //! Keep state for the devices of one source, bucketing angles into \e steps.
+  DeviceStateTable( AngleSteps steps );
+
+  //! Bucket the orientation of every device.  Returns the number of devices whose orientation changed since the last sweep.
+  unsigned int sweep( void );
+
+  //! Bucket the orientation of device \e id alone, for a listener that acts on each event.  Returns whether it had changed.
+  bool sweep( unsigned int id );
+
+  //! The number of devices seen, which is also the highest id.
+  unsigned int size( void ) const { return static_cast<unsigned int>( x_.size() ); }
+
+  //! \name Per-device state, by Device::id() (1 to size())
+  //@{
+  Quaternion orientation( unsigned int id ) const { return Quaternion( x_[id - 1], y_[id - 1], z_[id - 1], w_[id - 1] ); }
+  int roll( unsigned int id ) const { return roll_[id - 1]; }    //!< as of the last sweep()
+  int pitch( unsigned int id ) const { return pitch_[id - 1]; }  //!< as of the last sweep()
+  int yaw( unsigned int id ) const { return yaw_[id - 1]; }      //!< as of the last sweep()
+  Pose pose( unsigned int id ) const { return Pose( static_cast<Pose::Type>( pose_[id - 1] ) ); }
+  Arm arm( unsigned int id ) const { return static_cast<Arm>( arm_[id - 1] ); }
+  bool unlocked( unsigned int id ) const { return unlocked_[id - 1] != 0; }
+  bool changed( unsigned int id ) const { return changed_[id - 1] != 0; }  //!< orientation changed before the last sweep()
+
+  //! Bits the mapping sets and clears to remember which triggers have fired.
+  uint32_t &latches( unsigned int id ) { return latches_[id - 1]; }
+  //@}
+
+  //! The id of the device synced to \e arm, or 0 if there is none.
+  unsigned int deviceOnArm( Arm arm ) const;
+
+  //! \name The arrays, each size() long, for sweeping the ensemble directly
+  //@{
+  const int *rolls( void ) const { return roll_.empty() ? 0 : &roll_[0]; }
+  const int *pitches( void ) const { return pitch_.empty() ? 0 : &pitch_[0]; }
+  const int *yaws( void ) const { return yaw_.empty() ? 0 : &yaw_[0]; }
+  //@}
+
+  void onPair( Device *device, uint64_t timestamp );
+  void onArmSync( Device *device, uint64_t timestamp, Arm arm, XDirection xDirection );
+  void onArmUnsync( Device *device, uint64_t timestamp );
+  void onUnlock( Device *device, uint64_t timestamp );
+  void onLock( Device *device, uint64_t timestamp );
+  void onPose( Device *device, uint64_t timestamp, Pose pose );
+  void onOrientationData( Device *device, uint64_t timestamp, const Quaternion &rotation );
+
+ private:
+  AngleBucketer bucketer_;
+  std::vector<float> x_, y_, z_, w_;
+  std::vector<int> roll_, pitch_, yaw_;
+  std::vector<uint16_t> pose_;
+  std::vector<uint8_t> arm_, unlocked_, changed_, pending_;
+  std::vector<uint32_t> latches_;
+
+  // Grow the arrays to hold \e device and return its index.
+  unsigned int slot( Device *device );
+};
+
+} // namespace sensor
+
+#endif
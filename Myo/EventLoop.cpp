@@ -0,0 +1,154 @@
+/**********************************************************************/
+/*! \file EventLoop.cpp
+    \brief A reactor for the Myo programs' main loops.
+*/
+/**********************************************************************/
+
+#include "EventLoop.h"
+#include "MidiScheduler.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <sys/select.h>
+#include <unistd.h>
+
+namespace sensor {
+
+static const int64_t never = std::numeric_limits<int64_t>::max();
+
+EventLoop :: EventLoop( Source *source )
+  : source_( source ), scheduler_( 0 ), nextTimerId_( 1 ), stopped_( false ), wakeups_( 0 )
+{
+  if ( pipe( wakeFds_ ) != 0 )
+    throw std::runtime_error( std::string( "EventLoop: cannot create a pipe: " ) + strerror( errno ) );
+  for ( int i=0; i<2; i++ ) {
+    fcntl( wakeFds_[i], F_SETFL, fcntl( wakeFds_[i], F_GETFL ) | O_NONBLOCK );
+    fcntl( wakeFds_[i], F_SETFD, FD_CLOEXEC );
+  }
+}
+
+EventLoop :: ~EventLoop( void )
+{
+  close( wakeFds_[0] );
+  close( wakeFds_[1] );
+}
+
+int EventLoop :: addTimer( int64_t microseconds, const Callback &callback )
+{
+  Timer timer = { nextTimerId_++, steadyMicroseconds() + microseconds, microseconds, callback };
+  timers_.push_back( timer );
+  return timer.id;
+}
+
+void EventLoop :: removeTimer( int id )
+{
+  for ( size_t i=0; i<timers_.size(); i++ )
+    if ( timers_[i].id == id ) {
+      timers_.erase( timers_.begin() + i );
+      return;
+    }
+}
+
+void EventLoop :: post( const Callback &callback )
+{
+  {
+    std::lock_guard<std::mutex> guard( postLock_ );
+    posted_.push_back( callback );
+  }
+  // A full pipe already has the loop's attention.
+  char byte = 0;
+  if ( write( wakeFds_[1], &byte, 1 ) < 0 ) {}
+}
+
+void EventLoop :: stop( void )
+{
+  stopped_ = true;
+  char byte = 0;
+  if ( write( wakeFds_[1], &byte, 1 ) < 0 ) {}
+}
+
+// Timers may add or remove timers, so the due ones are collected
+// first and looked up again before each call.
+void EventLoop :: runTimers( int64_t now )
+{
+  std::vector<int> due;
+  for ( size_t i=0; i<timers_.size(); i++ )
+    if ( timers_[i].due <= now ) due.push_back( timers_[i].id );
+
+  for ( size_t i=0; i<due.size(); i++ ) {
+    for ( size_t j=0; j<timers_.size(); j++ ) {
+      if ( timers_[j].id != due[i] ) continue;
+      // Keep to the interval's grid, but after a stall skip the
+      // expiries that were missed rather than firing them in a burst.
+      Timer &timer = timers_[j];
+      timer.due += timer.interval;
+      if ( timer.due <= now ) timer.due = now + timer.interval;
+      Callback callback = timer.callback;
+      callback();
+      break;
+    }
+  }
+}
+
+void EventLoop :: runPosted( void )
+{
+  std::vector<Callback> callbacks;
+  {
+    std::lock_guard<std::mutex> guard( postLock_ );
+    callbacks.swap( posted_ );
+  }
+  for ( size_t i=0; i<callbacks.size(); i++ ) callbacks[i]();
+}
+
+void EventLoop :: wait( int64_t deadline )
+{
+  fd_set readable;
+  FD_ZERO( &readable );
+  FD_SET( wakeFds_[0], &readable );
+
+  struct timeval timeout, *timeoutPointer = 0;
+  if ( deadline != never ) {
+    int64_t remaining = std::max( (int64_t) 0, deadline - steadyMicroseconds() );
+    timeout.tv_sec = remaining / 1000000;
+    timeout.tv_usec = remaining % 1000000;
+    timeoutPointer = &timeout;
+  }
+
+  if ( select( wakeFds_[0] + 1, &readable, 0, 0, timeoutPointer ) > 0 ) {
+    char buffer[64];
+    while ( read( wakeFds_[0], buffer, sizeof( buffer ) ) > 0 ) {}
+  }
+}
+
+void EventLoop :: run( void )
+{
+  int64_t sourceNext = 0;
+  while ( !stopped_ ) {
+    int64_t now = steadyMicroseconds();
+    if ( source_ && sourceNext <= now && !source_->dispatchDue( now, sourceNext ) ) break;
+    if ( scheduler_ ) scheduler_->advance( steadyMicroseconds() );
+    runTimers( steadyMicroseconds() );
+    runPosted();
+    if ( stopped_ ) break;
+
+    int64_t deadline = source_ ? sourceNext : never;
+    for ( size_t i=0; i<timers_.size(); i++ ) deadline = std::min( deadline, timers_[i].due );
+    if ( scheduler_ ) deadline = std::min( deadline, scheduler_->nextDue() );
+    if ( deadline <= steadyMicroseconds() ) continue;
+
+    wakeups_++;
+    if ( source_ && source_->waitsForEvents() ) {
+      source_->waitForEvents( deadline );
+      sourceNext = 0;
+    }
+    else wait( deadline );
+  }
+  stopped_ = false;
+}
+
+} // namespace sensor
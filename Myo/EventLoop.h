@@ -0,0 +1,101 @@
+/**********************************************************************/
+/*! \file EventLoop.h
+    \brief A reactor for the Myo programs' main loops.
+
+    The programs used to call Source::run(1) in a loop, waking every
+    millisecond whether or not anything had happened, or run(50) and
+    redraw on every return.  An EventLoop instead sleeps until the
+    next thing that needs doing:
+
+    - the source's next event (Source::dispatchDue()), or the first
+      event from a source that delivers while waited on (the Myo hub);
+    - the next expiry of a timer (addTimer()), such as a display
+      refresh;
+    - a callback posted from another thread (post()), such as an
+      RtMidiIn callback handing a message to the loop;
+    - the next event of a MidiScheduler (setScheduler()), such as a
+      note-off.
+
+    Everything registered runs on the thread that calls run().  While
+    the loop waits in the Myo hub it cannot see posts, so they run
+    after the next armband event or timer, at most a few tens of
+    milliseconds later.
+*/
+/**********************************************************************/
+
+#ifndef EVENTLOOP_H
+#define EVENTLOOP_H
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+#include "SensorSource.h"
+
+class MidiScheduler;
+
+namespace sensor {
+
+class EventLoop
+{
+ public:
+  typedef std::function<void( void )> Callback;
+
+  //! Create a loop for \e source, which may be 0 for timers and posts only.
+  EventLoop( Source *source = 0 );
+  ~EventLoop( void );
+
+  //! Call \e callback every \e microseconds, starting one interval from now.  Returns an id for removeTimer().
+  int addTimer( int64_t microseconds, const Callback &callback );
+
+  //! Stop calling a timer.  Safe from inside any callback.
+  void removeTimer( int id );
+
+  //! Fire \e scheduler's events on the loop's thread as they fall due, or none if 0.
+  /*!
+      Events scheduled from another thread for sooner than the loop's
+      next wake-up wait until it wakes.
+  */
+  void setScheduler( MidiScheduler *scheduler ) { scheduler_ = scheduler; }
+
+  //! Run \e callback on the loop's thread.  Safe from any thread.
+  void post( const Callback &callback );
+
+  //! Run until stop() is called or the source has nothing more to deliver.
+  void run( void );
+
+  //! Make run() return.  Safe from any thread.
+  void stop( void );
+
+  //! The number of times run() has gone to sleep and woken up.
+  uint64_t getWakeups( void ) const { return wakeups_; }
+
+ private:
+  struct Timer {
+    int id;
+    int64_t due;
+    int64_t interval;
+    Callback callback;
+  };
+
+  Source *source_;
+  MidiScheduler *scheduler_;
+  std::vector<Timer> timers_;
+  int nextTimerId_;
+  std::atomic<bool> stopped_;
+  uint64_t wakeups_;
+
+  // Posted callbacks, and a pipe whose read end wakes the loop.
+  std::mutex postLock_;
+  std::vector<Callback> posted_;
+  int wakeFds_[2];
+
+  void runTimers( int64_t now );
+  void runPosted( void );
+  void wait( int64_t deadline );
+};
+
+} // namespace sensor
+
+#endif
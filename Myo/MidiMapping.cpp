@@ -0,0 +1,1003 @@
+/**********************************************************************/
+/*! \file MidiMapping.cpp
+    \brief Gesture-to-MIDI rules read from a file.
+*/
+/**********************************************************************/
+
+#include "MidiMapping.h"
+#include "MidiMessages.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+namespace sensor {
+
+// The number of latch bits DeviceStateTable keeps per device.
+static const int latchBits = 32;
+
+// Zones of one zone set, and the set's index in the TriggerEngine.
+struct ZoneNames {
+  unsigned int set;
+  unsigned int count;
+};
+
+//! Parses a mapping file into a MidiMapping's tables.
+class MappingCompiler
+{
+ public:
+  MappingCompiler( MidiMapping &mapping, const std::string &name, AngleSteps steps )
+    : m_( mapping ), name_( name ), line_( 0 ), position_( 0 ), latches_( 0 ), started_( false ), buckets_( false ), steps_( steps )
+  {
+  }
+
+  void compileLine( const std::string &text );
+  AngleSteps steps( void ) const { return steps_; }
+  bool readsBuckets( void ) const { return buckets_; }
+
+ private:
+  MidiMapping &m_;
+  std::string name_;
+  unsigned int line_;
+  std::vector<std::string> tokens_;
+  size_t position_;
+  std::map<std::string, int> variables_, groups_;
+  std::map<std::string, ZoneNames> zones_;
+  int latches_;
+  bool started_;   // a rule has been compiled
+  bool buckets_;   // a rule reads an axis other than through a threshold
+  AngleSteps steps_;
+
+  typedef MidiMapping M;
+
+  void fail( const std::string &message ) const;
+  bool atEnd( void ) const { return position_ == tokens_.size(); }
+  const std::string &peek( void ) const;
+  std::string next( const char *what );
+  bool accept( const char *token );
+  void expect( const char *token );
+  bool isNumber( const std::string &token ) const;
+  int number( const char *what, int minimum, int maximum );
+  bool role( uint16_t &result, bool subject );
+  int axis( const std::string &token ) const;
+  int variable( const std::string &token ) const;
+  int pose( void );
+  int latch( void );
+  const ZoneNames &zoneSet( void );
+  int64_t debounce( void );
+  int grid( void );
+  int domain( const M::Value &value ) const;
+
+  void statement( void );
+  void condition( M::Rule &rule );
+  void action( M::Rule &rule );
+  M::Value value( void );
+  void mapValue( M::Value &value );
+};
+
+void MappingCompiler :: fail( const std::string &message ) const
+{
+  std::ostringstream s;
+  s << name_ << ":" << line_ << ": " << message;
+  throw std::runtime_error( s.str() );
+}
+
+const std::string &MappingCompiler :: peek( void ) const
+{
+  static const std::string end;
+  return atEnd() ? end : tokens_[position_];
+}
+
+std::string MappingCompiler :: next( const char *what )
+{
+  if ( atEnd() ) fail( std::string( "expected " ) + what );
+  return tokens_[position_++];
+}
+
+bool MappingCompiler :: accept( const char *token )
+{
+  if ( atEnd() || tokens_[position_] != token ) return false;
+  position_++;
+  return true;
+}
+
+void MappingCompiler :: expect( const char *token )
+{
+  if ( !accept( token ) ) fail( std::string( "expected '" ) + token + "'" + ( atEnd() ? "" : " before '" + peek() + "'" ) );
+}
+
+bool MappingCompiler :: isNumber( const std::string &token ) const
+{
+  if ( token.empty() ) return false;
+  char *end;
+  strtol( token.c_str(), &end, 10 );
+  return *end == '\0';
+}
+
+int MappingCompiler :: number( const char *what, int minimum, int maximum )
+{
+  std::string token = next( what );
+  if ( !isNumber( token ) ) fail( std::string( "expected " ) + what + ", not '" + token + "'" );
+  long n = strtol( token.c_str(), 0, 10 );
+  if ( n < minimum || n > maximum ) {
+    std::ostringstream s;
+    s << what << " must be from " << minimum << " to " << maximum;
+    fail( s.str() );
+  }
+  return static_cast<int>( n );
+}
+
+// Reads a device: left, right, a number, and for a subject any.
+bool MappingCompiler :: role( uint16_t &result, bool subject )
+{
+  const std::string &token = peek();
+  if ( token == "left" ) result = M::roleLeft;
+  else if ( token == "right" ) result = M::roleRight;
+  else if ( subject && token == "any" ) result = M::roleAny;
+  else if ( isNumber( token ) ) {
+    result = static_cast<uint16_t>( M::roleDevice + number( "a device number", 1, 1000 ) );
+    return true;
+  }
+  else return false;
+  position_++;
+  return true;
+}
+
+int MappingCompiler :: axis( const std::string &token ) const
+{
+  if ( token == "roll" ) return M::axisRoll;
+  if ( token == "pitch" ) return M::axisPitch;
+  if ( token == "yaw" ) return M::axisYaw;
+  return -1;
+}
+
+int MappingCompiler :: variable( const std::string &token ) const
+{
+  std::map<std::string, int>::const_iterator i = variables_.find( token );
+  return i == variables_.end() ? -1 : i->second;
+}
+
+int MappingCompiler :: pose( void )
+{
+  std::string name = next( "a pose" );
+  Pose pose = Pose::fromString( name );
+  if ( pose == Pose::unknown ) fail( "unknown pose '" + name + "'" );
+  return pose.type();
+}
+
+int MappingCompiler :: latch( void )
+{
+  if ( latches_ == latchBits ) fail( "too many edge conditions" );
+  return latches_++;
+}
+
+const ZoneNames &MappingCompiler :: zoneSet( void )
+{
+  std::string name = next( "a zone set" );
+  std::map<std::string, ZoneNames>::const_iterator i = zones_.find( name );
+  if ( i == zones_.end() ) fail( "unknown zone set '" + name + "'" );
+  return i->second;
+}
+
+// An optional debounce time in ms, in microseconds.
+int64_t MappingCompiler :: debounce( void )
+{
+  return accept( "debounce" ) ? 1000 * (int64_t) number( "a debounce time in ms", 0, 60000 ) : 0;
+}
+
+// A note value 1/N as MIDI clock ticks.
+int MappingCompiler :: grid( void )
+{
+  std::string token = next( "a note value such as 1/16" );
+  int n = token.compare( 0, 2, "1/" ) == 0 && isNumber( token.substr( 2 ) ) ? atoi( token.c_str() + 2 ) : 0;
+  if ( n != 1 && n != 2 && n != 4 && n != 8 && n != 16 && n != 32 )
+    fail( "expected a note value of 1/1, 1/2, 1/4, 1/8, 1/16 or 1/32, not '" + token + "'" );
+  return 96 / n;
+}
+
+// The number of values a term can take, which a table maps.
+int MappingCompiler :: domain( const M::Value &value ) const
+{
+  if ( value.kind == M::valueVariable ) {
+    const M::Variable &v = m_.variables_[value.index];
+    return v.maximum - v.minimum + 1;
+  }
+  if ( value.index == M::axisRoll ) return steps_.roll + 1;
+  if ( value.index == M::axisPitch ) return steps_.pitch + 1;
+  return steps_.yaw + 1;
+}
+
+void MappingCompiler :: compileLine( const std::string &text )
+{
+  line_++;
+  std::string line = text.substr( 0, text.find( '#' ) );
+  std::string spaced;
+  for ( size_t i=0; i<line.size(); i++ ) {
+    char c = line[i];
+    if ( c == ',' || c == ':' || c == '[' || c == ']' ) {
+      spaced += ' ';
+      spaced += c;
+      spaced += ' ';
+    }
+    else spaced += c;
+  }
+
+  tokens_.clear();
+  position_ = 0;
+  std::istringstream words( spaced );
+  std::string word;
+  while ( words >> word ) tokens_.push_back( word );
+  if ( tokens_.empty() ) return;
+
+  statement();
+  if ( !atEnd() ) fail( "unexpected '" + peek() + "'" );
+}
+
+void MappingCompiler :: statement( void )
+{
+  if ( accept( "steps" ) ) {
+    if ( started_ ) fail( "steps must come before the rules" );
+    steps_.roll = number( "roll steps", 1, 1000 );
+    steps_.pitch = number( "pitch steps", 1, 1000 );
+    steps_.yaw = number( "yaw steps", 1, 1000 );
+    m_.triggers_ = TriggerEngine( steps_ );
+    return;
+  }
+
+  if ( accept( "zones" ) ) {
+    std::string name = next( "a zone set name" );
+    if ( zones_.count( name ) ) fail( "zone set '" + name + "' is already defined" );
+    std::string axisName = next( "an axis" );
+    int a = axis( axisName );
+    if ( a < 0 ) fail( "unknown axis '" + axisName + "'" );
+    std::vector<int> bounds;
+    while ( isNumber( peek() ) ) {
+      bounds.push_back( number( "a bound", -30000, 30000 ) );
+      if ( bounds.size() > 1 && bounds.back() <= bounds[bounds.size() - 2] ) fail( "zone bounds must increase" );
+    }
+    if ( bounds.empty() ) fail( "expected the zone bounds" );
+    int hysteresis = accept( "hysteresis" ) ? number( "a hysteresis", 0, 30000 ) : 0;
+    int64_t time = debounce();
+    ZoneNames zones;
+    zones.set = m_.triggers_.addZones( static_cast<TriggerEngine::Axis>( a ), bounds, hysteresis, time );
+    zones.count = static_cast<unsigned int>( bounds.size() + 1 );
+    zones_[name] = zones;
+    m_.zoneBase_.push_back( static_cast<uint16_t>( m_.events_ - M::eventZone ) );
+    m_.events_ += zones.count;
+    started_ = true;
+    return;
+  }
+
+  if ( accept( "limit" ) ) {
+    unsigned int channel = number( "a channel", 1, 16 );
+    unsigned int controller = number( "a controller", 0, 127 );
+    int threshold = accept( "threshold" ) ? number( "a threshold", 0, 127 ) : 0;
+    int64_t interval = accept( "rate" ) ? 1000000 / number( "a rate in Hz", 1, 1000 ) : 0;
+    if ( !threshold && !interval ) fail( "expected threshold or rate" );
+    m_.output_.setLimit( channel, controller, threshold, interval );
+    return;
+  }
+
+  if ( accept( "var" ) ) {
+    std::string name = next( "a variable name" );
+    if ( variable( name ) >= 0 ) fail( "variable '" + name + "' is already defined" );
+    if ( axis( name ) >= 0 || isNumber( name ) ) fail( "'" + name + "' cannot name a variable" );
+    M::Variable v;
+    v.value = number( "an initial value", -32768, 32767 );
+    v.minimum = number( "a minimum", -32768, 32767 );
+    v.maximum = number( "a maximum", v.minimum, 32767 );
+    if ( v.value < v.minimum || v.value > v.maximum ) fail( "the initial value must be within the minimum and maximum" );
+    variables_[name] = static_cast<int>( m_.variables_.size() );
+    m_.variables_.push_back( v );
+    return;
+  }
+
+  // A rule.
+  M::Rule rule;
+  rule.edge = -1;
+  rule.group = -1;
+  rule.quantize = 0;
+  rule.line = line_;
+  if ( accept( "start" ) ) {
+    rule.role = M::roleSelf;
+    rule.event = M::eventStart;
+  }
+  else {
+    if ( !role( rule.role, true ) ) fail( "expected a statement, not '" + peek() + "'" );
+    std::string event = next( "an event" );
+    if ( event == "orientation" ) rule.event = M::eventOrientation;
+    else if ( event == "pose" ) rule.event = static_cast<uint16_t>( M::eventPose + pose() );
+    else if ( event == "zone" ) {
+      const ZoneNames &zones = zoneSet();
+      int zone = number( "a zone", 0, zones.count - 1 );
+      rule.event = static_cast<uint16_t>( M::eventZone + m_.zoneBase_[zones.set] + zone );
+    }
+    else if ( event == "unlock" ) rule.event = M::eventUnlock;
+    else if ( event == "lock" ) rule.event = M::eventLock;
+    else if ( event == "pair" ) rule.event = M::eventPair;
+    else if ( event == "unpair" ) rule.event = M::eventUnpair;
+    else if ( event == "connect" ) rule.event = M::eventConnect;
+    else if ( event == "disconnect" ) rule.event = M::eventDisconnect;
+    else fail( "unknown event '" + event + "'" );
+  }
+
+  rule.conditions = static_cast<uint32_t>( m_.conditions_.size() );
+  accept( "when" );
+  while ( !accept( ":" ) ) {
+    if ( atEnd() ) fail( "expected ':' and the actions" );
+    condition( rule );
+  }
+  rule.conditionsEnd = static_cast<uint32_t>( m_.conditions_.size() );
+
+  rule.actions = static_cast<uint32_t>( m_.actions_.size() );
+  do action( rule ); while ( accept( "," ) );
+  rule.actionsEnd = static_cast<uint32_t>( m_.actions_.size() );
+
+  if ( m_.rules_.size() == 0xffff ) fail( "too many rules" );
+  m_.rules_.push_back( rule );
+  started_ = true;
+}
+
+void MappingCompiler :: condition( M::Rule &rule )
+{
+  if ( accept( "edge" ) ) {
+    if ( rule.event == M::eventStart ) fail( "a start rule cannot be an edge" );
+    rule.edge = static_cast<int8_t>( latch() );
+    return;
+  }
+  if ( accept( "group" ) ) {
+    if ( rule.event == M::eventStart ) fail( "a start rule cannot be in a group" );
+    std::string name = next( "a group name" );
+    if ( !groups_.count( name ) ) groups_[name] = static_cast<int>( groups_.size() );
+    rule.group = static_cast<int16_t>( groups_[name] );
+    return;
+  }
+  if ( accept( "quantize" ) ) {
+    rule.quantize = static_cast<uint8_t>( grid() );
+    return;
+  }
+
+  M::Condition c;
+  c.role = M::roleSelf;
+  c.subject = 0;
+  c.threshold = 0;
+  c.trigger = -1;
+  role( c.role, false );
+
+  std::string word = next( "a condition" );
+  int index;
+  if ( word == "unlocked" ) c.kind = M::conditionUnlocked;
+  else if ( word == "locked" ) c.kind = M::conditionLocked;
+  else if ( word == "pose" ) {
+    c.kind = M::conditionPose;
+    c.subject = static_cast<uint16_t>( pose() );
+  }
+  else if ( word == "zone" ) {
+    c.kind = M::conditionZone;
+    const ZoneNames &zones = zoneSet();
+    c.subject = static_cast<uint16_t>( zones.set );
+    c.threshold = static_cast<int16_t>( number( "a zone", 0, zones.count - 1 ) );
+  }
+  else if ( ( index = axis( word ) ) >= 0 || ( c.role == M::roleSelf && ( index = variable( word ) ) >= 0 ) ) {
+    c.kind = axis( word ) >= 0 ? M::conditionAxis : M::conditionVariable;
+    c.subject = static_cast<uint16_t>( index );
+    std::string op = next( "a comparison" );
+    if ( op == "<" ) c.op = M::opLess;
+    else if ( op == "<=" ) c.op = M::opLessEqual;
+    else if ( op == ">" ) c.op = M::opGreater;
+    else if ( op == ">=" ) c.op = M::opGreaterEqual;
+    else if ( op == "=" ) c.op = M::opEqual;
+    else if ( op == "!=" ) c.op = M::opNotEqual;
+    else fail( "unknown comparison '" + op + "'" );
+    c.threshold = static_cast<int16_t>( number( "a threshold", -30000, 30000 ) );
+
+    // Thresholds on an axis become triggers, in strict form.
+    bool threshold = c.kind == M::conditionAxis && c.op != M::opEqual && c.op != M::opNotEqual;
+    int hysteresis = 0;
+    if ( accept( "hysteresis" ) ) {
+      if ( !threshold ) fail( "hysteresis needs an axis compared with <, <=, > or >=" );
+      hysteresis = number( "a hysteresis", 0, 30000 );
+    }
+    int64_t time = debounce();
+    if ( time && !threshold ) fail( "debounce needs an axis compared with <, <=, > or >=" );
+    if ( threshold ) {
+      bool below = c.op == M::opLess || c.op == M::opLessEqual;
+      int at = c.threshold + ( c.op == M::opLessEqual ? 1 : c.op == M::opGreaterEqual ? -1 : 0 );
+      c.trigger = static_cast<int32_t>( m_.triggers_.addThreshold( static_cast<TriggerEngine::Axis>( index ), below, at, hysteresis, time ) );
+    }
+    else if ( c.kind == M::conditionAxis ) buckets_ = true;
+  }
+  else fail( "unknown condition '" + word + "'" );
+
+  if ( c.kind != M::conditionVariable && c.role == M::roleSelf && rule.event == M::eventStart )
+    fail( "a start rule has no device of its own" );
+  m_.conditions_.push_back( c );
+}
+
+MidiMapping::Value MappingCompiler :: value( void )
+{
+  M::Value v;
+  v.kind = M::valueConstant;
+  v.index = 0;
+  v.role = M::roleSelf;
+  v.table = -1;
+  v.offset = 0;
+
+  if ( isNumber( peek() ) ) {
+    v.offset = number( "a value", -32768, 32767 );
+    return v;
+  }
+
+  bool device = role( v.role, false );
+  std::string word = next( "a value" );
+  int index;
+  if ( ( index = axis( word ) ) >= 0 ) {
+    v.kind = M::valueAxis;
+    buckets_ = true;
+  }
+  else if ( !device && ( index = variable( word ) ) >= 0 ) v.kind = M::valueVariable;
+  else fail( "unknown value '" + word + "'" );
+  v.index = static_cast<uint8_t>( index );
+
+  mapValue( v );
+
+  if ( accept( "+" ) ) v.offset = number( "an offset", -32768, 32767 );
+  else if ( accept( "-" ) ) v.offset = -number( "an offset", -32768, 32767 );
+  return v;
+}
+
+// Compiles a range or table into a lookup over every value the term can take.
+void MappingCompiler :: mapValue( M::Value &v )
+{
+  int size = domain( v );
+  int first = v.kind == M::valueVariable ? m_.variables_[v.index].minimum : 0;
+  std::vector<double> entries;
+
+  if ( accept( "range" ) ) {
+    double inLow = number( "the bottom of the input range", -32768, 32767 );
+    double inHigh = number( "the top of the input range", -32768, 32767 );
+    double outLow = number( "the bottom of the output range", -32768, 32767 );
+    double outHigh = number( "the top of the output range", -32768, 32767 );
+    if ( inLow == inHigh ) fail( "the input range is empty" );
+    std::string curve = "linear";
+    if ( accept( "curve" ) ) curve = next( "a curve" );
+    if ( curve != "linear" && curve != "square" && curve != "sqrt" ) fail( "unknown curve '" + curve + "'" );
+
+    for ( int i=0; i<size; i++ ) {
+      double t = std::max( 0.0, std::min( 1.0, ( first + i - inLow ) / ( inHigh - inLow ) ) );
+      if ( curve == "square" ) t = t * t;
+      else if ( curve == "sqrt" ) t = std::sqrt( t );
+      entries.push_back( outLow + ( outHigh - outLow ) * t );
+    }
+  }
+  else if ( accept( "table" ) ) {
+    expect( "[" );
+    while ( !accept( "]" ) ) entries.push_back( number( "a table entry or ']'", -32768, 32767 ) );
+    if ( entries.empty() ) fail( "the table is empty" );
+    if ( (int) entries.size() > size ) fail( "the table has more entries than its input has values" );
+    // Values past the end of a short table take its last entry.
+    entries.resize( size, entries.back() );
+  }
+  else return;
+
+  // Kept in 16.16 fixed point, so a controller keeps the fraction.
+  v.table = static_cast<int32_t>( m_.tables_.size() );
+  for ( int i=0; i<size; i++ )
+    m_.tables_.push_back( static_cast<int32_t>( std::llround( std::max( -32768.0, std::min( 32767.0, entries[i] ) ) * 65536 ) ) );
+}
+
+void MappingCompiler :: action( M::Rule &rule )
+{
+  M::Action a;
+  a.channel = 0;
+  a.number = 0;
+  a.velocity = 0;
+  a.length = 0;
+  a.variable = 0;
+  a.value.kind = M::valueConstant;
+  a.value.index = 0;
+  a.value.role = M::roleSelf;
+  a.value.table = -1;
+  a.value.offset = 0;
+
+  std::string word = next( "an action" );
+  if ( word == "cc" ) {
+    a.kind = M::actionControl;
+    a.channel = static_cast<uint8_t>( number( "a channel", 1, 16 ) - 1 );
+    a.number = static_cast<uint8_t>( number( "a controller", 0, 127 ) );
+    a.value = value();
+  }
+  else if ( word == "note" || word == "voice" ) {
+    a.kind = word == "note" ? M::actionNote : M::actionVoice;
+    a.channel = static_cast<uint8_t>( number( "a channel", 1, 16 ) - 1 );
+    a.value = value();
+    a.velocity = static_cast<uint8_t>( number( "a velocity", 1, 127 ) );
+    if ( a.kind == M::actionNote ) a.length = accept( "hold" ) ? -1 : number( "a length in ms or hold", 0, 60000 );
+  }
+  else if ( word == "release" ) {
+    a.kind = M::actionRelease;
+    a.channel = static_cast<uint8_t>( number( "a channel", 1, 16 ) - 1 );
+  }
+  else if ( word == "program" ) {
+    a.kind = M::actionProgram;
+    a.channel = static_cast<uint8_t>( number( "a channel", 1, 16 ) - 1 );
+    a.number = static_cast<uint8_t>( number( "a program", 0, 127 ) );
+  }
+  else if ( word == "set" || word == "add" ) {
+    a.kind = word == "set" ? M::actionSet : M::actionAdd;
+    std::string name = next( "a variable" );
+    int index = variable( name );
+    if ( index < 0 ) fail( "unknown variable '" + name + "'" );
+    a.variable = static_cast<uint16_t>( index );
+    if ( a.kind == M::actionSet ) a.value = value();
+    else a.value.offset = number( "an amount", -32768, 32767 );
+  }
+  else if ( word == "unlock" ) {
+    if ( rule.event == M::eventStart ) fail( "a start rule has no device to unlock" );
+    a.kind = M::actionUnlock;
+  }
+  else fail( "unknown action '" + word + "'" );
+
+  if ( rule.event == M::eventStart && a.value.kind == M::valueAxis && a.value.role == M::roleSelf )
+    fail( "a start rule has no device of its own" );
+  m_.actions_.push_back( a );
+}
+
+static AngleSteps defaultSteps( void )
+{
+  AngleSteps steps = { 127, 127, 127 };
+  return steps;
+}
+
+MidiMapping :: MidiMapping( RtMidiOut *out, MidiScheduler &scheduler )
+  : out_( out ), scheduler_( scheduler ), notes_( out ), output_( out, scheduler ), log_( 0 ), firedFormat_( 0 ), quantizedFormat_( 0 ), board_( 0 ), table_( defaultSteps() ), triggers_( defaultSteps() ), thresholdsOnly_( false ), events_( eventZone ),
+    groups_( 0 ), devices_( 0 ), left_( 0 ), right_( 0 ), playing_( 0 )
+{
+  output_.setTracker( &notes_ );
+  for ( int i=0; i<16; i++ ) {
+    voices_[i] = -1;
+    for ( int note=0; note<128; note++ ) {
+      noteOffs_[i][note] = 0;
+      noteOns_[i][note] = 0;
+    }
+  }
+}
+
+MidiMapping :: ~MidiMapping( void )
+{
+  output_.flush();
+  for ( int i=0; i<16; i++ )
+    for ( int note=0; note<128; note++ ) endNote( i, note, 0 );
+  notes_.notesOff();
+}
+
+void MidiMapping :: load( const std::string &file )
+{
+  std::ifstream in( file.c_str() );
+  if ( !in ) throw std::runtime_error( "cannot open the mapping " + file );
+  load( in, file );
+}
+
+void MidiMapping :: load( std::istream &in, const std::string &name )
+{
+  rules_.clear();
+  conditions_.clear();
+  actions_.clear();
+  tables_.clear();
+  variables_.clear();
+  triggers_ = TriggerEngine( defaultSteps() );
+  zoneBase_.clear();
+  events_ = eventZone;
+  for ( unsigned int controller=0; controller<128; controller++ ) output_.setLimit( 0, controller, 0, 0 );
+
+  MappingCompiler compiler( *this, name, defaultSteps() );
+  std::string line;
+  while ( std::getline( in, line ) ) compiler.compileLine( line );
+
+  table_ = DeviceStateTable( compiler.steps() );
+  // Past a few thresholds, bucketing once and comparing is cheaper
+  // than a boundary test each (benchmarks/triggerbench).
+  AngleSteps steps = compiler.steps(), quantised = Quantiser::steps();
+  thresholdsOnly_ = !compiler.readsBuckets() && triggers_.zoneSets() == 0 && triggers_.thresholds() <= 4 &&
+                    steps.roll == quantised.roll && steps.pitch == quantised.pitch && steps.yaw == quantised.yaw;
+  groups_ = 0;
+  for ( size_t i=0; i<rules_.size(); i++ )
+    groups_ = std::max( groups_, (unsigned int) ( rules_[i].group + 1 ) );
+  startRules_.clear();
+  for ( size_t i=0; i<rules_.size(); i++ )
+    if ( rules_[i].event == eventStart ) startRules_.push_back( static_cast<uint16_t>( i ) );
+  fired_.resize( rules_.size() );
+  devices_ = 0;
+  left_ = right_ = 0;
+  groupLast_.clear();
+  rebuild( 0 );
+}
+
+void MidiMapping :: start( void )
+{
+  if ( !startRules_.empty() ) fire( &startRules_[0], startRules_.size(), 0 );
+}
+
+// Lists, for each device and event, the rules whose subject is that
+// device, so dispatch() need not look at the others.
+void MidiMapping :: rebuild( unsigned int devices )
+{
+  devices_ = devices;
+  dispatch_.assign( ( devices + 1 ) * events_ + 1, 0 );
+  ruleList_.clear();
+  for ( unsigned int id=1; id<=devices; id++ ) {
+    Arm arm = id <= table_.size() ? table_.arm( id ) : armUnknown;
+    for ( unsigned int event=0; event<events_; event++ ) {
+      dispatch_[id * events_ + event] = static_cast<uint32_t>( ruleList_.size() );
+      for ( size_t r=0; r<rules_.size(); r++ ) {
+        const Rule &rule = rules_[r];
+        if ( rule.event != event ) continue;
+        if ( rule.role == roleAny || ( rule.role == roleLeft && arm == armLeft ) ||
+             ( rule.role == roleRight && arm == armRight ) || rule.role == roleDevice + id )
+          ruleList_.push_back( static_cast<uint16_t>( r ) );
+      }
+    }
+  }
+  dispatch_.back() = static_cast<uint32_t>( ruleList_.size() );
+  groupLast_.resize( devices * groups_, -1 );
+}
+
+void MidiMapping :: dispatch( Device *device, unsigned int event )
+{
+  unsigned int id = device->id();
+  if ( id > devices_ ) rebuild( id );
+  const uint32_t *row = &dispatch_[id * events_ + event];
+  if ( row[1] > row[0] ) fire( &ruleList_[row[0]], row[1] - row[0], device );
+}
+
+void MidiMapping :: fire( const uint16_t *rules, size_t count, Device *device )
+{
+  unsigned int self = device ? device->id() : 0;
+  size_t fired = 0;
+  for ( size_t i=0; i<count; i++ )
+    if ( holds( rules[i], self ) ) fired_[fired++] = rules[i];
+
+  for ( size_t i=0; i<fired; i++ ) {
+    const Rule &rule = rules_[fired_[i]];
+    if ( rule.group >= 0 ) groupLast_[( self - 1 ) * groups_ + rule.group] = static_cast<int16_t>( fired_[i] );
+    int64_t due = rule.quantize ? gridPoint( rule.quantize ) : 0;
+    if ( log_ ) {
+      if ( due ) log_->log( quantizedFormat_, self, rule.line, due - MidiScheduler::now() );
+      else log_->log( firedFormat_, self, rule.line );
+    }
+    for ( uint32_t a=rule.actions; a<rule.actionsEnd; a++ ) perform( actions_[a], device, due );
+  }
+}
+
+void MidiMapping :: setLog( AsyncLog *log )
+{
+  log_ = log;
+  if ( !log ) return;
+  firedFormat_ = log->define( "device {}: rule at line {} fired" );
+  quantizedFormat_ = log->define( "device {}: rule at line {} fired, sending in {} us" );
+}
+
+// When to send a quantized rule's messages, or 0 for now.
+int64_t MidiMapping :: gridPoint( unsigned int ticks ) const
+{
+  if ( !grid_ ) return 0;
+  int64_t now = MidiScheduler::now();
+  int64_t point = grid_( ticks, now );
+  return point > now && point != std::numeric_limits<int64_t>::max() ? point : 0;
+}
+
+bool MidiMapping :: holds( unsigned int index, unsigned int self )
+{
+  const Rule &rule = rules_[index];
+  bool all = true;
+  for ( uint32_t c=rule.conditions; c<rule.conditionsEnd; c++ )
+    all &= test( conditions_[c], self );
+
+  if ( rule.group >= 0 && groupLast_[( self - 1 ) * groups_ + rule.group] == (int) index ) all = false;
+  if ( rule.edge >= 0 && self <= table_.size() ) {
+    uint32_t &latches = table_.latches( self );
+    uint32_t bit = 1u << rule.edge;
+    bool was = ( latches & bit ) != 0;
+    latches = all ? latches | bit : latches & ~bit;
+    if ( was ) return false;
+  }
+  return all;
+}
+
+bool MidiMapping :: compare( int value, unsigned int op, int threshold )
+{
+  switch ( op ) {
+  case opLess: return value < threshold;
+  case opLessEqual: return value <= threshold;
+  case opGreater: return value > threshold;
+  case opGreaterEqual: return value >= threshold;
+  case opEqual: return value == threshold;
+  default: return value != threshold;
+  }
+}
+
+bool MidiMapping :: test( const Condition &c, unsigned int self )
+{
+  if ( c.kind == conditionVariable ) return compare( variables_[c.subject].value, c.op, c.threshold );
+
+  unsigned int id = resolve( c.role, self );
+  if ( !id ) return false;
+  switch ( c.kind ) {
+  case conditionUnlocked: return table_.unlocked( id );
+  case conditionLocked: return !table_.unlocked( id );
+  case conditionPose: return table_.pose( id ) == static_cast<Pose::Type>( c.subject );
+  case conditionZone: return triggers_.zone( id, c.subject ) == c.threshold;
+  default: break;
+  }
+  if ( c.trigger >= 0 ) return triggers_.state( id, c.trigger );
+  return compare( bucket( id, c.subject ), c.op, c.threshold );
+}
+
+int MidiMapping :: bucket( unsigned int id, unsigned int axis ) const
+{
+  return axis == axisRoll ? table_.roll( id ) : axis == axisPitch ? table_.pitch( id ) : table_.yaw( id );
+}
+
+// A value in 16.16 fixed point.
+bool MidiMapping :: evaluate( const Value &v, unsigned int self, int64_t &result ) const
+{
+  int64_t x;
+  if ( v.kind == valueConstant ) {
+    result = (int64_t) v.offset << 16;
+    return true;
+  }
+  if ( v.kind == valueAxis ) {
+    unsigned int id = resolve( v.role, self );
+    if ( !id ) return false;
+    int b = bucket( id, v.index );
+    x = v.table >= 0 ? tables_[v.table + b] : (int64_t) b << 16;
+  }
+  else {
+    const Variable &variable = variables_[v.index];
+    x = v.table >= 0 ? tables_[v.table + variable.value - variable.minimum] : (int64_t) variable.value << 16;
+  }
+  result = x + ( (int64_t) v.offset << 16 );
+  return true;
+}
+
+// A value rounded to a whole number, for a note or a variable.
+static int whole( int64_t fixed )
+{
+  return static_cast<int>( ( fixed + 0x8000 ) >> 16 );
+}
+
+// Run an action, sending its messages at \e due, or now for 0.
+void MidiMapping :: perform( const Action &a, Device *device, int64_t due )
+{
+  unsigned int self = device ? device->id() : 0;
+  int64_t value;
+  playing_ = self;
+  switch ( a.kind ) {
+  case actionControl:
+    if ( evaluate( a.value, self, value ) ) control( due, a.channel, a.number, value );
+    break;
+  case actionNote: {
+    if ( !evaluate( a.value, self, value ) ) break;
+    int note = midiClamp7( whole( value ) );
+    int64_t &queued = noteOns_[a.channel][note];
+    if ( queued ) {
+      if ( queued > MidiScheduler::now() ) break;   // already waiting for its grid point
+      queued = 0;
+    }
+    if ( due ) queued = due;
+    endNote( a.channel, note, due );
+    send( due, 0x90 | a.channel, note, a.velocity );
+    if ( a.length < 0 ) break;
+    if ( a.length == 0 ) {
+      send( due, 0x80 | a.channel, note, a.velocity );
+      break;
+    }
+    unsigned char noteOff[3] = { static_cast<unsigned char>( 0x80 | a.channel ), static_cast<unsigned char>( note ), a.velocity };
+    noteOffs_[a.channel][note] = output_.later( ( due ? due : MidiScheduler::now() ) + a.length * (int64_t) 1000, noteOff, 3 );
+    break;
+  }
+  case actionVoice: {
+    if ( !evaluate( a.value, self, value ) ) break;
+    int note = midiClamp7( whole( value ) );
+    if ( voices_[a.channel] == note ) break;
+    if ( voices_[a.channel] >= 0 ) send( due, 0x80 | a.channel, voices_[a.channel], 0 );
+    send( due, 0x90 | a.channel, note, a.velocity );
+    voices_[a.channel] = note;
+    break;
+  }
+  case actionRelease:
+    if ( voices_[a.channel] < 0 ) break;
+    send( due, 0x80 | a.channel, voices_[a.channel], 0 );
+    voices_[a.channel] = -1;
+    break;
+  case actionProgram:
+    send( due, 0xC0 | a.channel, a.number );
+    break;
+  case actionSet:
+  case actionAdd: {
+    Variable &variable = variables_[a.variable];
+    if ( !evaluate( a.value, self, value ) ) break;
+    int amount = whole( value );
+    if ( a.kind == actionAdd ) amount += variable.value;
+    variable.value = std::max( variable.minimum, std::min( variable.maximum, amount ) );
+    break;
+  }
+  case actionUnlock:
+    if ( device ) device->unlock( Device::unlockHold );
+    break;
+  }
+}
+
+// Send a note's pending note-off at \e due (or now), if it has one.
+void MidiMapping :: endNote( unsigned int channel, int note, int64_t due )
+{
+  MidiScheduler::Handle &handle = noteOffs_[channel][note];
+  if ( handle && scheduler_.cancel( handle ) ) send( due, 0x80 | channel, note, 0 );
+  handle = 0;
+}
+
+unsigned int MidiMapping :: resolve( unsigned int role, unsigned int self ) const
+{
+  unsigned int id;
+  if ( role == roleSelf || role == roleAny ) id = self;
+  else if ( role == roleLeft ) id = left_;
+  else if ( role == roleRight ) id = right_;
+  else id = role - roleDevice;
+  return id <= table_.size() ? id : 0;
+}
+
+// A controller goes out as a MIDI 2.0 packet, its value 0-127 with the
+// fraction its mapping gives spread over 32 bits: between the MIDI 1.0
+// steps midiUmpScaleUp() puts them on, so a whole value converts back
+// exactly and a MIDI 1.0 port gets the fraction cut off.
+void MidiMapping :: control( int64_t due, unsigned int channel, unsigned int number, int64_t value )
+{
+  value = std::max( (int64_t) 0, std::min( (int64_t) 127 << 16, value ) );
+  uint32_t step = static_cast<uint32_t>( value >> 16 ), fraction = static_cast<uint32_t>( value & 0xFFFF );
+  uint32_t wide = midiUmpScaleUp( step, 7, 32 );
+  if ( fraction ) wide += static_cast<uint32_t>( ( (uint64_t) ( midiUmpScaleUp( step + 1, 7, 32 ) - wide ) * fraction ) >> 16 );
+  output_.send( MidiUmp::controlChange( channel, number, wide ), due, playing_ );
+}
+
+void MidiMapping :: send( int64_t due, unsigned char status, int data1, int data2 )
+{
+  unsigned char message[3] = { status, midiClamp7( data1 ), midiClamp7( data2 ) };
+  output_.send( message, 3, due, playing_ );
+}
+
+void MidiMapping :: send( int64_t due, unsigned char status, int data1 )
+{
+  unsigned char message[2] = { status, midiClamp7( data1 ) };
+  output_.send( message, 2, due );
+}
+
+// Hand the device's state to the status board, if there is one.
+void MidiMapping :: publish( Device *device )
+{
+  unsigned int id = device->id();
+  if ( !board_ || id < 1 || id > table_.size() ) return;
+  if ( connected_.size() < id ) connected_.resize( id, 1 );
+  DeviceStatus status;
+  status.roll = table_.roll( id );
+  status.pitch = table_.pitch( id );
+  status.yaw = table_.yaw( id );
+  status.pose = table_.pose( id );
+  status.arm = table_.arm( id );
+  status.unlocked = table_.unlocked( id );
+  status.connected = connected_[id - 1] != 0;
+  board_->publish( id, status );
+}
+
+void MidiMapping :: onPair( Device *device, uint64_t timestamp )
+{
+  table_.onPair( device, timestamp );
+  if ( !board_ ) std::cout << "Paired with " << device->id() << "." << std::endl;
+  dispatch( device, eventPair );
+  publish( device );
+}
+
+void MidiMapping :: onUnpair( Device *device, uint64_t /*timestamp*/ )
+{
+  dispatch( device, eventUnpair );
+  endNotes( device );
+}
+
+void MidiMapping :: onConnect( Device *device, uint64_t /*timestamp*/ )
+{
+  if ( !board_ ) std::cout << "Myo " << device->id() << " has connected." << std::endl;
+  else if ( connected_.size() >= device->id() ) connected_[device->id() - 1] = 1;
+  dispatch( device, eventConnect );
+  publish( device );
+}
+
+void MidiMapping :: onDisconnect( Device *device, uint64_t /*timestamp*/ )
+{
+  if ( !board_ ) std::cout << "Myo " << device->id() << " has disconnected." << std::endl;
+  else {
+    if ( connected_.size() < device->id() ) connected_.resize( device->id(), 1 );
+    connected_[device->id() - 1] = 0;
+  }
+  dispatch( device, eventDisconnect );
+  endNotes( device );
+  publish( device );
+}
+
+// End the notes \e device played that are still sounding, and forget
+// any voice among them.
+void MidiMapping :: endNotes( Device *device )
+{
+  if ( !notes_.notesOff( device->id() ) ) return;
+  for ( unsigned int i=0; i<16; i++ )
+    if ( voices_[i] >= 0 && !notes_.isSounding( i + 1, voices_[i] ) ) voices_[i] = -1;
+}
+
+void MidiMapping :: onArmSync( Device *device, uint64_t timestamp, Arm arm, XDirection xDirection )
+{
+  table_.onArmSync( device, timestamp, arm, xDirection );
+  left_ = table_.deviceOnArm( armLeft );
+  right_ = table_.deviceOnArm( armRight );
+  rebuild( std::max( devices_, table_.size() ) );
+  publish( device );
+}
+
+void MidiMapping :: onArmUnsync( Device *device, uint64_t timestamp )
+{
+  table_.onArmUnsync( device, timestamp );
+  left_ = table_.deviceOnArm( armLeft );
+  right_ = table_.deviceOnArm( armRight );
+  rebuild( std::max( devices_, table_.size() ) );
+  publish( device );
+}
+
+void MidiMapping :: onUnlock( Device *device, uint64_t timestamp )
+{
+  table_.onUnlock( device, timestamp );
+  dispatch( device, eventUnlock );
+  publish( device );
+}
+
+void MidiMapping :: onLock( Device *device, uint64_t timestamp )
+{
+  table_.onLock( device, timestamp );
+  dispatch( device, eventLock );
+  publish( device );
+}
+
+void MidiMapping :: onPose( Device *device, uint64_t timestamp, Pose pose )
+{
+  table_.onPose( device, timestamp, pose );
+  if ( pose.type() <= Pose::doubleTap ) dispatch( device, eventPose + pose.type() );
+  publish( device );
+}
+
+void MidiMapping :: onOrientationData( Device *device, uint64_t timestamp, const Quaternion &rotation )
+{
+  unsigned int id = device->id();
+  table_.onOrientationData( device, timestamp, rotation );
+
+  // When nothing reads the buckets, test the thresholds on the
+  // quaternion rather than bucket every angle.
+  size_t edges;
+  if ( thresholdsOnly_ && !board_ )
+    edges = triggers_.update( id, quantiser_, rotation, (int64_t) timestamp );
+  else {
+    table_.sweep( id );
+    edges = triggers_.update( id, table_.roll( id ), table_.pitch( id ), table_.yaw( id ), (int64_t) timestamp );
+  }
+  dispatch( device, eventOrientation );
+
+  // Then the rules for each zone the device has entered.
+  for ( size_t i=0; i<edges; i++ ) {
+    const TriggerEdge &edge = triggers_.edges()[i];
+    if ( edge.zone ) dispatch( device, eventZone + zoneBase_[edge.index] + edge.to );
+  }
+  publish( device );
+}
+
+} // namespace sensor
@@ -0,0 +1,321 @@
+/**********************************************************************/
+/*! \file MidiMapping.h
+    \brief Gesture-to-MIDI rules read from a file.
+
+    dj, instrument and liveloop each wrote their mapping as nested ifs
+    in a DataCollector, with the controllers, notes and scalings baked
+    in.  A MidiMapping reads the same kind of mapping from a text file
+    (see Myo/mappings/) and compiles it, so the three programs are now
+    three files for one program, myomidi.
+
+    A file holds one statement per line; # starts a comment.
+
+    \verbatim
+    steps ROLL PITCH YAW           buckets for each angle (default 127 127 127)
+    var NAME INITIAL MIN MAX       an integer the rules can test and change
+    zones NAME AXIS BOUND... [hysteresis H] [debounce MS]
+                                   bands of an axis, divided at each BOUND
+    limit CHANNEL CONTROLLER [threshold N] [rate HZ]
+                                   send a controller only on a change of N or
+                                   more, at most HZ times a second
+    SUBJECT EVENT [when CONDITION...] : ACTION [, ACTION...]
+    \endverbatim
+
+    SUBJECT is the device whose events the rule handles: left, right
+    (by the arm it is synced to), any, or a device number.  The
+    subject start has no EVENT and runs once, from start().  EVENT is
+    orientation, pose POSE, zone NAME N, unlock, lock, pair, unpair,
+    connect or disconnect, where POSE is a name as in Pose::toString()
+    and zone NAME N is the device entering zone N (from 0) of NAME.
+
+    A rule fires when all of its conditions hold:
+
+    \verbatim
+    unlocked | locked              the device is (not) unlocked
+    pose POSE                      the device's last pose
+    AXIS OP N [hysteresis H] [debounce MS]
+                                   roll, pitch or yaw bucket; OP is < <= > >= = !=
+    NAME OP N                      a variable
+    zone NAME N                    the device is in zone N of NAME
+    edge                           only when the other conditions become true
+    group NAME                     not if this rule was the last in NAME to fire
+    quantize 1/N                   send on the next 1/N note of the grid (N 1, 2, 4, 8, 16 or 32)
+    \endverbatim
+
+    Pose, lock, axis and zone conditions may name another device first
+    ("right pose fist", "left pitch > 40").  Axis thresholds and zones
+    are evaluated by a TriggerEngine on each orientation event: a
+    threshold with hysteresis stays true until its axis moves H
+    buckets back past it, a device stays in a zone until it is H
+    buckets outside it, and a debounced threshold or zone set ignores
+    a change sooner than MS after its last.  When the rules read the
+    axes only through a few thresholds, with the default steps
+    (liveloop), each threshold is tested on the orientation by an
+    AngleQuantiser and the angles are never bucketed.
+
+    The actions run in order, after every rule for the event has been
+    tested, so a rule's actions never change whether another rule for
+    the same event fires:
+
+    \verbatim
+    cc CHANNEL CONTROLLER VALUE
+    note CHANNEL VALUE VELOCITY LENGTH   LENGTH in ms, 0 for the note-off at once, or hold
+    voice CHANNEL VALUE VELOCITY         one note at a time: retrigger when VALUE changes
+    release CHANNEL                      end the voice's note
+    program CHANNEL N
+    set NAME VALUE
+    add NAME N                           kept within the variable's MIN and MAX
+    unlock                               hold the device unlocked
+    \endverbatim
+
+    A VALUE is a number, an axis (optionally of another device) or a
+    variable, optionally mapped and then offset:
+
+    \verbatim
+    VALUE := TERM [range IN_LO IN_HI OUT_LO OUT_HI [curve linear|square|sqrt] | table [ N ... ]] [+ N | - N]
+    \endverbatim
+
+    A note's note-off is left with a MidiScheduler, so the mapping
+    goes on handling events while the note sounds.  Playing a note
+    again before its note-off ends the first one at once.
+
+    A quantized rule's actions still run when it fires, but the
+    messages they send are handed to the scheduler for the next point
+    of the grid set with setGrid(), from a MidiClock or a
+    MidiClockFollower, so a gesture late or early by the Bluetooth
+    link still sounds on the beat.  A note waiting for its grid point
+    is not played again until it has sounded.  Without a grid, or
+    while the clock is stopped, quantized rules send at once.
+
+    Controllers go out through a MidiOutCache, so a value the same as
+    the one last sent is dropped, and a limited controller's changes
+    are thinned out with its latest value still sent soon after.  With
+    setQueue() everything the mapping sends, note-offs included, goes
+    on through a MidiOutQueue.
+
+    Every message also passes a MidiNoteTracker, which knows the notes
+    sounding and which device played each.  A note-off for a note not
+    sounding is dropped, and when a device unpairs or disconnects, or
+    the mapping is destroyed, its notes still sounding are ended.
+
+    Compiling turns each rule into flat arrays of conditions and
+    actions, and each mapped value into a lookup table over its
+    buckets, so handling an event is an indexed walk over the rules
+    for (device, event type) with no strings, parsing or virtual calls.
+    Mapped values keep their fraction, in 16.16 fixed point.  A note
+    or a variable takes the value rounded; a controller takes it
+    clamped to 0-127 and sent as a MIDI 2.0 control change at 32 bits,
+    which a MIDI 1.0 port receives with the fraction cut off, as the
+    MIDI 2.0 translation rule has it.
+*/
+/**********************************************************************/
+
+#ifndef MIDIMAPPING_H
+#define MIDIMAPPING_H
+
+#include <functional>
+#include <istream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "RtMidi.h"
+#include "AsyncLog.h"
+#include "MidiNoteTracker.h"
+#include "MidiOutCache.h"
+#include "MidiScheduler.h"
+#include "AngleQuantiser.h"
+#include "DeviceState.h"
+#include "SensorSource.h"
+#include "StatusDisplay.h"
+#include "TriggerEngine.h"
+
+namespace sensor {
+
+class MidiMapping : public Listener
+{
+ public:
+  //! The time of the first grid point at or after \e time whose tick (24 a quarter note) is a multiple of \e ticks, or INT64_MAX for none.
+  typedef std::function<int64_t( unsigned int ticks, int64_t time )> Grid;
+
+  //! Play to \e out, which the caller opens and keeps open, timing note lengths with \e scheduler.
+  /*!
+      The scheduler sends note-offs to \e out itself, so drive it from
+      the thread that delivers the events (EventLoop::setScheduler()).
+  */
+  MidiMapping( RtMidiOut *out, MidiScheduler &scheduler );
+
+  //! The destructor sends the held controller values and ends every note still sounding.
+  /*!
+      Quantized messages may still be waiting in the scheduler and call
+      back into the mapping, so do not advance the scheduler after.
+  */
+  ~MidiMapping( void );
+
+  //! Read and compile the rules in \e file.  Throws std::runtime_error naming the line of a mistake.
+  void load( const std::string &file );
+
+  //! Read and compile rules from \e in, calling it \e name in errors.
+  void load( std::istream &in, const std::string &name );
+
+  //! Quantize rules to \e grid, such as MidiClock::timeOfNext() or MidiClockFollower::timeOfNext().
+  void setGrid( const Grid &grid ) { grid_ = grid; }
+
+  //! Log each rule that fires, by its line in the file, to \e log (0 for none).
+  void setLog( AsyncLog *log );
+
+  //! Run the start rules.
+  void start( void );
+
+  //! Publish each device's state to \e board after every event (0 for none).  Pair and connection messages then go to the board rather than std::cout.
+  void setStatusBoard( StatusBoard *board ) { board_ = board; }
+
+  //! Send through \e queue, which sends to the same output, so notes go ahead of controllers within its bandwidth (0 for straight to the output).
+  void setQueue( MidiOutQueue *queue ) { notes_.setQueue( queue ); output_.setQueue( queue ); }
+
+  //! The output stage the messages go through, for its counts and to clear() it when the receiver restarts.
+  MidiOutCache &getOutput( void ) { return output_; }
+
+  //! The notes sounding, for their counts and to end them all.
+  MidiNoteTracker &getNotes( void ) { return notes_; }
+
+  //! The state of every device, as the rules see it.  Its buckets are only kept up to date when the rules or a status board read them.
+  const DeviceStateTable &getDevices( void ) const { return table_; }
+
+  void onPair( Device *device, uint64_t timestamp );
+  void onUnpair( Device *device, uint64_t timestamp );
+  void onConnect( Device *device, uint64_t timestamp );
+  void onDisconnect( Device *device, uint64_t timestamp );
+  void onArmSync( Device *device, uint64_t timestamp, Arm arm, XDirection xDirection );
+  void onArmUnsync( Device *device, uint64_t timestamp );
+  void onUnlock( Device *device, uint64_t timestamp );
+  void onLock( Device *device, uint64_t timestamp );
+  void onPose( Device *device, uint64_t timestamp, Pose pose );
+  void onOrientationData( Device *device, uint64_t timestamp, const Quaternion &rotation );
+
+ private:
+  friend class MappingCompiler;
+
+  enum Event {
+    eventOrientation, eventUnlock, eventLock, eventPair, eventUnpair, eventConnect, eventDisconnect,
+    eventPose,                    // + Pose::Type, rest to doubleTap
+    eventZone = eventPose + 6,    // + zoneBase_[set] + zone
+    eventStart = 0xffff
+  };
+
+  // Subjects and the devices conditions and values refer to.
+  enum Role { roleSelf, roleLeft, roleRight, roleAny, roleDevice };  // roleDevice + id for a numbered device
+
+  enum Axis { axisRoll, axisPitch, axisYaw };
+
+  struct Value {
+    uint8_t kind;       // valueConstant, valueAxis or valueVariable
+    uint8_t index;      // the axis or variable
+    uint16_t role;
+    int32_t table;      // first entry in tables_ for the bucket or variable, or -1
+    int32_t offset;
+  };
+  enum { valueConstant, valueAxis, valueVariable };
+
+  struct Condition {
+    uint8_t kind;       // conditionUnlocked ... conditionZone
+    uint8_t op;         // opLess ... opNotEqual
+    uint16_t role;
+    uint16_t subject;   // pose type, axis, variable or zone set
+    int16_t threshold;  // or zone
+    int32_t trigger;    // the TriggerEngine threshold for an axis compared with < <= > >=, or -1
+  };
+  enum { conditionUnlocked, conditionLocked, conditionPose, conditionAxis, conditionVariable, conditionZone };
+  enum { opLess, opLessEqual, opGreater, opGreaterEqual, opEqual, opNotEqual };
+
+  struct Action {
+    uint8_t kind;       // actionControl ... actionUnlock
+    uint8_t channel;    // 0-15
+    uint8_t number;     // controller or program
+    uint8_t velocity;
+    int32_t length;     // note length in ms, or -1 to hold
+    uint16_t variable;
+    Value value;
+  };
+  enum { actionControl, actionNote, actionVoice, actionRelease, actionProgram, actionSet, actionAdd, actionUnlock };
+
+  struct Rule {
+    uint16_t role;
+    uint16_t event;
+    uint32_t conditions, conditionsEnd;  // ranges in conditions_ and actions_
+    uint32_t actions, actionsEnd;
+    uint32_t line;      // in the file, for the log
+    int8_t edge;        // bit in DeviceStateTable::latches() remembering whether the conditions held, or -1
+    int16_t group;      // or -1
+    uint8_t quantize;   // grid in ticks, or 0
+  };
+
+  struct Variable {
+    int value, minimum, maximum;
+  };
+
+  RtMidiOut *out_;
+  MidiScheduler &scheduler_;
+  MidiNoteTracker notes_;
+  MidiOutCache output_;
+  Grid grid_;
+  AsyncLog *log_;
+  AsyncLog::Format firedFormat_, quantizedFormat_;
+  StatusBoard *board_;
+  std::vector<uint8_t> connected_;  // per device, for the board
+  DeviceStateTable table_;
+  TriggerEngine triggers_;
+
+  // The rules read the orientation only through thresholds, at the
+  // default steps, so an orientation event is tested by quantiser_
+  // and the table's buckets are left stale unless there is a board.
+  typedef AngleQuantiser<127, 127, 127> Quantiser;
+  Quantiser quantiser_;
+  bool thresholdsOnly_;
+  std::vector<uint16_t> zoneBase_;  // each zone set's first event after eventZone
+  unsigned int events_;             // event types, with the zones
+
+  std::vector<Rule> rules_;
+  std::vector<Condition> conditions_;
+  std::vector<Action> actions_;
+  std::vector<int32_t> tables_;      // 16.16 fixed point
+  std::vector<Variable> variables_;
+  unsigned int groups_;
+
+  // The rules for each (device, event): rules_[ruleList_[i]] for i
+  // from dispatch_[id * events_ + event] up to the next entry.
+  // Rebuilt when a device appears or changes arm.
+  std::vector<uint32_t> dispatch_;
+  std::vector<uint16_t> ruleList_;
+  std::vector<uint16_t> startRules_;
+  std::vector<uint16_t> fired_;
+  unsigned int devices_;     // devices dispatch_ covers
+  unsigned int left_, right_;
+  unsigned int playing_;     // the device whose actions are running, as the notes' owner
+
+  std::vector<int16_t> groupLast_;  // last rule fired per device and group
+  int voices_[16];                  // note sounding per channel, or -1
+  MidiScheduler::Handle noteOffs_[16][128];  // pending note-off per channel and note, or 0
+  int64_t noteOns_[16][128];        // grid point of a quantized note-on per channel and note, or 0
+
+  void rebuild( unsigned int devices );
+  void publish( Device *device );
+  void endNotes( Device *device );
+  void dispatch( Device *device, unsigned int event );
+  void fire( const uint16_t *rules, size_t count, Device *device );
+  bool holds( unsigned int index, unsigned int self );
+  bool test( const Condition &condition, unsigned int self );
+  int bucket( unsigned int id, unsigned int axis ) const;
+  bool evaluate( const Value &value, unsigned int self, int64_t &result ) const;
+  int64_t gridPoint( unsigned int ticks ) const;
+  void perform( const Action &action, Device *device, int64_t due );
+  void endNote( unsigned int channel, int note, int64_t due );
+  unsigned int resolve( unsigned int role, unsigned int self ) const;
+  void control( int64_t due, unsigned int channel, unsigned int number, int64_t value );
+  void send( int64_t due, unsigned char status, int data1, int data2 );
+  void send( int64_t due, unsigned char status, int data1 );
+  static bool compare( int value, unsigned int op, int threshold );
+};
+
+} // namespace sensor
+
+#endif
@@ -0,0 +1,126 @@
+/**********************************************************************/
+/*! \file MyoHubSource.cpp
+    \brief Armband events from Myo Connect, through the Myo SDK.
+*/
+/**********************************************************************/
+
+#include "MyoHubSource.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace sensor {
+
+void MyoHubSource::MyoDevice :: unlock( UnlockType type )
+{
+  myo_->unlock( type == unlockHold ? myo::Myo::unlockHold : myo::Myo::unlockTimed );
+}
+
+void MyoHubSource::MyoDevice :: lock( void )
+{
+  myo_->lock();
+}
+
+void MyoHubSource::MyoDevice :: vibrate( VibrationType type )
+{
+  static const myo::Myo::VibrationType types[] = { myo::Myo::vibrationShort, myo::Myo::vibrationMedium, myo::Myo::vibrationLong };
+  myo_->vibrate( types[type] );
+}
+
+void MyoHubSource::MyoDevice :: notifyUserAction( void )
+{
+  myo_->notifyUserAction();
+}
+
+MyoHubSource :: MyoHubSource( const std::string &applicationIdentifier )
+  : hub_( applicationIdentifier )
+{
+  hub_.addListener( this );
+}
+
+MyoHubSource :: ~MyoHubSource( void )
+{
+  hub_.removeListener( this );
+  for ( size_t i=0; i<devices_.size(); i++ )
+    delete devices_[i];
+}
+
+bool MyoHubSource :: run( unsigned int milliseconds )
+{
+  hub_.run( milliseconds );
+  return true;
+}
+
+// Hub events are only delivered inside waitForEvents().
+bool MyoHubSource :: dispatchDue( int64_t /*now*/, int64_t &next )
+{
+  next = std::numeric_limits<int64_t>::max();
+  return true;
+}
+
+void MyoHubSource :: waitForEvents( int64_t deadline )
+{
+  // runOnce() returns after the first event.  Its timeout is in
+  // whole milliseconds, so round up rather than wake early, and wake
+  // at least once a second when nothing else is scheduled.
+  int64_t remaining = deadline - steadyMicroseconds();
+  int64_t milliseconds = std::min( (int64_t) 1000, std::max( (int64_t) 1, ( remaining + 999 ) / 1000 ) );
+  hub_.runOnce( (unsigned int) milliseconds );
+}
+
+bool MyoHubSource :: waitForDevice( unsigned int milliseconds )
+{
+  return hub_.waitForMyo( milliseconds ) != 0;
+}
+
+Device *MyoHubSource :: device( myo::Myo *myo )
+{
+  // The SDK hands out one pointer per armband, so the wrapper for an
+  // armband is found by its pointer.
+  MyoDevice *&wrapper = wrappers_[myo];
+  if ( !wrapper ) {
+    wrapper = new MyoDevice( myo );
+    devices_.push_back( wrapper );
+  }
+  return wrapper;
+}
+
+void MyoHubSource :: onPair( myo::Myo *myo, uint64_t timestamp, myo::FirmwareVersion /*firmwareVersion*/ ) { pair( device( myo ), timestamp ); }
+void MyoHubSource :: onUnpair( myo::Myo *myo, uint64_t timestamp ) { unpair( device( myo ), timestamp ); }
+void MyoHubSource :: onConnect( myo::Myo *myo, uint64_t timestamp, myo::FirmwareVersion /*firmwareVersion*/ ) { connect( device( myo ), timestamp ); }
+void MyoHubSource :: onDisconnect( myo::Myo *myo, uint64_t timestamp ) { disconnect( device( myo ), timestamp ); }
+void MyoHubSource :: onArmUnsync( myo::Myo *myo, uint64_t timestamp ) { armUnsync( device( myo ), timestamp ); }
+void MyoHubSource :: onUnlock( myo::Myo *myo, uint64_t timestamp ) { unlocked( device( myo ), timestamp ); }
+void MyoHubSource :: onLock( myo::Myo *myo, uint64_t timestamp ) { locked( device( myo ), timestamp ); }
+void MyoHubSource :: onEmgData( myo::Myo *myo, uint64_t timestamp, const int8_t *samples ) { emg( device( myo ), timestamp, samples ); }
+
+void MyoHubSource :: onArmSync( myo::Myo *myo, uint64_t timestamp, myo::Arm arm, myo::XDirection xDirection )
+{
+  Arm sensorArm = arm == myo::armLeft ? armLeft : arm == myo::armRight ? armRight : armUnknown;
+  XDirection sensorDirection = xDirection == myo::xDirectionTowardWrist ? xDirectionTowardWrist :
+    xDirection == myo::xDirectionTowardElbow ? xDirectionTowardElbow : xDirectionUnknown;
+  armSync( device( myo ), timestamp, sensorArm, sensorDirection );
+}
+
+void MyoHubSource :: onPose( myo::Myo *myo, uint64_t timestamp, myo::Pose myoPose )
+{
+  // The SDK and sensor::Pose use the same pose numbers.
+  pose( device( myo ), timestamp, Pose( static_cast<Pose::Type>( myoPose.type() ) ) );
+}
+
+void MyoHubSource :: onOrientationData( myo::Myo *myo, uint64_t timestamp, const myo::Quaternion<float> &rotation )
+{
+  orientation( device( myo ), timestamp, Quaternion( rotation.x(), rotation.y(), rotation.z(), rotation.w() ) );
+}
+
+void MyoHubSource :: onAccelerometerData( myo::Myo *myo, uint64_t timestamp, const myo::Vector3<float> &accel )
+{
+  accelerometer( device( myo ), timestamp, Vector3( accel.x(), accel.y(), accel.z() ) );
+}
+
+void MyoHubSource :: onGyroscopeData( myo::Myo *myo, uint64_t timestamp, const myo::Vector3<float> &gyro )
+{
+  gyroscope( device( myo ), timestamp, Vector3( gyro.x(), gyro.y(), gyro.z() ) );
+}
+
+} // namespace sensor
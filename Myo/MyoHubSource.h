@@ -0,0 +1,71 @@
+/**********************************************************************/
+/*! \file MyoHubSource.h
+    \brief Armband events from Myo Connect, through the Myo SDK.
+
+    Only built when the Myo SDK is available (HAVE_MYO_SDK).
+*/
+/**********************************************************************/
+
+#ifndef MYOHUBSOURCE_H
+#define MYOHUBSOURCE_H
+
+#include <unordered_map>
+#include <myo/myo.hpp>
+#include "SensorSource.h"
+
+namespace sensor {
+
+class MyoHubSource : public Source, private myo::DeviceListener
+{
+ public:
+  //! Connect to Myo Connect.  Throws std::runtime_error (from the SDK) on failure.
+  MyoHubSource( const std::string &applicationIdentifier );
+  ~MyoHubSource( void );
+
+  bool run( unsigned int milliseconds );
+  bool waitForDevice( unsigned int milliseconds );
+  bool dispatchDue( int64_t now, int64_t &next );
+  bool waitsForEvents( void ) const { return true; }
+  void waitForEvents( int64_t deadline );
+
+ private:
+  // Wraps a myo::Myo so listeners can send it commands.
+  class MyoDevice : public Device
+  {
+   public:
+    MyoDevice( myo::Myo *myo ) : myo_( myo ) {}
+    myo::Myo *myo( void ) const { return myo_; }
+    void unlock( UnlockType type );
+    void lock( void );
+    void vibrate( VibrationType type );
+    void notifyUserAction( void );
+
+   private:
+    myo::Myo *myo_;
+  };
+
+  myo::Hub hub_;
+  std::vector<MyoDevice *> devices_;
+  std::unordered_map<myo::Myo *, MyoDevice *> wrappers_;
+
+  Device *device( myo::Myo *myo );
+
+  // myo::DeviceListener
+  void onPair( myo::Myo *myo, uint64_t timestamp, myo::FirmwareVersion firmwareVersion );
+  void onUnpair( myo::Myo *myo, uint64_t timestamp );
+  void onConnect( myo::Myo *myo, uint64_t timestamp, myo::FirmwareVersion firmwareVersion );
+  void onDisconnect( myo::Myo *myo, uint64_t timestamp );
+  void onArmSync( myo::Myo *myo, uint64_t timestamp, myo::Arm arm, myo::XDirection xDirection );
+  void onArmUnsync( myo::Myo *myo, uint64_t timestamp );
+  void onUnlock( myo::Myo *myo, uint64_t timestamp );
+  void onLock( myo::Myo *myo, uint64_t timestamp );
+  void onPose( myo::Myo *myo, uint64_t timestamp, myo::Pose pose );
+  void onOrientationData( myo::Myo *myo, uint64_t timestamp, const myo::Quaternion<float> &rotation );
+  void onAccelerometerData( myo::Myo *myo, uint64_t timestamp, const myo::Vector3<float> &accel );
+  void onGyroscopeData( myo::Myo *myo, uint64_t timestamp, const myo::Vector3<float> &gyro );
+  void onEmgData( myo::Myo *myo, uint64_t timestamp, const int8_t *emg );
+};
+
+} // namespace sensor
+
+#endif
@@ -0,0 +1,214 @@
+/**********************************************************************/
+/*! \file OrientationMath.cpp
+    \brief Quaternion to roll, pitch and yaw buckets for the gesture programs.
+*/
+/**********************************************************************/
+
+#define _USE_MATH_DEFINES
+#include "OrientationMath.h"
+
+#include <algorithm>
+#include <cmath>
+
+// The batch kernel is compiled once per instruction set and the
+// dynamic loader picks the best one the processor has (an ifunc).
+// ARM64 always has NEON, which the plain build already uses.
+#if defined(__x86_64__) && defined(__linux__) && defined(__GNUC__) && \
+    ( !defined(__clang__) || __clang_major__ >= 14 )
+  #define ORIENTATION_TARGET_CLONES __attribute__(( target_clones( "avx2", "default" ) ))
+#else
+  #define ORIENTATION_TARGET_CLONES
+#endif
+
+namespace sensor {
+
+static const float pi = 3.14159265f;
+static const float halfPi = 1.57079633f;
+
+// Abramowitz and Stegun 4.4.47: atan(a) on [-1, 1] to within 1e-5.
+static const float atanC1 = 0.9998660f;
+static const float atanC3 = -0.3302995f;
+static const float atanC5 = 0.1801410f;
+static const float atanC7 = -0.0851330f;
+static const float atanC9 = 0.0208351f;
+
+// Octant reduction with selects rather than branches, so the batch
+// loop vectorises.  atan2(0, 0) gives 0, as libm does; the gesture
+// programs' x arguments are 1 - 2(...), which is never -0, so the
+// libm results of +-pi for atan2(+-0, -0) cannot arise.
+static inline float fastAtan2( float y, float x )
+{
+  float ax = std::fabs( x ), ay = std::fabs( y );
+  float big = ax > ay ? ax : ay;
+  float small = ax > ay ? ay : ax;
+  float a = small / ( big > 1e-30f ? big : 1e-30f );
+  float s = a * a;
+  float r = a * ( atanC1 + s * ( atanC3 + s * ( atanC5 + s * ( atanC7 + s * atanC9 ) ) ) );
+  r = ay > ax ? halfPi - r : r;
+  r = x < 0.0f ? pi - r : r;
+  return std::copysign( r, y );
+}
+
+// The atan2() and asin() arguments, exactly as the gesture programs
+// compute them.
+struct EulerTerms {
+  float rollY, rollX, sinPitch, yawY, yawX;
+};
+
+static inline EulerTerms eulerTerms( float x, float y, float z, float w )
+{
+  EulerTerms t;
+  t.rollY = 2.0f * ( w * x + y * z );
+  t.rollX = 1.0f - 2.0f * ( x * x + y * y );
+  t.sinPitch = std::max( -1.0f, std::min( 1.0f, 2.0f * ( w * y - z * x ) ) );
+  t.yawY = 2.0f * ( w * z + x * y );
+  t.yawX = 1.0f - 2.0f * ( y * y + z * z );
+  return t;
+}
+
+// asin(t) as atan2(t, sqrt(1 - t^2)), with 1 - t^2 factored so there
+// is no cancellation near t = 1.
+static inline float fastAsin( float t )
+{
+  float c = ( 1.0f - t ) * ( 1.0f + t );
+  return fastAtan2( t, std::sqrt( c ) );
+}
+
+// The fast angle can be trusted unless it is within its error (plus
+// the rounding of the two bucket computations) of a boundary.
+static AngleBucketer::Scale bucketScale( float offset, double range, int steps )
+{
+  AngleBucketer::Scale b;
+  b.offset = offset;
+  b.range = range;
+  b.steps = steps;
+  b.scale = static_cast<float>( steps / range );
+  b.inverseGuard = 1.0f / ( ( maxEulerError + 1e-6f ) * b.scale + 2e-5f );
+  return b;
+}
+
+// Returns the bucket, and in \e margin how far inside it the angle
+// lies as a multiple of the guard; below 1 the bucket cannot be
+// trusted.  The angle is never below -pi - maxEulerError, so a
+// negative value truncates to bucket 0 with a negative margin.
+static inline int fastBucket( float angle, const AngleBucketer::Scale &b, float &margin )
+{
+  float v = ( angle + b.offset ) * b.scale;
+  int bucket = static_cast<int>( v );
+  float fraction = v - bucket;
+  float distance = fraction < 1.0f - fraction ? fraction : 1.0f - fraction;
+  float m = distance * b.inverseGuard;
+  margin = m < margin ? m : margin;
+  return bucket;
+}
+
+// Bucket the libm angle in the programs' own mixed float and double
+// arithmetic.
+static inline int exactBucket( float angle, const AngleBucketer::Scale &b )
+{
+  return static_cast<int>( ( angle + b.offset ) / b.range * b.steps );
+}
+
+EulerAngles eulerAngles( const Quaternion &q )
+{
+  EulerTerms t = eulerTerms( q.x(), q.y(), q.z(), q.w() );
+  EulerAngles a;
+  a.roll = std::atan2( t.rollY, t.rollX );
+  a.pitch = std::asin( t.sinPitch );
+  a.yaw = std::atan2( t.yawY, t.yawX );
+  return a;
+}
+
+EulerAngles fastEulerAngles( const Quaternion &q )
+{
+  EulerTerms t = eulerTerms( q.x(), q.y(), q.z(), q.w() );
+  EulerAngles a;
+  a.roll = fastAtan2( t.rollY, t.rollX );
+  a.pitch = fastAsin( t.sinPitch );
+  a.yaw = fastAtan2( t.yawY, t.yawX );
+  return a;
+}
+
+AngleBucketer :: AngleBucketer( AngleSteps steps )
+  : roll_( bucketScale( (float) M_PI, M_PI * 2.0f, steps.roll ) ),
+    pitch_( bucketScale( (float) M_PI / 2.0f, M_PI, steps.pitch ) ),
+    yaw_( bucketScale( (float) M_PI, M_PI * 2.0f, steps.yaw ) )
+{
+}
+
+AngleBuckets AngleBucketer :: exactBuckets( const Quaternion &q ) const
+{
+  EulerAngles a = eulerAngles( q );
+  AngleBuckets b;
+  b.roll = exactBucket( a.roll, roll_ );
+  b.pitch = exactBucket( a.pitch, pitch_ );
+  b.yaw = exactBucket( a.yaw, yaw_ );
+  return b;
+}
+
+AngleBuckets AngleBucketer :: buckets( const Quaternion &q ) const
+{
+  EulerAngles a = fastEulerAngles( q );
+  float margin = 1.0f;
+  AngleBuckets b;
+  b.roll = fastBucket( a.roll, roll_, margin );
+  b.pitch = fastBucket( a.pitch, pitch_, margin );
+  b.yaw = fastBucket( a.yaw, yaw_, margin );
+  return margin >= 1.0f ? b : exactBuckets( q );
+}
+
+// One block of the batch: every quaternion through the fast path,
+// noting the ones to redo with libm.  Kept free of calls and branches
+// so the compiler vectorises it.
+ORIENTATION_TARGET_CLONES
+static void fastBlock( const float *x, const float *y, const float *z, const float *w, size_t count,
+                       AngleBucketer::Scale rollScale, AngleBucketer::Scale pitchScale, AngleBucketer::Scale yawScale,
+                       int *__restrict roll, int *__restrict pitch, int *__restrict yaw, int *__restrict redo )
+{
+  for ( size_t i=0; i<count; i++ ) {
+    EulerTerms t = eulerTerms( x[i], y[i], z[i], w[i] );
+    float margin = 1.0f;
+    roll[i] = fastBucket( fastAtan2( t.rollY, t.rollX ), rollScale, margin );
+    pitch[i] = fastBucket( fastAsin( t.sinPitch ), pitchScale, margin );
+    yaw[i] = fastBucket( fastAtan2( t.yawY, t.yawX ), yawScale, margin );
+    redo[i] = margin < 1.0f;
+  }
+}
+
+void AngleBucketer :: buckets( const float *x, const float *y, const float *z, const float *w, size_t count,
+                               int *roll, int *pitch, int *yaw ) const
+{
+  static const size_t blockSize = 256;
+  int redo[blockSize];
+
+  for ( size_t start=0; start<count; start+=blockSize ) {
+    size_t n = std::min( blockSize, count - start );
+    fastBlock( x + start, y + start, z + start, w + start, n, roll_, pitch_, yaw_,
+               roll + start, pitch + start, yaw + start, redo );
+    for ( size_t i=0; i<n; i++ ) {
+      if ( !redo[i] ) continue;
+      size_t j = start + i;
+      AngleBuckets b = exactBuckets( Quaternion( x[j], y[j], z[j], w[j] ) );
+      roll[j] = b.roll;
+      pitch[j] = b.pitch;
+      yaw[j] = b.yaw;
+    }
+  }
+}
+
+const char *angleBucketKernel( void )
+{
+#if defined(__x86_64__)
+  #if defined(__linux__) && defined(__GNUC__) && ( !defined(__clang__) || __clang_major__ >= 14 )
+  __builtin_cpu_init();
+  if ( __builtin_cpu_supports( "avx2" ) ) return "avx2";
+  #endif
+  return "sse2";
+#elif defined(__aarch64__)
+  return "neon";
+#else
+  return "scalar";
+#endif
+}
+
+} // namespace sensor
@@ -0,0 +1,106 @@
+/**********************************************************************/
+/*! \file OrientationMath.h
+    \brief Quaternion to roll, pitch and yaw buckets for the gesture programs.
+
+    The gesture programs turn every orientation event into roll, pitch
+    and yaw with atan2(), asin() and atan2(), then scale each angle to
+    a small integer range ("buckets", 0 to 127 or 0 to 8).  The
+    functions here produce exactly the same buckets, faster:
+
+    - fastEulerAngles() uses a polynomial arctangent (all three angles
+      are arctangents; asin(t) is atan2(t, sqrt(1 - t^2))), with no
+      branches, and is within maxEulerError of the libm angles;
+    - AngleBucketer::buckets() buckets the fast angles, and falls back
+      to libm for the rare angle that lies within that error of a
+      bucket boundary, so its result always equals exactBuckets();
+    - the batch AngleBucketer::buckets() converts many quaternions stored as
+      separate x, y, z and w arrays at once, with a kernel chosen at
+      run time for the processor (AVX2 or SSE2 on x86-64, NEON on
+      ARM64).
+
+    See benchmarks/orientationbench for the speed and a check of every
+    path against libm.
+*/
+/**********************************************************************/
+
+#ifndef ORIENTATIONMATH_H
+#define ORIENTATIONMATH_H
+
+#include <stddef.h>
+#include "SensorSource.h"
+
+namespace sensor {
+
+//! Roll, pitch and yaw in radians, in the convention of the gesture programs.
+struct EulerAngles {
+  float roll;   //!< -pi to pi
+  float pitch;  //!< -pi/2 to pi/2
+  float yaw;    //!< -pi to pi
+};
+
+//! The largest difference, in radians, between fastEulerAngles() and eulerAngles().
+const float maxEulerError = 1.5e-5f;
+
+//! Angles computed with libm, as the gesture programs always did.
+EulerAngles eulerAngles( const Quaternion &q );
+
+//! Angles from polynomial approximations, within maxEulerError of eulerAngles().
+EulerAngles fastEulerAngles( const Quaternion &q );
+
+//! The number of buckets each angle's range is scaled to.
+/*!
+    A bucket is computed as in the gesture programs, for example
+    static_cast<int>((roll + (float)M_PI)/(M_PI * 2.0f) * roll), so an
+    angle at the very top of its range gives the value \e roll itself.
+*/
+struct AngleSteps {
+  int roll;
+  int pitch;
+  int yaw;
+};
+
+struct AngleBuckets {
+  int roll;
+  int pitch;
+  int yaw;
+};
+
+//! Converts quaternions to roll, pitch and yaw buckets.
+class AngleBucketer
+{
+ public:
+  AngleBucketer( AngleSteps steps );
+
+  //! Buckets of the libm angles: the reference.
+  AngleBuckets exactBuckets( const Quaternion &q ) const;
+
+  //! Buckets of the fast angles.  Always equal to exactBuckets().
+  AngleBuckets buckets( const Quaternion &q ) const;
+
+  //! Bucket \e count quaternions stored as separate component arrays.
+  /*!
+      The results are written to \e roll, \e pitch and \e yaw, which
+      must each hold \e count values, and equal exactBuckets() for
+      each quaternion.
+  */
+  void buckets( const float *x, const float *y, const float *z, const float *w, size_t count,
+                int *roll, int *pitch, int *yaw ) const;
+
+  struct Scale {
+    float offset;        // added to the angle, in float
+    double range;        // divided by, in double
+    int steps;
+    float scale;         // steps / range
+    float inverseGuard;  // 1 / the distance from a boundary, in buckets, inside which libm decides
+  };
+
+ private:
+  Scale roll_, pitch_, yaw_;
+};
+
+//! Returns the name of the batch kernel chosen for this processor ("avx2", "sse2", "neon" or "scalar").
+const char *angleBucketKernel( void );
+
+} // namespace sensor
+
+#endif
@@ -0,0 +1,773 @@
+/**********************************************************************/
+/*! \file SensorRecording.cpp
+    \brief Compact binary recordings of armband sessions.
+*/
+/**********************************************************************/
+
+#include "SensorRecording.h"
+#include "BitScan.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace sensor {
+
+static const char recordingMagic[8] = { 'S', 'N', 'S', 'R', 'E', 'C', '0', '1' };
+static const uint32_t recordingVersion = 1;
+
+static const size_t headerSize = 32;       // magic, version, devices, index offset, blocks, reserved
+static const size_t blockHeaderSize = 16;  // first timestamp, size, count, stream, device
+static const size_t indexEntrySize = 24;   // offset, then the block header
+
+static const unsigned int blockSamples = 1024;
+static const unsigned int riceGroup = 128;   // EMG samples per Rice parameter
+static const unsigned int riceEscape = 16;   // unary length that marks a raw 8-bit value
+static const unsigned int maxDevices = 256;
+
+// Streams are numbered so that events sort before data with the same
+// timestamp (a device pairs before its first sample).
+enum StreamType { STREAM_EVENTS, STREAM_ORIENTATION, STREAM_ACCEL, STREAM_GYRO, STREAM_EMG, N_STREAMS };
+
+enum EventType {
+  EVENT_PAIR, EVENT_UNPAIR, EVENT_CONNECT, EVENT_DISCONNECT, EVENT_ARM_SYNC,
+  EVENT_ARM_UNSYNC, EVENT_UNLOCK, EVENT_LOCK, EVENT_POSE
+};
+
+// The Myo's own accelerometer and gyroscope scales.
+static const float accelScale = 2048.0f;
+static const float gyroScale = 16.0f;
+
+//*********************************************************************//
+//  Encoding helpers
+//*********************************************************************//
+
+static void put16( unsigned char *p, uint32_t v ) { p[0] = v & 0xFF; p[1] = ( v >> 8 ) & 0xFF; }
+static void put32( unsigned char *p, uint32_t v ) { put16( p, v & 0xFFFF ); put16( p + 2, v >> 16 ); }
+static void put64( unsigned char *p, uint64_t v ) { put32( p, (uint32_t) v ); put32( p + 4, (uint32_t) ( v >> 32 ) ); }
+static uint32_t get16( const unsigned char *p ) { return p[0] | ( p[1] << 8 ); }
+static uint32_t get32( const unsigned char *p ) { return get16( p ) | ( get16( p + 2 ) << 16 ); }
+static uint64_t get64( const unsigned char *p ) { return get32( p ) | ( (uint64_t) get32( p + 4 ) << 32 ); }
+
+static uint64_t zigzag( int64_t v ) { return ( (uint64_t) v << 1 ) ^ (uint64_t) ( v >> 63 ); }
+static int64_t unzigzag( uint64_t v ) { return (int64_t) ( v >> 1 ) ^ -(int64_t) ( v & 1 ); }
+
+static void putVarint( std::vector<unsigned char> &out, uint64_t v )
+{
+  while ( v >= 0x80 ) {
+    out.push_back( (unsigned char) ( v | 0x80 ) );
+    v >>= 7;
+  }
+  out.push_back( (unsigned char) v );
+}
+
+// Append a column as its length followed by its bytes.
+static void putColumn( std::vector<unsigned char> &out, const std::vector<unsigned char> &column )
+{
+  putVarint( out, column.size() );
+  out.insert( out.end(), column.begin(), column.end() );
+}
+
+// Bits are written least significant first.
+class BitWriter
+{
+ public:
+  BitWriter( std::vector<unsigned char> &out ) : out_( out ), bits_( 0 ), count_( 0 ) {}
+
+  void put( uint32_t value, unsigned int n )
+  {
+    bits_ |= (uint64_t) value << count_;
+    count_ += n;
+    while ( count_ >= 8 ) {
+      out_.push_back( (unsigned char) bits_ );
+      bits_ >>= 8;
+      count_ -= 8;
+    }
+  }
+
+  void flush( void ) { if ( count_ ) out_.push_back( (unsigned char) bits_ ); bits_ = 0; count_ = 0; }
+
+ private:
+  std::vector<unsigned char> &out_;
+  uint64_t bits_;
+  unsigned int count_;
+};
+
+// Quaternion as the index of its largest component (made positive,
+// since q and -q are the same rotation) and the other three scaled
+// from [-1/sqrt(2), 1/sqrt(2)] to 10 bits.
+static uint32_t packQuaternion( const Quaternion &q )
+{
+  float c[4] = { q.x(), q.y(), q.z(), q.w() };
+  unsigned int largest = 0;
+  for ( unsigned int i=1; i<4; i++ )
+    if ( std::fabs( c[i] ) > std::fabs( c[largest] ) ) largest = i;
+  float scale = ( c[largest] < 0.0f ? -1.0f : 1.0f ) * 1.41421356f;
+
+  uint32_t word = largest << 30;
+  unsigned int shift = 20;
+  for ( unsigned int i=0; i<4; i++ ) {
+    if ( i == largest ) continue;
+    long n = std::lround( ( c[i] * scale + 1.0f ) * 511.5f );
+    word |= (uint32_t) std::min( 1023L, std::max( 0L, n ) ) << shift;
+    shift -= 10;
+  }
+  return word;
+}
+
+static Quaternion unpackQuaternion( uint32_t word )
+{
+  float c[4];
+  unsigned int largest = word >> 30;
+  unsigned int shift = 20;
+  float sum = 0.0f;
+  for ( unsigned int i=0; i<4; i++ ) {
+    if ( i == largest ) continue;
+    c[i] = ( ( ( word >> shift ) & 1023 ) / 511.5f - 1.0f ) * 0.70710678f;
+    sum += c[i] * c[i];
+    shift -= 10;
+  }
+  c[largest] = std::sqrt( std::max( 0.0f, 1.0f - sum ) );
+  return Quaternion( c[0], c[1], c[2], c[3] );
+}
+
+static int16_t quantise( float value, float scale )
+{
+  long n = std::lround( value * scale );
+  return (int16_t) std::min( 32767L, std::max( -32768L, n ) );
+}
+
+//*********************************************************************//
+//  RecordingWriter
+//*********************************************************************//
+
+struct RecordingWriter::StreamBuffer {
+  unsigned int device;
+  unsigned int stream;
+  std::vector<uint64_t> timestamps;
+  std::vector<uint32_t> words;           // orientation
+  std::vector<int16_t> values;           // accelerometer or gyroscope, 3 per sample
+  std::vector<int8_t> emg;               // emgChannels per sample
+  std::vector<unsigned char> types;      // events
+  std::vector<unsigned char> arguments;
+};
+
+RecordingWriter :: RecordingWriter( const std::string &fileName, bool recordImu )
+  : file_( fileName.c_str(), std::ios::binary | std::ios::trunc ), offset_( 0 ),
+    recordImu_( recordImu ), closed_( false ), fileIds_( -1 )
+{
+  if ( !file_ )
+    throw std::runtime_error( "RecordingWriter: cannot open " + fileName + " for writing" );
+
+  // The header is rewritten by close() once the index is known.  Until
+  // then its index offset is zero, which tells the reader to look for
+  // the blocks itself.
+  unsigned char header[headerSize] = { 0 };
+  memcpy( header, recordingMagic, sizeof( recordingMagic ) );
+  put32( header + 8, recordingVersion );
+  write( header, sizeof( header ) );
+  file_.flush();
+}
+
+RecordingWriter :: ~RecordingWriter( void )
+{
+  try {
+    close();
+  }
+  catch ( std::exception & ) {
+  }
+  for ( size_t i=0; i<buffers_.size(); i++ )
+    delete buffers_[i];
+}
+
+bool RecordingWriter :: isRecording( const std::string &fileName )
+{
+  char magic[sizeof( recordingMagic )];
+  std::ifstream file( fileName.c_str(), std::ios::binary );
+  return file.read( magic, sizeof( magic ) ) && memcmp( magic, recordingMagic, sizeof( magic ) ) == 0;
+}
+
+void RecordingWriter :: write( const unsigned char *data, size_t size )
+{
+  file_.write( reinterpret_cast<const char *>( data ), size );
+  offset_ += size;
+}
+
+RecordingWriter::StreamBuffer &RecordingWriter :: buffer( Device *device, unsigned int stream, uint64_t timestamp )
+{
+  int &fileId = fileIds_[device];
+  if ( fileId < 0 ) {
+    if ( devices_.size() == maxDevices )
+      throw std::runtime_error( "RecordingWriter: too many devices" );
+    fileId = static_cast<int>( devices_.size() );
+    devices_.push_back( device );
+    for ( unsigned int i=0; i<N_STREAMS; i++ ) {
+      StreamBuffer *buffer = new StreamBuffer;
+      buffer->device = static_cast<unsigned int>( fileId );
+      buffer->stream = i;
+      buffers_.push_back( buffer );
+    }
+  }
+
+  StreamBuffer &buffer = *buffers_[fileId * N_STREAMS + stream];
+  if ( buffer.timestamps.size() == blockSamples ) writeBlock( buffer );
+  buffer.timestamps.push_back( timestamp );
+  return buffer;
+}
+
+void RecordingWriter :: writeBlock( StreamBuffer &buffer )
+{
+  size_t count = buffer.timestamps.size();
+  if ( count == 0 ) return;
+
+  std::vector<unsigned char> &out = scratch_;
+  std::vector<unsigned char> column;
+  out.clear();
+
+  // Timestamps: the change in interval, which is zero at a steady rate.
+  int64_t lastDelta = 0;
+  for ( size_t i=1; i<count; i++ ) {
+    int64_t delta = (int64_t) ( buffer.timestamps[i] - buffer.timestamps[i - 1] );
+    putVarint( column, zigzag( delta - lastDelta ) );
+    lastDelta = delta;
+  }
+  putColumn( out, column );
+
+  switch ( buffer.stream ) {
+  case STREAM_ORIENTATION:
+    column.resize( 4 * count );
+    for ( size_t i=0; i<count; i++ ) put32( &column[4 * i], buffer.words[i] );
+    putColumn( out, column );
+    break;
+
+  case STREAM_ACCEL:
+  case STREAM_GYRO:
+    for ( unsigned int axis=0; axis<3; axis++ ) {
+      column.clear();
+      int last = 0;
+      for ( size_t i=0; i<count; i++ ) {
+        int value = buffer.values[3 * i + axis];
+        putVarint( column, zigzag( value - last ) );
+        last = value;
+      }
+      putColumn( out, column );
+    }
+    break;
+
+  case STREAM_EMG:
+    for ( unsigned int channel=0; channel<emgChannels; channel++ ) {
+      column.clear();
+      BitWriter bits( column );
+      for ( size_t group=0; group<count; group+=riceGroup ) {
+        size_t end = std::min( count, group + riceGroup );
+
+        // Pick the Rice parameter that codes this group in the fewest bits.
+        unsigned int bestK = 0;
+        size_t bestBits = ~(size_t) 0;
+        for ( unsigned int k=0; k<8; k++ ) {
+          size_t nBits = 0;
+          for ( size_t i=group; i<end; i++ ) {
+            uint32_t q = (uint32_t) zigzag( buffer.emg[i * emgChannels + channel] ) >> k;
+            nBits += q < riceEscape ? q + 1 + k : riceEscape + 8;
+          }
+          if ( nBits < bestBits ) { bestBits = nBits; bestK = k; }
+        }
+
+        bits.put( bestK, 3 );
+        for ( size_t i=group; i<end; i++ ) {
+          uint32_t z = (uint32_t) zigzag( buffer.emg[i * emgChannels + channel] );
+          uint32_t q = z >> bestK;
+          if ( q < riceEscape ) {
+            bits.put( ( 1u << q ) - 1, q + 1 );
+            bits.put( z & ( ( 1u << bestK ) - 1 ), bestK );
+          }
+          else {
+            bits.put( ( 1u << riceEscape ) - 1, riceEscape );
+            bits.put( z, 8 );
+          }
+        }
+      }
+      bits.flush();
+      putColumn( out, column );
+    }
+    break;
+
+  case STREAM_EVENTS:
+    putColumn( out, buffer.types );
+    putColumn( out, buffer.arguments );
+    break;
+  }
+
+  // Each block starts with its index entry (less the offset), so a
+  // recording that was never closed can still be read.
+  unsigned char entry[indexEntrySize];
+  put64( entry, offset_ + blockHeaderSize );
+  put64( entry + 8, buffer.timestamps[0] );
+  put32( entry + 16, static_cast<uint32_t>( out.size() ) );
+  put16( entry + 20, static_cast<uint32_t>( count ) );
+  entry[22] = static_cast<unsigned char>( buffer.stream );
+  entry[23] = static_cast<unsigned char>( buffer.device );
+  index_.insert( index_.end(), entry, entry + sizeof( entry ) );
+
+  write( entry + 8, blockHeaderSize );
+  write( &out[0], out.size() );
+  file_.flush();
+  buffer.timestamps.clear();
+  buffer.words.clear();
+  buffer.values.clear();
+  buffer.emg.clear();
+  buffer.types.clear();
+  buffer.arguments.clear();
+}
+
+void RecordingWriter :: close( void )
+{
+  if ( closed_ ) return;
+  closed_ = true;
+
+  for ( size_t i=0; i<buffers_.size(); i++ )
+    writeBlock( *buffers_[i] );
+
+  uint64_t indexOffset = offset_;
+  if ( !index_.empty() ) write( &index_[0], index_.size() );
+
+  unsigned char header[headerSize] = { 0 };
+  memcpy( header, recordingMagic, sizeof( recordingMagic ) );
+  put32( header + 8, recordingVersion );
+  put32( header + 12, static_cast<uint32_t>( devices_.size() ) );
+  put64( header + 16, indexOffset );
+  put32( header + 24, static_cast<uint32_t>( index_.size() / indexEntrySize ) );
+  file_.seekp( 0 );
+  file_.write( reinterpret_cast<const char *>( header ), sizeof( header ) );
+  file_.close();
+  if ( file_.fail() )
+    throw std::runtime_error( "RecordingWriter: error writing the recording" );
+}
+
+void RecordingWriter :: event( Device *device, uint64_t timestamp, unsigned char type, unsigned char argument )
+{
+  if ( closed_ ) return;
+  StreamBuffer &events = buffer( device, STREAM_EVENTS, timestamp );
+  events.types.push_back( type );
+  events.arguments.push_back( argument );
+}
+
+void RecordingWriter :: onPair( Device *device, uint64_t timestamp ) { event( device, timestamp, EVENT_PAIR, 0 ); }
+void RecordingWriter :: onUnpair( Device *device, uint64_t timestamp ) { event( device, timestamp, EVENT_UNPAIR, 0 ); }
+void RecordingWriter :: onConnect( Device *device, uint64_t timestamp ) { event( device, timestamp, EVENT_CONNECT, 0 ); }
+void RecordingWriter :: onDisconnect( Device *device, uint64_t timestamp ) { event( device, timestamp, EVENT_DISCONNECT, 0 ); }
+void RecordingWriter :: onArmUnsync( Device *device, uint64_t timestamp ) { event( device, timestamp, EVENT_ARM_UNSYNC, 0 ); }
+void RecordingWriter :: onUnlock( Device *device, uint64_t timestamp ) { event( device, timestamp, EVENT_UNLOCK, 0 ); }
+void RecordingWriter :: onLock( Device *device, uint64_t timestamp ) { event( device, timestamp, EVENT_LOCK, 0 ); }
+
+void RecordingWriter :: onArmSync( Device *device, uint64_t timestamp, Arm arm, XDirection xDirection )
+{
+  event( device, timestamp, EVENT_ARM_SYNC, static_cast<unsigned char>( arm | ( xDirection << 4 ) ) );
+}
+
+void RecordingWriter :: onPose( Device *device, uint64_t timestamp, Pose pose )
+{
+  event( device, timestamp, EVENT_POSE, pose == Pose::unknown ? 0xFF : static_cast<unsigned char>( pose.type() ) );
+}
+
+void RecordingWriter :: onOrientationData( Device *device, uint64_t timestamp, const Quaternion &rotation )
+{
+  if ( closed_ ) return;
+  buffer( device, STREAM_ORIENTATION, timestamp ).words.push_back( packQuaternion( rotation ) );
+}
+
+void RecordingWriter :: onAccelerometerData( Device *device, uint64_t timestamp, const Vector3 &accel )
+{
+  if ( closed_ || !recordImu_ ) return;
+  std::vector<int16_t> &values = buffer( device, STREAM_ACCEL, timestamp ).values;
+  values.push_back( quantise( accel.x(), accelScale ) );
+  values.push_back( quantise( accel.y(), accelScale ) );
+  values.push_back( quantise( accel.z(), accelScale ) );
+}
+
+void RecordingWriter :: onGyroscopeData( Device *device, uint64_t timestamp, const Vector3 &gyro )
+{
+  if ( closed_ || !recordImu_ ) return;
+  std::vector<int16_t> &values = buffer( device, STREAM_GYRO, timestamp ).values;
+  values.push_back( quantise( gyro.x(), gyroScale ) );
+  values.push_back( quantise( gyro.y(), gyroScale ) );
+  values.push_back( quantise( gyro.z(), gyroScale ) );
+}
+
+void RecordingWriter :: onEmgData( Device *device, uint64_t timestamp, const int8_t *emg )
+{
+  if ( closed_ ) return;
+  std::vector<int8_t> &samples = buffer( device, STREAM_EMG, timestamp ).emg;
+  samples.insert( samples.end(), emg, emg + emgChannels );
+}
+
+//*********************************************************************//
+//  RecordingSource
+//*********************************************************************//
+
+namespace {
+
+struct BlockInfo {
+  uint64_t offset;
+  uint64_t firstTimestamp;
+  uint32_t size;
+  uint32_t count;
+};
+
+// Reads the columns of one block.  Running off the end of the block
+// means the file is corrupt.
+class ColumnReader
+{
+ public:
+  ColumnReader( const unsigned char *data, size_t size ) : p_( data ), end_( data + size ) {}
+
+  uint64_t varint( void )
+  {
+    uint64_t v = 0;
+    for ( unsigned int shift=0; shift<64; shift+=7 ) {
+      if ( p_ == end_ ) corrupt();
+      unsigned char byte = *p_++;
+      v |= (uint64_t) ( byte & 0x7F ) << shift;
+      if ( !( byte & 0x80 ) ) return v;
+    }
+    corrupt();
+    return 0;
+  }
+
+  ColumnReader column( void )
+  {
+    uint64_t length = varint();
+    if ( length > (uint64_t) ( end_ - p_ ) ) corrupt();
+    ColumnReader column( p_, (size_t) length );
+    p_ += length;
+    return column;
+  }
+
+  const unsigned char *data( void ) const { return p_; }
+  size_t size( void ) const { return end_ - p_; }
+
+  static void corrupt( void ) { throw std::runtime_error( "RecordingSource: corrupt block" ); }
+
+ private:
+  const unsigned char *p_;
+  const unsigned char *end_;
+};
+
+// Bits are read least significant first.  Reading past the end gives
+// zeros, which at worst decodes garbage within the block.
+class BitReader
+{
+ public:
+  BitReader( const unsigned char *data, size_t size ) : p_( data ), end_( data + size ), bits_( 0 ), count_( 0 ) {}
+
+  uint32_t get( unsigned int n )
+  {
+    if ( count_ < n ) refill();
+    uint32_t v = (uint32_t) ( bits_ & ( ( (uint64_t) 1 << n ) - 1 ) );
+    skip( n );
+    return v;
+  }
+
+  // Count leading one bits, up to riceEscape.
+  unsigned int ones( void )
+  {
+    if ( count_ < riceEscape + 1 ) refill();
+    uint64_t zeros = ~bits_;
+    unsigned int n = zeros ? bitLowest( zeros ) : 64;
+    return std::min( n, riceEscape );
+  }
+
+  void skip( unsigned int n )
+  {
+    if ( count_ < n ) { bits_ = 0; count_ = 0; return; }
+    bits_ >>= n;
+    count_ -= n;
+  }
+
+ private:
+  const unsigned char *p_;
+  const unsigned char *end_;
+  uint64_t bits_;
+  unsigned int count_;
+
+  void refill( void )
+  {
+    while ( count_ <= 56 && p_ < end_ ) {
+      bits_ |= (uint64_t) *p_++ << count_;
+      count_ += 8;
+    }
+    if ( p_ == end_ && count_ < 32 ) count_ = 32;  // pad with zeros
+  }
+};
+
+} // namespace
+
+struct RecordingSource::Cursor {
+  unsigned int stream;
+  unsigned int device;
+  std::vector<BlockInfo> blocks;
+  size_t nextBlock;
+  size_t position;
+  std::vector<uint64_t> timestamps;
+  std::vector<uint32_t> words;
+  std::vector<int16_t> values;
+  std::vector<int8_t> emg;
+  std::vector<unsigned char> types;
+  std::vector<unsigned char> arguments;
+};
+
+RecordingSource :: RecordingSource( const std::string &fileName, double speed )
+  : PacedSource( speed ), data_( 0 ), size_( 0 ), eventCount_( 0 )
+{
+  int fd = open( fileName.c_str(), O_RDONLY );
+  if ( fd < 0 )
+    throw std::runtime_error( "RecordingSource: cannot open " + fileName );
+  struct stat info;
+  if ( fstat( fd, &info ) < 0 || info.st_size < (off_t) headerSize ) {
+    ::close( fd );
+    throw std::runtime_error( "RecordingSource: " + fileName + " is not a recording" );
+  }
+  size_ = (size_t) info.st_size;
+  void *map = mmap( 0, size_, PROT_READ, MAP_PRIVATE, fd, 0 );
+  ::close( fd );
+  if ( map == MAP_FAILED )
+    throw std::runtime_error( "RecordingSource: cannot map " + fileName );
+  data_ = static_cast<const unsigned char *>( map );
+
+  if ( memcmp( data_, recordingMagic, sizeof( recordingMagic ) ) != 0 || get32( data_ + 8 ) != recordingVersion ) {
+    munmap( const_cast<unsigned char *>( data_ ), size_ );
+    throw std::runtime_error( "RecordingSource: " + fileName + " is not a recording" );
+  }
+
+  // Use the index, or when the recording was never closed, find the
+  // complete blocks by their headers.
+  uint64_t indexOffset = get64( data_ + 16 );
+  std::vector<const unsigned char *> entries;   // the block header fields of each block
+  std::vector<uint64_t> offsets;
+  unsigned int nDevices = get32( data_ + 12 );
+  if ( indexOffset != 0 ) {
+    uint32_t nBlocks = get32( data_ + 24 );
+    if ( indexOffset > size_ || nBlocks > ( size_ - indexOffset ) / indexEntrySize ) indexOffset = size_ + 1;
+    for ( uint32_t i=0; indexOffset <= size_ && i<nBlocks; i++ ) {
+      const unsigned char *entry = data_ + indexOffset + i * indexEntrySize;
+      offsets.push_back( get64( entry ) );
+      entries.push_back( entry + 8 );
+    }
+  }
+  else {
+    nDevices = 0;
+    uint64_t offset = headerSize;
+    while ( size_ - offset >= blockHeaderSize ) {
+      const unsigned char *entry = data_ + offset;
+      offset += blockHeaderSize;
+      if ( get32( entry + 8 ) > size_ - offset ) break;
+      offsets.push_back( offset );
+      entries.push_back( entry );
+      nDevices = std::max( nDevices, entry[15] + 1u );
+      offset += get32( entry + 8 );
+    }
+    indexOffset = size_;
+  }
+
+  // Check every block before allocating anything for them.
+  bool valid = indexOffset <= size_ && nDevices <= maxDevices;
+  for ( size_t i=0; valid && i<entries.size(); i++ ) {
+    const unsigned char *entry = entries[i];
+    valid = entry[14] < N_STREAMS && entry[15] < nDevices && offsets[i] <= indexOffset &&
+      get32( entry + 8 ) <= indexOffset - offsets[i] && get16( entry + 12 ) != 0;
+  }
+  if ( !valid ) {
+    munmap( const_cast<unsigned char *>( data_ ), size_ );
+    throw std::runtime_error( "RecordingSource: " + fileName + " has a corrupt index" );
+  }
+
+  for ( unsigned int i=0; i<nDevices; i++ )
+    devices_.push_back( new Device );
+  for ( unsigned int i=0; i<nDevices * N_STREAMS; i++ ) {
+    Cursor *cursor = new Cursor;
+    cursor->device = i / N_STREAMS;
+    cursor->stream = i % N_STREAMS;
+    cursor->nextBlock = 0;
+    cursor->position = 0;
+    cursors_.push_back( cursor );
+  }
+
+  // Hand each block to its stream.  The blocks of a stream are
+  // written in time order.
+  for ( size_t i=0; i<entries.size(); i++ ) {
+    const unsigned char *entry = entries[i];
+    BlockInfo block;
+    block.offset = offsets[i];
+    block.firstTimestamp = get64( entry );
+    block.size = get32( entry + 8 );
+    block.count = get16( entry + 12 );
+    cursors_[entry[15] * N_STREAMS + entry[14]]->blocks.push_back( block );
+    eventCount_ += block.count;
+  }
+
+  try {
+    for ( unsigned int i=0; i<cursors_.size(); i++ )
+      if ( loadBlock( *cursors_[i] ) ) heap_.push( HeapEntry( cursors_[i]->timestamps[0], i ) );
+  }
+  catch ( ... ) {
+    release();
+    throw;
+  }
+}
+
+RecordingSource :: ~RecordingSource( void )
+{
+  release();
+}
+
+void RecordingSource :: release( void )
+{
+  for ( size_t i=0; i<cursors_.size(); i++ )
+    delete cursors_[i];
+  cursors_.clear();
+  for ( size_t i=0; i<devices_.size(); i++ )
+    delete devices_[i];
+  devices_.clear();
+  if ( data_ ) munmap( const_cast<unsigned char *>( data_ ), size_ );
+  data_ = 0;
+}
+
+bool RecordingSource :: loadBlock( Cursor &cursor )
+{
+  if ( cursor.nextBlock == cursor.blocks.size() ) return false;
+  const BlockInfo &block = cursor.blocks[cursor.nextBlock++];
+  size_t count = block.count;
+  ColumnReader reader( data_ + block.offset, block.size );
+  cursor.position = 0;
+
+  ColumnReader times = reader.column();
+  cursor.timestamps.resize( count );
+  cursor.timestamps[0] = block.firstTimestamp;
+  int64_t delta = 0;
+  for ( size_t i=1; i<count; i++ ) {
+    delta += unzigzag( times.varint() );
+    cursor.timestamps[i] = cursor.timestamps[i - 1] + delta;
+  }
+
+  switch ( cursor.stream ) {
+  case STREAM_ORIENTATION: {
+    ColumnReader words = reader.column();
+    if ( words.size() != 4 * count ) ColumnReader::corrupt();
+    cursor.words.resize( count );
+    for ( size_t i=0; i<count; i++ ) cursor.words[i] = get32( words.data() + 4 * i );
+    break;
+  }
+
+  case STREAM_ACCEL:
+  case STREAM_GYRO:
+    cursor.values.resize( 3 * count );
+    for ( unsigned int axis=0; axis<3; axis++ ) {
+      ColumnReader column = reader.column();
+      int64_t value = 0;
+      for ( size_t i=0; i<count; i++ ) {
+        value += unzigzag( column.varint() );
+        cursor.values[3 * i + axis] = (int16_t) value;
+      }
+    }
+    break;
+
+  case STREAM_EMG:
+    cursor.emg.resize( emgChannels * count );
+    for ( unsigned int channel=0; channel<emgChannels; channel++ ) {
+      ColumnReader column = reader.column();
+      BitReader bits( column.data(), column.size() );
+      unsigned int k = 0;
+      for ( size_t i=0; i<count; i++ ) {
+        if ( i % riceGroup == 0 ) k = bits.get( 3 );
+        uint32_t z;
+        unsigned int q = bits.ones();
+        if ( q == riceEscape ) {
+          bits.skip( riceEscape );
+          z = bits.get( 8 );
+        }
+        else {
+          bits.skip( q + 1 );
+          z = ( q << k ) | bits.get( k );
+        }
+        cursor.emg[i * emgChannels + channel] = (int8_t) unzigzag( z );
+      }
+    }
+    break;
+
+  case STREAM_EVENTS: {
+    ColumnReader types = reader.column();
+    ColumnReader arguments = reader.column();
+    if ( types.size() != count || arguments.size() != count ) ColumnReader::corrupt();
+    cursor.types.assign( types.data(), types.data() + count );
+    cursor.arguments.assign( arguments.data(), arguments.data() + count );
+    break;
+  }
+  }
+  return true;
+}
+
+bool RecordingSource :: nextEventTime( uint64_t &timestamp )
+{
+  if ( heap_.empty() ) return false;
+  timestamp = heap_.top().first;
+  return true;
+}
+
+void RecordingSource :: dispatchNext( void )
+{
+  unsigned int index = heap_.top().second;
+  heap_.pop();
+  Cursor &cursor = *cursors_[index];
+  size_t i = cursor.position;
+  uint64_t timestamp = cursor.timestamps[i];
+  Device *device = devices_[cursor.device];
+
+  switch ( cursor.stream ) {
+  case STREAM_ORIENTATION:
+    orientation( device, timestamp, unpackQuaternion( cursor.words[i] ) );
+    break;
+  case STREAM_ACCEL:
+    accelerometer( device, timestamp, Vector3( cursor.values[3 * i] / accelScale, cursor.values[3 * i + 1] / accelScale,
+                                               cursor.values[3 * i + 2] / accelScale ) );
+    break;
+  case STREAM_GYRO:
+    gyroscope( device, timestamp, Vector3( cursor.values[3 * i] / gyroScale, cursor.values[3 * i + 1] / gyroScale,
+                                           cursor.values[3 * i + 2] / gyroScale ) );
+    break;
+  case STREAM_EMG:
+    emg( device, timestamp, &cursor.emg[i * emgChannels] );
+    break;
+  case STREAM_EVENTS: {
+    unsigned char argument = cursor.arguments[i];
+    switch ( cursor.types[i] ) {
+    case EVENT_PAIR: pair( device, timestamp ); break;
+    case EVENT_UNPAIR: unpair( device, timestamp ); break;
+    case EVENT_CONNECT: connect( device, timestamp ); break;
+    case EVENT_DISCONNECT: disconnect( device, timestamp ); break;
+    case EVENT_ARM_SYNC:
+      armSync( device, timestamp, static_cast<Arm>( std::min( argument & 0x0F, (int) armUnknown ) ),
+               static_cast<XDirection>( std::min( argument >> 4, (int) xDirectionUnknown ) ) );
+      break;
+    case EVENT_ARM_UNSYNC: armUnsync( device, timestamp ); break;
+    case EVENT_UNLOCK: unlocked( device, timestamp ); break;
+    case EVENT_LOCK: locked( device, timestamp ); break;
+    case EVENT_POSE:
+      pose( device, timestamp, Pose( argument <= Pose::doubleTap ? static_cast<Pose::Type>( argument ) : Pose::unknown ) );
+      break;
+    }
+    break;
+  }
+  }
+
+  // Move on, decoding the next block when this one is used up.
+  if ( ++cursor.position < cursor.timestamps.size() || loadBlock( cursor ) )
+    heap_.push( HeapEntry( cursor.timestamps[cursor.position], index ) );
+}
+
+} // namespace sensor
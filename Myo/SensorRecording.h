@@ -0,0 +1,135 @@
+/**********************************************************************/
+/*! \file SensorRecording.h
+    \brief Compact binary recordings of armband sessions.
+
+    RecordingWriter stores every event it receives and RecordingSource
+    memory-maps the file and plays it back.  The format is columnar:
+    each device has one stream per kind of data (orientation,
+    accelerometer, gyroscope, EMG and a sparse stream of pair, arm,
+    lock and pose events), and each stream is cut into blocks of up to
+    1024 samples whose columns are stored one after another:
+
+    - timestamps: the first in the block index, then the change in the
+      sample interval as a zigzag varint (one byte at a steady rate);
+    - orientation: 32 bits per quaternion, "smallest three" (the index
+      of the largest component and the other three in 10 bits each,
+      within a quarter of a degree);
+    - accelerometer and gyroscope: the Myo's native 16-bit scales
+      (2048 per g, 16 per degree/s), delta coded as zigzag varints;
+    - EMG: one column per channel, Rice coded with the parameter chosen
+      for every 128 samples;
+    - events: a type byte and an argument byte each.
+
+    The file ends with an index of blocks, which the reader uses to
+    decode each stream a block at a time and merge the streams in
+    timestamp order.  Each block also starts with its own index entry,
+    so a recording that was never closed (the program was killed)
+    plays back up to its last complete block.  Integers are stored
+    little-endian.
+
+    An hour of two armbands (IMU at 50 Hz, EMG at 200 Hz) takes 11 to
+    15 MB, against over 100 MB as text; see benchmarks/recordingbench.
+*/
+/**********************************************************************/
+
+#ifndef SENSORRECORDING_H
+#define SENSORRECORDING_H
+
+#include <fstream>
+#include <queue>
+#include "SensorSource.h"
+
+namespace sensor {
+
+//! Writes every event it receives to a binary recording.
+class RecordingWriter : public Listener
+{
+ public:
+  //! Create \e fileName.  Throws std::runtime_error on failure.
+  /*!
+      Accelerometer and gyroscope data, which the gesture programs do
+      not use, are only stored if \e recordImu is true.
+  */
+  RecordingWriter( const std::string &fileName, bool recordImu = true );
+
+  //! Finishes the recording if close() was not called.
+  ~RecordingWriter( void );
+
+  //! Write the remaining blocks and the index.  Throws std::runtime_error on a write error.
+  void close( void );
+
+  //! Returns the size of the file so far.
+  uint64_t getBytesWritten( void ) const { return offset_; }
+
+  void onPair( Device *device, uint64_t timestamp );
+  void onUnpair( Device *device, uint64_t timestamp );
+  void onConnect( Device *device, uint64_t timestamp );
+  void onDisconnect( Device *device, uint64_t timestamp );
+  void onArmSync( Device *device, uint64_t timestamp, Arm arm, XDirection xDirection );
+  void onArmUnsync( Device *device, uint64_t timestamp );
+  void onUnlock( Device *device, uint64_t timestamp );
+  void onLock( Device *device, uint64_t timestamp );
+  void onPose( Device *device, uint64_t timestamp, Pose pose );
+  void onOrientationData( Device *device, uint64_t timestamp, const Quaternion &rotation );
+  void onAccelerometerData( Device *device, uint64_t timestamp, const Vector3 &accel );
+  void onGyroscopeData( Device *device, uint64_t timestamp, const Vector3 &gyro );
+  void onEmgData( Device *device, uint64_t timestamp, const int8_t *emg );
+
+  //! Returns true if \e fileName starts like a binary recording.
+  static bool isRecording( const std::string &fileName );
+
+ private:
+  struct StreamBuffer;
+
+  std::ofstream file_;
+  uint64_t offset_;
+  bool recordImu_;
+  bool closed_;
+  std::vector<Device *> devices_;
+  DeviceTable<int> fileIds_;          // index into devices_, or -1
+  std::vector<StreamBuffer *> buffers_;
+  std::vector<unsigned char> index_;
+  std::vector<unsigned char> scratch_;
+
+  StreamBuffer &buffer( Device *device, unsigned int stream, uint64_t timestamp );
+  void event( Device *device, uint64_t timestamp, unsigned char type, unsigned char argument );
+  void writeBlock( StreamBuffer &buffer );
+  void write( const unsigned char *data, size_t size );
+};
+
+//! Plays back a recording made by RecordingWriter.
+class RecordingSource : public PacedSource
+{
+ public:
+  //! Map \e fileName.  Throws std::runtime_error if it cannot be read or is not a valid recording.
+  RecordingSource( const std::string &fileName, double speed = 1.0 );
+  ~RecordingSource( void );
+
+  //! Returns the number of samples and events in the recording.
+  uint64_t getEventCount( void ) const { return eventCount_; }
+
+  //! Returns the number of devices in the recording.
+  unsigned int getDeviceCount( void ) const { return static_cast<unsigned int>( devices_.size() ); }
+
+ protected:
+  bool nextEventTime( uint64_t &timestamp );
+  void dispatchNext( void );
+
+ private:
+  struct Cursor;
+  typedef std::pair<uint64_t, unsigned int> HeapEntry;
+
+  const unsigned char *data_;
+  size_t size_;
+  uint64_t eventCount_;
+  std::vector<Device *> devices_;
+  std::vector<Cursor *> cursors_;
+  std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry> > heap_;
+
+  bool loadBlock( Cursor &cursor );
+  void release( void );
+};
+
+} // namespace sensor
+
+#endif
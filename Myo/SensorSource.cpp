@@ -0,0 +1,309 @@
+/**********************************************************************/
+/*! \file SensorSource.cpp
+    \brief Hardware-independent armband events for the Myo programs.
+*/
+/**********************************************************************/
+
+#include "SensorSource.h"
+#include "SensorRecording.h"
+#include "SyntheticSource.h"
+#include "TextReplaySource.h"
+#if defined(HAVE_MYO_SDK)
+  #include "MyoHubSource.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+namespace sensor {
+
+static const char *poseNames[] = { "rest", "fist", "waveIn", "waveOut", "fingersSpread", "doubleTap" };
+static const unsigned int nPoseNames = sizeof( poseNames ) / sizeof( poseNames[0] );
+
+std::string Pose :: toString( void ) const
+{
+  if ( type_ < nPoseNames ) return poseNames[type_];
+  return "unknown";
+}
+
+Pose Pose :: fromString( const std::string &name )
+{
+  for ( unsigned int i=0; i<nPoseNames; i++ )
+    if ( name == poseNames[i] ) return Pose( static_cast<Type>( i ) );
+  return Pose( unknown );
+}
+
+//*********************************************************************//
+//  Source
+//*********************************************************************//
+
+Source :: ~Source( void )
+{
+  for ( size_t i=0; i<adopted_.size(); i++ )
+    delete adopted_[i];
+}
+
+void Source :: addListener( Listener *listener )
+{
+  listeners_.push_back( listener );
+}
+
+void Source :: removeListener( Listener *listener )
+{
+  listeners_.erase( std::remove( listeners_.begin(), listeners_.end(), listener ), listeners_.end() );
+}
+
+void Source :: adoptListener( Listener *listener )
+{
+  adopted_.push_back( listener );
+  addListener( listener );
+}
+
+void Source :: pair( Device *device, uint64_t timestamp )
+{
+  registry_.add( device );
+  for ( size_t i=0; i<listeners_.size(); i++ ) listeners_[i]->onPair( device, timestamp );
+}
+
+void Source :: unpair( Device *device, uint64_t timestamp )
+{
+  registry_.add( device );
+  for ( size_t i=0; i<listeners_.size(); i++ ) listeners_[i]->onUnpair( device, timestamp );
+}
+
+void Source :: connect( Device *device, uint64_t timestamp )
+{
+  registry_.add( device );
+  for ( size_t i=0; i<listeners_.size(); i++ ) listeners_[i]->onConnect( device, timestamp );
+}
+
+void Source :: disconnect( Device *device, uint64_t timestamp )
+{
+  registry_.add( device );
+  for ( size_t i=0; i<listeners_.size(); i++ ) listeners_[i]->onDisconnect( device, timestamp );
+}
+
+void Source :: armSync( Device *device, uint64_t timestamp, Arm arm, XDirection xDirection )
+{
+  registry_.add( device );
+  for ( size_t i=0; i<listeners_.size(); i++ ) listeners_[i]->onArmSync( device, timestamp, arm, xDirection );
+}
+
+void Source :: armUnsync( Device *device, uint64_t timestamp )
+{
+  registry_.add( device );
+  for ( size_t i=0; i<listeners_.size(); i++ ) listeners_[i]->onArmUnsync( device, timestamp );
+}
+
+void Source :: unlocked( Device *device, uint64_t timestamp )
+{
+  registry_.add( device );
+  for ( size_t i=0; i<listeners_.size(); i++ ) listeners_[i]->onUnlock( device, timestamp );
+}
+
+void Source :: locked( Device *device, uint64_t timestamp )
+{
+  registry_.add( device );
+  for ( size_t i=0; i<listeners_.size(); i++ ) listeners_[i]->onLock( device, timestamp );
+}
+
+void Source :: pose( Device *device, uint64_t timestamp, Pose pose )
+{
+  registry_.add( device );
+  for ( size_t i=0; i<listeners_.size(); i++ ) listeners_[i]->onPose( device, timestamp, pose );
+}
+
+void Source :: orientation( Device *device, uint64_t timestamp, const Quaternion &rotation )
+{
+  registry_.add( device );
+  for ( size_t i=0; i<listeners_.size(); i++ ) listeners_[i]->onOrientationData( device, timestamp, rotation );
+}
+
+void Source :: accelerometer( Device *device, uint64_t timestamp, const Vector3 &accel )
+{
+  registry_.add( device );
+  for ( size_t i=0; i<listeners_.size(); i++ ) listeners_[i]->onAccelerometerData( device, timestamp, accel );
+}
+
+void Source :: gyroscope( Device *device, uint64_t timestamp, const Vector3 &gyro )
+{
+  registry_.add( device );
+  for ( size_t i=0; i<listeners_.size(); i++ ) listeners_[i]->onGyroscopeData( device, timestamp, gyro );
+}
+
+void Source :: emg( Device *device, uint64_t timestamp, const int8_t *samples )
+{
+  registry_.add( device );
+  for ( size_t i=0; i<listeners_.size(); i++ ) listeners_[i]->onEmgData( device, timestamp, samples );
+}
+
+bool Source :: dispatchDue( int64_t now, int64_t &next )
+{
+  next = now;
+  return run( 1 );
+}
+
+//*********************************************************************//
+//  PacedSource
+//*********************************************************************//
+
+typedef std::chrono::steady_clock Clock;
+
+int64_t steadyMicroseconds( void )
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>( Clock::now().time_since_epoch() ).count();
+}
+
+static void sleepUntil( int64_t wall )
+{
+  std::this_thread::sleep_until( Clock::time_point( std::chrono::microseconds( wall ) ) );
+}
+
+PacedSource :: PacedSource( double speed )
+  : speed_( speed ), started_( false ), now_( 0 ), origin_( 0 ), wallOrigin_( 0 )
+{
+}
+
+// Start the clock at the first event rather than at time zero, so a
+// recording made late in a session does not begin with a long
+// silence.  Returns false if there are no events at all.
+bool PacedSource :: start( void )
+{
+  uint64_t next;
+  if ( !nextEventTime( next ) ) return false;
+  now_ = origin_ = next;
+  wallOrigin_ = steadyMicroseconds();
+  started_ = true;
+  return true;
+}
+
+bool PacedSource :: run( unsigned int milliseconds )
+{
+  uint64_t next;
+  if ( !started_ && !start() ) return false;
+
+  uint64_t end = now_ + (uint64_t) milliseconds * 1000;
+  while ( nextEventTime( next ) && next < end ) {
+    if ( speed_ > 0.0 && next > now_ ) sleepUntil( wallTime( next ) );
+    now_ = std::max( now_, next );
+    dispatchNext();
+  }
+  now_ = end;
+  if ( speed_ > 0.0 ) sleepUntil( wallTime( end ) );
+
+  return nextEventTime( next );
+}
+
+bool PacedSource :: dispatchDue( int64_t now, int64_t &next )
+{
+  uint64_t timestamp;
+  if ( !started_ && !start() ) return false;
+
+  if ( speed_ == 0.0 ) {
+    // As fast as possible: a slice at a time, so the loop still
+    // services its timers in between.
+    next = now;
+    return run( 100 );
+  }
+
+  while ( nextEventTime( timestamp ) && wallTime( timestamp ) <= now ) {
+    now_ = std::max( now_, timestamp );
+    dispatchNext();
+  }
+  if ( !nextEventTime( timestamp ) ) return false;
+  next = wallTime( timestamp );
+  return true;
+}
+
+//*********************************************************************//
+//  Command line
+//*********************************************************************//
+
+static void printSourceUsage( const char *program )
+{
+  std::cerr << "usage: " << program << " [--myo | --replay FILE [SPEED] | --synthetic [SPEED]] [--record FILE]\n"
+            << "    SPEED is a multiple of real time; 0 replays as fast as possible.\n";
+}
+
+static double parseSpeed( int argc, char **argv, int &i )
+{
+  if ( i + 1 < argc && argv[i + 1][0] != '-' ) {
+    char *end;
+    double speed = strtod( argv[++i], &end );
+    if ( *end != '\0' || speed < 0.0 )
+      throw std::runtime_error( std::string( "invalid replay speed: " ) + argv[i] );
+    return speed;
+  }
+  return 1.0;
+}
+
+Source *openSource( int argc, char **argv, const std::string &applicationIdentifier )
+{
+  enum { SOURCE_DEFAULT, SOURCE_MYO, SOURCE_REPLAY, SOURCE_SYNTHETIC } kind = SOURCE_DEFAULT;
+  std::string replayFile, recordFile;
+  double speed = 1.0;
+
+  for ( int i=1; i<argc; i++ ) {
+    if ( strcmp( argv[i], "--myo" ) == 0 )
+      kind = SOURCE_MYO;
+    else if ( strcmp( argv[i], "--replay" ) == 0 && i + 1 < argc ) {
+      kind = SOURCE_REPLAY;
+      replayFile = argv[++i];
+      speed = parseSpeed( argc, argv, i );
+    }
+    else if ( strcmp( argv[i], "--synthetic" ) == 0 ) {
+      kind = SOURCE_SYNTHETIC;
+      speed = parseSpeed( argc, argv, i );
+    }
+    else if ( strcmp( argv[i], "--record" ) == 0 && i + 1 < argc )
+      recordFile = argv[++i];
+    else {
+      printSourceUsage( argv[0] );
+      throw std::runtime_error( std::string( "unknown argument: " ) + argv[i] );
+    }
+  }
+
+#if defined(HAVE_MYO_SDK)
+  if ( kind == SOURCE_DEFAULT ) kind = SOURCE_MYO;
+#else
+  (void) applicationIdentifier;
+  if ( kind == SOURCE_MYO )
+    throw std::runtime_error( "this program was built without the Myo SDK" );
+  if ( kind == SOURCE_DEFAULT ) kind = SOURCE_SYNTHETIC;
+#endif
+
+  Source *source = 0;
+  switch ( kind ) {
+#if defined(HAVE_MYO_SDK)
+  case SOURCE_MYO: source = new MyoHubSource( applicationIdentifier ); break;
+#endif
+  case SOURCE_REPLAY:
+    if ( RecordingWriter::isRecording( replayFile ) ) source = new RecordingSource( replayFile, speed );
+    else source = new TextReplaySource( replayFile, speed );
+    break;
+  default: source = new SyntheticSource( speed ); break;
+  }
+
+  if ( !recordFile.empty() ) {
+    try {
+      // Binary unless the name asks for text.
+      size_t length = recordFile.size();
+      if ( length > 4 && recordFile.compare( length - 4, 4, ".txt" ) == 0 )
+        source->adoptListener( new TextRecorder( recordFile ) );
+      else
+        source->adoptListener( new RecordingWriter( recordFile ) );
+    }
+    catch ( ... ) {
+      delete source;
+      throw;
+    }
+  }
+  return source;
+}
+
+} // namespace sensor
@@ -0,0 +1,313 @@
+/**********************************************************************/
+/*! \file SensorSource.h
+    \brief Hardware-independent armband events for the Myo programs.
+
+    The gesture programs used to derive from myo::DeviceListener and
+    pull events from a myo::Hub, so none of them could run without an
+    armband and the OS X Myo SDK.  They now derive from
+    sensor::Listener and are driven by a sensor::Source, which may be
+    the live hub (MyoHubSource.h), a recording (SensorRecording.h or
+    TextReplaySource.h) or a generator (SyntheticSource.h).
+
+    The types here mirror the parts of the Myo SDK the programs use,
+    so a listener reads the same as before with myo:: replaced by
+    sensor::.  Timestamps are microseconds, as in the SDK.
+*/
+/**********************************************************************/
+
+#ifndef SENSORSOURCE_H
+#define SENSORSOURCE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace sensor {
+
+//! A unit quaternion, as delivered by onOrientationData().
+class Quaternion
+{
+ public:
+  Quaternion( float x = 0.0f, float y = 0.0f, float z = 0.0f, float w = 1.0f ) : x_( x ), y_( y ), z_( z ), w_( w ) {}
+  float x( void ) const { return x_; }
+  float y( void ) const { return y_; }
+  float z( void ) const { return z_; }
+  float w( void ) const { return w_; }
+
+ private:
+  float x_, y_, z_, w_;
+};
+
+//! An accelerometer (g) or gyroscope (deg/s) sample.
+class Vector3
+{
+ public:
+  Vector3( float x = 0.0f, float y = 0.0f, float z = 0.0f ) : x_( x ), y_( y ), z_( z ) {}
+  float x( void ) const { return x_; }
+  float y( void ) const { return y_; }
+  float z( void ) const { return z_; }
+
+ private:
+  float x_, y_, z_;
+};
+
+//! A hand pose.
+class Pose
+{
+ public:
+  enum Type {
+    rest          = 0,
+    fist          = 1,
+    waveIn        = 2,
+    waveOut       = 3,
+    fingersSpread = 4,
+    doubleTap     = 5,
+    unknown       = 0xffff
+  };
+
+  Pose( Type type = unknown ) : type_( type ) {}
+  Type type( void ) const { return type_; }
+  bool operator==( Pose other ) const { return type_ == other.type_; }
+  bool operator!=( Pose other ) const { return type_ != other.type_; }
+  bool operator==( Type type ) const { return type_ == type; }
+  bool operator!=( Type type ) const { return type_ != type; }
+
+  //! Returns the pose name used in recordings ("fist", "waveIn", ...).
+  std::string toString( void ) const;
+
+  //! Parse a name written by toString().  Unknown names give Pose::unknown.
+  static Pose fromString( const std::string &name );
+
+ private:
+  Type type_;
+};
+
+enum Arm { armLeft, armRight, armUnknown };
+enum XDirection { xDirectionTowardWrist, xDirectionTowardElbow, xDirectionUnknown };
+
+//! Number of EMG channels in each onEmgData() sample.
+const unsigned int emgChannels = 8;
+
+//! One armband.
+/*!
+    A source owns its devices and hands out the same pointer for a
+    device on every event, so listeners may compare device pointers.
+    The commands do nothing unless the source talks to hardware.
+*/
+class Device
+{
+ public:
+  enum UnlockType { unlockTimed, unlockHold };
+  enum VibrationType { vibrationShort, vibrationMedium, vibrationLong };
+
+  Device( void ) : id_( 0 ) {}
+  virtual ~Device( void ) {}
+  virtual void unlock( UnlockType /*type*/ ) {}
+  virtual void lock( void ) {}
+  virtual void vibrate( VibrationType /*type*/ ) {}
+  virtual void notifyUserAction( void ) {}
+
+  //! The device's number within its source: 1, 2, ... in the order its events began.
+  /*!
+      Numbers are dense, so listeners can keep per-device state in a
+      DeviceTable (or any array) instead of searching for the pointer.
+  */
+  unsigned int id( void ) const { return id_; }
+
+ private:
+  friend class DeviceRegistry;
+  unsigned int id_;
+};
+
+//! The devices a source has delivered events for, by Device::id().
+class DeviceRegistry
+{
+ public:
+  //! Give \e device the next id if it has none.
+  void add( Device *device )
+  {
+    if ( device->id_ ) return;
+    devices_.push_back( device );
+    device->id_ = static_cast<unsigned int>( devices_.size() );
+  }
+
+  //! The device numbered \e id, or 0.
+  Device *device( unsigned int id ) const { return id >= 1 && id <= devices_.size() ? devices_[id - 1] : 0; }
+
+  //! The number of devices, which is also the highest id.
+  unsigned int size( void ) const { return static_cast<unsigned int>( devices_.size() ); }
+
+ private:
+  std::vector<Device *> devices_;
+};
+
+//! A listener's value for each device of one source, indexed by Device::id().
+template <typename T>
+class DeviceTable
+{
+ public:
+  DeviceTable( const T &initial = T() ) : initial_( initial ) {}
+
+  //! The value for \e device, starting as the initial value.
+  T &operator[]( const Device *device )
+  {
+    unsigned int id = device->id();
+    if ( id >= values_.size() ) values_.resize( id + 1, initial_ );
+    return values_[id];
+  }
+
+ private:
+  std::vector<T> values_;
+  T initial_;
+};
+
+//! Receives events from a Source.  Override only the events you need.
+class Listener
+{
+ public:
+  virtual ~Listener( void ) {}
+  virtual void onPair( Device * /*device*/, uint64_t /*timestamp*/ ) {}
+  virtual void onUnpair( Device * /*device*/, uint64_t /*timestamp*/ ) {}
+  virtual void onConnect( Device * /*device*/, uint64_t /*timestamp*/ ) {}
+  virtual void onDisconnect( Device * /*device*/, uint64_t /*timestamp*/ ) {}
+  virtual void onArmSync( Device * /*device*/, uint64_t /*timestamp*/, Arm /*arm*/, XDirection /*xDirection*/ ) {}
+  virtual void onArmUnsync( Device * /*device*/, uint64_t /*timestamp*/ ) {}
+  virtual void onUnlock( Device * /*device*/, uint64_t /*timestamp*/ ) {}
+  virtual void onLock( Device * /*device*/, uint64_t /*timestamp*/ ) {}
+  virtual void onPose( Device * /*device*/, uint64_t /*timestamp*/, Pose /*pose*/ ) {}
+  virtual void onOrientationData( Device * /*device*/, uint64_t /*timestamp*/, const Quaternion & /*rotation*/ ) {}
+  virtual void onAccelerometerData( Device * /*device*/, uint64_t /*timestamp*/, const Vector3 & /*accel*/ ) {}
+  virtual void onGyroscopeData( Device * /*device*/, uint64_t /*timestamp*/, const Vector3 & /*gyro*/ ) {}
+  virtual void onEmgData( Device * /*device*/, uint64_t /*timestamp*/, const int8_t * /*emg*/ ) {}
+};
+
+//! A stream of armband events.
+class Source
+{
+ public:
+  virtual ~Source( void );
+
+  void addListener( Listener *listener );
+  void removeListener( Listener *listener );
+
+  //! Add a listener that the source deletes when it is destroyed.
+  void adoptListener( Listener *listener );
+
+  //! The devices delivered so far.  Each is numbered when its first event is delivered.
+  const DeviceRegistry &getDevices( void ) const { return registry_; }
+
+  //! Deliver events for \e milliseconds, like myo::Hub::run().
+  /*!
+      Returns false once the source has nothing more to deliver (the
+      end of a recording), true otherwise.
+  */
+  virtual bool run( unsigned int milliseconds ) = 0;
+
+  //! Wait up to \e milliseconds for a device to appear.  Returns false on timeout.
+  virtual bool waitForDevice( unsigned int /*milliseconds*/ ) { return true; }
+
+  //! Deliver the events due by \e now, for an EventLoop.
+  /*!
+      \e now and \e next are steadyMicroseconds() times.  Stores in
+      \e next when the next event is due, so the loop can sleep until
+      then; a source that cannot tell leaves it at \e now.  Returns
+      false once the source has nothing more to deliver.  The default
+      runs the source for a millisecond, which is how the programs
+      polled before.
+  */
+  virtual bool dispatchDue( int64_t now, int64_t &next );
+
+  //! Whether events arrive only inside waitForEvents().
+  /*!
+      True for the Myo hub, whose SDK delivers events on the thread
+      that waits in it and has no descriptor to poll.  An EventLoop
+      waits in such a source instead of sleeping.
+  */
+  virtual bool waitsForEvents( void ) const { return false; }
+
+  //! Deliver events as they arrive until the first one, or until \e deadline.
+  virtual void waitForEvents( int64_t /*deadline*/ ) {}
+
+ protected:
+  std::vector<Listener *> listeners_;
+  std::vector<Listener *> adopted_;
+  DeviceRegistry registry_;
+
+  // Deliver one event to every listener, numbering the device first
+  // if this is its first event.
+  void pair( Device *device, uint64_t timestamp );
+  void unpair( Device *device, uint64_t timestamp );
+  void connect( Device *device, uint64_t timestamp );
+  void disconnect( Device *device, uint64_t timestamp );
+  void armSync( Device *device, uint64_t timestamp, Arm arm, XDirection xDirection );
+  void armUnsync( Device *device, uint64_t timestamp );
+  void unlocked( Device *device, uint64_t timestamp );
+  void locked( Device *device, uint64_t timestamp );
+  void pose( Device *device, uint64_t timestamp, Pose pose );
+  void orientation( Device *device, uint64_t timestamp, const Quaternion &rotation );
+  void accelerometer( Device *device, uint64_t timestamp, const Vector3 &accel );
+  void gyroscope( Device *device, uint64_t timestamp, const Vector3 &gyro );
+  void emg( Device *device, uint64_t timestamp, const int8_t *samples );
+};
+
+//! A source that produces timestamped events and paces their delivery.
+/*!
+    With a speed of 1 events are delivered in real time, with a speed
+    of N they are delivered N times faster, and with a speed of 0
+    run() delivers the next \e milliseconds of events without
+    waiting.
+*/
+class PacedSource : public Source
+{
+ public:
+  PacedSource( double speed );
+  bool run( unsigned int milliseconds );
+  bool dispatchDue( int64_t now, int64_t &next );
+
+  //! Returns the speed given to the constructor.
+  double getSpeed( void ) const { return speed_; }
+
+ protected:
+  //! Store the time of the next event in \e timestamp, or return false if there is none.
+  virtual bool nextEventTime( uint64_t &timestamp ) = 0;
+
+  //! Deliver the next event.
+  virtual void dispatchNext( void ) = 0;
+
+ private:
+  double speed_;
+  bool started_;
+  uint64_t now_;       // source time in microseconds
+  uint64_t origin_;    // source time at wallOrigin_
+  int64_t wallOrigin_; // steady clock in microseconds
+
+  bool start( void );
+  int64_t wallTime( uint64_t timestamp ) const { return wallOrigin_ + (int64_t) ( ( timestamp - origin_ ) / speed_ ); }
+};
+
+//! The steady clock in microseconds: the time base of PacedSource and EventLoop.
+int64_t steadyMicroseconds( void );
+
+//! Create the source selected on the command line.
+/*!
+    Recognised arguments are
+    \verbatim
+    --myo                      the armbands, through Myo Connect
+    --replay FILE [SPEED]      a recording made with --record
+    --synthetic [SPEED]        generated gestures from two armbands
+    --record FILE              also write every event to FILE
+    \endverbatim
+    Recordings are binary (SensorRecording.h) unless FILE ends in
+    ".txt", when they are text (TextReplaySource.h); --replay accepts
+    either.
+    SPEED defaults to 1 (real time); 0 means as fast as possible.
+    Without a source argument the armbands are used when the program
+    was built with the Myo SDK and the generator otherwise.  Throws
+    std::runtime_error, after printing the usage for a bad command
+    line, if the source cannot be opened.
+*/
+Source *openSource( int argc, char **argv, const std::string &applicationIdentifier );
+
+} // namespace sensor
+
+#endif
@@ -0,0 +1,185 @@
+/**********************************************************************/
+/*! \file StatusDisplay.cpp
+    \brief Show each armband's state from a thread of its own.
+*/
+/**********************************************************************/
+
+#include "StatusDisplay.h"
+
+#include <chrono>
+#include <cstdio>
+
+namespace sensor {
+
+// A device's status as one word: the buckets in the low 48 bits, then
+// the pose (0xff for unknown), arm, unlocked and connected.
+static uint64_t pack( const DeviceStatus &s )
+{
+  uint64_t pose = s.pose.type() <= Pose::doubleTap ? (uint64_t) s.pose.type() : 0xff;
+  return ( (uint64_t) (uint16_t) s.roll ) | ( (uint64_t) (uint16_t) s.pitch << 16 ) | ( (uint64_t) (uint16_t) s.yaw << 32 )
+    | ( pose << 48 ) | ( (uint64_t) ( s.arm & 3 ) << 56 ) | ( (uint64_t) s.unlocked << 58 ) | ( (uint64_t) s.connected << 59 );
+}
+
+static DeviceStatus unpack( uint64_t word )
+{
+  DeviceStatus s;
+  s.roll = (int16_t) ( word & 0xffff );
+  s.pitch = (int16_t) ( ( word >> 16 ) & 0xffff );
+  s.yaw = (int16_t) ( ( word >> 32 ) & 0xffff );
+  unsigned int pose = ( word >> 48 ) & 0xff;
+  s.pose = Pose( pose == 0xff ? Pose::unknown : static_cast<Pose::Type>( pose ) );
+  s.arm = static_cast<Arm>( ( word >> 56 ) & 3 );
+  s.unlocked = ( word >> 58 ) & 1;
+  s.connected = ( word >> 59 ) & 1;
+  return s;
+}
+
+StatusBoard :: StatusBoard( void )
+  : sequence_( 0 ), count_( 0 )
+{
+  for ( unsigned int i=0; i<maxDevices; i++ ) devices_[i].store( 0, std::memory_order_relaxed );
+}
+
+void StatusBoard :: publish( unsigned int id, const DeviceStatus &status )
+{
+  if ( id < 1 || id > maxDevices ) return;
+  uint32_t sequence = sequence_.load( std::memory_order_relaxed );
+  sequence_.store( sequence + 1, std::memory_order_relaxed );
+  std::atomic_thread_fence( std::memory_order_release );
+  devices_[id - 1].store( pack( status ), std::memory_order_relaxed );
+  if ( id > count_.load( std::memory_order_relaxed ) ) count_.store( id, std::memory_order_relaxed );
+  sequence_.store( sequence + 2, std::memory_order_release );
+}
+
+unsigned int StatusBoard :: read( DeviceStatus *status ) const
+{
+  uint64_t words[maxDevices];
+  unsigned int count;
+  for ( ;; ) {
+    uint32_t sequence = sequence_.load( std::memory_order_acquire );
+    if ( sequence & 1 ) continue;
+    count = count_.load( std::memory_order_relaxed );
+    for ( unsigned int i=0; i<count; i++ ) words[i] = devices_[i].load( std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_acquire );
+    if ( sequence_.load( std::memory_order_relaxed ) == sequence ) break;
+  }
+  for ( unsigned int i=0; i<count; i++ ) status[i] = unpack( words[i] );
+  return count;
+}
+
+// Each field's width, so a field keeps its column however its value
+// changes.
+static const unsigned int widths[] = { 4, 11, 12, 10, 14, 9, 12 };
+
+StatusDisplay :: StatusDisplay( const StatusBoard &board, std::ostream &out, int64_t interval )
+  : board_( board ), out_( out ), interval_( interval ), rows_( 0 ), drawn_( 0 ), bytes_( 0 ),
+    running_( false ), stopping_( false )
+{
+}
+
+StatusDisplay :: ~StatusDisplay( void )
+{
+  stop();
+}
+
+void StatusDisplay :: start( void )
+{
+  std::lock_guard<std::mutex> guard( lock_ );
+  if ( running_ ) return;
+  stopping_ = false;
+  running_ = true;
+  thread_ = std::thread( &StatusDisplay::run, this );
+}
+
+void StatusDisplay :: stop( void )
+{
+  {
+    std::lock_guard<std::mutex> guard( lock_ );
+    if ( !running_ ) return;
+    stopping_ = true;
+  }
+  wake_.notify_one();
+  thread_.join();
+  running_ = false;
+  render();
+  if ( rows_ ) out_ << std::endl;
+  rows_ = 0;
+  previous_.clear();
+}
+
+void StatusDisplay :: run( void )
+{
+  std::unique_lock<std::mutex> guard( lock_ );
+  while ( !stopping_ ) {
+    guard.unlock();
+    render();
+    guard.lock();
+    wake_.wait_for( guard, std::chrono::microseconds( interval_ ), [this]() { return stopping_; } );
+  }
+}
+
+void StatusDisplay :: format( const DeviceStatus &s, unsigned int field )
+{
+  char text[32];
+  switch ( field ) {
+  case fieldArm: snprintf( text, sizeof( text ), "[%c]", s.arm == armLeft ? 'L' : s.arm == armRight ? 'R' : '?' ); break;
+  case fieldRoll: snprintf( text, sizeof( text ), "roll: %d", s.roll ); break;
+  case fieldPitch: snprintf( text, sizeof( text ), "pitch: %d", s.pitch ); break;
+  case fieldYaw: snprintf( text, sizeof( text ), "yaw: %d", s.yaw ); break;
+  case fieldPose: snprintf( text, sizeof( text ), "%s", s.pose == Pose::unknown ? "-" : s.pose.toString().c_str() ); break;
+  case fieldLock: snprintf( text, sizeof( text ), "%s", s.unlocked ? "unlocked" : "locked" ); break;
+  default: snprintf( text, sizeof( text ), "%s", s.connected ? "connected" : "disconnected" ); break;
+  }
+  field_ = text;
+  field_.resize( widths[field], ' ' );
+}
+
+void StatusDisplay :: render( void )
+{
+  uint32_t version = board_.version();
+  if ( rows_ && version == drawn_ ) return;
+  DeviceStatus status[StatusBoard::maxDevices];
+  unsigned int count = board_.read( status );
+  drawn_ = version;
+
+  // A new device gets a new line below the others.
+  frame_.clear();
+  for ( ; rows_ < count; rows_++ ) {
+    if ( rows_ ) frame_ += '\n';
+    previous_.resize( ( rows_ + 1 ) * fields );
+  }
+
+  // Move only when the next changed field is not where the cursor is.
+  unsigned int cursorRow = rows_ - 1, cursorColumn = 0;
+  char move[32];
+  for ( unsigned int row=0; row<count; row++ ) {
+    unsigned int column = 1;
+    for ( unsigned int f=0; f<fields; column+=widths[f], f++ ) {
+      format( status[row], f );
+      std::string &previous = previous_[row * fields + f];
+      if ( field_ == previous ) continue;
+      previous = field_;
+      if ( row != cursorRow ) {
+        snprintf( move, sizeof( move ), row < cursorRow ? "\033[%uA" : "\033[%uB", row < cursorRow ? cursorRow - row : row - cursorRow );
+        frame_ += move;
+        cursorRow = row;
+      }
+      if ( column != cursorColumn ) {
+        snprintf( move, sizeof( move ), "\033[%uG", column );
+        frame_ += move;
+      }
+      frame_ += field_;
+      cursorColumn = column + widths[f];
+    }
+  }
+  if ( cursorRow != rows_ - 1 ) {
+    snprintf( move, sizeof( move ), "\033[%uB", rows_ - 1 - cursorRow );
+    frame_ += move;
+  }
+  if ( frame_.empty() ) return;
+  out_.write( frame_.data(), (std::streamsize) frame_.size() );
+  out_.flush();
+  bytes_.fetch_add( frame_.size(), std::memory_order_relaxed );
+}
+
+} // namespace sensor
@@ -0,0 +1,118 @@
+/**********************************************************************/
+/*! \file StatusDisplay.h
+    \brief Show each armband's state from a thread of its own.
+
+    The status line used to be printed on the sensor thread, from a
+    timer between events, so every redraw held up the next event and
+    the MIDI it sends for as long as the terminal took to take the
+    text.  Now the sensor thread only publishes each device's state to
+    a StatusBoard, and a StatusDisplay redraws it from its own thread
+    at its own rate.
+
+    The board is a sequence lock over one packed word per device: the
+    publisher never waits, and the display rereads in the rare case
+    that it overlaps an update.  The display keeps what it last drew
+    of each field and, on each frame, moves the cursor to and rewrites
+    only the fields that changed.
+*/
+/**********************************************************************/
+
+#ifndef STATUSDISPLAY_H
+#define STATUSDISPLAY_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "SensorSource.h"
+
+namespace sensor {
+
+//! What the display shows of one armband.
+struct DeviceStatus
+{
+  int roll, pitch, yaw;   //!< buckets, as the mapping sees them
+  Pose pose;
+  Arm arm;
+  bool unlocked;
+  bool connected;
+};
+
+class StatusBoard
+{
+ public:
+  //! The most devices a board holds.
+  static const unsigned int maxDevices = 8;
+
+  StatusBoard( void );
+
+  //! Publish device \e id's status (1 to maxDevices; others are ignored).  Call from one thread only.
+  void publish( unsigned int id, const DeviceStatus &status );
+
+  //! Copy every device's status into \e status, which has room for maxDevices, and return how many.  Never blocks publish().
+  unsigned int read( DeviceStatus *status ) const;
+
+  //! Changes each time something is published.
+  uint32_t version( void ) const { return sequence_.load( std::memory_order_acquire ); }
+
+ private:
+  std::atomic<uint32_t> sequence_;
+  std::atomic<uint32_t> count_;
+  std::atomic<uint64_t> devices_[maxDevices];
+};
+
+class StatusDisplay
+{
+ public:
+  //! Draw \e board to \e out, checking for changes every \e interval microseconds once started.
+  StatusDisplay( const StatusBoard &board, std::ostream &out, int64_t interval = 50000 );
+
+  //! The destructor stops the display thread.
+  ~StatusDisplay( void );
+
+  //! Start drawing from a thread of the display's own.
+  void start( void );
+
+  //! Stop the thread and leave the cursor on a new line below the display.
+  void stop( void );
+
+  //! Draw what has changed since the last frame.  The display thread calls this; call it only while that is stopped.
+  void render( void );
+
+  //! Bytes written so far.
+  uint64_t bytesWritten( void ) const { return bytes_.load( std::memory_order_relaxed ); }
+
+ private:
+  enum { fieldArm, fieldRoll, fieldPitch, fieldYaw, fieldPose, fieldLock, fieldConnection, fields };
+
+  const StatusBoard &board_;
+  std::ostream &out_;
+  int64_t interval_;
+
+  // The cursor rests on the last of rows_ lines, or where the first
+  // will go while there are none.
+  unsigned int rows_;
+  uint32_t drawn_;                    // the board's version last drawn
+  std::vector<std::string> previous_; // each row's fields as drawn
+  std::string frame_, field_;
+  std::atomic<uint64_t> bytes_;
+
+  std::mutex lock_;
+  std::condition_variable wake_;
+  std::thread thread_;
+  bool running_, stopping_;
+
+  void run( void );
+  void format( const DeviceStatus &status, unsigned int field );
+
+  StatusDisplay( const StatusDisplay & );
+  StatusDisplay &operator=( const StatusDisplay & );
+};
+
+} // namespace sensor
+
+#endif
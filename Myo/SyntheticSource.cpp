@@ -0,0 +1,145 @@
+/**********************************************************************/
+/*! \file SyntheticSource.cpp
+    \brief Generated armband events for running without hardware.
+*/
+/**********************************************************************/
+
+#include "SyntheticSource.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace sensor {
+
+static const double twoPi = 6.283185307179586;
+
+// Poses in the order each device steps through them.
+static const Pose::Type poseCycle[] = {
+  Pose::rest, Pose::fist, Pose::rest, Pose::waveIn, Pose::waveOut,
+  Pose::fingersSpread, Pose::rest, Pose::doubleTap, Pose::fist, Pose::fingersSpread
+};
+static const unsigned int poseCycleLength = sizeof( poseCycle ) / sizeof( poseCycle[0] );
+
+// Stream start times, so the devices appear before any data.
+static const uint64_t startTime = 1000000;
+static const uint64_t dataTime = startTime + 100000;
+
+SyntheticSource :: SyntheticSource( double speed, unsigned int devices, uint64_t duration, uint32_t seed )
+  : PacedSource( speed ), duration_( duration ), random_( seed ? seed : 1 )
+{
+  for ( unsigned int i=0; i<devices; i++ ) {
+    devices_.push_back( new Device );
+    poses_.push_back( Pose::rest );
+    Stream startup = { STARTUP, i, startTime + i * 1000, 0 };
+    Stream imu = { IMU, i, dataTime + i * 1000, 0 };
+    Stream emg = { EMG, i, dataTime + i * 1000 + 500, 0 };
+    Stream pose = { POSE, i, dataTime + posePeriod / 2 + i * ( posePeriod / 3 ), 0 };
+    streams_.push_back( startup );
+    streams_.push_back( imu );
+    streams_.push_back( emg );
+    streams_.push_back( pose );
+  }
+}
+
+SyntheticSource :: ~SyntheticSource( void )
+{
+  for ( size_t i=0; i<devices_.size(); i++ )
+    delete devices_[i];
+}
+
+size_t SyntheticSource :: nextStream( void ) const
+{
+  size_t best = streams_.size();
+  for ( size_t i=0; i<streams_.size(); i++ )
+    if ( best == streams_.size() || streams_[i].next < streams_[best].next ) best = i;
+  return best;
+}
+
+bool SyntheticSource :: nextEventTime( uint64_t &timestamp )
+{
+  size_t i = nextStream();
+  if ( i == streams_.size() ) return false;
+  if ( duration_ && streams_[i].next >= startTime + duration_ ) return false;
+  timestamp = streams_[i].next;
+  return true;
+}
+
+void SyntheticSource :: dispatchNext( void )
+{
+  Stream &stream = streams_[nextStream()];
+  Device *device = devices_[stream.device];
+  uint64_t timestamp = stream.next;
+
+  switch ( stream.type ) {
+  case STARTUP:
+    pair( device, timestamp );
+    connect( device, timestamp );
+    armSync( device, timestamp, stream.device % 2 ? armRight : armLeft, xDirectionTowardWrist );
+    unlocked( device, timestamp );
+    stream.next = ~(uint64_t) 0;
+    break;
+  case IMU:
+    imu( stream.device, timestamp );
+    stream.next += imuPeriod;
+    break;
+  case EMG: {
+    // Laplacian noise, which is how surface EMG is distributed, louder
+    // when the hand is tensed than at rest.
+    int8_t samples[emgChannels];
+    double scale = poses_[stream.device] == Pose::rest ? 2.0 : poses_[stream.device] == Pose::fist ? 20.0 : 8.0;
+    for ( unsigned int i=0; i<emgChannels; i++ ) {
+      random_ = random_ * 1664525u + 1013904223u;
+      double magnitude = -scale * std::log( ( ( random_ >> 8 ) + 0.5 ) / 16777216.0 );
+      int sample = static_cast<int>( magnitude + 0.5 );
+      if ( random_ & 0x80 ) sample = -sample;
+      samples[i] = static_cast<int8_t>( std::max( -128, std::min( 127, sample ) ) );
+    }
+    emg( device, timestamp, samples );
+    stream.step++;
+    stream.next += emgPeriod;
+    break;
+  }
+  case POSE:
+    poses_[stream.device] = poseCycle[( stream.step + stream.device * 3 ) % poseCycleLength];
+    pose( device, timestamp, Pose( poses_[stream.device] ) );
+    stream.step++;
+    stream.next += posePeriod;
+    break;
+  }
+}
+
+void SyntheticSource :: imu( unsigned int index, uint64_t timestamp )
+{
+  // Each device sweeps at its own rates, between 0.1 and 0.4 Hz.
+  double t = ( timestamp - dataTime ) * 1e-6;
+  double rate = 1.0 + 0.37 * index;
+  double roll = 2.9 * std::sin( twoPi * 0.13 * rate * t );
+  double pitch = 1.4 * std::sin( twoPi * 0.21 * rate * t + 0.5 );
+  double yaw = 2.9 * std::sin( twoPi * 0.07 * rate * t + 1.0 );
+
+  // Roll, pitch and yaw to a quaternion, in the convention the
+  // gesture programs use to convert back.
+  double cr = std::cos( roll / 2 ), sr = std::sin( roll / 2 );
+  double cp = std::cos( pitch / 2 ), sp = std::sin( pitch / 2 );
+  double cy = std::cos( yaw / 2 ), sy = std::sin( yaw / 2 );
+  Quaternion rotation( static_cast<float>( sr * cp * cy - cr * sp * sy ),
+                       static_cast<float>( cr * sp * cy + sr * cp * sy ),
+                       static_cast<float>( cr * cp * sy - sr * sp * cy ),
+                       static_cast<float>( cr * cp * cy + sr * sp * sy ) );
+
+  // Gravity in the device frame, and the angular rate of the sweep.
+  Vector3 accel( static_cast<float>( -std::sin( pitch ) ),
+                 static_cast<float>( std::sin( roll ) * std::cos( pitch ) ),
+                 static_cast<float>( std::cos( roll ) * std::cos( pitch ) ) );
+  double degrees = 360.0 / twoPi;
+  Vector3 gyro( static_cast<float>( degrees * 2.9 * twoPi * 0.13 * rate * std::cos( twoPi * 0.13 * rate * t ) ),
+                static_cast<float>( degrees * 1.4 * twoPi * 0.21 * rate * std::cos( twoPi * 0.21 * rate * t + 0.5 ) ),
+                static_cast<float>( degrees * 2.9 * twoPi * 0.07 * rate * std::cos( twoPi * 0.07 * rate * t + 1.0 ) ) );
+
+  Device *device = devices_[index];
+  orientation( device, timestamp, rotation );
+  accelerometer( device, timestamp, accel );
+  gyroscope( device, timestamp, gyro );
+}
+
+} // namespace sensor
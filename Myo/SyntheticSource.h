@@ -0,0 +1,60 @@
+/**********************************************************************/
+/*! \file SyntheticSource.h
+    \brief Generated armband events for running without hardware.
+
+    The generator pairs, syncs and unlocks its devices and then
+    streams data at the armband's rates: orientation, accelerometer
+    and gyroscope at 50 Hz and EMG at 200 Hz.  Each device sweeps
+    roll, pitch and yaw through most of their range at its own slow
+    rates and steps through the poses, so every branch of the gesture
+    programs is exercised.  Odd-numbered devices sync to the left arm
+    and even-numbered ones to the right.  The output depends only on
+    the constructor arguments.
+*/
+/**********************************************************************/
+
+#ifndef SYNTHETICSOURCE_H
+#define SYNTHETICSOURCE_H
+
+#include "SensorSource.h"
+
+namespace sensor {
+
+class SyntheticSource : public PacedSource
+{
+ public:
+  //! Generate events for \e devices armbands, for \e duration microseconds (0 runs forever).
+  SyntheticSource( double speed = 1.0, unsigned int devices = 2, uint64_t duration = 0, uint32_t seed = 1 );
+  ~SyntheticSource( void );
+
+  static const uint64_t imuPeriod = 20000;   //!< orientation, accelerometer and gyroscope (50 Hz)
+  static const uint64_t emgPeriod = 5000;    //!< EMG (200 Hz)
+  static const uint64_t posePeriod = 1500000;
+
+ protected:
+  bool nextEventTime( uint64_t &timestamp );
+  void dispatchNext( void );
+
+ private:
+  enum StreamType { STARTUP, IMU, EMG, POSE };
+
+  struct Stream {
+    StreamType type;
+    unsigned int device;
+    uint64_t next;
+    unsigned int step;
+  };
+
+  std::vector<Device *> devices_;
+  std::vector<Stream> streams_;
+  std::vector<Pose::Type> poses_;    // the last pose of each device, which sets its EMG level
+  uint64_t duration_;
+  uint32_t random_;
+
+  size_t nextStream( void ) const;
+  void imu( unsigned int device, uint64_t timestamp );
+};
+
+} // namespace sensor
+
+#endif
@@ -0,0 +1,212 @@
+/**********************************************************************/
+/*! \file TextReplaySource.cpp
+    \brief Record armband events to a text file and play them back.
+*/
+/**********************************************************************/
+
+#include "TextReplaySource.h"
+
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace sensor {
+
+static const char *armNames[] = { "left", "right", "unknown" };
+static const char *directionNames[] = { "wrist", "elbow", "unknown" };
+
+// A sanity limit on device numbers, so a corrupt line cannot make us
+// allocate millions of devices.
+static const unsigned int maxDevices = 256;
+
+//*********************************************************************//
+//  TextRecorder
+//*********************************************************************//
+
+TextRecorder :: TextRecorder( const std::string &fileName )
+  : file_( fileName.c_str() ), devices_( 0 ), lastFlush_( 0 )
+{
+  if ( !file_ )
+    throw std::runtime_error( "TextRecorder: cannot open " + fileName + " for writing" );
+  file_ << "# timestamp(us) device event arguments\n";
+  file_ << std::setprecision( 9 );
+}
+
+std::ostream &TextRecorder :: begin( Device *device, uint64_t timestamp, const char *event )
+{
+  unsigned int &fileId = fileIds_[device];
+  if ( !fileId ) fileId = ++devices_;
+
+  // Flush a few times a second so little is lost when the program is
+  // killed.
+  if ( timestamp >= lastFlush_ + 250000 ) {
+    file_.flush();
+    lastFlush_ = timestamp;
+  }
+  return file_ << timestamp << ' ' << fileId << ' ' << event;
+}
+
+void TextRecorder :: onPair( Device *device, uint64_t timestamp ) { begin( device, timestamp, "pair" ) << '\n'; }
+void TextRecorder :: onUnpair( Device *device, uint64_t timestamp ) { begin( device, timestamp, "unpair" ) << '\n'; }
+void TextRecorder :: onConnect( Device *device, uint64_t timestamp ) { begin( device, timestamp, "connect" ) << '\n'; }
+void TextRecorder :: onDisconnect( Device *device, uint64_t timestamp ) { begin( device, timestamp, "disconnect" ) << '\n'; }
+void TextRecorder :: onArmUnsync( Device *device, uint64_t timestamp ) { begin( device, timestamp, "unarm" ) << '\n'; }
+void TextRecorder :: onUnlock( Device *device, uint64_t timestamp ) { begin( device, timestamp, "unlock" ) << '\n'; }
+void TextRecorder :: onLock( Device *device, uint64_t timestamp ) { begin( device, timestamp, "lock" ) << '\n'; }
+
+void TextRecorder :: onArmSync( Device *device, uint64_t timestamp, Arm arm, XDirection xDirection )
+{
+  begin( device, timestamp, "arm" ) << ' ' << armNames[arm] << ' ' << directionNames[xDirection] << '\n';
+}
+
+void TextRecorder :: onPose( Device *device, uint64_t timestamp, Pose pose )
+{
+  begin( device, timestamp, "pose" ) << ' ' << pose.toString() << '\n';
+}
+
+void TextRecorder :: onOrientationData( Device *device, uint64_t timestamp, const Quaternion &rotation )
+{
+  begin( device, timestamp, "orient" ) << ' ' << rotation.x() << ' ' << rotation.y()
+                                       << ' ' << rotation.z() << ' ' << rotation.w() << '\n';
+}
+
+void TextRecorder :: onAccelerometerData( Device *device, uint64_t timestamp, const Vector3 &accel )
+{
+  begin( device, timestamp, "accel" ) << ' ' << accel.x() << ' ' << accel.y() << ' ' << accel.z() << '\n';
+}
+
+void TextRecorder :: onGyroscopeData( Device *device, uint64_t timestamp, const Vector3 &gyro )
+{
+  begin( device, timestamp, "gyro" ) << ' ' << gyro.x() << ' ' << gyro.y() << ' ' << gyro.z() << '\n';
+}
+
+void TextRecorder :: onEmgData( Device *device, uint64_t timestamp, const int8_t *emg )
+{
+  std::ostream &out = begin( device, timestamp, "emg" );
+  for ( unsigned int i=0; i<emgChannels; i++ ) out << ' ' << (int) emg[i];
+  out << '\n';
+}
+
+//*********************************************************************//
+//  TextReplaySource
+//*********************************************************************//
+
+template <class T>
+static bool parseName( const std::string &word, const char **names, unsigned int nNames, T &value )
+{
+  for ( unsigned int i=0; i<nNames; i++ )
+    if ( word == names[i] ) { value = static_cast<T>( i ); return true; }
+  return false;
+}
+
+TextReplaySource :: TextReplaySource( const std::string &fileName, double speed )
+  : PacedSource( speed ), next_( 0 )
+{
+  std::ifstream file( fileName.c_str() );
+  if ( !file )
+    throw std::runtime_error( "TextReplaySource: cannot open " + fileName );
+
+  std::string line;
+  unsigned int lineNumber = 0;
+  while ( std::getline( file, line ) ) {
+    lineNumber++;
+    if ( line.empty() || line[0] == '#' ) continue;
+
+    std::istringstream words( line );
+    std::string type;
+    Event event;
+    bool ok = !!( words >> event.timestamp >> event.device >> type ) &&
+      event.device > 0 && event.device <= maxDevices;
+
+    if ( !ok ) {}
+    else if ( type == "pair" ) event.type = PAIR;
+    else if ( type == "unpair" ) event.type = UNPAIR;
+    else if ( type == "connect" ) event.type = CONNECT;
+    else if ( type == "disconnect" ) event.type = DISCONNECT;
+    else if ( type == "unarm" ) event.type = ARM_UNSYNC;
+    else if ( type == "unlock" ) event.type = UNLOCK;
+    else if ( type == "lock" ) event.type = LOCK;
+    else if ( type == "arm" ) {
+      std::string arm, direction;
+      event.type = ARM_SYNC;
+      ok = !!( words >> arm >> direction ) &&
+        parseName( arm, armNames, 3, event.sync.arm ) &&
+        parseName( direction, directionNames, 3, event.sync.xDirection );
+    }
+    else if ( type == "pose" ) {
+      std::string name;
+      event.type = POSE;
+      ok = !!( words >> name );
+      event.pose = Pose::fromString( name ).type();
+    }
+    else if ( type == "orient" ) {
+      event.type = ORIENTATION;
+      ok = !!( words >> event.values[0] >> event.values[1] >> event.values[2] >> event.values[3] );
+    }
+    else if ( type == "accel" || type == "gyro" ) {
+      event.type = type == "accel" ? ACCELEROMETER : GYROSCOPE;
+      ok = !!( words >> event.values[0] >> event.values[1] >> event.values[2] );
+    }
+    else if ( type == "emg" ) {
+      event.type = EMG;
+      for ( unsigned int i=0; ok && i<emgChannels; i++ ) {
+        int sample;
+        ok = !!( words >> sample ) && sample >= -128 && sample <= 127;
+        event.emg[i] = static_cast<int8_t>( sample );
+      }
+    }
+    else ok = false;
+
+    // A recording cut short (the programs are usually stopped with
+    // Ctrl-C) can end part way through a line; play what came before.
+    if ( !ok && file.eof() ) break;
+
+    if ( !ok ) {
+      std::ostringstream ost;
+      ost << "TextReplaySource: " << fileName << ":" << lineNumber << ": cannot parse '" << line << "'";
+      throw std::runtime_error( ost.str() );
+    }
+
+    event.device--;
+    while ( devices_.size() <= event.device ) devices_.push_back( new Device );
+    events_.push_back( event );
+  }
+}
+
+TextReplaySource :: ~TextReplaySource( void )
+{
+  for ( size_t i=0; i<devices_.size(); i++ )
+    delete devices_[i];
+}
+
+bool TextReplaySource :: nextEventTime( uint64_t &timestamp )
+{
+  if ( next_ >= events_.size() ) return false;
+  timestamp = events_[next_].timestamp;
+  return true;
+}
+
+void TextReplaySource :: dispatchNext( void )
+{
+  const Event &event = events_[next_++];
+  Device *device = devices_[event.device];
+  const float *v = event.values;
+
+  switch ( event.type ) {
+  case PAIR: pair( device, event.timestamp ); break;
+  case UNPAIR: unpair( device, event.timestamp ); break;
+  case CONNECT: connect( device, event.timestamp ); break;
+  case DISCONNECT: disconnect( device, event.timestamp ); break;
+  case ARM_SYNC: armSync( device, event.timestamp, event.sync.arm, event.sync.xDirection ); break;
+  case ARM_UNSYNC: armUnsync( device, event.timestamp ); break;
+  case UNLOCK: unlocked( device, event.timestamp ); break;
+  case LOCK: locked( device, event.timestamp ); break;
+  case POSE: pose( device, event.timestamp, Pose( event.pose ) ); break;
+  case ORIENTATION: orientation( device, event.timestamp, Quaternion( v[0], v[1], v[2], v[3] ) ); break;
+  case ACCELEROMETER: accelerometer( device, event.timestamp, Vector3( v[0], v[1], v[2] ) ); break;
+  case GYROSCOPE: gyroscope( device, event.timestamp, Vector3( v[0], v[1], v[2] ) ); break;
+  case EMG: emg( device, event.timestamp, event.emg ); break;
+  }
+}
+
+} // namespace sensor
@@ -0,0 +1,99 @@
+/**********************************************************************/
+/*! \file TextReplaySource.h
+    \brief Record armband events to a text file and play them back.
+
+    A recording has one event per line:
+    \verbatim
+    # timestamp(us) device event arguments
+    1000000 1 pair
+    1000000 1 arm left wrist
+    1020000 1 orient 0.01 -0.2 0.03 0.97
+    1020000 1 pose fist
+    1025000 1 emg 3 -4 12 0 1 -2 7 5
+    \endverbatim
+    Devices are numbered from 1 in the order they were first seen.
+    The other events are unpair, connect, disconnect, unarm, unlock,
+    lock, accel X Y Z and gyro X Y Z.  Lines starting with # are
+    comments.
+*/
+/**********************************************************************/
+
+#ifndef TEXTREPLAYSOURCE_H
+#define TEXTREPLAYSOURCE_H
+
+#include <fstream>
+#include "SensorSource.h"
+
+namespace sensor {
+
+//! Writes every event it receives to a recording.
+class TextRecorder : public Listener
+{
+ public:
+  //! Open \e fileName for writing.  Throws std::runtime_error on failure.
+  TextRecorder( const std::string &fileName );
+
+  void onPair( Device *device, uint64_t timestamp );
+  void onUnpair( Device *device, uint64_t timestamp );
+  void onConnect( Device *device, uint64_t timestamp );
+  void onDisconnect( Device *device, uint64_t timestamp );
+  void onArmSync( Device *device, uint64_t timestamp, Arm arm, XDirection xDirection );
+  void onArmUnsync( Device *device, uint64_t timestamp );
+  void onUnlock( Device *device, uint64_t timestamp );
+  void onLock( Device *device, uint64_t timestamp );
+  void onPose( Device *device, uint64_t timestamp, Pose pose );
+  void onOrientationData( Device *device, uint64_t timestamp, const Quaternion &rotation );
+  void onAccelerometerData( Device *device, uint64_t timestamp, const Vector3 &accel );
+  void onGyroscopeData( Device *device, uint64_t timestamp, const Vector3 &gyro );
+  void onEmgData( Device *device, uint64_t timestamp, const int8_t *emg );
+
+ private:
+  std::ofstream file_;
+  unsigned int devices_;
+  DeviceTable<unsigned int> fileIds_;  // the device's number in the file, or 0
+  uint64_t lastFlush_;
+
+  std::ostream &begin( Device *device, uint64_t timestamp, const char *event );
+};
+
+//! Plays back a recording made by TextRecorder.
+class TextReplaySource : public PacedSource
+{
+ public:
+  //! Load \e fileName.  Throws std::runtime_error if it cannot be read or parsed.
+  TextReplaySource( const std::string &fileName, double speed = 1.0 );
+  ~TextReplaySource( void );
+
+  //! Returns the number of events in the recording.
+  size_t getEventCount( void ) const { return events_.size(); }
+
+ protected:
+  bool nextEventTime( uint64_t &timestamp );
+  void dispatchNext( void );
+
+ private:
+  enum EventType {
+    PAIR, UNPAIR, CONNECT, DISCONNECT, ARM_SYNC, ARM_UNSYNC,
+    UNLOCK, LOCK, POSE, ORIENTATION, ACCELEROMETER, GYROSCOPE, EMG
+  };
+
+  struct Event {
+    uint64_t timestamp;
+    unsigned int device;
+    EventType type;
+    union {
+      float values[4];
+      int8_t emg[emgChannels];
+      struct { Arm arm; XDirection xDirection; } sync;
+      Pose::Type pose;
+    };
+  };
+
+  std::vector<Event> events_;
+  std::vector<Device *> devices_;
+  size_t next_;
+};
+
+} // namespace sensor
+
+#endif
@@ -0,0 +1,209 @@
+/**********************************************************************/
+/*! \file TriggerEngine.cpp
+    \brief Threshold and zone triggers on roll, pitch and yaw buckets.
+*/
+/**********************************************************************/
+
+#include "TriggerEngine.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+// As in OrientationMath.cpp, the compare loop is compiled once per
+// instruction set and the dynamic loader picks the best.
+#if defined(__x86_64__) && defined(__linux__) && defined(__GNUC__) && \
+    ( !defined(__clang__) || __clang_major__ >= 14 )
+  #define TRIGGER_TARGET_CLONES __attribute__(( target_clones( "avx2", "default" ) ))
+#else
+  #define TRIGGER_TARGET_CLONES
+#endif
+
+namespace sensor {
+
+// Before a trigger's first edge, so that edge is never debounced.
+static const int64_t longAgo = INT64_MIN / 2;
+
+// The next state of every lane, where group g's lanes, from first[g]
+// up to first[g + 1], see the input x[g].  The bounds are read before
+// each loop: next is bytes, which may alias them, and the compiler
+// would otherwise reload them every lane and not vectorise.
+TRIGGER_TARGET_CLONES
+static void thresholdLanes( const int16_t x[6], const unsigned int first[7], const int16_t *__restrict on,
+                            const int16_t *__restrict off, const uint8_t *__restrict state, uint8_t *__restrict next )
+{
+  for ( unsigned int g=0; g<6; g++ ) {
+    const int16_t input = x[g];
+    const unsigned int begin = first[g], end = first[g + 1];
+    for ( unsigned int i=begin; i<end; i++ )
+      next[i] = static_cast<uint8_t>( ( input > on[i] ) | ( state[i] & ( input > off[i] ) ) );
+  }
+}
+
+TriggerEngine :: TriggerEngine( AngleSteps steps )
+  : steps_( steps ), devices_( 0 )
+{
+  clear();
+}
+
+void TriggerEngine :: clear( void )
+{
+  on_.clear();
+  off_.clear();
+  debounce_.clear();
+  trigger_.clear();
+  lane_.clear();
+  for ( int g=0; g<7; g++ ) first_[g] = 0;
+  sets_.clear();
+  zoneOf_.clear();
+  low_.clear();
+  high_.clear();
+  grow( 0 );
+}
+
+unsigned int TriggerEngine :: addThreshold( Axis axis, bool below, int threshold, int hysteresis, int64_t debounce )
+{
+  if ( hysteresis < 0 ) throw std::invalid_argument( "TriggerEngine: negative hysteresis" );
+  threshold = std::max( -30000, std::min( 30000, threshold ) );
+  hysteresis = std::min( 30000, hysteresis );
+
+  // Insert the lane at the end of its group and move the later groups up.
+  unsigned int group = axis * 2 + ( below ? 1 : 0 );
+  unsigned int lane = first_[group + 1];
+  on_.insert( on_.begin() + lane, static_cast<int16_t>( below ? -threshold : threshold ) );
+  off_.insert( off_.begin() + lane, static_cast<int16_t>( below ? -threshold - hysteresis : threshold - hysteresis ) );
+  debounce_.insert( debounce_.begin() + lane, debounce );
+  for ( unsigned int g=group + 1; g<7; g++ ) first_[g]++;
+
+  unsigned int index = static_cast<unsigned int>( lane_.size() );
+  for ( size_t i=0; i<lane_.size(); i++ )
+    if ( lane_[i] >= lane ) lane_[i]++;
+  lane_.push_back( lane );
+  trigger_.insert( trigger_.begin() + lane, index );
+
+  // The lanes have moved, so the devices start again.
+  grow( 0 );
+  return index;
+}
+
+unsigned int TriggerEngine :: addZones( Axis axis, const std::vector<int> &bounds, int hysteresis, int64_t debounce )
+{
+  for ( size_t i=1; i<bounds.size(); i++ )
+    if ( bounds[i] <= bounds[i - 1] ) throw std::invalid_argument( "TriggerEngine: zone bounds must increase" );
+  if ( hysteresis < 0 ) throw std::invalid_argument( "TriggerEngine: negative hysteresis" );
+
+  ZoneSet set;
+  set.axis = axis;
+  set.table = static_cast<unsigned int>( zoneOf_.size() );
+  set.bounds = static_cast<unsigned int>( low_.size() );
+  set.hysteresis = std::min( 30000, hysteresis );
+  set.debounce = debounce;
+
+  int top = steps( axis );
+  size_t zone = 0;
+  for ( int v=0; v<=top; v++ ) {
+    while ( zone < bounds.size() && v >= bounds[zone] ) zone++;
+    zoneOf_.push_back( static_cast<int16_t>( zone ) );
+  }
+  for ( size_t z=0; z<=bounds.size(); z++ ) {
+    low_.push_back( static_cast<int16_t>( z == 0 ? 0 : std::max( -30000, std::min( 30000, bounds[z - 1] ) ) ) );
+    high_.push_back( static_cast<int16_t>( z == bounds.size() ? top : std::max( -30000, std::min( 30000, bounds[z] - 1 ) ) ) );
+  }
+
+  sets_.push_back( set );
+  grow( 0 );
+  return static_cast<unsigned int>( sets_.size() - 1 );
+}
+
+void TriggerEngine :: grow( unsigned int devices )
+{
+  if ( devices == 0 ) {
+    state_.clear();
+    lastEdge_.clear();
+    zone_.clear();
+    lastZoneEdge_.clear();
+  }
+  if ( devices <= devices_ && devices ) return;
+  devices_ = devices;
+  state_.resize( devices * stride(), 0 );
+  next_.assign( stride(), 0 );
+  lastEdge_.resize( devices * stride(), longAgo );
+  zone_.resize( devices * sets_.size(), -1 );
+  lastZoneEdge_.resize( devices * sets_.size(), longAgo );
+}
+
+size_t TriggerEngine :: update( unsigned int id, int roll, int pitch, int yaw, int64_t now )
+{
+  if ( id > devices_ ) grow( id );
+  edges_.clear();
+  int values[3] = { roll, pitch, yaw };
+  evaluate( id, values, now );
+  return edges_.size();
+}
+
+size_t TriggerEngine :: update( const int *roll, const int *pitch, const int *yaw, unsigned int devices, int64_t now )
+{
+  if ( devices > devices_ ) grow( devices );
+  edges_.clear();
+  for ( unsigned int i=0; i<devices; i++ ) {
+    int values[3] = { roll[i], pitch[i], yaw[i] };
+    evaluate( i + 1, values, now );
+  }
+  return edges_.size();
+}
+
+void TriggerEngine :: evaluate( unsigned int id, const int values[3], int64_t now )
+{
+  unsigned int count = lanes();
+  if ( count ) {
+    uint8_t *state = &state_[( id - 1 ) * stride()];
+    int16_t x[6];
+    for ( unsigned int a=0; a<3; a++ ) {
+      x[a * 2] = static_cast<int16_t>( std::max( -30000, std::min( 30000, values[a] ) ) );
+      x[a * 2 + 1] = static_cast<int16_t>( -x[a * 2] );
+    }
+    thresholdLanes( x, first_, &on_[0], &off_[0], state, &next_[0] );
+    scan( id, now );
+  }
+
+  for ( size_t s=0; s<sets_.size(); s++ ) {
+    const ZoneSet &set = sets_[s];
+    int v = std::max( 0, std::min( steps( set.axis ), values[set.axis] ) );
+    int16_t &zone = zone_[( id - 1 ) * sets_.size() + s];
+    if ( zone >= 0 && v >= low_[set.bounds + zone] - set.hysteresis && v <= high_[set.bounds + zone] + set.hysteresis )
+      continue;
+    int next = zoneOf_[set.table + v];
+    int64_t &last = lastZoneEdge_[( id - 1 ) * sets_.size() + s];
+    if ( next == zone || now - last < set.debounce ) continue;
+    TriggerEdge edge = { id, static_cast<unsigned int>( s ), true, zone, next };
+    edges_.push_back( edge );
+    zone = static_cast<int16_t>( next );
+    last = now;
+  }
+}
+
+void TriggerEngine :: scan( unsigned int id, int64_t now )
+{
+  unsigned int count = lanes();
+  uint8_t *state = &state_[( id - 1 ) * stride()];
+
+  // Edges are rare, so look for them eight lanes at a time.  The
+  // lanes past count in the last block are zero in both.
+  int64_t *last = &lastEdge_[( id - 1 ) * stride()];
+  for ( unsigned int block=0; block<count; block+=8 ) {
+    uint64_t before, after;
+    memcpy( &before, state + block, 8 );
+    memcpy( &after, &next_[block], 8 );
+    if ( before == after ) continue;
+    unsigned int end = std::min( count, block + 8 );
+    for ( unsigned int i=block; i<end; i++ ) {
+      if ( next_[i] == state[i] || now - last[i] < debounce_[i] ) continue;
+      TriggerEdge edge = { id, trigger_[i], false, state[i], next_[i] };
+      edges_.push_back( edge );
+      state[i] = next_[i];
+      last[i] = now;
+    }
+  }
+}
+
+} // namespace sensor
@@ -0,0 +1,179 @@
+/**********************************************************************/
+/*! \file TriggerEngine.h
+    \brief Threshold and zone triggers on roll, pitch and yaw buckets.
+
+    The gesture mappings latched their thresholds by hand: liveloop
+    fired above pitch 80 and re-armed below 81, a band too narrow to
+    stop chatter, and dj remembered the last drum it played instead.
+    A TriggerEngine holds every threshold of a mapping and evaluates
+    them together for each frame of a device.
+
+    A threshold trigger turns on when its axis passes the threshold
+    and off only once the axis is back past it by the hysteresis.  The
+    thresholds are kept as a structure of arrays grouped by axis and
+    direction, so one frame is a few branch-free compare loops over
+    contiguous arrays, which the compiler vectorises, and a scan for
+    changes eight lanes at a time.  A mapping with thresholds and no
+    zones can skip the buckets and have each threshold tested on the
+    quaternion by an AngleQuantiser instead.
+
+    A zone set divides an axis into bands at a list of bounds.  Its
+    current band is found from a table and kept until the axis leaves
+    it by the hysteresis, so a set costs the same however many zones
+    it has.
+
+    Each change of state is an edge; update() reports only edges.  A
+    trigger or zone set with a debounce time ignores an edge that comes
+    sooner than that after its previous one.  Each device has its own
+    states, indexed by Device::id().
+*/
+/**********************************************************************/
+
+#ifndef TRIGGERENGINE_H
+#define TRIGGERENGINE_H
+
+#include <stdint.h>
+#include <vector>
+#include "OrientationMath.h"
+
+namespace sensor {
+
+//! A change of a trigger's state or of a zone set's zone.
+struct TriggerEdge {
+  unsigned int device;
+  unsigned int index;    // the trigger or zone set
+  bool zone;             // index is a zone set
+  int from, to;          // off (0) and on (1), or zones; a zone set starts from -1
+};
+
+class TriggerEngine
+{
+ public:
+  enum Axis { roll, pitch, yaw };
+
+  //! Triggers on buckets of \e steps.
+  TriggerEngine( AngleSteps steps );
+
+  //! Add a trigger that turns on when \e axis goes above \e threshold (below, if \e below).  Returns its index.
+  /*!
+      It turns off once the axis is back at or below threshold -
+      hysteresis (at or above threshold + hysteresis).  \e debounce
+      is in microseconds of event time.
+  */
+  unsigned int addThreshold( Axis axis, bool below, int threshold, int hysteresis = 0, int64_t debounce = 0 );
+
+  //! Add zones on \e axis divided at \e bounds, which must increase.  Returns the set's index.
+  /*!
+      Zone 0 is below bounds[0], zone i from bounds[i - 1] up to
+      bounds[i], and the last zone from the last bound up.  A device
+      stays in a zone until the axis is \e hysteresis past its edge.
+  */
+  unsigned int addZones( Axis axis, const std::vector<int> &bounds, int hysteresis = 0, int64_t debounce = 0 );
+
+  //! Remove every trigger and zone set.
+  void clear( void );
+
+  //! Evaluate every trigger for device \e id's buckets at event time \e now.  Returns the number of edges.
+  size_t update( unsigned int id, int roll, int pitch, int yaw, int64_t now );
+
+  //! Evaluate every device, from arrays of \e devices buckets such as DeviceStateTable::rolls().
+  size_t update( const int *roll, const int *pitch, const int *yaw, unsigned int devices, int64_t now );
+
+  //! Evaluate the thresholds of device \e id straight from its orientation \e q.  Returns the number of edges.
+  /*!
+      \e quantiser is an AngleQuantiser with this engine's steps.  Each
+      threshold is a test of one bucket boundary on \e q, so no angle
+      is bucketed.  Zones need the buckets, so this is only for an
+      engine without zone sets.
+  */
+  template <class Quantiser>
+  size_t update( unsigned int id, const Quantiser &quantiser, const Quaternion &q, int64_t now );
+
+  //! The edges found by the last update().
+  const std::vector<TriggerEdge> &edges( void ) const { return edges_; }
+
+  //! Whether trigger \e index of device \e id is on.
+  bool state( unsigned int id, unsigned int index ) const
+  {
+    return id <= devices_ && state_[( id - 1 ) * stride() + lane_[index]] != 0;
+  }
+
+  //! The zone device \e id is in, or -1 before its first update().
+  int zone( unsigned int id, unsigned int set ) const
+  {
+    return id <= devices_ ? zone_[( id - 1 ) * sets_.size() + set] : -1;
+  }
+
+  unsigned int thresholds( void ) const { return static_cast<unsigned int>( lane_.size() ); }
+  unsigned int zoneSets( void ) const { return static_cast<unsigned int>( sets_.size() ); }
+
+ private:
+  struct ZoneSet {
+    unsigned int axis;
+    unsigned int table;     // first entry in zoneOf_ for bucket 0
+    unsigned int bounds;    // first entry in low_ and high_
+    int hysteresis;
+    int64_t debounce;
+  };
+
+  AngleSteps steps_;
+
+  // Thresholds, in lanes grouped by axis and direction: group g =
+  // axis * 2 + below holds lanes first_[g] up to first_[g + 1].  A
+  // below trigger is stored negated, so every lane turns on when its
+  // input is above on_ and stays on while it is above off_.
+  std::vector<int16_t> on_, off_;
+  std::vector<int64_t> debounce_;
+  std::vector<unsigned int> trigger_;  // lane to trigger index
+  std::vector<unsigned int> lane_;     // trigger index to lane
+  unsigned int first_[7];
+
+  std::vector<ZoneSet> sets_;
+  std::vector<int16_t> zoneOf_;        // zone of each bucket
+  std::vector<int16_t> low_, high_;    // each zone's lowest and highest bucket
+
+  // Per device, by id - 1.
+  unsigned int devices_;
+  std::vector<uint8_t> state_, next_;  // stride() per device; next_ holds one device's
+  std::vector<int64_t> lastEdge_;
+  std::vector<int16_t> zone_;
+  std::vector<int64_t> lastZoneEdge_;
+
+  std::vector<TriggerEdge> edges_;
+
+  unsigned int lanes( void ) const { return static_cast<unsigned int>( on_.size() ); }
+  unsigned int stride( void ) const { return ( lanes() + 7 ) & ~7u; }
+  int steps( unsigned int axis ) const { return axis == roll ? steps_.roll : axis == pitch ? steps_.pitch : steps_.yaw; }
+  void grow( unsigned int devices );
+  void evaluate( unsigned int id, const int values[3], int64_t now );
+  void scan( unsigned int id, int64_t now );
+};
+
+template <class Quantiser>
+size_t TriggerEngine :: update( unsigned int id, const Quantiser &quantiser, const Quaternion &q, int64_t now )
+{
+  if ( id > devices_ ) grow( id );
+  edges_.clear();
+  if ( lanes() == 0 ) return 0;
+
+  // A lane above its threshold t is on once the bucket reaches t + 1;
+  // a below lane, stored negated as -t, once the bucket is under t.
+  // On, a lane only needs the boundary it turns off at, and off only
+  // the one it turns on at, so each lane is one test.
+  const uint8_t *state = &state_[( id - 1 ) * stride()];
+  for ( unsigned int g=0; g<6; g++ ) {
+    int axis = g / 2;
+    bool below = ( g & 1 ) != 0;
+    for ( unsigned int i=first_[g]; i<first_[g + 1]; i++ ) {
+      int bound = state[i] ? off_[i] : on_[i];
+      bool on = below ? !quantiser.atLeast( axis, -bound, q ) : quantiser.atLeast( axis, bound + 1, q );
+      next_[i] = static_cast<uint8_t>( on );
+    }
+  }
+  scan( id, now );
+  return edges_.size();
+}
+
+} // namespace sensor
+
+#endif
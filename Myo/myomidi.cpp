@@ -0,0 +1,170 @@
+//*****************************************//
+//  myomidi.cpp
+//
+//  Plays armband gestures as MIDI through
+//  the rules in a mapping file.  The dj,
+//  instrument and liveloop programs are
+//  the mappings in Myo/mappings/.
+//
+//  usage: myomidi MAPPING [--clock BPM | --follow PORT] [--pace BYTES] [--log FILE] [SOURCE]
+//
+//*****************************************//
+
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "RtMidi.h"
+#include "MidiClock.h"
+#include "MidiClockFollower.h"
+#include "AsyncLog.h"
+#include "MidiOutQueue.h"
+#include "MidiScheduler.h"
+
+// Armband events come from a sensor::Source: the Myo hub, a recording or the synthetic generator.
+#include "SensorSource.h"
+#include "EventLoop.h"
+#include "MidiMapping.h"
+
+static void usage( void )
+{
+  std::cerr << "usage: myomidi MAPPING [--clock BPM | --follow PORT] [--pace BYTES] [--log FILE] [SOURCE]\n"
+            << "    MAPPING is a rules file such as Myo/mappings/dj.map.\n"
+            << "    --clock sends MIDI clock, start and stop at BPM on the same port.\n"
+            << "    --follow takes the clock from input PORT, a number or part of a name.\n"
+            << "    Either clock sets the grid for quantized rules.\n"
+            << "    --pace sends at most BYTES a second (3125 for a DIN port), notes before controllers.\n"
+            << "    --log writes each rule that fires to FILE.\n"
+            << "    SOURCE is --myo, --replay FILE [SPEED] or --synthetic [SPEED], and --record FILE.\n";
+}
+
+// Ctrl-C stops the loop, so the mapping ends its notes on the way out.
+static sensor::EventLoop *running = 0;
+
+static void interrupt( int )
+{
+  if ( running ) running->stop();
+}
+
+// The input port numbered \e name, or the first whose name contains it.
+static unsigned int findPort( RtMidiIn &in, const char *name )
+{
+  char *end;
+  unsigned long number = strtoul( name, &end, 10 );
+  if ( *name && *end == '\0' && number < in.getPortCount() ) return (unsigned int) number;
+  for ( unsigned int i=0; i<in.getPortCount(); i++ )
+    if ( in.getPortName( i ).find( name ) != std::string::npos ) return i;
+  throw std::runtime_error( std::string( "no MIDI input port '" ) + name + "'" );
+}
+
+int main( int argc, char *argv[] )
+{
+  if ( argc < 2 || argv[1][0] == '-' ) {
+    usage();
+    return 1;
+  }
+
+  RtMidiOut *midiout = 0;
+  try {
+    midiout = new RtMidiOut();
+    midiout->openVirtualPort();
+  }
+  catch ( RtMidiError &error ) {
+    error.printMessage();
+    delete midiout;
+    exit( EXIT_FAILURE );
+  }
+
+  try {
+    MidiScheduler scheduler;
+    std::unique_ptr<MidiOutQueue> queue;   // outlives the mapping, which sends through it
+    sensor::MidiMapping mapping( midiout, scheduler );
+    mapping.load( argv[1] );
+
+    // The rest of the command line chooses the source.
+    double bpm = 0.0;
+    unsigned int pace = 0;
+    const char *follow = 0, *logName = 0;
+    std::vector<char *> sourceArgs( 1, argv[0] );
+    for ( int i=2; i<argc; i++ ) {
+      if ( strcmp( argv[i], "--clock" ) == 0 && i + 1 < argc ) bpm = strtod( argv[++i], 0 );
+      else if ( strcmp( argv[i], "--follow" ) == 0 && i + 1 < argc ) follow = argv[++i];
+      else if ( strcmp( argv[i], "--pace" ) == 0 && i + 1 < argc ) pace = (unsigned int) strtoul( argv[++i], 0, 10 );
+      else if ( strcmp( argv[i], "--log" ) == 0 && i + 1 < argc ) logName = argv[++i];
+      else sourceArgs.push_back( argv[i] );
+    }
+    std::unique_ptr<sensor::Source> source( sensor::openSource( (int) sourceArgs.size(), &sourceArgs[0], "com.example.myomidi" ) );
+
+    // The log writes from its own thread, so logging never waits on the file.
+    std::ofstream logFile;
+    std::unique_ptr<AsyncLog> log;
+    if ( logName ) {
+      logFile.open( logName );
+      if ( !logFile ) throw std::runtime_error( std::string( "cannot write " ) + logName );
+      log.reset( new AsyncLog( logFile ) );
+      mapping.setLog( log.get() );
+    }
+
+    // On a slow link, notes and the clock go ahead of the controllers
+    // waiting, and only each controller's latest value waits.
+    if ( pace ) {
+      queue.reset( new MidiOutQueue( midiout, scheduler, pace ) );
+      mapping.setQueue( queue.get() );
+    }
+
+    std::cout << "Attempting to find a Myo..." << std::endl;
+    if ( !source->waitForDevice( 10000 ) )
+      throw std::runtime_error( "Unable to find a Myo!" );
+    std::cout << "Connected to a Myo armband!" << std::endl << std::endl;
+
+    // The status display draws from its own thread, so a slow terminal
+    // never holds up the MIDI.
+    sensor::StatusBoard board;
+    mapping.setStatusBoard( &board );
+    sensor::StatusDisplay display( board, std::cout );
+    display.start();
+
+    source->addListener( &mapping );
+    mapping.start();
+    std::unique_ptr<MidiClock> clock;
+    MidiClockFollower follower;
+    std::unique_ptr<RtMidiIn> clockIn;
+    if ( bpm > 0.0 ) {
+      clock.reset( new MidiClock( midiout, scheduler, bpm ) );
+      clock->setQueue( queue.get() );
+      clock->start();
+      mapping.setGrid( [&clock]( unsigned int ticks, int64_t time ) { return clock->timeOfNext( ticks, time ); } );
+    }
+    else if ( follow ) {
+      clockIn.reset( new RtMidiIn() );
+      follower.attach( clockIn.get() );
+      clockIn->openPort( findPort( *clockIn, follow ) );
+      mapping.setGrid( [&follower]( unsigned int ticks, int64_t time ) { return follower.timeOfNext( ticks, time ); } );
+    }
+
+    // The event loop sleeps until the next armband event or note-off,
+    // and ends when a recording runs out.
+    sensor::EventLoop loop( source.get() );
+    loop.setScheduler( &scheduler );
+    running = &loop;
+    std::signal( SIGINT, interrupt );
+    std::signal( SIGTERM, interrupt );
+    loop.run();
+    running = 0;
+    if ( clock ) clock->stop();
+    display.stop();
+  }
+  catch ( const std::exception &e ) {
+    std::cerr << "myomidi: " << e.what() << std::endl;
+    delete midiout;
+    return 1;
+  }
+
+  delete midiout;
+  return 0;
+}
@@ -37,7 +37,9 @@
 /**********************************************************************/
 
 #include "RtMidi.h"
+#include "MidiUmp.h"
 #include <sstream>
+#include <cstring>
 
 //*********************************************************************//
 //  RtMidi Definitions
@@ -78,6 +80,9 @@ void RtMidi :: getCompiledApi( std::vector<RtMidi::Api> &apis ) throw()
 #if defined(__WINDOWS_MM__)
   apis.push_back( WINDOWS_MM );
 #endif
+#if defined(__RTMIDI_LOOPBACK__)
+  apis.push_back( RTMIDI_LOOPBACK );
+#endif
 #if defined(__RTMIDI_DUMMY__)
   apis.push_back( RTMIDI_DUMMY );
 #endif
@@ -109,6 +114,10 @@ void RtMidiIn :: openMidiApi( RtMidi::Api api, const std::string clientName, uns
   if ( api == MACOSX_CORE )
     rtapi_ = new MidiInCore( clientName, queueSizeLimit );
 #endif
+#if defined(__RTMIDI_LOOPBACK__)
+  if ( api == RTMIDI_LOOPBACK )
+    rtapi_ = new MidiInLoopback( clientName, queueSizeLimit );
+#endif
 #if defined(__RTMIDI_DUMMY__)
   if ( api == RTMIDI_DUMMY )
     rtapi_ = new MidiInDummy( clientName, queueSizeLimit );
@@ -178,6 +187,10 @@ void RtMidiOut :: openMidiApi( RtMidi::Api api, const std::string clientName )
   if ( api == MACOSX_CORE )
     rtapi_ = new MidiOutCore( clientName );
 #endif
+#if defined(__RTMIDI_LOOPBACK__)
+  if ( api == RTMIDI_LOOPBACK )
+    rtapi_ = new MidiOutLoopback( clientName );
+#endif
 #if defined(__RTMIDI_DUMMY__)
   if ( api == RTMIDI_DUMMY )
     rtapi_ = new MidiOutDummy( clientName );
@@ -363,6 +376,23 @@ MidiOutApi :: ~MidiOutApi( void )
 {
 }
 
+void MidiOutApi :: sendUmp( const MidiUmp &packet )
+{
+  // Backends that only understand MIDI 1.0 byte streams get the
+  // packet converted here.  Packets without a MIDI 1.0 equivalent
+  // (per-note controllers, utility messages) are dropped.
+  unsigned char bytes[3];
+  size_t nBytes = midiUmpToMidi1( packet, bytes );
+  if ( nBytes > 0 ) sendMessage( bytes, nBytes );
+}
+
+bool MidiOutApi :: connectPort( unsigned int /*portNumber*/ )
+{
+  // Only backends that can fan one port out to several destinations
+  // override this.
+  return false;
+}
+
 // *************************************************** //
 //
 // OS/API-specific methods.
@@ -989,11 +1019,11 @@ void MidiOutCore :: openVirtualPort( std::string portName )
 //  free( sreq );
 //}
 
-void MidiOutCore :: sendMessage( std::vector<unsigned char> *message )
+void MidiOutCore :: sendMessage( const unsigned char *message, size_t size )
 {
   // We use the MIDISendSysex() function to asynchronously send sysex
   // messages.  Otherwise, we use a single CoreMidi MIDIPacket.
-  unsigned int nBytes = message->size();
+  unsigned int nBytes = static_cast<unsigned int>( size );
   if ( nBytes == 0 ) {
     errorString_ = "MidiOutCore::sendMessage: no data in message argument!";      
     error( RtMidiError::WARNING, errorString_ );
@@ -1051,7 +1081,7 @@ void MidiOutCore :: sendMessage( std::vector<unsigned char> *message )
 
   MIDIPacketList packetList;
   MIDIPacket *packet = MIDIPacketListInit( &packetList );
-  packet = MIDIPacketListAdd( &packetList, sizeof(packetList), packet, timeStamp, nBytes, (const Byte *) &message->at( 0 ) );
+  packet = MIDIPacketListAdd( &packetList, sizeof(packetList), packet, timeStamp, nBytes, (const Byte *) message );
   if ( !packet ) {
     errorString_ = "MidiOutCore::sendMessage: could not allocate packet list";      
     error( RtMidiError::DRIVER_ERROR, errorString_ );
@@ -1112,6 +1142,7 @@ struct AlsaMidiData {
   unsigned int portNum;
   int vport;
   snd_seq_port_subscribe_t *subscription;
+  std::vector<snd_seq_port_subscribe_t *> extraSubscriptions; // added with connectPort()
   snd_midi_event_t *coder;
   unsigned int bufferSize;
   unsigned char *buffer;
@@ -1829,12 +1860,62 @@ void MidiOutAlsa :: openPort( unsigned int portNumber, const std::string portNam
   connected_ = true;
 }
 
+bool MidiOutAlsa :: connectPort( unsigned int portNumber )
+{
+  // Every event is sent to the port's subscribers (see
+  // snd_seq_ev_set_subs() in sendMessage), so another destination is
+  // just another subscription on the same port.
+  if ( !connected_ ) return false;
+
+  snd_seq_port_info_t *pinfo;
+  snd_seq_port_info_alloca( &pinfo );
+  AlsaMidiData *data = static_cast<AlsaMidiData *> (apiData_);
+  if ( portInfo( data->seq, pinfo, SND_SEQ_PORT_CAP_WRITE|SND_SEQ_PORT_CAP_SUBS_WRITE, (int) portNumber ) == 0 ) {
+    std::ostringstream ost;
+    ost << "MidiOutAlsa::connectPort: the 'portNumber' argument (" << portNumber << ") is invalid.";
+    errorString_ = ost.str();
+    error( RtMidiError::INVALID_PARAMETER, errorString_ );
+    return false;
+  }
+
+  snd_seq_addr_t sender, receiver;
+  receiver.client = snd_seq_port_info_get_client( pinfo );
+  receiver.port = snd_seq_port_info_get_port( pinfo );
+  sender.client = snd_seq_client_id( data->seq );
+  sender.port = data->vport;
+
+  snd_seq_port_subscribe_t *subscription;
+  if ( snd_seq_port_subscribe_malloc( &subscription ) < 0 ) {
+    errorString_ = "MidiOutAlsa::connectPort: error allocating port subscription.";
+    error( RtMidiError::DRIVER_ERROR, errorString_ );
+    return false;
+  }
+  snd_seq_port_subscribe_set_sender( subscription, &sender );
+  snd_seq_port_subscribe_set_dest( subscription, &receiver );
+  snd_seq_port_subscribe_set_time_update( subscription, 1 );
+  snd_seq_port_subscribe_set_time_real( subscription, 1 );
+  if ( snd_seq_subscribe_port( data->seq, subscription ) ) {
+    snd_seq_port_subscribe_free( subscription );
+    errorString_ = "MidiOutAlsa::connectPort: ALSA error making port connection.";
+    error( RtMidiError::DRIVER_ERROR, errorString_ );
+    return false;
+  }
+
+  data->extraSubscriptions.push_back( subscription );
+  return true;
+}
+
 void MidiOutAlsa :: closePort( void )
 {
   if ( connected_ ) {
     AlsaMidiData *data = static_cast<AlsaMidiData *> (apiData_);
     snd_seq_unsubscribe_port( data->seq, data->subscription );
     snd_seq_port_subscribe_free( data->subscription );
+    for ( size_t i=0; i<data->extraSubscriptions.size(); ++i ) {
+      snd_seq_unsubscribe_port( data->seq, data->extraSubscriptions[i] );
+      snd_seq_port_subscribe_free( data->extraSubscriptions[i] );
+    }
+    data->extraSubscriptions.clear();
     connected_ = false;
   }
 }
@@ -1854,11 +1935,11 @@ void MidiOutAlsa :: openVirtualPort( std::string portName )
   }
 }
 
-void MidiOutAlsa :: sendMessage( std::vector<unsigned char> *message )
+void MidiOutAlsa :: sendMessage( const unsigned char *message, size_t size )
 {
   int result;
   AlsaMidiData *data = static_cast<AlsaMidiData *> (apiData_);
-  unsigned int nBytes = message->size();
+  unsigned int nBytes = static_cast<unsigned int>( size );
   if ( nBytes > data->bufferSize ) {
     data->bufferSize = nBytes;
     result = snd_midi_event_resize_buffer ( data->coder, nBytes);
@@ -1881,7 +1962,7 @@ void MidiOutAlsa :: sendMessage( std::vector<unsigned char> *message )
   snd_seq_ev_set_source(&ev, data->vport);
   snd_seq_ev_set_subs(&ev);
   snd_seq_ev_set_direct(&ev);
-  for ( unsigned int i=0; i<nBytes; ++i ) data->buffer[i] = message->at(i);
+  memcpy( data->buffer, message, nBytes );
   result = snd_midi_event_encode( data->coder, data->buffer, (long)nBytes, &ev );
   if ( result < (int)nBytes ) {
     errorString_ = "MidiOutAlsa::sendMessage: event parsing error!";
@@ -1899,6 +1980,85 @@ void MidiOutAlsa :: sendMessage( std::vector<unsigned char> *message )
   snd_seq_drain_output(data->seq);
 }
 
+void MidiOutAlsa :: sendUmp( const MidiUmp &packet )
+{
+  // Channel voice and real-time packets are written straight into a
+  // sequencer event, which skips the byte parser used by
+  // sendMessage().  Anything else takes the MIDI 1.0 byte path.
+  AlsaMidiData *data = static_cast<AlsaMidiData *> (apiData_);
+  snd_seq_event_t ev;
+  snd_seq_ev_clear(&ev);
+  snd_seq_ev_set_source(&ev, data->vport);
+  snd_seq_ev_set_subs(&ev);
+  snd_seq_ev_set_direct(&ev);
+
+  unsigned int type = packet.type();
+  unsigned int channel = packet.channel();
+  unsigned int index = packet.index();
+  uint32_t value = packet.word[1];
+
+  if ( type == MidiUmp::MIDI1_VOICE ) {
+    unsigned char bytes[3];
+    midiUmpToMidi1( packet, bytes );
+    switch ( packet.status() ) {
+    case MidiUmp::NOTE_ON: snd_seq_ev_set_noteon( &ev, channel, bytes[1], bytes[2] ); break;
+    case MidiUmp::NOTE_OFF: snd_seq_ev_set_noteoff( &ev, channel, bytes[1], bytes[2] ); break;
+    case MidiUmp::CONTROL_CHANGE: snd_seq_ev_set_controller( &ev, channel, bytes[1], bytes[2] ); break;
+    case MidiUmp::PROGRAM_CHANGE: snd_seq_ev_set_pgmchange( &ev, channel, bytes[1] ); break;
+    default: MidiOutApi::sendUmp( packet ); return;
+    }
+  }
+  else if ( type == MidiUmp::MIDI2_VOICE ) {
+    switch ( packet.status() ) {
+    case MidiUmp::NOTE_ON: {
+      unsigned int velocity = midiUmpScaleDown( value >> 16, 16, 7 );
+      snd_seq_ev_set_noteon( &ev, channel, index, velocity ? velocity : 1 );
+      break;
+    }
+    case MidiUmp::NOTE_OFF:
+      snd_seq_ev_set_noteoff( &ev, channel, index, midiUmpScaleDown( value >> 16, 16, 7 ) );
+      break;
+    case MidiUmp::POLY_PRESSURE:
+      snd_seq_ev_set_keypress( &ev, channel, index, midiUmpScaleDown( value, 32, 7 ) );
+      break;
+    case MidiUmp::CONTROL_CHANGE:
+      snd_seq_ev_set_controller( &ev, channel, index, midiUmpScaleDown( value, 32, 7 ) );
+      break;
+    case MidiUmp::PROGRAM_CHANGE:
+      snd_seq_ev_set_pgmchange( &ev, channel, ( value >> 24 ) & 0x7F );
+      break;
+    case MidiUmp::CHANNEL_PRESSURE:
+      snd_seq_ev_set_chanpress( &ev, channel, midiUmpScaleDown( value, 32, 7 ) );
+      break;
+    case MidiUmp::PITCH_BEND:
+      // ALSA pitch bend values are signed around zero.
+      snd_seq_ev_set_pitchbend( &ev, channel, (int) midiUmpScaleDown( value, 32, 14 ) - 8192 );
+      break;
+    default:
+      // Per-note controllers and per-note pitch bend have no MIDI 1.0 form.
+      return;
+    }
+  }
+  else if ( type == MidiUmp::SYSTEM ) {
+    switch ( ( packet.word[0] >> 16 ) & 0xFF ) {
+    case 0xF8: ev.type = SND_SEQ_EVENT_CLOCK; break;
+    case 0xFA: ev.type = SND_SEQ_EVENT_START; break;
+    case 0xFB: ev.type = SND_SEQ_EVENT_CONTINUE; break;
+    case 0xFC: ev.type = SND_SEQ_EVENT_STOP; break;
+    default: MidiOutApi::sendUmp( packet ); return;
+    }
+  }
+  else return;
+
+  int result = snd_seq_event_output(data->seq, &ev);
+  if ( result < 0 ) {
+    errorString_ = "MidiOutAlsa::sendUmp: error sending MIDI message to port.";
+    error( RtMidiError::WARNING, errorString_ );
+    return;
+  }
+  snd_seq_drain_output(data->seq);
+}
+
 #endif // __LINUX_ALSA__
 
 
@@ -2343,11 +2503,11 @@ void MidiOutWinMM :: openVirtualPort( std::string /*portName*/ )
   error( RtMidiError::WARNING, errorString_ );
 }
 
-void MidiOutWinMM :: sendMessage( std::vector<unsigned char> *message )
+void MidiOutWinMM :: sendMessage( const unsigned char *message, size_t size )
 {
   if ( !connected_ ) return;
 
-  unsigned int nBytes = static_cast<unsigned int>(message->size());
+  unsigned int nBytes = static_cast<unsigned int>(size);
   if ( nBytes == 0 ) {
     errorString_ = "MidiOutWinMM::sendMessage: message argument is empty!";
     error( RtMidiError::WARNING, errorString_ );
@@ -2356,7 +2516,7 @@ void MidiOutWinMM :: sendMessage( std::vector<unsigned char> *message )
 
   MMRESULT result;
   WinMidiData *data = static_cast<WinMidiData *> (apiData_);
-  if ( message->at(0) == 0xF0 ) { // Sysex message
+  if ( message[0] == 0xF0 ) { // Sysex message
 
     // Allocate buffer for sysex data.
     char *buffer = (char *) malloc( nBytes );
@@ -2367,7 +2527,7 @@ void MidiOutWinMM :: sendMessage( std::vector<unsigned char> *message )
     }
 
     // Copy data to buffer.
-    for ( unsigned int i=0; i<nBytes; ++i ) buffer[i] = message->at(i);
+    for ( unsigned int i=0; i<nBytes; ++i ) buffer[i] = message[i];
 
     // Create and prepare MIDIHDR structure.
     MIDIHDR sysex;
@@ -2408,7 +2568,7 @@ void MidiOutWinMM :: sendMessage( std::vector<unsigned char> *message )
     DWORD packet;
     unsigned char *ptr = (unsigned char *) &packet;
     for ( unsigned int i=0; i<nBytes; ++i ) {
-      *ptr = message->at(i);
+      *ptr = message[i];
       ++ptr;
     }
 
@@ -2825,15 +2985,448 @@ void MidiOutJack :: closePort()
   data->port = NULL;
 }
 
-void MidiOutJack :: sendMessage( std::vector<unsigned char> *message )
+void MidiOutJack :: sendMessage( const unsigned char *message, size_t size )
 {
-  int nBytes = message->size();
+  int nBytes = static_cast<int>( size );
   JackMidiData *data = static_cast<JackMidiData *> (apiData_);
 
   // Write full message to buffer
-  jack_ringbuffer_write( data->buffMessage, ( const char * ) &( *message )[0],
-                         message->size() );
+  jack_ringbuffer_write( data->buffMessage, ( const char * ) message, size );
   jack_ringbuffer_write( data->buffSize, ( char * ) &nBytes, sizeof( nBytes ) );
 }
 
 #endif  // __UNIX_JACK__
+
+
+//*********************************************************************//
+//  API: LOOPBACK
+//*********************************************************************//
+
+#if defined(__RTMIDI_LOOPBACK__)
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+// The bus keeps every open virtual port.  Virtual inputs are listed
+// as ports by MidiOutLoopback and virtual outputs are listed as ports
+// by MidiInLoopback.  All connection changes happen with loopbackMutex
+// held.  A send copies its receivers under the lock and counts a
+// delivery in to each, then delivers with the lock released, so an
+// input callback may itself send, open or close loopback ports.  An
+// input being closed waits for the deliveries counted in to it.  An
+// input may be closed or deleted from one of its own callbacks.
+static std::mutex loopbackMutex;
+static std::vector<MidiInLoopback *> loopbackVirtualInputs;
+static std::vector<MidiOutLoopback *> loopbackVirtualOutputs;
+static std::vector<MidiOutLoopback *> loopbackOutputs;
+
+struct LoopbackInData {
+  MidiInLoopback *input;
+  std::string portName;
+  MidiOutLoopback *source;     // the port opened with openPort(), if any
+  bool isVirtual;
+  std::chrono::steady_clock::time_point lastTime;
+  std::recursive_mutex deliverMutex; // one delivery at a time, as from an input thread
+  std::atomic<int> inFlight;   // deliveries counted in and not yet done
+  bool orphaned;               // the input was deleted from inside a delivery
+};
+
+// The inputs whose callbacks this thread is inside, innermost last.
+static thread_local std::vector<MidiInLoopback *> loopbackDelivering;
+
+// One delivery's hold on an input: its delivery lock, its place on
+// this thread's stack and its count in inFlight.  All are let go
+// however the callback leaves, by returning or throwing.  If the
+// input was deleted from inside a callback, the last delivery to let
+// go deletes its data.
+class LoopbackDelivery
+{
+ public:
+  LoopbackDelivery( LoopbackInData *data ) : data_( data )
+  {
+    data_->deliverMutex.lock();
+    loopbackDelivering.push_back( data_->input );
+  }
+  ~LoopbackDelivery( void )
+  {
+    loopbackDelivering.pop_back();
+    bool last = --data_->inFlight == 0 && data_->orphaned;
+    data_->deliverMutex.unlock();
+    if ( last ) delete data_;
+  }
+
+ private:
+  LoopbackInData *data_;
+
+  LoopbackDelivery( const LoopbackDelivery & );
+  LoopbackDelivery &operator=( const LoopbackDelivery & );
+};
+
+struct LoopbackOutData {
+  std::string portName;
+  std::vector<MidiInLoopback *> destinations; // from openPort() and connectPort()
+  std::vector<MidiInLoopback *> subscribers;
+  bool isVirtual;
+  std::atomic<int> receivers;  // destinations plus subscribers, read without the lock
+  unsigned long long messageCount;
+};
+
+template <class T>
+static void loopbackErase( std::vector<T *> &list, T *item )
+{
+  list.erase( std::remove( list.begin(), list.end(), item ), list.end() );
+}
+
+//*********************************************************************//
+//  API: LOOPBACK
+//  Class Definitions: MidiInLoopback
+//*********************************************************************//
+
+MidiInLoopback :: MidiInLoopback( const std::string clientName, unsigned int queueSizeLimit ) : MidiInApi( queueSizeLimit )
+{
+  initialize( clientName );
+}
+
+MidiInLoopback :: ~MidiInLoopback( void )
+{
+  closePort();
+
+  // Deleted from inside one of its own callbacks: the deliveries still
+  // hold the data, and the last to finish deletes it.
+  LoopbackInData *data = static_cast<LoopbackInData *> (apiData_);
+  if ( std::find( loopbackDelivering.begin(), loopbackDelivering.end(), this ) != loopbackDelivering.end() ) {
+    data->orphaned = true;
+    return;
+  }
+  delete data;
+}
+
+void MidiInLoopback :: initialize( const std::string& /*clientName*/ )
+{
+  LoopbackInData *data = new LoopbackInData;
+  data->input = this;
+  data->orphaned = false;
+  data->source = 0;
+  data->isVirtual = false;
+  data->inFlight = 0;
+  apiData_ = (void *) data;
+  inputData_.apiData = (void *) data;
+}
+
+unsigned int MidiInLoopback :: getPortCount( void )
+{
+  std::lock_guard<std::mutex> lock( loopbackMutex );
+  return static_cast<unsigned int>( loopbackVirtualOutputs.size() );
+}
+
+std::string MidiInLoopback :: getPortName( unsigned int portNumber )
+{
+  std::lock_guard<std::mutex> lock( loopbackMutex );
+  if ( portNumber < loopbackVirtualOutputs.size() )
+    return static_cast<LoopbackOutData *> ( loopbackVirtualOutputs[portNumber]->apiData_ )->portName;
+
+  std::ostringstream ost;
+  ost << "MidiInLoopback::getPortName: the 'portNumber' argument (" << portNumber << ") is invalid.";
+  errorString_ = ost.str();
+  error( RtMidiError::WARNING, errorString_ );
+  return std::string();
+}
+
+void MidiInLoopback :: openPort( unsigned int portNumber, const std::string portName )
+{
+  if ( connected_ ) {
+    errorString_ = "MidiInLoopback::openPort: a valid connection already exists!";
+    error( RtMidiError::WARNING, errorString_ );
+    return;
+  }
+
+  LoopbackInData *data = static_cast<LoopbackInData *> (apiData_);
+  {
+    std::lock_guard<std::mutex> lock( loopbackMutex );
+    if ( portNumber < loopbackVirtualOutputs.size() ) {
+      MidiOutLoopback *source = loopbackVirtualOutputs[portNumber];
+      LoopbackOutData *sourceData = static_cast<LoopbackOutData *> ( source->apiData_ );
+      sourceData->subscribers.push_back( this );
+      sourceData->receivers++;
+      data->source = source;
+      data->portName = portName;
+      data->lastTime = std::chrono::steady_clock::now();
+      inputData_.firstMessage = true;
+      connected_ = true;
+      return;
+    }
+  }
+
+  std::ostringstream ost;
+  ost << "MidiInLoopback::openPort: the 'portNumber' argument (" << portNumber << ") is invalid.";
+  errorString_ = ost.str();
+  error( RtMidiError::INVALID_PARAMETER, errorString_ );
+}
+
+void MidiInLoopback :: openVirtualPort( const std::string portName )
+{
+  LoopbackInData *data = static_cast<LoopbackInData *> (apiData_);
+  std::lock_guard<std::mutex> lock( loopbackMutex );
+  if ( data->isVirtual ) return;
+  data->isVirtual = true;
+  data->portName = portName;
+  data->lastTime = std::chrono::steady_clock::now();
+  inputData_.firstMessage = true;
+  loopbackVirtualInputs.push_back( this );
+}
+
+void MidiInLoopback :: closePort( void )
+{
+  LoopbackInData *data = static_cast<LoopbackInData *> (apiData_);
+  {
+    std::lock_guard<std::mutex> lock( loopbackMutex );
+    unlink();
+  }
+
+  // No send can count a delivery in now.  Wait for those already
+  // counted and for the last to let go of the input, unless this
+  // thread is inside one (a callback closing its own port) and so
+  // holds the input itself.
+  if ( std::find( loopbackDelivering.begin(), loopbackDelivering.end(), this ) != loopbackDelivering.end() ) return;
+  while ( data->inFlight > 0 ) std::this_thread::yield();
+  std::lock_guard<std::recursive_mutex> wait( data->deliverMutex );
+}
+
+// Take the input off the bus.  Called with loopbackMutex held.
+void MidiInLoopback :: unlink( void )
+{
+  LoopbackInData *data = static_cast<LoopbackInData *> (apiData_);
+  if ( data->source ) {
+    LoopbackOutData *sourceData = static_cast<LoopbackOutData *> ( data->source->apiData_ );
+    loopbackErase( sourceData->subscribers, this );
+    sourceData->receivers--;
+    data->source = 0;
+  }
+
+  if ( data->isVirtual ) {
+    // Disconnect any outputs that opened this port.
+    for ( size_t i=0; i<loopbackOutputs.size(); ++i ) {
+      LoopbackOutData *outData = static_cast<LoopbackOutData *> ( loopbackOutputs[i]->apiData_ );
+      size_t before = outData->destinations.size();
+      loopbackErase( outData->destinations, this );
+      if ( outData->destinations.size() == before ) continue;
+      outData->receivers -= static_cast<int>( before - outData->destinations.size() );
+      if ( outData->destinations.empty() ) loopbackOutputs[i]->connected_ = false;
+    }
+    loopbackErase( loopbackVirtualInputs, this );
+    data->isVirtual = false;
+  }
+
+  connected_ = false;
+}
+
+void MidiInLoopback :: deliver( void *inputData, const unsigned char *message, size_t size )
+{
+  LoopbackInData *data = static_cast<LoopbackInData *> (inputData);
+  LoopbackDelivery delivery( data );
+  if ( !data->orphaned ) data->input->receive( message, size );
+}
+
+// Filter, timestamp and hand on one message, with the input's
+// deliverMutex held.
+void MidiInLoopback :: receive( const unsigned char *message, size_t size )
+{
+  LoopbackInData *data = static_cast<LoopbackInData *> (apiData_);
+  MidiInApi::RtMidiInData *input = &inputData_;
+
+  // Apply the same filtering as the system backends.
+  unsigned char status = message[0];
+  if ( ( input->ignoreFlags & 0x01 ) && status == 0xF0 ) return;
+  if ( ( input->ignoreFlags & 0x02 ) && ( status == 0xF1 || status == 0xF8 || status == 0xF9 ) ) return;
+  if ( ( input->ignoreFlags & 0x04 ) && status == 0xFE ) return;
+
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  MidiMessage &midiMessage = input->message;
+  midiMessage.bytes.assign( message, message + size );
+  midiMessage.timeStamp = 0.0;
+  if ( input->firstMessage )
+    input->firstMessage = false;
+  else
+    midiMessage.timeStamp = std::chrono::duration<double>( now - data->lastTime ).count();
+  data->lastTime = now;
+
+  if ( input->usingCallback ) {
+    RtMidiIn::RtMidiCallback callback = (RtMidiIn::RtMidiCallback) input->userCallback;
+    callback( midiMessage.timeStamp, &midiMessage.bytes, input->userData );
+  }
+  else {
+    // As long as we haven't reached our queue size limit, push the message.
+    if ( input->queue.size < input->queue.ringSize ) {
+      input->queue.ring[input->queue.back++] = midiMessage;
+      if ( input->queue.back == input->queue.ringSize )
+        input->queue.back = 0;
+      input->queue.size++;
+    }
+    else
+      std::cerr << "\nMidiInLoopback: message queue limit reached!!\n\n";
+  }
+}
+
+//*********************************************************************//
+//  API: LOOPBACK
+//  Class Definitions: MidiOutLoopback
+//*********************************************************************//
+
+MidiOutLoopback :: MidiOutLoopback( const std::string clientName ) : MidiOutApi()
+{
+  initialize( clientName );
+}
+
+MidiOutLoopback :: ~MidiOutLoopback( void )
+{
+  closePort();
+
+  // Unsubscribe any inputs still listening to our virtual port.
+  LoopbackOutData *data = static_cast<LoopbackOutData *> (apiData_);
+  {
+    std::lock_guard<std::mutex> lock( loopbackMutex );
+    for ( size_t i=0; i<data->subscribers.size(); ++i ) {
+      LoopbackInData *inData = static_cast<LoopbackInData *> ( data->subscribers[i]->apiData_ );
+      inData->source = 0;
+    }
+    if ( data->isVirtual ) loopbackErase( loopbackVirtualOutputs, this );
+    loopbackErase( loopbackOutputs, this );
+  }
+  delete data;
+}
+
+void MidiOutLoopback :: initialize( const std::string& /*clientName*/ )
+{
+  LoopbackOutData *data = new LoopbackOutData;
+  data->isVirtual = false;
+  data->receivers = 0;
+  data->messageCount = 0;
+  apiData_ = (void *) data;
+
+  std::lock_guard<std::mutex> lock( loopbackMutex );
+  loopbackOutputs.push_back( this );
+}
+
+unsigned int MidiOutLoopback :: getPortCount( void )
+{
+  std::lock_guard<std::mutex> lock( loopbackMutex );
+  return static_cast<unsigned int>( loopbackVirtualInputs.size() );
+}
+
+std::string MidiOutLoopback :: getPortName( unsigned int portNumber )
+{
+  std::lock_guard<std::mutex> lock( loopbackMutex );
+  if ( portNumber < loopbackVirtualInputs.size() )
+    return static_cast<LoopbackInData *> ( loopbackVirtualInputs[portNumber]->apiData_ )->portName;
+
+  std::ostringstream ost;
+  ost << "MidiOutLoopback::getPortName: the 'portNumber' argument (" << portNumber << ") is invalid.";
+  errorString_ = ost.str();
+  error( RtMidiError::WARNING, errorString_ );
+  return std::string();
+}
+
+void MidiOutLoopback :: openPort( unsigned int portNumber, const std::string portName )
+{
+  if ( connected_ ) {
+    errorString_ = "MidiOutLoopback::openPort: a valid connection already exists!";
+    error( RtMidiError::WARNING, errorString_ );
+    return;
+  }
+
+  LoopbackOutData *data = static_cast<LoopbackOutData *> (apiData_);
+  {
+    std::lock_guard<std::mutex> lock( loopbackMutex );
+    if ( portNumber < loopbackVirtualInputs.size() ) {
+      data->destinations.push_back( loopbackVirtualInputs[portNumber] );
+      data->portName = portName;
+      data->receivers++;
+      connected_ = true;
+      return;
+    }
+  }
+
+  std::ostringstream ost;
+  ost << "MidiOutLoopback::openPort: the 'portNumber' argument (" << portNumber << ") is invalid.";
+  errorString_ = ost.str();
+  error( RtMidiError::INVALID_PARAMETER, errorString_ );
+}
+
+void MidiOutLoopback :: openVirtualPort( const std::string portName )
+{
+  LoopbackOutData *data = static_cast<LoopbackOutData *> (apiData_);
+  std::lock_guard<std::mutex> lock( loopbackMutex );
+  if ( data->isVirtual ) return;
+  data->isVirtual = true;
+  data->portName = portName;
+  loopbackVirtualOutputs.push_back( this );
+}
+
+void MidiOutLoopback :: closePort( void )
+{
+  LoopbackOutData *data = static_cast<LoopbackOutData *> (apiData_);
+  std::lock_guard<std::mutex> lock( loopbackMutex );
+  data->receivers -= static_cast<int>( data->destinations.size() );
+  data->destinations.clear();
+  connected_ = false;
+}
+
+bool MidiOutLoopback :: connectPort( unsigned int portNumber )
+{
+  if ( !connected_ ) return false;
+
+  LoopbackOutData *data = static_cast<LoopbackOutData *> (apiData_);
+  {
+    std::lock_guard<std::mutex> lock( loopbackMutex );
+    if ( portNumber < loopbackVirtualInputs.size() ) {
+      data->destinations.push_back( loopbackVirtualInputs[portNumber] );
+      data->receivers++;
+      return true;
+    }
+  }
+
+  std::ostringstream ost;
+  ost << "MidiOutLoopback::connectPort: the 'portNumber' argument (" << portNumber << ") is invalid.";
+  errorString_ = ost.str();
+  error( RtMidiError::INVALID_PARAMETER, errorString_ );
+  return false;
+}
+
+void MidiOutLoopback :: sendMessage( const unsigned char *message, size_t size )
+{
+  LoopbackOutData *data = static_cast<LoopbackOutData *> (apiData_);
+  data->messageCount++;
+  if ( size == 0 || data->receivers == 0 ) return;
+
+  // Copy the receivers and count a delivery in to each under the lock,
+  // then deliver without it.  A few receivers fit on the stack.
+  LoopbackInData *fixed[8];
+  std::vector<LoopbackInData *> spill;
+  LoopbackInData **receivers = fixed;
+  size_t count;
+  {
+    std::lock_guard<std::mutex> lock( loopbackMutex );
+    count = data->destinations.size() + data->subscribers.size();
+    if ( count > 8 ) {
+      spill.resize( count );
+      receivers = &spill[0];
+    }
+    for ( size_t i=0; i<count; ++i ) {
+      MidiInLoopback *input = i < data->destinations.size() ? data->destinations[i] : data->subscribers[i - data->destinations.size()];
+      receivers[i] = static_cast<LoopbackInData *> ( input->apiData_ );
+      receivers[i]->inFlight++;
+    }
+  }
+  for ( size_t i=0; i<count; ++i )
+    MidiInLoopback::deliver( receivers[i], message, size );
+}
+
+unsigned long long MidiOutLoopback :: getMessageCount( void ) const
+{
+  return static_cast<const LoopbackOutData *> (apiData_)->messageCount;
+}
+
+#endif  // __RTMIDI_LOOPBACK__
@@ -112,6 +112,7 @@ class RtMidiError : public std::exception
 typedef void (*RtMidiErrorCallback)( RtMidiError::Type type, const std::string &errorText );
 
 class MidiApi;
+struct MidiUmp;
 
 class RtMidi
 {
@@ -124,7 +125,8 @@ class RtMidi
     LINUX_ALSA,     /*!< The Advanced Linux Sound Architecture API. */
     UNIX_JACK,      /*!< The JACK Low-Latency MIDI Server API. */
     WINDOWS_MM,     /*!< The Microsoft Multimedia MIDI API. */
-    RTMIDI_DUMMY    /*!< A compilable but non-functional API. */
+    RTMIDI_DUMMY,   /*!< A compilable but non-functional API. */
+    RTMIDI_LOOPBACK /*!< An in-process MIDI bus for testing and benchmarking. */
   };
 
   //! A static function to determine the current RtMidi version.
@@ -375,6 +377,17 @@ class RtMidiOut : public RtMidi
   */
   void openPort( unsigned int portNumber = 0, const std::string portName = std::string( "RtMidi Output" ) );
 
+  //! Connect the open output port to one more destination.
+  /*!
+      With the Linux ALSA and loopback APIs an output port can feed
+      several destinations, so each message is encoded and sent once
+      however many destinations are connected.  Returns true if \e
+      portNumber was added to the connection made by openPort(), and
+      false if the API cannot do this or no port is open.  An
+      exception is thrown if the port number is invalid.
+  */
+  bool connectPort( unsigned int portNumber );
+
   //! Close an open MIDI connection (if one exists).
   void closePort( void );
 
@@ -408,6 +421,29 @@ class RtMidiOut : public RtMidi
   */
   void sendMessage( std::vector<unsigned char> *message );
 
+  //! Immediately send a single message, given as a byte array, out an open MIDI output port.
+  /*!
+      This avoids building a std::vector for fixed-size messages.  An
+      exception is thrown if an error occurs during output or an
+      output connection was not previously established.
+  */
+  void sendMessage( const unsigned char *message, size_t size );
+
+  //! Immediately send a fixed-size message object (see MidiMessages.h).
+  /*!
+      Any type with data() and size() members can be passed, so the
+      message bytes go to the backend without an intermediate copy.
+  */
+  template <class Message>
+  void send( const Message &message ) { sendMessage( message.data(), message.size() ); }
+
+  //! Immediately send a single Universal MIDI Packet out an open MIDI output port.
+  /*!
+      MIDI 1.0 backends convert the packet at the output boundary (see
+      MidiUmp.h).  Packets without a MIDI 1.0 equivalent are dropped.
+  */
+  void sendUmp( const MidiUmp &packet );
+
   //! Set an error callback function to be invoked when an error has occured.
   /*!
     The callback function will be called whenever an error has occured. It is best
@@ -527,7 +563,9 @@ class MidiOutApi : public MidiApi
 
   MidiOutApi( void );
   virtual ~MidiOutApi( void );
-  virtual void sendMessage( std::vector<unsigned char> *message ) = 0;
+  virtual void sendMessage( const unsigned char *message, size_t size ) = 0;
+  virtual void sendUmp( const MidiUmp &packet );
+  virtual bool connectPort( unsigned int portNumber );
 };
 
 // **************************************************************** //
@@ -541,22 +579,25 @@ inline void RtMidiIn :: openPort( unsigned int portNumber, const std::string por
 inline void RtMidiIn :: openVirtualPort( const std::string portName ) { rtapi_->openVirtualPort( portName ); }
 inline void RtMidiIn :: closePort( void ) { rtapi_->closePort(); }
 inline bool RtMidiIn :: isPortOpen() const { return rtapi_->isPortOpen(); }
-inline void RtMidiIn :: setCallback( RtMidiCallback callback, void *userData ) { ((MidiInApi *)rtapi_)->setCallback( callback, userData ); }
-inline void RtMidiIn :: cancelCallback( void ) { ((MidiInApi *)rtapi_)->cancelCallback(); }
+inline void RtMidiIn :: setCallback( RtMidiCallback callback, void *userData ) { static_cast<MidiInApi *>( rtapi_ )->setCallback( callback, userData ); }
+inline void RtMidiIn :: cancelCallback( void ) { static_cast<MidiInApi *>( rtapi_ )->cancelCallback(); }
 inline unsigned int RtMidiIn :: getPortCount( void ) { return rtapi_->getPortCount(); }
 inline std::string RtMidiIn :: getPortName( unsigned int portNumber ) { return rtapi_->getPortName( portNumber ); }
-inline void RtMidiIn :: ignoreTypes( bool midiSysex, bool midiTime, bool midiSense ) { ((MidiInApi *)rtapi_)->ignoreTypes( midiSysex, midiTime, midiSense ); }
-inline double RtMidiIn :: getMessage( std::vector<unsigned char> *message ) { return ((MidiInApi *)rtapi_)->getMessage( message ); }
+inline void RtMidiIn :: ignoreTypes( bool midiSysex, bool midiTime, bool midiSense ) { static_cast<MidiInApi *>( rtapi_ )->ignoreTypes( midiSysex, midiTime, midiSense ); }
+inline double RtMidiIn :: getMessage( std::vector<unsigned char> *message ) { return static_cast<MidiInApi *>( rtapi_ )->getMessage( message ); }
 inline void RtMidiIn :: setErrorCallback( RtMidiErrorCallback errorCallback ) { rtapi_->setErrorCallback(errorCallback); }
 
 inline RtMidi::Api RtMidiOut :: getCurrentApi( void ) throw() { return rtapi_->getCurrentApi(); }
 inline void RtMidiOut :: openPort( unsigned int portNumber, const std::string portName ) { rtapi_->openPort( portNumber, portName ); }
 inline void RtMidiOut :: openVirtualPort( const std::string portName ) { rtapi_->openVirtualPort( portName ); }
+inline bool RtMidiOut :: connectPort( unsigned int portNumber ) { return static_cast<MidiOutApi *>( rtapi_ )->connectPort( portNumber ); }
 inline void RtMidiOut :: closePort( void ) { rtapi_->closePort(); }
 inline bool RtMidiOut :: isPortOpen() const { return rtapi_->isPortOpen(); }
 inline unsigned int RtMidiOut :: getPortCount( void ) { return rtapi_->getPortCount(); }
 inline std::string RtMidiOut :: getPortName( unsigned int portNumber ) { return rtapi_->getPortName( portNumber ); }
-inline void RtMidiOut :: sendMessage( std::vector<unsigned char> *message ) { ((MidiOutApi *)rtapi_)->sendMessage( message ); }
+inline void RtMidiOut :: sendMessage( std::vector<unsigned char> *message ) { static_cast<MidiOutApi *>( rtapi_ )->sendMessage( message->empty() ? 0 : &message->at( 0 ), message->size() ); }
+inline void RtMidiOut :: sendMessage( const unsigned char *message, size_t size ) { static_cast<MidiOutApi *>( rtapi_ )->sendMessage( message, size ); }
+inline void RtMidiOut :: sendUmp( const MidiUmp &packet ) { static_cast<MidiOutApi *>( rtapi_ )->sendUmp( packet ); }
 inline void RtMidiOut :: setErrorCallback( RtMidiErrorCallback errorCallback ) { rtapi_->setErrorCallback(errorCallback); }
 
 // **************************************************************** //
@@ -565,7 +606,7 @@ inline void RtMidiOut :: setErrorCallback( RtMidiErrorCallback errorCallback ) {
 //
 // **************************************************************** //
 
-#if !defined(__LINUX_ALSA__) && !defined(__UNIX_JACK__) && !defined(__MACOSX_CORE__) && !defined(__WINDOWS_MM__)
+#if !defined(__LINUX_ALSA__) && !defined(__UNIX_JACK__) && !defined(__MACOSX_CORE__) && !defined(__WINDOWS_MM__) && !defined(__RTMIDI_LOOPBACK__)
   #define __RTMIDI_DUMMY__
 #endif
 
@@ -598,7 +639,7 @@ class MidiOutCore: public MidiOutApi
   void closePort( void );
   unsigned int getPortCount( void );
   std::string getPortName( unsigned int portNumber );
-  void sendMessage( std::vector<unsigned char> *message );
+  void sendMessage( const unsigned char *message, size_t size );
 
  protected:
   void initialize( const std::string& clientName );
@@ -638,7 +679,7 @@ class MidiOutJack: public MidiOutApi
   void closePort( void );
   unsigned int getPortCount( void );
   std::string getPortName( unsigned int portNumber );
-  void sendMessage( std::vector<unsigned char> *message );
+  void sendMessage( const unsigned char *message, size_t size );
 
  protected:
   std::string clientName;
@@ -678,7 +719,9 @@ class MidiOutAlsa: public MidiOutApi
   void closePort( void );
   unsigned int getPortCount( void );
   std::string getPortName( unsigned int portNumber );
-  void sendMessage( std::vector<unsigned char> *message );
+  void sendMessage( const unsigned char *message, size_t size );
+  void sendUmp( const MidiUmp &packet );
+  bool connectPort( unsigned int portNumber );
 
  protected:
   void initialize( const std::string& clientName );
@@ -715,7 +758,7 @@ class MidiOutWinMM: public MidiOutApi
   void closePort( void );
   unsigned int getPortCount( void );
   std::string getPortName( unsigned int portNumber );
-  void sendMessage( std::vector<unsigned char> *message );
+  void sendMessage( const unsigned char *message, size_t size );
 
  protected:
   void initialize( const std::string& clientName );
@@ -750,7 +793,7 @@ class MidiOutDummy: public MidiOutApi
   void closePort( void ) {}
   unsigned int getPortCount( void ) { return 0; }
   std::string getPortName( unsigned int /*portNumber*/ ) { return ""; }
-  void sendMessage( std::vector<unsigned char> * /*message*/ ) {}
+  void sendMessage( const unsigned char * /*message*/, size_t /*size*/ ) {}
 
  protected:
   void initialize( const std::string& /*clientName*/ ) {}
@@ -758,4 +801,137 @@ class MidiOutDummy: public MidiOutApi
 
 #endif
 
+#if defined(__RTMIDI_LOOPBACK__)
+
+// The loopback API is an in-process MIDI bus.  A virtual port opened
+// on one side is listed as a port on the other side, so an RtMidiOut
+// and an RtMidiIn in the same process can be wired together without
+// any system MIDI service.  Messages are delivered synchronously on
+// the sending thread.
+
+class MidiInLoopback: public MidiInApi
+{
+ public:
+  MidiInLoopback( const std::string clientName, unsigned int queueSizeLimit );
+  ~MidiInLoopback( void );
+  RtMidi::Api getCurrentApi( void ) { return RtMidi::RTMIDI_LOOPBACK; };
+  void openPort( unsigned int portNumber, const std::string portName );
+  void openVirtualPort( const std::string portName );
+  void closePort( void );
+  unsigned int getPortCount( void );
+  std::string getPortName( unsigned int portNumber );
+
+  // Called by MidiOutLoopback for each message, with the input's
+  // apiData_, after it has counted the delivery in and released the
+  // bus.  The input may have been deleted since by one of its own
+  // callbacks; its data then outlives it until the delivery is done.
+  static void deliver( void *inputData, const unsigned char *message, size_t size );
+
+ protected:
+  friend class MidiOutLoopback;
+  void initialize( const std::string& clientName );
+  void unlink( void );
+  void receive( const unsigned char *message, size_t size );
+};
+
+class MidiOutLoopback: public MidiOutApi
+{
+ public:
+  MidiOutLoopback( const std::string clientName );
+  ~MidiOutLoopback( void );
+  RtMidi::Api getCurrentApi( void ) { return RtMidi::RTMIDI_LOOPBACK; };
+  void openPort( unsigned int portNumber, const std::string portName );
+  void openVirtualPort( const std::string portName );
+  void closePort( void );
+  unsigned int getPortCount( void );
+  std::string getPortName( unsigned int portNumber );
+  void sendMessage( const unsigned char *message, size_t size );
+  bool connectPort( unsigned int portNumber );
+
+  //! Returns the number of messages passed to sendMessage() so far.
+  unsigned long long getMessageCount( void ) const;
+
+ protected:
+  friend class MidiInLoopback;
+  void initialize( const std::string& clientName );
+};
+
+#endif
+
+// **************************************************************** //
+//
+// BasicMidiIn and BasicMidiOut class templates.
+//
+// RtMidiIn and RtMidiOut choose a backend at run time and reach it
+// through a MidiApi pointer, so every call is a virtual call.  When a
+// program only ever uses one backend, BasicMidiIn<Backend> and
+// BasicMidiOut<Backend> hold that backend by value and call it with
+// qualified names, so the send path is an ordinary (inlinable)
+// function call.  The interface mirrors RtMidiIn and RtMidiOut.
+//
+// **************************************************************** //
+
+template <class Backend>
+class BasicMidiOut
+{
+ public:
+  BasicMidiOut( const std::string clientName = std::string( "RtMidi Output Client" ) ) : api_( clientName ) {}
+
+  RtMidi::Api getCurrentApi( void ) { return api_.Backend::getCurrentApi(); }
+  void openPort( unsigned int portNumber = 0, const std::string portName = std::string( "RtMidi Output" ) ) { api_.Backend::openPort( portNumber, portName ); }
+  void openVirtualPort( const std::string portName = std::string( "RtMidi Output" ) ) { api_.Backend::openVirtualPort( portName ); }
+  bool connectPort( unsigned int portNumber ) { return api_.Backend::connectPort( portNumber ); }
+  void closePort( void ) { api_.Backend::closePort(); }
+  bool isPortOpen( void ) const { return api_.isPortOpen(); }
+  unsigned int getPortCount( void ) { return api_.Backend::getPortCount(); }
+  std::string getPortName( unsigned int portNumber = 0 ) { return api_.Backend::getPortName( portNumber ); }
+  void setErrorCallback( RtMidiErrorCallback errorCallback = NULL ) { api_.setErrorCallback( errorCallback ); }
+
+  void sendMessage( const unsigned char *message, size_t size ) { api_.Backend::sendMessage( message, size ); }
+  void sendMessage( std::vector<unsigned char> *message ) { sendMessage( message->empty() ? 0 : &message->at( 0 ), message->size() ); }
+  void sendUmp( const MidiUmp &packet ) { api_.Backend::sendUmp( packet ); }
+  template <class Message>
+  void send( const Message &message ) { api_.Backend::sendMessage( message.data(), message.size() ); }
+
+  //! Direct access to the backend object.
+  Backend &backend( void ) { return api_; }
+
+ private:
+  BasicMidiOut( const BasicMidiOut & );
+  BasicMidiOut &operator=( const BasicMidiOut & );
+
+  Backend api_;
+};
+
+template <class Backend>
+class BasicMidiIn
+{
+ public:
+  BasicMidiIn( const std::string clientName = std::string( "RtMidi Input Client" ), unsigned int queueSizeLimit = 100 )
+    : api_( clientName, queueSizeLimit ) {}
+
+  RtMidi::Api getCurrentApi( void ) { return api_.Backend::getCurrentApi(); }
+  void openPort( unsigned int portNumber = 0, const std::string portName = std::string( "RtMidi Input" ) ) { api_.Backend::openPort( portNumber, portName ); }
+  void openVirtualPort( const std::string portName = std::string( "RtMidi Input" ) ) { api_.Backend::openVirtualPort( portName ); }
+  void closePort( void ) { api_.Backend::closePort(); }
+  bool isPortOpen( void ) const { return api_.isPortOpen(); }
+  unsigned int getPortCount( void ) { return api_.Backend::getPortCount(); }
+  std::string getPortName( unsigned int portNumber = 0 ) { return api_.Backend::getPortName( portNumber ); }
+  void setErrorCallback( RtMidiErrorCallback errorCallback = NULL ) { api_.setErrorCallback( errorCallback ); }
+
+  void setCallback( RtMidiIn::RtMidiCallback callback, void *userData = 0 ) { api_.setCallback( callback, userData ); }
+  void cancelCallback( void ) { api_.cancelCallback(); }
+  void ignoreTypes( bool midiSysex = true, bool midiTime = true, bool midiSense = true ) { api_.Backend::ignoreTypes( midiSysex, midiTime, midiSense ); }
+  double getMessage( std::vector<unsigned char> *message ) { return api_.getMessage( message ); }
+
+  //! Direct access to the backend object.
+  Backend &backend( void ) { return api_; }
+
+ private:
+  BasicMidiIn( const BasicMidiIn & );
+  BasicMidiIn &operator=( const BasicMidiIn & );
+
+  Backend api_;
+};
+
 #endif
@@ -0,0 +1,151 @@
+//*****************************************//
+//  clockbench.cpp
+//
+//  Measures MidiClock's timing clock as an
+//  input receives it: each tick's distance
+//  from its ideal time, and the drift over
+//  the run, idle and with every CPU kept
+//  busy, with the timing thread sleeping
+//  until each tick or spinning out the
+//  last 300 us.  For comparison, the ticks
+//  sent from a loop that sleeps one period
+//  between them.
+//
+//*****************************************//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "RtMidi.h"
+#include "MidiClock.h"
+#include "MidiScheduler.h"
+
+static std::mutex lock;
+static std::vector<int64_t> arrivals;
+
+static void receive( double /*deltatime*/, std::vector< unsigned char > *message, void * /*userData*/ )
+{
+  int64_t now = MidiScheduler::now();
+  if ( message->empty() || ( *message )[0] != 0xF8 ) return;
+  std::lock_guard<std::mutex> guard( lock );
+  arrivals.push_back( now );
+}
+
+// Threads that spin, one per CPU, to load the machine.
+class Load
+{
+ public:
+  Load( bool on ) : stop_( false )
+  {
+    unsigned int count = on ? std::max( 1u, std::thread::hardware_concurrency() ) : 0;
+    for ( unsigned int i=0; i<count; i++ )
+      threads_.push_back( std::thread( [this]() { volatile uint64_t x = 0; while ( !stop_ ) x = x + 1; } ) );
+  }
+  ~Load( void )
+  {
+    stop_ = true;
+    for ( size_t i=0; i<threads_.size(); i++ ) threads_[i].join();
+  }
+
+ private:
+  std::atomic<bool> stop_;
+  std::vector<std::thread> threads_;
+};
+
+// Each arrival's distance from start + k * period, in microseconds.
+static void report( const char *name, int64_t start, double period )
+{
+  std::lock_guard<std::mutex> guard( lock );
+  std::vector<double> error, magnitude;
+  for ( size_t k=0; k<arrivals.size(); k++ ) {
+    error.push_back( arrivals[k] - ( start + k * period ) );
+    magnitude.push_back( std::fabs( error.back() ) );
+  }
+  size_t n = error.size(), edge = std::max( (size_t) 1, n / 10 );
+  if ( n < 2 ) {
+    std::cout << std::setw( 22 ) << name << "  no ticks" << std::endl;
+    return;
+  }
+  double first = 0.0, last = 0.0;
+  for ( size_t i=0; i<edge; i++ ) {
+    first += error[i] / edge;
+    last += error[n - 1 - i] / edge;
+  }
+  std::sort( magnitude.begin(), magnitude.end() );
+  std::cout << std::left << std::setw( 22 ) << name << std::right << std::setw( 8 ) << n << std::fixed << std::setprecision( 1 )
+            << std::setw( 10 ) << magnitude[n / 2] << std::setw( 10 ) << magnitude[n * 99 / 100]
+            << std::setw( 10 ) << magnitude[n - 1] << std::setw( 10 ) << last - first << std::endl;
+  arrivals.clear();
+}
+
+int main( int argc, char *argv[] )
+{
+  double seconds = 10.0, bpm = 120.0;
+  if ( argc > 1 ) seconds = strtod( argv[1], 0 );
+  if ( argc > 2 ) bpm = strtod( argv[2], 0 );
+  double period = 60000000.0 / ( bpm * MidiClock::PPQN );
+
+  try {
+    RtMidiOut out( RtMidi::RTMIDI_LOOPBACK, "clockbench" );
+    out.openVirtualPort( "clock" );
+    RtMidiIn in( RtMidi::RTMIDI_LOOPBACK, "clockbench" );
+    unsigned int port = 0;
+    while ( port < in.getPortCount() && in.getPortName( port ).find( "clock" ) == std::string::npos ) port++;
+    if ( port == in.getPortCount() ) throw std::runtime_error( "cannot find the clock's port" );
+    in.ignoreTypes( true, false, true );
+    in.setCallback( &receive );
+    in.openPort( port, "clockbench in" );
+
+    std::cout << "clockbench: " << seconds << " s at " << bpm << " bpm, a tick every " << std::fixed
+              << std::setprecision( 1 ) << period << " us, " << std::max( 1u, std::thread::hardware_concurrency() )
+              << " CPUs\nmicroseconds from each tick's ideal time; drift is the last tenth's mean less the first's\n\n"
+              << std::left << std::setw( 22 ) << "clock" << std::right << std::setw( 8 ) << "ticks" << std::setw( 10 )
+              << "p50" << std::setw( 10 ) << "p99" << std::setw( 10 ) << "max" << std::setw( 10 ) << "drift" << std::endl;
+
+    static const char *names[2][2] = { { "MidiClock", "MidiClock, loaded" }, { "MidiClock spin", "MidiClock spin, loaded" } };
+    for ( int loaded=0; loaded<2; loaded++ ) {
+      Load load( loaded != 0 );
+
+      // MidiClock on the scheduler's timing thread, which sleeps until
+      // each tick or wakes 300 us early and spins.
+      for ( int spin=0; spin<2; spin++ ) {
+        MidiScheduler scheduler;
+        MidiClock clock( &out, scheduler, bpm );
+        scheduler.start( spin ? 300 : 0 );
+        int64_t start = MidiScheduler::now() + 10000;
+        clock.start( start );
+        std::this_thread::sleep_for( std::chrono::microseconds( (int64_t) ( seconds * 1e6 ) ) );
+        clock.stop();
+        scheduler.stop();
+        report( names[spin][loaded], start, period );
+      }
+
+      // A loop that sleeps a period after each tick.
+      int64_t start = MidiScheduler::now();
+      unsigned char tick = 0xF8;
+      for ( int64_t end = start + (int64_t) ( seconds * 1e6 ); MidiScheduler::now() < end; ) {
+        out.sendMessage( &tick, 1 );
+        std::this_thread::sleep_for( std::chrono::microseconds( (int64_t) period ) );
+      }
+      report( loaded ? "sleep loop, loaded" : "sleep loop", start, period );
+    }
+  }
+  catch ( RtMidiError &error ) {
+    error.printMessage();
+    return 1;
+  }
+  catch ( std::exception &error ) {
+    std::cerr << "clockbench: " << error.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,205 @@
+//*****************************************//
+//  dedupbench.cpp
+//
+//  Measures how much of a mapping's
+//  controller traffic the output cache
+//  saves and what it costs in accuracy.
+//  Two synthetic armbands play dj.map,
+//  instrument.map and instrument.map with
+//  its two controllers limited, in real
+//  time, into a loopback input.  Counts
+//  the controller messages the rules asked
+//  for (what reached Ableton before the
+//  cache) and those that arrived, and
+//  after each orientation event compares
+//  every controller's value at the input
+//  with the last one asked for.  Last,
+//  checks that the cache passes a repeated
+//  All Notes Off and data increment.
+//
+//  usage: dedupbench [SECONDS]
+//
+//*****************************************//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "RtMidi.h"
+#include "MidiScheduler.h"
+#include "EventLoop.h"
+#include "MidiMapping.h"
+#include "StatusDisplay.h"
+#include "SyntheticSource.h"
+
+// What has arrived at the input.
+static uint64_t controls = 0;
+static int received[16][128];
+static unsigned int arrivals[16][128];
+
+static void receive( double /*deltatime*/, std::vector< unsigned char > *message, void * /*userData*/ )
+{
+  if ( message->size() == 3 && ( ( *message )[0] & 0xF0 ) == 0xB0 ) {
+    received[( *message )[0] & 0x0F][( *message )[1]] = ( *message )[2];
+    arrivals[( *message )[0] & 0x0F][( *message )[1]]++;
+    controls++;
+  }
+}
+
+// A value the cache keeps at 32 bits as it reaches a MIDI 1.0 port, or -1 for none.
+static int sevenBits( int64_t value )
+{
+  return value < 0 ? -1 : static_cast<int>( value >> 25 );
+}
+
+// After the mapping has handled an event, how far the input is from
+// what the rules asked for.
+class Checker : public sensor::Listener
+{
+ public:
+  Checker( sensor::MidiMapping &mapping ) : mapping_( mapping ), samples( 0 ), off( 0 ), error( 0 ), worst( 0 ) {}
+
+  void onOrientationData( sensor::Device *, uint64_t, const sensor::Quaternion & )
+  {
+    const MidiOutCache &cache = mapping_.getOutput();
+    for ( unsigned int channel=1; channel<=16; channel++ )
+      for ( unsigned int controller=0; controller<128; controller++ ) {
+        int wanted = sevenBits( cache.value( channel, controller ) );
+        if ( wanted < 0 ) continue;
+        int difference = std::abs( wanted - received[channel - 1][controller] );
+        samples++;
+        if ( difference ) off++;
+        error += difference;
+        if ( difference > worst ) worst = difference;
+      }
+  }
+
+  sensor::MidiMapping &mapping_;
+  uint64_t samples, off, error;
+  int worst;
+};
+
+static void run( const char *name, const std::string &rules, double seconds )
+{
+  controls = 0;
+  for ( int i=0; i<16; i++ )
+    for ( int j=0; j<128; j++ ) received[i][j] = -1;
+
+  RtMidiOut out( RtMidi::RTMIDI_LOOPBACK, "dedupbench" );
+  out.openVirtualPort( "mapping" );
+  RtMidiIn in( RtMidi::RTMIDI_LOOPBACK, "dedupbench" );
+  unsigned int port = 0;
+  while ( port < in.getPortCount() && in.getPortName( port ).find( "mapping" ) == std::string::npos ) port++;
+  if ( port == in.getPortCount() ) throw std::runtime_error( "cannot find the mapping's output port" );
+  in.setCallback( &receive );
+  in.openPort( port, "dedupbench in" );
+
+  MidiScheduler scheduler;
+  sensor::StatusBoard board;
+  sensor::MidiMapping mapping( &out, scheduler );
+  std::istringstream text( rules );
+  mapping.load( text, name );
+  mapping.setStatusBoard( &board );
+  Checker checker( mapping );
+
+  sensor::SyntheticSource source( 1.0, 2, (uint64_t) ( seconds * 1000000 ) );
+  source.addListener( &mapping );
+  source.addListener( &checker );
+  mapping.start();
+  sensor::EventLoop loop( &source );
+  loop.setScheduler( &scheduler );
+  loop.run();
+
+  // What the input holds once the held values have gone.
+  MidiOutCache &cache = mapping.getOutput();
+  cache.flush();
+  uint64_t asked = controls + cache.getSuppressed();
+  unsigned int stale = 0;
+  for ( unsigned int channel=1; channel<=16; channel++ )
+    for ( unsigned int controller=0; controller<128; controller++ )
+      if ( sevenBits( cache.value( channel, controller ) ) != received[channel - 1][controller] ) stale++;
+
+  std::cout << std::left << std::setw( 28 ) << name << std::right << std::setw( 9 ) << asked << std::setw( 9 ) << controls
+            << std::setw( 7 ) << std::fixed << std::setprecision( 1 ) << 100.0 * controls / asked << "%"
+            << std::setw( 8 ) << std::setprecision( 1 ) << 100.0 * checker.off / std::max( checker.samples, (uint64_t) 1 ) << "%"
+            << std::setw( 9 ) << std::setprecision( 2 ) << (double) checker.error / std::max( checker.samples, (uint64_t) 1 )
+            << std::setw( 7 ) << checker.worst << std::setw( 7 ) << stale << std::endl;
+}
+
+// Send \e controller on channel 1 three times with the same value and
+// return how many arrived.
+static unsigned int repeat( unsigned int controller, unsigned char value )
+{
+  RtMidiOut out( RtMidi::RTMIDI_LOOPBACK, "dedupbench" );
+  out.openVirtualPort( "repeat" );
+  RtMidiIn in( RtMidi::RTMIDI_LOOPBACK, "dedupbench" );
+  unsigned int port = 0;
+  while ( port < in.getPortCount() && in.getPortName( port ).find( "repeat" ) == std::string::npos ) port++;
+  if ( port == in.getPortCount() ) throw std::runtime_error( "cannot find the repeat port" );
+  in.setCallback( &receive );
+  in.openPort( port, "dedupbench in" );
+
+  MidiScheduler scheduler;
+  MidiOutCache cache( &out, scheduler );
+  arrivals[0][controller] = 0;
+  unsigned char message[3] = { 0xB0, static_cast<unsigned char>( controller ), value };
+  for ( int i=0; i<3; i++ ) cache.send( message, 3 );
+  return arrivals[0][controller];
+}
+
+static std::string readFile( const std::string &name )
+{
+  std::ifstream file( name.c_str() );
+  if ( !file ) throw std::runtime_error( "cannot read " + name );
+  std::ostringstream text;
+  text << file.rdbuf();
+  return text.str();
+}
+
+int main( int argc, char *argv[] )
+{
+  double seconds = argc > 1 ? strtod( argv[1], 0 ) : 10.0;
+  if ( !( seconds > 0.0 ) ) {
+    std::cerr << "usage: dedupbench [SECONDS]" << std::endl;
+    return 1;
+  }
+
+  try {
+    std::string dj = readFile( MAPPING_DIRECTORY "/dj.map" );
+    std::string instrument = readFile( MAPPING_DIRECTORY "/instrument.map" );
+    std::cout << "dedupbench: " << seconds << " s of two synthetic armbands per mapping, in real time\n"
+              << "controller messages asked for and sent; samples after each orientation event\n"
+              << "where the input differs from the value asked for, the mean and worst difference;\n"
+              << "controllers still different after the final flush\n\n"
+              << std::left << std::setw( 28 ) << "mapping" << std::right << std::setw( 9 ) << "asked" << std::setw( 9 ) << "sent"
+              << std::setw( 8 ) << "share" << std::setw( 9 ) << "off" << std::setw( 9 ) << "mean" << std::setw( 7 ) << "worst"
+              << std::setw( 7 ) << "stale" << std::endl;
+    run( "dj.map", dj, seconds );
+    run( "instrument.map", instrument, seconds );
+    run( "instrument.map, limited", instrument + "limit 1 9 threshold 2 rate 25\nlimit 1 8 threshold 2 rate 25\n", seconds );
+
+    // Each of these does something every time, so none may be dropped.
+    unsigned int allNotesOff = repeat( 123, 0 ), increment = repeat( 96, 1 );
+    std::cout << "\nrepeated three times: All Notes Off arrived " << allNotesOff << ", data increment "
+              << increment << std::endl;
+    if ( allNotesOff != 3 || increment != 3 ) {
+      std::cerr << "dedupbench: the cache dropped a repeated channel mode or data increment message" << std::endl;
+      return 1;
+    }
+  }
+  catch ( RtMidiError &error ) {
+    error.printMessage();
+    return 1;
+  }
+  catch ( std::exception &error ) {
+    std::cerr << "dedupbench: " << error.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,150 @@
+//*****************************************//
+//  displaybench.cpp
+//
+//  Measures what the status display costs
+//  the sensor thread: two armbands' state
+//  published at 200 events a second to a
+//  StatusBoard drawn by a StatusDisplay
+//  thread, against redrawing the whole
+//  line on the sensor thread every 50 ms
+//  as the mapping's print() timer did.
+//  Also counts the bytes a frame of each
+//  writes.
+//
+//*****************************************//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "StatusDisplay.h"
+
+typedef std::chrono::steady_clock Clock;
+
+using namespace sensor;
+
+static double nanoseconds( Clock::time_point start )
+{
+  return std::chrono::duration<double, std::nano>( Clock::now() - start ).count();
+}
+
+static void report( const char *name, std::vector<double> &costs )
+{
+  std::sort( costs.begin(), costs.end() );
+  size_t n = costs.size();
+  std::cout << std::left << std::setw( 34 ) << name << std::right << std::fixed << std::setprecision( 0 )
+            << std::setw( 10 ) << costs[n / 2] << std::setw( 10 ) << costs[n * 99 / 100] << std::setw( 10 ) << costs[n - 1]
+            << std::endl;
+}
+
+// Two armbands wandering slowly, as they do between gestures.
+class Wander
+{
+ public:
+  Wander( void ) : random_( 3 ), step_( -1, 1 )
+  {
+    for ( int d=0; d<2; d++ ) {
+      status_[d].roll = 60;
+      status_[d].pitch = 60;
+      status_[d].yaw = 60;
+      status_[d].pose = Pose( Pose::rest );
+      status_[d].arm = d ? armRight : armLeft;
+      status_[d].unlocked = true;
+      status_[d].connected = true;
+    }
+  }
+  const DeviceStatus &next( int d )
+  {
+    DeviceStatus &s = status_[d];
+    int *axes[3] = { &s.roll, &s.pitch, &s.yaw };
+    int *axis = axes[random_() % 3];
+    *axis = std::max( 0, std::min( 127, *axis + step_( random_ ) ) );
+    if ( random_() % 200 == 0 ) s.pose = Pose( static_cast<Pose::Type>( random_() % 6 ) );
+    return s;
+  }
+
+ private:
+  std::mt19937 random_;
+  std::uniform_int_distribution<int> step_;
+  DeviceStatus status_[2];
+};
+
+int main( int argc, char *argv[] )
+{
+  double seconds = 5.0;
+  if ( argc > 1 ) seconds = strtod( argv[1], 0 );
+  size_t events = (size_t) ( seconds * 200 );
+  std::ofstream null( "/dev/null" );
+
+  std::cout << "displaybench: " << events << " events over " << seconds << " s, two armbands\n"
+            << "nanoseconds on the sensor thread\n\n" << std::left << std::setw( 34 ) << "" << std::right
+            << std::setw( 10 ) << "p50" << std::setw( 10 ) << "p99" << std::setw( 10 ) << "max" << std::endl;
+
+  // Publish each event to a board the display thread draws at 20 Hz.
+  uint64_t diffBytes, frames = (uint64_t) ( seconds * 20 );
+  {
+    Wander wander;
+    StatusBoard board;
+    StatusDisplay display( board, null );
+    display.start();
+    std::vector<double> costs;
+    for ( size_t i=0; i<events; i++ ) {
+      int d = (int) ( i & 1 );
+      const DeviceStatus &status = wander.next( d );
+      Clock::time_point start = Clock::now();
+      board.publish( d + 1, status );
+      costs.push_back( nanoseconds( start ) );
+      std::this_thread::sleep_for( std::chrono::microseconds( 5000 ) );
+    }
+    display.stop();
+    diffBytes = display.bytesWritten();
+    report( "publish to the board", costs );
+  }
+
+  // The old way: every tenth event, redraw the whole line here.
+  uint64_t fullBytes = 0;
+  {
+    Wander wander;
+    DeviceStatus status[2];
+    std::vector<double> costs;
+    for ( size_t i=0; i<events; i++ ) {
+      int d = (int) ( i & 1 );
+      status[d] = wander.next( d );
+      if ( i % 10 ) continue;
+      Clock::time_point start = Clock::now();
+      std::ostringstream line;
+      line << '\r';
+      for ( int k=0; k<2; k++ )
+        line << '[' << ( status[k].arm == armLeft ? 'L' : 'R' ) << "] roll: " << status[k].roll << " pitch: "
+             << status[k].pitch << " yaw: " << status[k].yaw << "  ";
+      null << line.str() << std::flush;
+      costs.push_back( nanoseconds( start ) );
+      fullBytes += line.str().size();
+    }
+    report( "redraw the line, every 50 ms", costs );
+  }
+
+  // The same two lines drawn whole, as a new display draws them.
+  uint64_t wholeBytes;
+  {
+    Wander wander;
+    StatusBoard board;
+    board.publish( 1, wander.next( 0 ) );
+    board.publish( 2, wander.next( 1 ) );
+    std::ostringstream out;
+    StatusDisplay display( board, out );
+    display.render();
+    wholeBytes = display.bytesWritten();
+  }
+
+  std::cout << "\nbytes a frame: " << std::setprecision( 1 ) << (double) diffBytes / frames << " redrawing the changed fields, "
+            << wholeBytes << " redrawing both lines whole; the old line was " << (double) fullBytes / ( events / 10 )
+            << " without pose, lock or connection" << std::endl;
+  return 0;
+}
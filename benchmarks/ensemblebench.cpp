@@ -0,0 +1,129 @@
+//*****************************************//
+//  ensemblebench.cpp
+//
+//  Measures how many armband orientation
+//  frames one core can turn into buckets,
+//  for ensembles of 2 to 64 synthetic
+//  armbands: bucketing each event as it
+//  arrives into a per-device struct, as
+//  the collectors do, against storing
+//  events in a DeviceStateTable and
+//  sweeping it once per frame.
+//
+//*****************************************//
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "DeviceState.h"
+#include "SyntheticSource.h"
+
+typedef std::chrono::steady_clock Clock;
+
+struct Event {
+  sensor::Device *device;
+  sensor::Quaternion rotation;
+};
+
+// Keeps the orientation events, with the index of the first event of
+// each frame.  The armbands are not in step, so a frame is an IMU
+// period, in which each armband reports once.
+class Capture : public sensor::Listener
+{
+ public:
+  Capture( void ) : first( 0 ), last( ~(uint64_t) 0 ) {}
+  void onOrientationData( sensor::Device *device, uint64_t timestamp, const sensor::Quaternion &rotation )
+  {
+    if ( events.empty() ) first = timestamp;
+    uint64_t frame = ( timestamp - first ) / sensor::SyntheticSource::imuPeriod;
+    if ( frame != last ) frames.push_back( events.size() );
+    last = frame;
+    Event event = { device, rotation };
+    events.push_back( event );
+  }
+  std::vector<Event> events;
+  std::vector<size_t> frames;
+  uint64_t first, last;
+};
+
+// The collectors' layout: each event bucketed on arrival into the
+// device's own struct.
+class PerEvent : public sensor::Listener
+{
+ public:
+  PerEvent( sensor::AngleSteps steps ) : bucketer( steps ) {}
+  void onOrientationData( sensor::Device *device, uint64_t, const sensor::Quaternion &rotation )
+  {
+    State &s = states[device];
+    s.rotation = rotation;
+    s.buckets = bucketer.buckets( rotation );
+  }
+
+  struct State {
+    sensor::Quaternion rotation;
+    sensor::AngleBuckets buckets;
+  };
+  sensor::AngleBucketer bucketer;
+  sensor::DeviceTable<State> states;
+};
+
+static double rate( Clock::duration elapsed, size_t count )
+{
+  return count / std::chrono::duration<double>( elapsed ).count() / 1e6;
+}
+
+int main( int argc, char *argv[] )
+{
+  size_t deviceFrames = 2000000;
+  if ( argc > 1 ) deviceFrames = strtoul( argv[1], 0, 10 );
+  sensor::AngleSteps steps = { 127, 127, 127 };
+
+  std::cout << "ensemblebench: " << deviceFrames << " device-frames per ensemble, one core\n"
+            << "million device-frames per second\n\n";
+  std::cout << std::setw( 8 ) << "devices" << std::setw( 14 ) << "per event" << std::setw( 18 ) << "table + sweep"
+            << std::setw( 10 ) << "ratio" << std::endl;
+
+  static const unsigned int sizes[] = { 2, 4, 8, 16, 32, 64 };
+  long checksum = 0;
+  for ( size_t k=0; k<sizeof( sizes ) / sizeof( sizes[0] ); k++ ) {
+    unsigned int devices = sizes[k];
+    uint64_t frames = deviceFrames / devices;
+    sensor::SyntheticSource source( 0.0, devices, frames * sensor::SyntheticSource::imuPeriod );
+    Capture capture;
+    source.addListener( &capture );
+    while ( source.run( 1000 ) ) {}
+    capture.frames.push_back( capture.events.size() );
+    const std::vector<Event> &events = capture.events;
+    size_t count = events.size();
+
+    // Both are driven through the Listener interface, as a source would.
+    PerEvent perEvent( steps );
+    sensor::Listener *listener = &perEvent;
+    Clock::time_point start = Clock::now();
+    for ( size_t i=0; i<count; i++ )
+      listener->onOrientationData( events[i].device, 0, events[i].rotation );
+    double perEventRate = rate( Clock::now() - start, count );
+    for ( unsigned int id=1; id<=devices; id++ )
+      checksum += perEvent.states[source.getDevices().device( id )].buckets.pitch;
+
+    sensor::DeviceStateTable table( steps );
+    listener = &table;
+    start = Clock::now();
+    for ( size_t f=0; f+1<capture.frames.size(); f++ ) {
+      for ( size_t i=capture.frames[f]; i<capture.frames[f + 1]; i++ )
+        listener->onOrientationData( events[i].device, 0, events[i].rotation );
+      table.sweep();
+    }
+    double tableRate = rate( Clock::now() - start, count );
+    for ( unsigned int id=1; id<=devices; id++ ) checksum -= table.pitch( id );
+
+    std::cout << std::setw( 8 ) << devices << std::fixed << std::setprecision( 2 ) << std::setw( 14 ) << perEventRate
+              << std::setw( 18 ) << tableRate << std::setw( 10 ) << tableRate / perEventRate << std::endl;
+  }
+
+  // The two must agree on every device's final buckets.
+  std::cout << "\nchecksum " << checksum << ( checksum ? " (mismatch)" : "" ) << std::endl;
+  return checksum ? 1 : 0;
+}
@@ -0,0 +1,119 @@
+//*****************************************//
+//  followerbench.cpp
+//
+//  Feeds MidiClockFollower a simulated
+//  master clock at 120 bpm that steps to
+//  128 bpm halfway, with arrival jitter and
+//  the odd badly late tick, and compares
+//  its tempo and next-tick predictions with
+//  an estimator that trusts the last
+//  interval.  Then times at() with and
+//  without a thread writing ticks.
+//
+//*****************************************//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+#include "MidiClock.h"
+#include "MidiClockFollower.h"
+
+struct Errors {
+  std::vector<double> tempo, phase;
+};
+
+static void row( const char *name, std::vector<double> &values, const char *unit )
+{
+  std::sort( values.begin(), values.end() );
+  size_t n = values.size();
+  std::cout << std::left << std::setw( 30 ) << name << std::right << std::fixed << std::setprecision( 2 )
+            << std::setw( 10 ) << values[n / 2] << std::setw( 10 ) << values[n * 99 / 100]
+            << std::setw( 10 ) << values[n - 1] << "  " << unit << std::endl;
+}
+
+int main( int argc, char *argv[] )
+{
+  double seconds = 60.0, jitter = 300.0;
+  if ( argc > 1 ) seconds = strtod( argv[1], 0 );
+  if ( argc > 2 ) jitter = strtod( argv[2], 0 );
+
+  std::mt19937_64 random( 7 );
+  std::normal_distribution<double> noise( 0.0, jitter );
+  std::uniform_real_distribution<double> chance( 0.0, 1.0 );
+
+  // The master's ideal tick times.
+  std::vector<double> ideal, bpm;
+  double time = 1000000.0;
+  while ( time < 1000000.0 + seconds * 1e6 ) {
+    double tempo = time < 1000000.0 + seconds * 0.5e6 ? 120.0 : 128.0;
+    ideal.push_back( time );
+    bpm.push_back( tempo );
+    time += 60000000.0 / ( tempo * MidiClock::PPQN );
+  }
+
+  MidiClockFollower follower;
+  unsigned char start = 0xFA, tick = 0xF8;
+  follower.receive( &start, 1, 999000 );
+
+  Errors loop, naive;
+  double lastArrival = 0.0, lastInterval = 0.0;
+  size_t step = ideal.size(), settled = 0;
+  for ( size_t k=0; k<ideal.size(); k++ ) {
+    if ( step == ideal.size() && bpm[k] != bpm[0] ) step = k;
+    double arrival = ideal[k] + noise( random );
+    if ( chance( random ) < 0.005 ) arrival += 12000.0;  // a tick more than half a period late
+    follower.receive( &tick, 1, (int64_t) arrival );
+    if ( lastArrival > 0.0 ) lastInterval = arrival - lastArrival;
+    lastArrival = arrival;
+    if ( k + 1 >= ideal.size() || k < 96 ) continue;
+
+    // Skip the beat after the tempo step for the steady-state figures,
+    // but note when the loop comes within half a bpm of the new tempo.
+    double truth = bpm[k + 1];
+    MusicalTime now = follower.at( (int64_t) arrival );
+    double next = (double) follower.timeOfBeat( ( k + 1 ) / (double) MidiClock::PPQN );
+    if ( k >= step && !settled && std::fabs( now.bpm - truth ) < 0.5 ) settled = k - step + 1;
+    if ( k >= step && k < step + MidiClock::PPQN ) continue;
+    loop.tempo.push_back( std::fabs( now.bpm - truth ) );
+    loop.phase.push_back( std::fabs( next - ideal[k + 1] ) );
+    naive.tempo.push_back( std::fabs( 60000000.0 / ( lastInterval * MidiClock::PPQN ) - truth ) );
+    naive.phase.push_back( std::fabs( arrival + lastInterval - ideal[k + 1] ) );
+  }
+
+  std::cout << "followerbench: " << ideal.size() << " ticks, 120 then 128 bpm, jitter " << jitter
+            << " us, 0.5% of ticks 12 ms late\n\n" << std::left << std::setw( 30 ) << "estimate" << std::right
+            << std::setw( 10 ) << "p50" << std::setw( 10 ) << "p99" << std::setw( 10 ) << "max" << std::endl;
+  row( "tempo, phase-locked loop", loop.tempo, "bpm" );
+  row( "tempo, last interval", naive.tempo, "bpm" );
+  row( "next tick, phase-locked loop", loop.phase, "us" );
+  row( "next tick, last interval", naive.phase, "us" );
+  std::cout << "\nloop within 0.5 bpm of the new tempo " << settled << " ticks after the step; "
+            << follower.getOutliers() << " outliers rejected\n\n";
+
+  // Read cost, alone and against a writer that never pauses.
+  const int reads = 2000000;
+  for ( int contended=0; contended<2; contended++ ) {
+    std::atomic<bool> stop( false );
+    std::thread writer;
+    if ( contended ) writer = std::thread( [&]() {
+        int64_t t = 1000000000;
+        while ( !stop ) { follower.receive( &tick, 1, t ); t += 20833; }
+      } );
+    double sum = 0.0;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for ( int i=0; i<reads; i++ ) sum += follower.at( i ).beats;
+    double elapsed = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - begin ).count();
+    stop = true;
+    if ( writer.joinable() ) writer.join();
+    std::cout << ( contended ? "at() with a writer" : "at() alone" ) << ": " << std::setprecision( 1 )
+              << elapsed / reads << " ns a read" << ( sum < 0 ? " " : "" ) << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,163 @@
+//*****************************************//
+//  keybench.cpp
+//
+//  Measures key-to-MIDI latency through a
+//  pseudo-terminal: a script types arrow
+//  and controller keys into the master
+//  side while a KeyboardController reads
+//  the slave, and a loopback input times
+//  each message's arrival.  For
+//  comparison, the same controller fed by
+//  a loop that sleeps 20 ms between reads,
+//  as midiout's getch() loop did.  Also
+//  times a burst of ten notes.
+//
+//*****************************************//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "RtMidi.h"
+#include "KeyboardController.h"
+#include "MidiScheduler.h"
+
+static std::atomic<uint64_t> received( 0 );
+static std::atomic<int64_t> lastArrival( 0 );
+
+// Count note-ons and controller changes, which each key sends one of.
+static void receive( double /*deltatime*/, std::vector< unsigned char > *message, void * /*userData*/ )
+{
+  if ( message->empty() ) return;
+  unsigned char status = ( *message )[0] & 0xF0;
+  if ( status != 0x90 && status != 0xB0 ) return;
+  lastArrival = MidiScheduler::now();
+  received++;
+}
+
+static const char *keys[] = { "\033[C", "\033[D", "d", "a", "c", "z" };
+
+static void report( const char *name, std::vector<int64_t> &latency, size_t lost )
+{
+  std::sort( latency.begin(), latency.end() );
+  size_t n = latency.size();
+  std::cout << std::left << std::setw( 24 ) << name << std::right << std::setw( 8 ) << n << std::setw( 10 ) << latency[n / 2]
+            << std::setw( 10 ) << latency[n * 99 / 100] << std::setw( 10 ) << latency[n - 1] << std::setw( 8 ) << lost << std::endl;
+}
+
+// Type \e presses keys a few milliseconds apart and time each one's message.
+static void type( int master, size_t presses, std::vector<int64_t> &latency, size_t &lost )
+{
+  lost = 0;
+  for ( size_t i=0; i<presses; i++ ) {
+    const char *key = keys[i % 6];
+    uint64_t before = received;
+    int64_t sent = MidiScheduler::now();
+    if ( write( master, key, strlen( key ) ) < 0 ) throw std::runtime_error( "cannot write to the terminal" );
+    while ( received == before && MidiScheduler::now() - sent < 100000 ) std::this_thread::yield();
+    if ( received == before ) lost++;
+    else latency.push_back( lastArrival - sent );
+    std::this_thread::sleep_for( std::chrono::microseconds( 3000 + rand() % 4000 ) );
+  }
+}
+
+// Ten right arrows at once: how long until the tenth note-on.
+static int64_t burst( int master )
+{
+  uint64_t before = received;
+  std::string keys;
+  for ( int i=0; i<10; i++ ) keys += "\033[C";
+  int64_t sent = MidiScheduler::now();
+  if ( write( master, keys.data(), keys.size() ) < 0 ) throw std::runtime_error( "cannot write to the terminal" );
+  while ( received < before + 10 && MidiScheduler::now() - sent < 1000000 ) std::this_thread::yield();
+  return lastArrival - sent;
+}
+
+int main( int argc, char *argv[] )
+{
+  size_t presses = 600;
+  if ( argc > 1 ) presses = strtoul( argv[1], 0, 10 );
+
+  try {
+    int master = posix_openpt( O_RDWR | O_NOCTTY );
+    if ( master < 0 || grantpt( master ) != 0 || unlockpt( master ) != 0 ) throw std::runtime_error( "cannot open a pseudo-terminal" );
+    int slave = open( ptsname( master ), O_RDWR | O_NOCTTY );
+    if ( slave < 0 ) throw std::runtime_error( "cannot open the pseudo-terminal's slave" );
+    RawTerminal terminal( slave );
+
+    RtMidiOut out( RtMidi::RTMIDI_LOOPBACK, "keybench" );
+    out.openVirtualPort( "keys" );
+    RtMidiIn in( RtMidi::RTMIDI_LOOPBACK, "keybench" );
+    unsigned int port = 0;
+    while ( port < in.getPortCount() && in.getPortName( port ).find( "keys" ) == std::string::npos ) port++;
+    if ( port == in.getPortCount() ) throw std::runtime_error( "cannot find the controller's port" );
+    in.setCallback( &receive );
+    in.openPort( port, "keybench in" );
+
+    std::cout << "keybench: " << presses << " keys through a pseudo-terminal, microseconds from write to MIDI\n\n"
+              << std::left << std::setw( 24 ) << "reader" << std::right << std::setw( 8 ) << "keys" << std::setw( 10 )
+              << "p50" << std::setw( 10 ) << "p99" << std::setw( 10 ) << "max" << std::setw( 8 ) << "lost" << std::endl;
+
+    // The controller's own loop, waiting in select().
+    MidiScheduler scheduler;
+    std::vector<int64_t> latency;
+    size_t lost;
+    int64_t burstTime;
+    {
+      KeyboardController controller( &out, scheduler );
+      std::thread reader( [&controller, slave]() { controller.run( slave ); } );
+      type( master, presses, latency, lost );
+      std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+      burstTime = burst( master );
+      controller.stop();
+      reader.join();
+    }
+    report( "select() loop", latency, lost );
+    int64_t selectBurst = burstTime;
+
+    // Reading every 20 ms.
+    latency.clear();
+    {
+      KeyboardController controller( &out, scheduler );
+      fcntl( slave, F_SETFL, fcntl( slave, F_GETFL ) | O_NONBLOCK );
+      std::atomic<bool> stop( false );
+      std::thread reader( [&]() {
+          unsigned char buffer[64];
+          while ( !stop ) {
+            std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+            ssize_t size = read( slave, buffer, sizeof( buffer ) );
+            if ( size > 0 ) controller.feed( buffer, (size_t) size );
+            scheduler.advance( MidiScheduler::now() );
+          }
+        } );
+      type( master, presses / 4, latency, lost );
+      burstTime = burst( master );
+      stop = true;
+      reader.join();
+    }
+    report( "20 ms polling", latency, lost );
+
+    std::cout << "\nten notes typed at once: the last sent after " << selectBurst << " us from select(), "
+              << burstTime << " us polling" << std::endl;
+    close( slave );
+    close( master );
+  }
+  catch ( RtMidiError &error ) {
+    error.printMessage();
+    return 1;
+  }
+  catch ( std::exception &error ) {
+    std::cerr << "keybench: " << error.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
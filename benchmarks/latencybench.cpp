@@ -0,0 +1,302 @@
+//*****************************************//
+//  latencybench.cpp
+//
+//  Measures the latency from an armband
+//  event to the MIDI it causes, through
+//  a mapping (dj's by default) and a real
+//  output port.
+//
+//  Each orientation or pose event is timed
+//  when the source should have delivered
+//  it, when the mapping receives it and
+//  when each resulting message arrives at
+//  an input connected to the mapping's
+//  port.  With the loopback API delivery
+//  happens inside sendMessage(); with ALSA
+//  it includes the trip through the
+//  sequencer, so replay at real-time speed
+//  there to keep each message attributed
+//  to the event that caused it.  Messages
+//  sent between events, the start rules'
+//  and the note-offs the mapping schedules
+//  for later, are only counted
+//  (benchmarks/schedulerbench times those).
+//
+//*****************************************//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "RtMidi.h"
+#include "MidiScheduler.h"
+#include "SensorSource.h"
+#include "MidiMapping.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static int64_t nowMicroseconds( void )
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>( Clock::now().time_since_epoch() ).count();
+}
+
+// The event the mapping is handling, set before the mapping sees it
+// (the probe is registered first).
+struct Cause {
+  const char *type;
+  uint64_t timestamp; // source time
+  int64_t dispatch;   // when the listeners got it
+};
+
+struct Sample {
+  uint64_t timestamp;
+  int64_t dispatch;
+  int64_t arrival;    // when the message reached the input
+};
+
+static std::mutex lock;
+static Cause current = { 0, 0, 0 };
+static std::map<std::string, std::vector<Sample> > samples;
+static unsigned long between = 0;
+
+// The source never delivers an event early, so the smallest
+// difference between dispatch and scaled source time is the best
+// estimate of when the source meant to deliver each event.
+static double speed = 0.0;
+static double wallOffset = 1e300;
+
+class Probe : public sensor::Listener
+{
+ public:
+  void onOrientationData( sensor::Device *, uint64_t timestamp, const sensor::Quaternion & ) { begin( "orientation", timestamp ); }
+  void onPose( sensor::Device *, uint64_t timestamp, sensor::Pose ) { begin( "pose", timestamp ); }
+
+ private:
+  void begin( const char *type, uint64_t timestamp )
+  {
+    int64_t now = nowMicroseconds();
+    std::lock_guard<std::mutex> guard( lock );
+    current.type = type;
+    current.timestamp = timestamp;
+    current.dispatch = now;
+    if ( speed > 0.0 ) wallOffset = std::min( wallOffset, now - timestamp / speed );
+  }
+};
+
+// Registered after the mapping: messages sent between events come
+// from the start rules or the mapping's scheduler.
+class ProbeEnd : public sensor::Listener
+{
+ public:
+  void onOrientationData( sensor::Device *, uint64_t, const sensor::Quaternion & ) { end(); }
+  void onPose( sensor::Device *, uint64_t, sensor::Pose ) { end(); }
+
+ private:
+  void end( void )
+  {
+    std::lock_guard<std::mutex> guard( lock );
+    current.type = 0;
+  }
+};
+
+static void receive( double /*deltatime*/, std::vector< unsigned char > *message, void * /*userData*/ )
+{
+  int64_t now = nowMicroseconds();
+  std::lock_guard<std::mutex> guard( lock );
+  if ( message->empty() ) return;
+  if ( !current.type ) {
+    between++;
+    return;
+  }
+
+  const char *kind = "other";
+  unsigned char status = ( *message )[0] & 0xF0;
+  if ( status == 0xB0 ) kind = "cc";
+  else if ( status == 0x90 && message->size() > 2 && ( *message )[2] > 0 ) kind = "note-on";
+  else if ( status == 0x80 || status == 0x90 ) kind = "note-off";
+
+  Sample sample = { current.timestamp, current.dispatch, now };
+  samples[std::string( current.type ) + "/" + kind].push_back( sample );
+}
+
+// Discards what the mapping prints.
+class NullBuffer : public std::streambuf
+{
+ protected:
+  int overflow( int c ) { return c; }
+};
+
+struct Summary {
+  std::string event;
+  size_t count;
+  double p50, p99, p999, max, jitter, schedule50, output50;
+};
+
+static double percentile( const std::vector<double> &sorted, double p )
+{
+  return sorted[std::min( sorted.size() - 1, (size_t) ( p * ( sorted.size() - 1 ) + 0.5 ) )];
+}
+
+static Summary summarise( const std::string &event, const std::vector<Sample> &list )
+{
+  std::vector<double> total, schedule, output;
+  double sum = 0.0, sumSquares = 0.0;
+  for ( size_t i=0; i<list.size(); i++ ) {
+    double due = speed > 0.0 ? wallOffset + list[i].timestamp / speed : list[i].dispatch;
+    total.push_back( list[i].arrival - due );
+    schedule.push_back( list[i].dispatch - due );
+    output.push_back( (double) ( list[i].arrival - list[i].dispatch ) );
+    sum += total.back();
+    sumSquares += total.back() * total.back();
+  }
+  std::sort( total.begin(), total.end() );
+  std::sort( schedule.begin(), schedule.end() );
+  std::sort( output.begin(), output.end() );
+
+  double mean = sum / list.size();
+  Summary s = { event, list.size(), percentile( total, 0.5 ), percentile( total, 0.99 ), percentile( total, 0.999 ),
+                total.back(), std::sqrt( std::max( 0.0, sumSquares / list.size() - mean * mean ) ),
+                percentile( schedule, 0.5 ), percentile( output, 0.5 ) };
+  return s;
+}
+
+static void usage( void )
+{
+  std::cerr << "usage: latencybench [--api loopback|alsa] [--seconds N] [--json FILE] [--mapping FILE] [SOURCE]\n"
+            << "    SOURCE is --replay FILE [SPEED] or --synthetic [SPEED], as for the Myo programs\n"
+            << "    (default: --synthetic 1).  N is seconds of source time (default 20).  The mapping\n"
+            << "    defaults to dj's.\n";
+}
+
+int main( int argc, char *argv[] )
+{
+  RtMidi::Api api = RtMidi::RTMIDI_LOOPBACK;
+  std::string apiName = "loopback", jsonFile, mappingFile = MAPPING_DIRECTORY "/dj.map";
+  double seconds = 20.0;
+
+  // Take out our own options; the rest choose the source.
+  std::vector<char *> sourceArgs( 1, argv[0] );
+  for ( int i=1; i<argc; i++ ) {
+    if ( strcmp( argv[i], "--api" ) == 0 && i + 1 < argc ) {
+      apiName = argv[++i];
+      if ( apiName == "alsa" ) api = RtMidi::LINUX_ALSA;
+      else if ( apiName != "loopback" ) { usage(); return 1; }
+    }
+    else if ( strcmp( argv[i], "--seconds" ) == 0 && i + 1 < argc )
+      seconds = strtod( argv[++i], 0 );
+    else if ( strcmp( argv[i], "--json" ) == 0 && i + 1 < argc )
+      jsonFile = argv[++i];
+    else if ( strcmp( argv[i], "--mapping" ) == 0 && i + 1 < argc )
+      mappingFile = argv[++i];
+    else if ( strcmp( argv[i], "--help" ) == 0 ) { usage(); return 0; }
+    else sourceArgs.push_back( argv[i] );
+  }
+  if ( sourceArgs.size() == 1 ) sourceArgs.push_back( const_cast<char *>( "--synthetic" ) );
+
+  unsigned long messages = 0;
+  try {
+    std::unique_ptr<sensor::Source> source( sensor::openSource( (int) sourceArgs.size(), &sourceArgs[0], "com.example.latencybench" ) );
+    sensor::PacedSource *paced = dynamic_cast<sensor::PacedSource *>( source.get() );
+    if ( paced ) speed = paced->getSpeed();
+
+    std::vector<RtMidi::Api> apis;
+    RtMidi::getCompiledApi( apis );
+    if ( std::find( apis.begin(), apis.end(), api ) == apis.end() )
+      throw std::runtime_error( "the " + apiName + " API was not compiled in (see API in config.mk)" );
+
+    RtMidiOut out( api, "latencybench" );
+    out.openVirtualPort( "dj" );
+
+    RtMidiIn in( api, "latencybench" );
+    unsigned int port = 0;
+    while ( port < in.getPortCount() && in.getPortName( port ).find( "dj" ) == std::string::npos ) port++;
+    if ( port == in.getPortCount() )
+      throw std::runtime_error( "cannot find the mapping's output port" );
+    in.setCallback( &receive );
+    in.openPort( port, "latencybench in" );
+
+    Probe probe;
+    ProbeEnd probeEnd;
+    MidiScheduler scheduler;
+    sensor::MidiMapping mapping( &out, scheduler );
+    mapping.load( mappingFile );
+    source->addListener( &probe );
+    source->addListener( &mapping );
+    source->addListener( &probeEnd );
+
+    NullBuffer null;
+    std::streambuf *coutBuffer = std::cout.rdbuf( &null );
+    mapping.start();
+    // The note-offs are only counted, so a slice at a time is soon enough.
+    for ( unsigned int i=0; i<seconds * 10 && source->run( 100 ); i++ )
+      scheduler.advance( MidiScheduler::now() );
+    std::cout.rdbuf( coutBuffer );
+
+    // Let the last messages through the sequencer.
+    if ( api != RtMidi::RTMIDI_LOOPBACK ) std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+    in.closePort();
+  }
+  catch ( RtMidiError &error ) {
+    error.printMessage();
+    return 1;
+  }
+  catch ( std::exception &error ) {
+    std::cerr << "latencybench: " << error.what() << std::endl;
+    return 1;
+  }
+
+  std::lock_guard<std::mutex> guard( lock );
+  std::vector<Summary> summaries;
+  for ( std::map<std::string, std::vector<Sample> >::const_iterator i=samples.begin(); i!=samples.end(); ++i ) {
+    summaries.push_back( summarise( i->first, i->second ) );
+    messages += i->second.size();
+  }
+
+  std::cout << "latencybench: " << seconds << " s of source time at speed " << speed << ", " << apiName
+            << " API, " << messages << " messages and " << between << " between events\n"
+            << "latency in microseconds from when the source should have delivered the event to\n"
+            << "the message's arrival; schedule and output split the median at dispatch\n\n";
+  std::cout << std::left << std::setw( 22 ) << "event" << std::right << std::setw( 8 ) << "count"
+            << std::setw( 10 ) << "p50" << std::setw( 10 ) << "p99" << std::setw( 10 ) << "p99.9"
+            << std::setw( 10 ) << "max" << std::setw( 10 ) << "jitter" << std::setw( 10 ) << "schedule"
+            << std::setw( 10 ) << "output" << std::endl;
+  std::cout << std::fixed << std::setprecision( 1 );
+  for ( size_t i=0; i<summaries.size(); i++ ) {
+    const Summary &s = summaries[i];
+    std::cout << std::left << std::setw( 22 ) << s.event << std::right << std::setw( 8 ) << s.count
+              << std::setw( 10 ) << s.p50 << std::setw( 10 ) << s.p99 << std::setw( 10 ) << s.p999
+              << std::setw( 10 ) << s.max << std::setw( 10 ) << s.jitter << std::setw( 10 ) << s.schedule50
+              << std::setw( 10 ) << s.output50 << std::endl;
+  }
+
+  if ( !jsonFile.empty() ) {
+    std::ofstream json( jsonFile.c_str() );
+    json << std::fixed << std::setprecision( 3 );
+    json << "{\n  \"benchmark\": \"latencybench\",\n  \"api\": \"" << apiName << "\",\n"
+         << "  \"seconds\": " << seconds << ",\n  \"speed\": " << speed << ",\n  \"unit\": \"us\",\n  \"events\": [";
+    for ( size_t i=0; i<summaries.size(); i++ ) {
+      const Summary &s = summaries[i];
+      json << ( i ? "," : "" ) << "\n    { \"event\": \"" << s.event << "\", \"count\": " << s.count
+           << ", \"p50\": " << s.p50 << ", \"p99\": " << s.p99 << ", \"p99_9\": " << s.p999
+           << ", \"max\": " << s.max << ", \"jitter\": " << s.jitter
+           << ", \"schedule_p50\": " << s.schedule50 << ", \"output_p50\": " << s.output50 << " }";
+    }
+    json << "\n  ]\n}\n";
+    if ( !json ) {
+      std::cerr << "latencybench: cannot write " << jsonFile << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,98 @@
+//*****************************************//
+//  logbench.cpp
+//
+//  Measures the cost to the logging thread
+//  of one diagnostic line: AsyncLog's
+//  record against formatting with an
+//  ostream and ending the line with
+//  std::endl, in bursts like a gesture
+//  frame's, from one thread and from
+//  several at once.
+//
+//*****************************************//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "AsyncLog.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static const size_t burst = 64;
+
+// Bursts of \e burst lines a millisecond apart; the time of each burst
+// over its lines.
+template <class Write>
+static std::vector<double> run( size_t bursts, Write write )
+{
+  std::vector<double> costs;
+  costs.reserve( bursts );
+  for ( size_t b=0; b<bursts; b++ ) {
+    Clock::time_point start = Clock::now();
+    for ( size_t i=0; i<burst; i++ ) write( (int) ( b * burst + i ), 0.5 * i );
+    costs.push_back( std::chrono::duration<double, std::nano>( Clock::now() - start ).count() / burst );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+  }
+  return costs;
+}
+
+static std::mutex lock;
+
+static void report( const char *name, std::vector<double> &costs )
+{
+  std::lock_guard<std::mutex> guard( lock );
+  std::sort( costs.begin(), costs.end() );
+  size_t n = costs.size();
+  std::cout << std::left << std::setw( 30 ) << name << std::right << std::fixed << std::setprecision( 1 )
+            << std::setw( 10 ) << costs[n / 2] << std::setw( 10 ) << costs[n * 99 / 100]
+            << std::setw( 10 ) << costs[n - 1] << std::endl;
+}
+
+int main( int argc, char *argv[] )
+{
+  size_t bursts = 1000;
+  unsigned int threads = 4;
+  if ( argc > 1 ) bursts = strtoul( argv[1], 0, 10 );
+  if ( argc > 2 ) threads = (unsigned int) strtoul( argv[2], 0, 10 );
+
+  std::cout << "logbench: " << bursts << " bursts of " << burst << " lines, nanoseconds a line on the logging thread\n\n"
+            << std::left << std::setw( 30 ) << "writer" << std::right << std::setw( 10 ) << "p50" << std::setw( 10 )
+            << "p99" << std::setw( 10 ) << "max" << std::endl;
+
+  std::ofstream null( "/dev/null" );
+  std::vector<double> costs = run( bursts, [&null]( int frame, double pitch ) {
+      null << "frame " << frame << " pitch " << pitch << std::endl;
+    } );
+  report( "ostream, std::endl", costs );
+
+  costs = run( bursts, [&null]( int frame, double pitch ) {
+      null << "frame " << frame << " pitch " << pitch << '\n';
+    } );
+  report( "ostream, '\\n'", costs );
+
+  uint64_t dropped;
+  {
+    AsyncLog log( null );
+    AsyncLog::Format format = log.define( "frame {} pitch {}" );
+    costs = run( bursts, [&log, format]( int frame, double pitch ) { log.log( format, frame, pitch ); } );
+    report( "AsyncLog", costs );
+
+    std::vector<std::thread> writers;
+    for ( unsigned int t=0; t<threads; t++ )
+      writers.push_back( std::thread( [&log, format, bursts]() {
+            std::vector<double> mine = run( bursts, [&log, format]( int frame, double pitch ) { log.log( format, frame, pitch ); } );
+            report( "AsyncLog, one of several", mine );
+          } ) );
+    for ( size_t t=0; t<writers.size(); t++ ) writers[t].join();
+    log.flush();
+    dropped = log.dropped();
+  }
+  std::cout << "\nAsyncLog dropped " << dropped << " of " << bursts * burst * ( threads + 1 ) << " records" << std::endl;
+  return 0;
+}
@@ -0,0 +1,203 @@
+//*****************************************//
+//  notebench.cpp
+//
+//  Checks the notes a mapping leaves the
+//  receiver with.  Two synthetic armbands
+//  play dj.map, instrument.map and
+//  liveloop.map in real time into a
+//  loopback input, which keeps its own
+//  bit per note and counts note-offs for
+//  notes not sounding, note-ons for notes
+//  already sounding and the notes still
+//  sounding after the mapping is gone.
+//  Reports what the mapping's note
+//  tracker dropped and retriggered and the
+//  note-offs it sent at the end.  Then
+//  times ending a few sounding notes with
+//  the tracker against a note-off for
+//  every note on every channel, and the
+//  time each takes on a DIN port.
+//
+//  usage: notebench [SECONDS]
+//
+//*****************************************//
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "RtMidi.h"
+#include "MidiNoteTracker.h"
+#include "MidiOutQueue.h"
+#include "MidiScheduler.h"
+#include "EventLoop.h"
+#include "MidiMapping.h"
+#include "StatusDisplay.h"
+#include "SyntheticSource.h"
+
+// The receiver's view.
+static bool sounding[16][128];
+static uint64_t stray = 0, stacked = 0, noteOffs = 0, messages = 0;
+
+static void receive( double /*deltatime*/, std::vector< unsigned char > *message, void * /*userData*/ )
+{
+  const std::vector<unsigned char> &m = *message;
+  messages++;
+  if ( m.size() != 3 ) return;
+  unsigned int type = m[0] & 0xF0, channel = m[0] & 0x0F, note = m[1] & 0x7F;
+  if ( type == 0x90 && m[2] ) {
+    if ( sounding[channel][note] ) stacked++;
+    sounding[channel][note] = true;
+  }
+  else if ( type == 0x80 || type == 0x90 ) {
+    if ( !sounding[channel][note] ) stray++;
+    sounding[channel][note] = false;
+    noteOffs++;
+  }
+}
+
+static void reset( void )
+{
+  for ( int i=0; i<16; i++ )
+    for ( int j=0; j<128; j++ ) sounding[i][j] = false;
+  stray = stacked = noteOffs = messages = 0;
+}
+
+static unsigned int countSounding( void )
+{
+  unsigned int count = 0;
+  for ( int i=0; i<16; i++ )
+    for ( int j=0; j<128; j++ ) count += sounding[i][j];
+  return count;
+}
+
+static std::string readFile( const std::string &name )
+{
+  std::ifstream file( name.c_str() );
+  if ( !file ) throw std::runtime_error( "cannot read " + name );
+  std::ostringstream text;
+  text << file.rdbuf();
+  return text.str();
+}
+
+static void play( const char *name, RtMidiOut &out, double seconds )
+{
+  reset();
+  uint64_t dropped, retriggered;
+  unsigned int before, ended;
+  {
+    MidiScheduler scheduler;
+    sensor::StatusBoard board;
+    sensor::MidiMapping mapping( &out, scheduler );
+    std::istringstream text( readFile( std::string( MAPPING_DIRECTORY "/" ) + name ) );
+    mapping.load( text, name );
+    mapping.setStatusBoard( &board );
+
+    sensor::SyntheticSource source( 1.0, 2, (uint64_t) ( seconds * 1000000 ) );
+    source.addListener( &mapping );
+    mapping.start();
+    sensor::EventLoop loop( &source );
+    loop.setScheduler( &scheduler );
+    loop.run();
+
+    dropped = mapping.getNotes().getDropped();
+    retriggered = mapping.getNotes().getRetriggered();
+    before = countSounding();
+    ended = noteOffs;
+  }
+  ended = noteOffs - ended;
+
+  std::cout << std::left << std::setw( 16 ) << name << std::right << std::setw( 8 ) << stray << std::setw( 9 ) << stacked
+            << std::setw( 9 ) << dropped << std::setw( 11 ) << retriggered << std::setw( 8 ) << before
+            << std::setw( 7 ) << ended << std::setw( 7 ) << countSounding() << std::endl;
+}
+
+// Time ending \e notes sounding notes, with the tracker or blind.
+static void panic( RtMidiOut &out, unsigned int notes )
+{
+  typedef std::chrono::steady_clock Clock;
+  const int rounds = 2000;
+  int64_t tracked = 0, blind = 0;
+  uint64_t trackedMessages = 0, blindMessages = 0;
+  MidiNoteTracker tracker( &out );
+  for ( int round=0; round<rounds; round++ ) {
+    for ( unsigned int i=0; i<notes; i++ ) {
+      unsigned char on[3] = { static_cast<unsigned char>( 0x90 | ( i % 4 ) ), static_cast<unsigned char>( 36 + i * 5 ), 100 };
+      tracker.send( on, 3 );
+    }
+    uint64_t start = messages;
+    Clock::time_point t0 = Clock::now();
+    tracker.notesOff();
+    Clock::time_point t1 = Clock::now();
+    trackedMessages += messages - start;
+
+    start = messages;
+    for ( unsigned int channel=0; channel<16; channel++ )
+      for ( unsigned int note=0; note<128; note++ ) {
+        unsigned char off[3] = { static_cast<unsigned char>( 0x80 | channel ), static_cast<unsigned char>( note ), 0 };
+        out.sendMessage( off, 3 );
+      }
+    Clock::time_point t2 = Clock::now();
+    blindMessages += messages - start;
+    tracked += std::chrono::duration_cast<std::chrono::nanoseconds>( t1 - t0 ).count();
+    blind += std::chrono::duration_cast<std::chrono::nanoseconds>( t2 - t1 ).count();
+  }
+
+  std::cout << std::fixed << std::setprecision( 2 );
+  std::cout << std::left << std::setw( 16 ) << "tracker" << std::right << std::setw( 10 ) << trackedMessages / rounds
+            << std::setw( 12 ) << tracked / rounds / 1000.0 << std::setw( 12 ) << trackedMessages / rounds * 3 * 1000.0 / MidiOutQueue::DIN_RATE << std::endl;
+  std::cout << std::left << std::setw( 16 ) << "every note" << std::right << std::setw( 10 ) << blindMessages / rounds
+            << std::setw( 12 ) << blind / rounds / 1000.0 << std::setw( 12 ) << blindMessages / rounds * 3 * 1000.0 / MidiOutQueue::DIN_RATE << std::endl;
+}
+
+int main( int argc, char *argv[] )
+{
+  double seconds = argc > 1 ? strtod( argv[1], 0 ) : 10.0;
+  if ( !( seconds > 0.0 ) ) {
+    std::cerr << "usage: notebench [SECONDS]" << std::endl;
+    return 1;
+  }
+
+  try {
+    RtMidiOut out( RtMidi::RTMIDI_LOOPBACK, "notebench" );
+    out.openVirtualPort( "mapping" );
+    RtMidiIn in( RtMidi::RTMIDI_LOOPBACK, "notebench" );
+    unsigned int port = 0;
+    while ( port < in.getPortCount() && in.getPortName( port ).find( "mapping" ) == std::string::npos ) port++;
+    if ( port == in.getPortCount() ) throw std::runtime_error( "cannot find the mapping's output port" );
+    in.setCallback( &receive );
+    in.openPort( port, "notebench in" );
+
+    std::cout << "notebench: " << seconds << " s of two synthetic armbands per mapping, in real time\n"
+              << "at the receiver: note-offs for notes not sounding, note-ons for notes sounding;\n"
+              << "the tracker's dropped note-offs and retriggers; notes sounding when the mapping\n"
+              << "ends, the note-offs it sends and the notes sounding after\n\n"
+              << std::left << std::setw( 16 ) << "mapping" << std::right << std::setw( 8 ) << "stray" << std::setw( 9 ) << "stacked"
+              << std::setw( 9 ) << "dropped" << std::setw( 11 ) << "retrigger" << std::setw( 8 ) << "at end"
+              << std::setw( 7 ) << "ended" << std::setw( 7 ) << "hung" << std::endl;
+    play( "dj.map", out, seconds );
+    play( "instrument.map", out, seconds );
+    play( "liveloop.map", out, seconds );
+
+    std::cout << "\nending 4 sounding notes: messages, microseconds to send on loopback and\n"
+              << "milliseconds on a DIN port\n\n"
+              << std::left << std::setw( 16 ) << "panic" << std::right << std::setw( 10 ) << "messages" << std::setw( 12 ) << "send us"
+              << std::setw( 12 ) << "DIN ms" << std::endl;
+    reset();
+    panic( out, 4 );
+  }
+  catch ( RtMidiError &error ) {
+    error.printMessage();
+    return 1;
+  }
+  catch ( std::exception &error ) {
+    std::cerr << "notebench: " << error.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,182 @@
+//*****************************************//
+//  orientationbench.cpp
+//
+//  Measures quaternion to roll, pitch and
+//  yaw buckets with libm, with the
+//  polynomial scalar path, with the batch
+//  kernel and with the trig-free table
+//  quantiser, and checks that they all
+//  give the same buckets.
+//
+//*****************************************//
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "AngleQuantiser.h"
+#include "OrientationMath.h"
+
+typedef std::chrono::steady_clock Clock;
+
+struct Quaternions {
+  std::vector<float> x, y, z, w;
+  void add( float qx, float qy, float qz, float qw ) { x.push_back( qx ); y.push_back( qy ); z.push_back( qz ); w.push_back( qw ); }
+  size_t size( void ) const { return x.size(); }
+  sensor::Quaternion operator[]( size_t i ) const { return sensor::Quaternion( x[i], y[i], z[i], w[i] ); }
+};
+
+static uint32_t state = 12345;
+
+static double uniform( void )
+{
+  state = state * 1664525u + 1013904223u;
+  return ( ( state >> 8 ) + 0.5 ) / 16777216.0;
+}
+
+// Uniformly distributed rotations, plus the awkward ones: the axes,
+// signed zeros and pitch at +-90 degrees.
+static Quaternions testQuaternions( size_t count )
+{
+  Quaternions q;
+  static const float h = 0.70710678f;
+  float special[][4] = {
+    { 0, 0, 0, 1 }, { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { -0.0f, -0.0f, -0.0f, 1 },
+    { 0, -0.0f, 0, -1 }, { h, 0, 0, h }, { 0, h, 0, h }, { 0, 0, h, h }, { 0, -h, 0, h },
+    { h, h, 0, 0 }, { 0.5f, 0.5f, 0.5f, 0.5f }, { -0.5f, 0.5f, -0.5f, 0.5f }, { 0.5f, -0.5f, 0.5f, 0.5f }
+  };
+  for ( size_t i=0; i<sizeof( special ) / sizeof( special[0] ); i++ )
+    q.add( special[i][0], special[i][1], special[i][2], special[i][3] );
+
+  while ( q.size() < count ) {
+    // Shoemake's method.
+    double u1 = uniform(), u2 = 2 * M_PI * uniform(), u3 = 2 * M_PI * uniform();
+    double a = std::sqrt( 1 - u1 ), b = std::sqrt( u1 );
+    q.add( (float) ( a * std::sin( u2 ) ), (float) ( a * std::cos( u2 ) ), (float) ( b * std::sin( u3 ) ), (float) ( b * std::cos( u3 ) ) );
+  }
+  return q;
+}
+
+// The largest error of the fast angles against double precision.
+static double maxAngleError( const Quaternions &q )
+{
+  double worst = 0.0;
+  for ( size_t i=0; i<q.size(); i++ ) {
+    float x = q.x[i], y = q.y[i], z = q.z[i], w = q.w[i];
+    double roll = std::atan2( (double) ( 2.0f * ( w * x + y * z ) ), (double) ( 1.0f - 2.0f * ( x * x + y * y ) ) );
+    double pitch = std::asin( (double) std::max( -1.0f, std::min( 1.0f, 2.0f * ( w * y - z * x ) ) ) );
+    double yaw = std::atan2( (double) ( 2.0f * ( w * z + x * y ) ), (double) ( 1.0f - 2.0f * ( y * y + z * z ) ) );
+    sensor::EulerAngles fast = sensor::fastEulerAngles( q[i] );
+    double e = std::max( std::fabs( fast.pitch - pitch ),
+                         std::max( std::remainder( std::fabs( fast.roll - roll ), 2 * M_PI ),
+                                   std::remainder( std::fabs( fast.yaw - yaw ), 2 * M_PI ) ) );
+    worst = std::max( worst, std::fabs( e ) );
+  }
+  return worst;
+}
+
+template <int RollSteps, int PitchSteps, int YawSteps>
+static size_t countMismatches( const Quaternions &q )
+{
+  sensor::AngleSteps steps = { RollSteps, PitchSteps, YawSteps };
+  sensor::AngleBucketer bucketer( steps );
+  sensor::AngleQuantiser<RollSteps, PitchSteps, YawSteps> quantiser;
+  size_t n = q.size(), mismatches = 0;
+  std::vector<int> roll( n ), pitch( n ), yaw( n );
+  bucketer.buckets( &q.x[0], &q.y[0], &q.z[0], &q.w[0], n, &roll[0], &pitch[0], &yaw[0] );
+  for ( size_t i=0; i<n; i++ ) {
+    sensor::AngleBuckets exact = bucketer.exactBuckets( q[i] );
+    sensor::AngleBuckets fast = bucketer.buckets( q[i] );
+    sensor::AngleBuckets table = quantiser.buckets( q[i] );
+    bool thresholds = quantiser.template rollAtLeast<RollSteps / 2>( q[i] ) == ( exact.roll >= RollSteps / 2 ) &&
+                      quantiser.template pitchAtLeast<PitchSteps - 1>( q[i] ) == ( exact.pitch >= PitchSteps - 1 ) &&
+                      quantiser.template yawAtLeast<1>( q[i] ) == ( exact.yaw >= 1 );
+    if ( fast.roll != exact.roll || fast.pitch != exact.pitch || fast.yaw != exact.yaw ||
+         roll[i] != exact.roll || pitch[i] != exact.pitch || yaw[i] != exact.yaw ||
+         table.roll != exact.roll || table.pitch != exact.pitch || table.yaw != exact.yaw || !thresholds ) {
+      if ( mismatches++ < 5 )
+        std::cout << "mismatch at (" << q.x[i] << ", " << q.y[i] << ", " << q.z[i] << ", " << q.w[i] << ")\n";
+    }
+  }
+  return mismatches;
+}
+
+static void report( const std::string &name, Clock::duration elapsed, size_t count )
+{
+  double ns = std::chrono::duration<double, std::nano>( elapsed ).count() / count;
+  std::cout << std::left << std::setw( 40 ) << name << std::right
+            << std::fixed << std::setprecision( 2 ) << std::setw( 10 ) << ns << std::endl;
+}
+
+int main( int argc, char *argv[] )
+{
+  size_t count = 1000000;
+  unsigned int rounds = 10;
+  if ( argc > 1 ) count = strtoul( argv[1], 0, 10 );
+
+  Quaternions q = testQuaternions( count );
+  sensor::AngleSteps steps = { 127, 127, 127 };
+
+  std::cout << "orientationbench: " << count << " quaternions, batch kernel " << sensor::angleBucketKernel() << "\n\n";
+
+  double error = maxAngleError( q );
+  size_t mismatches = countMismatches<127, 127, 127>( q ) + countMismatches<127, 8, 127>( q );
+  std::cout << "max angle error " << std::scientific << std::setprecision( 2 ) << error
+            << " rad (bound " << sensor::maxEulerError << "), " << mismatches << " bucket mismatches\n\n";
+
+  sensor::AngleBucketer bucketer( steps );
+  std::cout << std::left << std::setw( 40 ) << "case" << std::right << std::setw( 10 ) << "ns/quat" << std::endl;
+
+  long checksum = 0;
+  Clock::time_point start = Clock::now();
+  for ( unsigned int r=0; r<rounds; r++ )
+    for ( size_t i=0; i<count; i++ ) {
+      sensor::AngleBuckets b = bucketer.exactBuckets( q[i] );
+      checksum += b.roll + b.pitch + b.yaw;
+    }
+  report( "libm atan2/asin/atan2", Clock::now() - start, rounds * count );
+
+  start = Clock::now();
+  for ( unsigned int r=0; r<rounds; r++ )
+    for ( size_t i=0; i<count; i++ ) {
+      sensor::AngleBuckets b = bucketer.buckets( q[i] );
+      checksum -= b.roll + b.pitch + b.yaw;
+    }
+  report( "polynomial, one at a time", Clock::now() - start, rounds * count );
+
+  sensor::AngleQuantiser<127, 127, 127> quantiser;
+  start = Clock::now();
+  for ( unsigned int r=0; r<rounds; r++ )
+    for ( size_t i=0; i<count; i++ ) {
+      sensor::AngleBuckets b = quantiser.buckets( q[i] );
+      checksum += b.roll + b.pitch + b.yaw;
+    }
+  report( "table quantiser, one at a time", Clock::now() - start, rounds * count );
+
+  // The dj mapping's tests: pitch_w > 80 and pitch_w < 20.
+  start = Clock::now();
+  for ( unsigned int r=0; r<rounds; r++ )
+    for ( size_t i=0; i<count; i++ )
+      checksum += quantiser.pitchAtLeast<81>( q[i] ) + !quantiser.pitchAtLeast<20>( q[i] );
+  report( "table thresholds, pitch > 80, < 20", Clock::now() - start, rounds * count );
+
+  // Batches the size of a handful of armbands up to a large table.
+  static const size_t batchSizes[] = { 2, 8, 64, 4096 };
+  std::vector<int> roll( count ), pitch( count ), yaw( count );
+  for ( size_t k=0; k<sizeof( batchSizes ) / sizeof( batchSizes[0] ); k++ ) {
+    size_t batch = batchSizes[k];
+    size_t n = count - count % batch;
+    start = Clock::now();
+    for ( unsigned int r=0; r<rounds; r++ )
+      for ( size_t i=0; i<n; i+=batch )
+        bucketer.buckets( &q.x[i], &q.y[i], &q.z[i], &q.w[i], batch, &roll[i], &pitch[i], &yaw[i] );
+    report( "batch of " + std::to_string( batch ), Clock::now() - start, rounds * n );
+    for ( size_t i=0; i<n; i++ ) checksum += roll[i] + pitch[i] + yaw[i];
+  }
+
+  std::cout << "\nchecksum " << checksum << std::endl;
+  return ( error <= sensor::maxEulerError && mismatches == 0 ) ? 0 : 1;
+}
@@ -0,0 +1,237 @@
+//*****************************************//
+//  pacebench.cpp
+//
+//  Measures note and clock latency on a
+//  saturated DIN-rate link.  Two simulated
+//  armbands each send twelve controllers
+//  at 50 Hz, about 115% of 3125 bytes a
+//  second, while a note plays every 125 ms
+//  and a clock ticks at 120 bpm.  The same
+//  stream goes through a single paced
+//  first-in first-out queue, as a driver's
+//  buffer sends it, and through a
+//  MidiOutQueue's lanes at the same rate,
+//  into a loopback input that times each
+//  arrival.  Also reports how old each
+//  controller value is when it arrives and
+//  the bytes a second sent.
+//
+//  usage: pacebench [SECONDS]
+//
+//*****************************************//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "RtMidi.h"
+#include "MidiOutQueue.h"
+#include "MidiScheduler.h"
+
+static const unsigned int rate = MidiOutQueue::DIN_RATE;
+static const unsigned int armbands = 2, controllers = 12;
+static const int64_t framePeriod = 20000, notePeriod = 125000, noteLength = 60000;
+static const int64_t tickPeriod = 60000000 / ( 120 * 24 );
+
+// When each thing was asked for, and how long it took to arrive.
+struct Record {
+  std::vector<int64_t> noteAsked;            // by note number
+  std::deque<int64_t> ticksAsked;
+  std::vector<int64_t> controlAsked;         // by controller and value
+  std::vector<int64_t> notes, ticks, ages;
+  uint64_t bytes;
+};
+
+static Record record;
+
+static void receive( double /*deltatime*/, std::vector< unsigned char > *message, void * /*userData*/ )
+{
+  int64_t now = MidiScheduler::now();
+  const std::vector<unsigned char> &m = *message;
+  record.bytes += m.size();
+  if ( m[0] == 0xF8 ) {
+    if ( record.ticksAsked.empty() ) return;
+    record.ticks.push_back( now - record.ticksAsked.front() );
+    record.ticksAsked.pop_front();
+  }
+  else if ( ( m[0] & 0xF0 ) == 0x90 ) record.notes.push_back( now - record.noteAsked[m[1]] );
+  else if ( ( m[0] & 0xF0 ) == 0xB0 ) record.ages.push_back( now - record.controlAsked[( ( m[0] & 0x0F ) * 128 + m[1] ) * 128 + m[2]] );
+}
+
+// A single paced queue in arrival order, as a driver sends it.
+class Fifo
+{
+ public:
+  Fifo( RtMidiOut *out, MidiScheduler &scheduler )
+    : out_( out ), scheduler_( scheduler ), credit_( 4.0 ), refilled_( MidiScheduler::now() ), pending_( 0 ) {}
+  ~Fifo( void ) { if ( pending_ ) scheduler_.cancel( pending_ ); }
+
+  void send( const unsigned char *message, size_t size )
+  {
+    queue_.push_back( std::vector<unsigned char>( message, message + size ) );
+    pump();
+  }
+
+ private:
+  RtMidiOut *out_;
+  MidiScheduler &scheduler_;
+  std::deque<std::vector<unsigned char> > queue_;
+  double credit_;
+  int64_t refilled_;
+  MidiScheduler::Handle pending_;
+
+  void pump( void )
+  {
+    int64_t now = MidiScheduler::now();
+    credit_ = std::min( 4.0, credit_ + ( now - refilled_ ) * ( rate / 1000000.0 ) );
+    refilled_ = now;
+    while ( !queue_.empty() ) {
+      std::vector<unsigned char> &message = queue_.front();
+      if ( credit_ < message.size() ) {
+        if ( !pending_ )
+          pending_ = scheduler_.schedule( now + (int64_t) std::ceil( ( message.size() - credit_ ) * 1000000.0 / rate ),
+                                          [this]( void ) { pending_ = 0; pump(); } );
+        return;
+      }
+      out_->sendMessage( &message[0], message.size() );
+      credit_ -= message.size();
+      queue_.pop_front();
+    }
+  }
+};
+
+template <class Link>
+static void run( const char *name, Link &link, MidiScheduler &scheduler, double seconds )
+{
+  record.noteAsked.assign( 128, 0 );
+  record.ticksAsked.clear();
+  record.controlAsked.assign( 16 * 128 * 128, 0 );
+  record.notes.clear();
+  record.ticks.clear();
+  record.ages.clear();
+  record.bytes = 0;
+
+  int64_t start = MidiScheduler::now(), end = start + (int64_t) ( seconds * 1000000 );
+  int64_t nextFrame[armbands], nextNote = start + notePeriod / 2, nextTick = start;
+  unsigned int frame[armbands], note = 0;
+  for ( unsigned int a=0; a<armbands; a++ ) {
+    nextFrame[a] = start + a * framePeriod / armbands;
+    frame[a] = 0;
+  }
+  std::vector<std::pair<int64_t, unsigned int> > noteOffs;
+
+  for ( ;; ) {
+    int64_t now = MidiScheduler::now();
+    scheduler.advance( now );
+    if ( now >= end ) break;
+
+    for ( unsigned int a=0; a<armbands; a++ ) {
+      if ( now < nextFrame[a] ) continue;
+      // Each controller sweeps, so every value is new.
+      for ( unsigned int c=0; c<controllers; c++ ) {
+        unsigned int channel = a, controller = 20 + c, value = ( frame[a] + c * 7 ) & 0x7F;
+        unsigned char message[3] = { static_cast<unsigned char>( 0xB0 | channel ), static_cast<unsigned char>( controller ), static_cast<unsigned char>( value ) };
+        record.controlAsked[( channel * 128 + controller ) * 128 + value] = now;
+        link.send( message, 3 );
+      }
+      frame[a]++;
+      nextFrame[a] += framePeriod;
+    }
+    if ( now >= nextNote ) {
+      unsigned char message[3] = { 0x99, static_cast<unsigned char>( note ), 100 };
+      record.noteAsked[note] = now;
+      link.send( message, 3 );
+      noteOffs.push_back( std::make_pair( now + noteLength, note ) );
+      note = ( note + 1 ) & 0x7F;
+      nextNote += notePeriod;
+    }
+    while ( !noteOffs.empty() && noteOffs.front().first <= now ) {
+      unsigned char message[3] = { 0x89, static_cast<unsigned char>( noteOffs.front().second ), 0 };
+      link.send( message, 3 );
+      noteOffs.erase( noteOffs.begin() );
+    }
+    if ( now >= nextTick ) {
+      unsigned char tick = 0xF8;
+      record.ticksAsked.push_back( now );
+      link.send( &tick, 1 );
+      nextTick += tickPeriod;
+    }
+
+    int64_t wake = std::min( std::min( nextNote, nextTick ), std::min( scheduler.nextDue(), end ) );
+    for ( unsigned int a=0; a<armbands; a++ ) wake = std::min( wake, nextFrame[a] );
+    if ( !noteOffs.empty() ) wake = std::min( wake, noteOffs.front().first );
+    int64_t remaining = wake - MidiScheduler::now();
+    if ( remaining > 0 ) std::this_thread::sleep_for( std::chrono::microseconds( remaining ) );
+  }
+
+  std::vector<int64_t> *sets[] = { &record.notes, &record.ticks, &record.ages };
+  std::cout << std::left << std::setw( 10 ) << name << std::right << std::fixed << std::setprecision( 1 );
+  for ( int i=0; i<3; i++ ) {
+    std::vector<int64_t> &v = *sets[i];
+    std::sort( v.begin(), v.end() );
+    size_t n = v.size();
+    if ( n == 0 ) {
+      std::cout << std::setw( 8 ) << "-" << std::setw( 8 ) << "-" << std::setw( 8 ) << "-";
+      continue;
+    }
+    std::cout << std::setw( 8 ) << v[n / 2] / 1000.0 << std::setw( 8 ) << v[n * 99 / 100] / 1000.0 << std::setw( 8 ) << v[n - 1] / 1000.0;
+  }
+  std::cout << std::setw( 9 ) << (uint64_t) ( record.bytes / seconds ) << std::endl;
+}
+
+int main( int argc, char *argv[] )
+{
+  double seconds = argc > 1 ? strtod( argv[1], 0 ) : 8.0;
+  if ( !( seconds > 0.0 ) ) {
+    std::cerr << "usage: pacebench [SECONDS]" << std::endl;
+    return 1;
+  }
+
+  try {
+    RtMidiOut out( RtMidi::RTMIDI_LOOPBACK, "pacebench" );
+    out.openVirtualPort( "din" );
+    RtMidiIn in( RtMidi::RTMIDI_LOOPBACK, "pacebench" );
+    unsigned int port = 0;
+    while ( port < in.getPortCount() && in.getPortName( port ).find( "din" ) == std::string::npos ) port++;
+    if ( port == in.getPortCount() ) throw std::runtime_error( "cannot find the output port" );
+    in.setCallback( &receive );
+    in.ignoreTypes( true, false, true );
+    in.openPort( port, "pacebench in" );
+
+    std::cout << "pacebench: " << seconds << " s at " << rate << " bytes a second, asked for "
+              << (unsigned int) ( armbands * controllers * 3 * 1000000 / framePeriod + 3 * 2 * 1000000 / notePeriod + 1000000 / tickPeriod )
+              << "\nmilliseconds from asking to arrival: note-ons, clock ticks and the age of each\n"
+              << "controller value that arrives (p50, p99, max); bytes a second at the input\n\n"
+              << std::left << std::setw( 10 ) << "link" << std::right << std::setw( 24 ) << "note-on" << std::setw( 24 ) << "clock"
+              << std::setw( 24 ) << "controller age" << std::setw( 9 ) << "bytes/s" << std::endl;
+
+    {
+      MidiScheduler scheduler;
+      Fifo fifo( &out, scheduler );
+      run( "fifo", fifo, scheduler, seconds );
+    }
+    {
+      MidiScheduler scheduler;
+      MidiOutQueue queue( &out, scheduler, rate );
+      run( "lanes", queue, scheduler, seconds );
+      std::cout << "\nlanes: " << queue.getCoalesced() << " controller values replaced while waiting, "
+                << queue.getDropped() << " messages dropped" << std::endl;
+    }
+  }
+  catch ( RtMidiError &error ) {
+    error.printMessage();
+    return 1;
+  }
+  catch ( std::exception &error ) {
+    std::cerr << "pacebench: " << error.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,224 @@
+//*****************************************//
+//  recordingbench.cpp
+//
+//  Measures the size and the encode and
+//  decode rates of the binary sensor
+//  recording format against the text
+//  format, on an hour of two synthetic
+//  armbands, and checks that a recording
+//  plays back what was recorded.
+//
+//*****************************************//
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "SensorRecording.h"
+#include "SyntheticSource.h"
+#include "TextReplaySource.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static double seconds( Clock::duration elapsed )
+{
+  return std::chrono::duration<double>( elapsed ).count();
+}
+
+// Counts events, to measure decoding alone.
+class Counter : public sensor::Listener
+{
+ public:
+  Counter( void ) : count( 0 ) {}
+  void onPair( sensor::Device *, uint64_t ) { count++; }
+  void onConnect( sensor::Device *, uint64_t ) { count++; }
+  void onArmSync( sensor::Device *, uint64_t, sensor::Arm, sensor::XDirection ) { count++; }
+  void onUnlock( sensor::Device *, uint64_t ) { count++; }
+  void onPose( sensor::Device *, uint64_t, sensor::Pose ) { count++; }
+  void onOrientationData( sensor::Device *, uint64_t, const sensor::Quaternion & ) { count++; }
+  void onAccelerometerData( sensor::Device *, uint64_t, const sensor::Vector3 & ) { count++; }
+  void onGyroscopeData( sensor::Device *, uint64_t, const sensor::Vector3 & ) { count++; }
+  void onEmgData( sensor::Device *, uint64_t, const int8_t * ) { count++; }
+  uint64_t count;
+};
+
+// Keeps every event as a line of text, to compare a recording with
+// what was recorded.
+class Log : public sensor::Listener
+{
+ public:
+  Log( void ) : maxError( 0.0 ) {}
+
+  void onPair( sensor::Device *d, uint64_t t ) { add( d, t, "pair" ); }
+  void onConnect( sensor::Device *d, uint64_t t ) { add( d, t, "connect" ); }
+  void onUnlock( sensor::Device *d, uint64_t t ) { add( d, t, "unlock" ); }
+  void onArmSync( sensor::Device *d, uint64_t t, sensor::Arm arm, sensor::XDirection x )
+  {
+    add( d, t, "arm " + std::to_string( arm ) + " " + std::to_string( x ) );
+  }
+  void onPose( sensor::Device *d, uint64_t t, sensor::Pose pose ) { add( d, t, "pose " + pose.toString() ); }
+  void onOrientationData( sensor::Device *d, uint64_t t, const sensor::Quaternion &q )
+  {
+    add( d, t, "orient" );
+    quaternions.push_back( q );
+  }
+  void onEmgData( sensor::Device *d, uint64_t t, const int8_t *emg )
+  {
+    std::string line = "emg";
+    for ( unsigned int i=0; i<sensor::emgChannels; i++ ) line += " " + std::to_string( emg[i] );
+    add( d, t, line );
+  }
+
+  std::vector<std::string> lines;
+  std::vector<sensor::Quaternion> quaternions;
+  double maxError;
+
+ private:
+  std::vector<sensor::Device *> devices_;
+
+  void add( sensor::Device *device, uint64_t timestamp, const std::string &event )
+  {
+    size_t id = 0;
+    while ( id < devices_.size() && devices_[id] != device ) id++;
+    if ( id == devices_.size() ) devices_.push_back( device );
+    lines.push_back( std::to_string( timestamp ) + " " + std::to_string( id ) + " " + event );
+  }
+};
+
+static uint64_t fileSize( const std::string &fileName )
+{
+  FILE *file = fopen( fileName.c_str(), "rb" );
+  if ( !file ) return 0;
+  fseek( file, 0, SEEK_END );
+  long size = ftell( file );
+  fclose( file );
+  return size;
+}
+
+static void runToEnd( sensor::Source &source )
+{
+  while ( source.run( 1000 ) ) {}
+}
+
+static void report( const std::string &name, uint64_t bytes, double minutes, uint64_t events,
+                    double encodeSeconds, double decodeSeconds )
+{
+  std::cout << std::left << std::setw( 28 ) << name << std::right << std::fixed
+            << std::setw( 12 ) << std::setprecision( 2 ) << bytes / 1e6 * 60.0 / minutes
+            << std::setw( 12 ) << std::setprecision( 2 ) << 8.0 * bytes / events
+            << std::setw( 14 ) << std::setprecision( 2 ) << events / encodeSeconds / 1e6
+            << std::setw( 14 ) << std::setprecision( 2 ) << events / decodeSeconds / 1e6 << std::endl;
+}
+
+// Record \e minutes of synthetic data in the binary format and play it back.
+static void measureBinary( const std::string &name, const std::string &fileName, double minutes, bool imu )
+{
+  sensor::SyntheticSource source( 0.0, 2, (uint64_t) ( minutes * 60e6 ) );
+  Counter counter;
+  Clock::time_point start = Clock::now();
+  {
+    sensor::RecordingWriter writer( fileName, imu );
+    source.addListener( &writer );
+    source.addListener( &counter );
+    runToEnd( source );
+    writer.close();
+  }
+  double encode = seconds( Clock::now() - start );
+
+  start = Clock::now();
+  sensor::RecordingSource replay( fileName, 0.0 );
+  Counter replayed;
+  replay.addListener( &replayed );
+  runToEnd( replay );
+  double decode = seconds( Clock::now() - start );
+
+  report( name, fileSize( fileName ), minutes, replayed.count, encode, decode );
+}
+
+static void measureText( const std::string &fileName, double minutes )
+{
+  sensor::SyntheticSource source( 0.0, 2, (uint64_t) ( minutes * 60e6 ) );
+  Clock::time_point start = Clock::now();
+  {
+    sensor::TextRecorder recorder( fileName );
+    source.addListener( &recorder );
+    runToEnd( source );
+  }
+  double encode = seconds( Clock::now() - start );
+
+  start = Clock::now();
+  sensor::TextReplaySource replay( fileName, 0.0 );
+  Counter replayed;
+  replay.addListener( &replayed );
+  runToEnd( replay );
+  double decode = seconds( Clock::now() - start );
+
+  report( "text", fileSize( fileName ), minutes, replayed.count, encode, decode );
+}
+
+// Compare a replay with the source it was recorded from.  Everything
+// but orientation must match exactly.
+static bool verify( const std::string &fileName, double minutes )
+{
+  sensor::SyntheticSource source( 0.0, 2, (uint64_t) ( minutes * 60e6 ) );
+  Log original;
+  {
+    sensor::RecordingWriter writer( fileName, false );
+    source.addListener( &writer );
+    source.addListener( &original );
+    runToEnd( source );
+  }
+
+  sensor::RecordingSource replay( fileName, 0.0 );
+  Log replayed;
+  replay.addListener( &replayed );
+  runToEnd( replay );
+
+  if ( original.lines != replayed.lines ) {
+    std::cout << "verify: the replayed events differ from the recorded ones" << std::endl;
+    return false;
+  }
+
+  // Angle between the rotations, allowing for q and -q.
+  double maxAngle = 0.0;
+  for ( size_t i=0; i<original.quaternions.size(); i++ ) {
+    const sensor::Quaternion &a = original.quaternions[i], &b = replayed.quaternions[i];
+    double dot = std::fabs( a.x() * b.x() + a.y() * b.y() + a.z() * b.z() + a.w() * b.w() );
+    maxAngle = std::max( maxAngle, 2.0 * std::acos( std::min( 1.0, dot ) ) * 180.0 / M_PI );
+  }
+  std::cout << "verify: " << original.lines.size() << " events match, orientation error <= "
+            << std::setprecision( 3 ) << maxAngle << " degrees" << std::endl;
+  return maxAngle < 0.5;
+}
+
+int main( int argc, char *argv[] )
+{
+  double minutes = 60.0;
+  if ( argc > 1 ) minutes = strtod( argv[1], 0 );
+  std::string fileName = "recordingbench.tmp";
+
+  try {
+    std::cout << "recordingbench: " << minutes << " minutes of two synthetic armbands\n\n";
+    std::cout << std::left << std::setw( 28 ) << "format" << std::right << std::setw( 12 ) << "MB/hour"
+              << std::setw( 12 ) << "bits/event" << std::setw( 14 ) << "Mevents/s in"
+              << std::setw( 14 ) << "Mevents/s out" << std::endl;
+    measureBinary( "binary", fileName, minutes, true );
+    measureBinary( "binary, no accel/gyro", fileName, minutes, false );
+    measureText( fileName, std::min( minutes, 5.0 ) );
+    std::cout << std::endl;
+
+    bool ok = verify( fileName, std::min( minutes, 5.0 ) );
+    remove( fileName.c_str() );
+    return ok ? 0 : 1;
+  }
+  catch ( std::exception &error ) {
+    remove( fileName.c_str() );
+    std::cerr << "recordingbench: " << error.what() << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,204 @@
+//*****************************************//
+//  schedulerbench.cpp
+//
+//  Measures MidiScheduler: the cost of
+//  scheduling and cancelling an event with
+//  100 to 100000 others pending, against
+//  an ordered std::multimap, the cost per
+//  event of firing a burst due in one
+//  tick, and how late its timing thread
+//  fires thousands of note-offs spread
+//  over two seconds.  Checks first that
+//  random events, some cancelled, fire in
+//  time order and those due together in
+//  the order scheduled.
+//
+//*****************************************//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "MidiScheduler.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static double nanosecondsSince( Clock::time_point start, size_t operations )
+{
+  return std::chrono::duration<double, std::nano>( Clock::now() - start ).count() / operations;
+}
+
+// Schedule and then cancel one event at a time while \e pending others
+// wait, as a gesture does when it replaces a note's note-off.
+static double wheelCost( size_t pending, size_t operations )
+{
+  MidiScheduler scheduler( 100, pending + 1 );
+  int64_t base = MidiScheduler::now();
+  uint32_t random = 1;
+  for ( size_t i=0; i<pending; i++ ) {
+    random = random * 1664525u + 1013904223u;
+    scheduler.schedule( base + 1000000 + random % 2000000, MidiScheduler::Callback() );
+  }
+  Clock::time_point start = Clock::now();
+  for ( size_t i=0; i<operations; i++ ) {
+    random = random * 1664525u + 1013904223u;
+    MidiScheduler::Handle handle = scheduler.schedule( base + 1000000 + random % 2000000, MidiScheduler::Callback() );
+    scheduler.cancel( handle );
+  }
+  return nanosecondsSince( start, operations );
+}
+
+static double multimapCost( size_t pending, size_t operations )
+{
+  std::mutex lock;
+  std::multimap<int64_t, MidiScheduler::Callback> queue;
+  uint32_t random = 1;
+  for ( size_t i=0; i<pending; i++ ) {
+    random = random * 1664525u + 1013904223u;
+    queue.insert( std::make_pair( (int64_t) ( random % 2000000 ), MidiScheduler::Callback() ) );
+  }
+  Clock::time_point start = Clock::now();
+  for ( size_t i=0; i<operations; i++ ) {
+    random = random * 1664525u + 1013904223u;
+    std::multimap<int64_t, MidiScheduler::Callback>::iterator it;
+    {
+      std::lock_guard<std::mutex> guard( lock );
+      it = queue.insert( std::make_pair( (int64_t) ( random % 2000000 ), MidiScheduler::Callback() ) );
+    }
+    std::lock_guard<std::mutex> guard( lock );
+    queue.erase( it );
+  }
+  return nanosecondsSince( start, operations );
+}
+
+// Fire \e burst events due within one tick, scheduled out of order as
+// several chords' note-offs are, and return the cost per event.
+static double burstCost( size_t burst )
+{
+  const int rounds = 20;
+  double total = 0.0;
+  size_t fired = 0;
+  for ( int round=0; round<rounds; round++ ) {
+    MidiScheduler scheduler( 100, burst );
+    int64_t due = MidiScheduler::now() + 1000000;
+    for ( size_t i=0; i<burst; i++ )
+      scheduler.schedule( due + ( burst - i ) % 50, [&fired]() { fired++; } );
+    Clock::time_point start = Clock::now();
+    scheduler.advance( due + 100 );
+    total += nanosecondsSince( start, burst );
+  }
+  return total / rounds;
+}
+
+// Schedule events at random times, many due in the same few ticks,
+// cancel some, advance in random steps and compare the firing order
+// with a stable sort by due time.  Returns the rounds that differ.
+static int checkOrder( int rounds )
+{
+  uint32_t random = 3;
+  int failures = 0;
+  for ( int round=0; round<rounds; round++ ) {
+    MidiScheduler scheduler( 100 );
+    int64_t base = MidiScheduler::now();
+    const int events = 500;
+    std::vector<std::pair<int64_t, int> > expected;
+    std::vector<MidiScheduler::Handle> handles;
+    std::vector<int> fired;
+    for ( int i=0; i<events; i++ ) {
+      random = random * 1664525u + 1013904223u;
+      // A quarter land in the first 50 ticks, the rest anywhere in 30 s,
+      // so bursts share slots and others cascade down every level.
+      int64_t due = base + ( ( random >> 30 ) == 0 ? (int64_t) ( random % 50 ) * 100 : (int64_t) ( random % 30000000 ) );
+      handles.push_back( scheduler.schedule( due, [&fired, i]() { fired.push_back( i ); } ) );
+      expected.push_back( std::make_pair( due, i ) );
+    }
+    std::vector<bool> cancelled( events, false );
+    for ( int i=0; i<events / 10; i++ ) {
+      random = random * 1664525u + 1013904223u;
+      int k = random % events;
+      if ( !cancelled[k] && scheduler.cancel( handles[k] ) ) cancelled[k] = true;
+    }
+    std::vector<std::pair<int64_t, int> > order;
+    for ( int i=0; i<events; i++ )
+      if ( !cancelled[expected[i].second] ) order.push_back( expected[i] );
+    std::stable_sort( order.begin(), order.end(),
+                      []( const std::pair<int64_t, int> &a, const std::pair<int64_t, int> &b ) { return a.first < b.first; } );
+
+    int64_t now = base;
+    while ( scheduler.pending() ) {
+      random = random * 1664525u + 1013904223u;
+      now += random % 200000;
+      scheduler.advance( now );
+    }
+    bool same = fired.size() == order.size();
+    for ( size_t i=0; same && i<order.size(); i++ ) same = fired[i] == order[i].second;
+    if ( !same ) failures++;
+  }
+  return failures;
+}
+
+static std::mutex lateLock;
+static std::vector<int64_t> lateness;
+
+int main( int argc, char *argv[] )
+{
+  size_t events = 5000;
+  if ( argc > 1 ) events = strtoul( argv[1], 0, 10 );
+
+  const int rounds = 200;
+  int failures = checkOrder( rounds );
+  std::cout << "schedulerbench: " << rounds - failures << " of " << rounds << " rounds of 500 random events fired in order\n\n";
+  if ( failures ) return 1;
+
+  std::cout << "nanoseconds to schedule and cancel one event\n\n"
+            << std::setw( 10 ) << "pending" << std::setw( 12 ) << "wheel" << std::setw( 12 ) << "multimap" << std::endl;
+  static const size_t counts[] = { 100, 1000, 10000, 100000 };
+  for ( size_t k=0; k<sizeof( counts ) / sizeof( counts[0] ); k++ ) {
+    double wheel = wheelCost( counts[k], 1000000 );
+    double tree = multimapCost( counts[k], 1000000 );
+    std::cout << std::setw( 10 ) << counts[k] << std::fixed << std::setprecision( 1 )
+              << std::setw( 12 ) << wheel << std::setw( 12 ) << tree << std::endl;
+  }
+
+  std::cout << "\nnanoseconds per event to fire a burst due in one tick\n\n"
+            << std::setw( 10 ) << "burst" << std::setw( 12 ) << "wheel" << std::endl;
+  static const size_t bursts[] = { 4, 64, 1024 };
+  for ( size_t k=0; k<sizeof( bursts ) / sizeof( bursts[0] ); k++ )
+    std::cout << std::setw( 10 ) << bursts[k] << std::fixed << std::setprecision( 1 ) << std::setw( 12 ) << burstCost( bursts[k] ) << std::endl;
+
+  // Fire events at random times over two seconds from the timing
+  // thread, recording how late each one runs.
+  MidiScheduler scheduler;
+  lateness.reserve( events );
+  int64_t base = MidiScheduler::now() + 10000;
+  uint32_t random = 7;
+  for ( size_t i=0; i<events; i++ ) {
+    random = random * 1664525u + 1013904223u;
+    int64_t due = base + random % 2000000;
+    scheduler.schedule( due, [due]() {
+      int64_t late = MidiScheduler::now() - due;
+      std::lock_guard<std::mutex> guard( lateLock );
+      lateness.push_back( late );
+    } );
+  }
+  size_t pending = scheduler.pending();
+  scheduler.start();
+  while ( scheduler.pending() ) std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+  scheduler.stop();
+
+  std::lock_guard<std::mutex> guard( lateLock );
+  std::sort( lateness.begin(), lateness.end() );
+  size_t n = lateness.size();
+  std::cout << "\n" << n << " of " << pending << " events fired by the timing thread over 2 s, microseconds late:\n"
+            << "  min " << lateness[0] << "  p50 " << lateness[n / 2] << "  p99 " << lateness[n * 99 / 100]
+            << "  max " << lateness[n - 1] << std::endl;
+
+  // An event must never fire early.
+  return lateness[0] < 0 || n != pending ? 1 : 0;
+}
@@ -0,0 +1,156 @@
+//*****************************************//
+//  sendbench.cpp
+//
+//  Measures the per-message cost of the
+//  RtMidiOut send paths against the
+//  statically bound BasicMidiOut<Backend>,
+//  and of fanning one stream out to several
+//  destinations with MidiOutGroup.
+//
+//*****************************************//
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "RtMidi.h"
+#include "MidiMessages.h"
+#include "MidiOutGroup.h"
+
+#if !defined(__RTMIDI_LOOPBACK__)
+  #error "sendbench needs the loopback API (-D__RTMIDI_LOOPBACK__)"
+#endif
+
+typedef std::chrono::steady_clock Clock;
+
+static unsigned long received = 0;
+
+void countMessage( double /*deltatime*/, std::vector< unsigned char > * /*message*/, void * /*userData*/ )
+{
+  received++;
+}
+
+void report( const std::string &name, Clock::duration elapsed, unsigned long count )
+{
+  double ns = std::chrono::duration<double, std::nano>( elapsed ).count() / count;
+  std::cout << std::left << std::setw( 50 ) << name << std::right
+            << std::fixed << std::setprecision( 2 ) << std::setw( 10 ) << ns << std::endl;
+}
+
+template <class Out>
+Clock::duration sendVector( Out &out, unsigned long count )
+{
+  std::vector<unsigned char> message( 3 );
+  Clock::time_point start = Clock::now();
+  for ( unsigned long i=0; i<count; i++ ) {
+    message[0] = 0xB0;
+    message[1] = 7;
+    message[2] = i & 0x7F;
+    out.sendMessage( &message );
+  }
+  return Clock::now() - start;
+}
+
+template <class Out>
+Clock::duration sendTyped( Out &out, unsigned long count )
+{
+  Clock::time_point start = Clock::now();
+  for ( unsigned long i=0; i<count; i++ )
+    out.send( ControlChange<1, 7>( i & 0x7F ) );
+  return Clock::now() - start;
+}
+
+template <class Out>
+Clock::duration sendUmp( Out &out, unsigned long count )
+{
+  Clock::time_point start = Clock::now();
+  for ( unsigned long i=0; i<count; i++ )
+    out.sendUmp( MidiUmp::controlChange( 0, 7, (uint32_t) i << 25 ) );
+  return Clock::now() - start;
+}
+
+int main( int argc, char *argv[] )
+{
+  unsigned long count = 10000000;
+  if ( argc > 1 ) count = strtoul( argv[1], 0, 10 );
+
+  std::cout << "sendbench: " << count << " messages per case (loopback API)\n\n";
+  std::cout << std::left << std::setw( 50 ) << "case" << std::right << std::setw( 10 ) << "ns/msg" << std::endl;
+
+  try {
+    // Unconnected virtual ports measure dispatch overhead alone.
+    RtMidiOut dynamicOut( RtMidi::RTMIDI_LOOPBACK );
+    dynamicOut.openVirtualPort( "sendbench dynamic" );
+    BasicMidiOut<MidiOutLoopback> staticOut;
+    staticOut.openVirtualPort( "sendbench static" );
+
+    report( "RtMidiOut::sendMessage( vector * )", sendVector( dynamicOut, count ), count );
+    report( "RtMidiOut::send( ControlChange )", sendTyped( dynamicOut, count ), count );
+    report( "RtMidiOut::sendUmp", sendUmp( dynamicOut, count ), count );
+    report( "BasicMidiOut<Loopback>::sendMessage( vector * )", sendVector( staticOut, count ), count );
+    report( "BasicMidiOut<Loopback>::send( ControlChange )", sendTyped( staticOut, count ), count );
+    report( "BasicMidiOut<Loopback>::sendUmp", sendUmp( staticOut, count ), count );
+
+    // With a receiver attached, each message is also delivered to an
+    // RtMidiIn callback on the sending thread.
+    RtMidiIn input( RtMidi::RTMIDI_LOOPBACK );
+    input.openVirtualPort( "sendbench input" );
+    input.setCallback( &countMessage );
+    RtMidiOut connectedDynamic( RtMidi::RTMIDI_LOOPBACK );
+    connectedDynamic.openPort( 0 );
+    BasicMidiOut<MidiOutLoopback> connectedStatic;
+    connectedStatic.openPort( 0 );
+
+    report( "RtMidiOut::send( ControlChange ) -> RtMidiIn", sendTyped( connectedDynamic, count ), count );
+    report( "BasicMidiOut::send( ControlChange ) -> RtMidiIn", sendTyped( connectedStatic, count ), count );
+
+    // Fan-out to four receivers: four separate outputs, a group whose
+    // destinations share one port, and a group with one filter (and
+    // so one port) per destination.
+    const unsigned int fanout = 4;
+    std::vector<RtMidiIn *> receivers;
+    for ( unsigned int i=0; i<fanout - 1; i++ ) {
+      receivers.push_back( new RtMidiIn( RtMidi::RTMIDI_LOOPBACK ) );
+      receivers.back()->openVirtualPort( "sendbench fanout" );
+      receivers.back()->setCallback( &countMessage );
+    }
+
+    std::vector<RtMidiOut *> separate;
+    for ( unsigned int i=0; i<fanout; i++ ) {
+      separate.push_back( new RtMidiOut( RtMidi::RTMIDI_LOOPBACK ) );
+      separate.back()->openPort( i );
+    }
+    Clock::time_point start = Clock::now();
+    for ( unsigned long i=0; i<count; i++ )
+      for ( unsigned int j=0; j<fanout; j++ )
+        separate[j]->send( ControlChange<1, 7>( i & 0x7F ) );
+    report( "4 x RtMidiOut::send( ControlChange )", Clock::now() - start, count );
+    for ( unsigned int i=0; i<fanout; i++ ) delete separate[i];
+
+    MidiOutGroup shared;
+    for ( unsigned int i=0; i<fanout; i++ )
+      shared.addDestination( RtMidi::RTMIDI_LOOPBACK, i );
+    report( "MidiOutGroup::send, 4 destinations on 1 port", sendTyped( shared, count ), count );
+
+    MidiOutGroup filtered;
+    for ( unsigned int i=0; i<fanout; i++ )
+      filtered.addDestination( RtMidi::RTMIDI_LOOPBACK, i, MidiOutFilter( MidiOutFilter::ALL_CHANNELS, MidiOutFilter::CONTROL_CHANGE | ( 1 << i ) ) );
+    report( "MidiOutGroup::send, 4 filtered destinations", sendTyped( filtered, count ), count );
+
+    for ( unsigned int i=0; i<receivers.size(); i++ ) delete receivers[i];
+
+    unsigned long expected = 2 * count + 3 * fanout * count;
+    if ( received != expected ) {
+      std::cerr << "\nsendbench: expected " << expected << " deliveries, got " << received << std::endl;
+      return 1;
+    }
+  }
+  catch ( RtMidiError &error ) {
+    error.printMessage();
+    return 1;
+  }
+
+  return 0;
+}
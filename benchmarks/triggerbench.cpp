@@ -0,0 +1,233 @@
+//*****************************************//
+//  triggerbench.cpp
+//
+//  Measures the cost of evaluating 4 to
+//  1024 threshold triggers with hysteresis
+//  on every frame of 8 armbands: one rule
+//  at a time, as the mappings did, against
+//  sensor::TriggerEngine.  Then the cost
+//  of a zone set as its zones increase.
+//  Last, thresholds evaluated from the
+//  quaternion: bucketing every angle then
+//  updating, against testing each bound
+//  with an AngleQuantiser.  Each pair must
+//  find the same edges.
+//
+//*****************************************//
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "AngleQuantiser.h"
+#include "TriggerEngine.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static const unsigned int devices = 8;
+
+struct Rule {
+  int axis;
+  bool below;
+  int threshold;
+  int hysteresis;
+};
+
+// One rule at a time, each with a branch for its direction and its
+// latch, as MidiMapping first tested them.
+class Scalar
+{
+ public:
+  Scalar( const std::vector<Rule> &rules ) : rules_( rules ), state_( rules.size() * devices, 0 ) {}
+
+  size_t update( unsigned int id, const int values[3] )
+  {
+    size_t edges = 0;
+    uint8_t *state = &state_[( id - 1 ) * rules_.size()];
+    for ( size_t i=0; i<rules_.size(); i++ ) {
+      const Rule &r = rules_[i];
+      int v = values[r.axis];
+      bool on;
+      if ( r.below ) on = state[i] ? v < r.threshold + r.hysteresis : v < r.threshold;
+      else on = state[i] ? v > r.threshold - r.hysteresis : v > r.threshold;
+      if ( on != ( state[i] != 0 ) ) {
+        state[i] = on;
+        edges++;
+      }
+    }
+    return edges;
+  }
+
+ private:
+  std::vector<Rule> rules_;
+  std::vector<uint8_t> state_;
+};
+
+// Buckets that wander like an arm: a random walk on each axis that
+// moves one bucket in about one frame of four.
+static std::vector<int> makeFrames( size_t frames )
+{
+  std::vector<int> values( frames * devices * 3 );
+  int current[devices][3];
+  for ( unsigned int d=0; d<devices; d++ )
+    for ( int a=0; a<3; a++ ) current[d][a] = 64;
+  uint32_t random = 1;
+  for ( size_t f=0; f<frames; f++ )
+    for ( unsigned int d=0; d<devices; d++ )
+      for ( int a=0; a<3; a++ ) {
+        random = random * 1664525u + 1013904223u;
+        current[d][a] = std::max( 0, std::min( 127, current[d][a] + ( random >> 29 == 0 ) - ( random >> 29 == 7 ) ) );
+        values[( f * devices + d ) * 3 + a] = current[d][a];
+      }
+  return values;
+}
+
+// Orientations that wander the same way, a few thousandths of a
+// radian a frame on each angle, as quaternions.
+static std::vector<sensor::Quaternion> makeOrientations( size_t frames )
+{
+  std::vector<sensor::Quaternion> q;
+  q.reserve( frames * devices );
+  float angle[devices][3];
+  for ( unsigned int d=0; d<devices; d++ )
+    for ( int a=0; a<3; a++ ) angle[d][a] = 0.0f;
+  uint32_t random = 3;
+  for ( size_t f=0; f<frames; f++ )
+    for ( unsigned int d=0; d<devices; d++ ) {
+      for ( int a=0; a<3; a++ ) {
+        random = random * 1664525u + 1013904223u;
+        float limit = a == 1 ? 1.5f : 3.1f;
+        angle[d][a] = std::max( -limit, std::min( limit, angle[d][a] + ( (int) ( random >> 24 ) - 128 ) * 4e-5f ) );
+      }
+      float cr = std::cos( angle[d][0] / 2 ), sr = std::sin( angle[d][0] / 2 );
+      float cp = std::cos( angle[d][1] / 2 ), sp = std::sin( angle[d][1] / 2 );
+      float cy = std::cos( angle[d][2] / 2 ), sy = std::sin( angle[d][2] / 2 );
+      q.push_back( sensor::Quaternion( sr * cp * cy - cr * sp * sy, cr * sp * cy + sr * cp * sy,
+                                       cr * cp * sy - sr * sp * cy, cr * cp * cy + sr * sp * sy ) );
+    }
+  return q;
+}
+
+int main( int argc, char *argv[] )
+{
+  size_t frames = 20000;
+  if ( argc > 1 ) frames = strtoul( argv[1], 0, 10 );
+  sensor::AngleSteps steps = { 127, 127, 127 };
+  std::vector<int> values = makeFrames( frames );
+  size_t deviceFrames = frames * devices;
+
+  std::cout << "triggerbench: " << frames << " frames of " << devices << " armbands\n"
+            << "nanoseconds per device-frame\n\n";
+  std::cout << std::setw( 8 ) << "rules" << std::setw( 12 ) << "per rule" << std::setw( 15 ) << "TriggerEngine"
+            << std::setw( 10 ) << "ratio" << std::setw( 10 ) << "edges" << std::endl;
+
+  static const unsigned int counts[] = { 4, 16, 64, 256, 1024 };
+  int mismatches = 0;
+  for ( size_t k=0; k<sizeof( counts ) / sizeof( counts[0] ); k++ ) {
+    std::vector<Rule> rules;
+    sensor::TriggerEngine engine( steps );
+    uint32_t random = 7;
+    for ( unsigned int i=0; i<counts[k]; i++ ) {
+      random = random * 1664525u + 1013904223u;
+      Rule r = { (int) ( random >> 30 ) % 3, ( ( random >> 16 ) & 1 ) != 0, 8 + (int) ( ( random >> 8 ) % 112 ), (int) ( random % 8 ) };
+      rules.push_back( r );
+      engine.addThreshold( static_cast<sensor::TriggerEngine::Axis>( r.axis ), r.below, r.threshold, r.hysteresis );
+    }
+    Scalar scalar( rules );
+
+    size_t scalarEdges = 0, engineEdges = 0;
+    Clock::time_point start = Clock::now();
+    for ( size_t f=0; f<frames; f++ )
+      for ( unsigned int d=0; d<devices; d++ )
+        scalarEdges += scalar.update( d + 1, &values[( f * devices + d ) * 3] );
+    double scalarTime = std::chrono::duration<double, std::nano>( Clock::now() - start ).count() / deviceFrames;
+
+    start = Clock::now();
+    for ( size_t f=0; f<frames; f++ )
+      for ( unsigned int d=0; d<devices; d++ ) {
+        const int *v = &values[( f * devices + d ) * 3];
+        engineEdges += engine.update( d + 1, v[0], v[1], v[2], (int64_t) f * 20000 );
+      }
+    double engineTime = std::chrono::duration<double, std::nano>( Clock::now() - start ).count() / deviceFrames;
+    if ( scalarEdges != engineEdges ) mismatches++;
+
+    std::cout << std::setw( 8 ) << counts[k] << std::fixed << std::setprecision( 1 ) << std::setw( 12 ) << scalarTime
+              << std::setw( 15 ) << engineTime << std::setw( 10 ) << scalarTime / engineTime
+              << std::setw( 10 ) << engineEdges << ( scalarEdges != engineEdges ? "  (mismatch)" : "" ) << std::endl;
+  }
+
+  std::cout << "\n" << std::setw( 8 ) << "zones" << std::setw( 12 ) << "ns" << std::endl;
+  static const unsigned int zones[] = { 2, 8, 32, 128 };
+  for ( size_t k=0; k<sizeof( zones ) / sizeof( zones[0] ); k++ ) {
+    sensor::TriggerEngine engine( steps );
+    std::vector<int> bounds;
+    for ( unsigned int i=1; i<zones[k]; i++ ) bounds.push_back( (int) ( i * 128 / zones[k] ) );
+    engine.addZones( sensor::TriggerEngine::pitch, bounds, 2 );
+
+    Clock::time_point start = Clock::now();
+    size_t edges = 0;
+    for ( size_t f=0; f<frames; f++ )
+      for ( unsigned int d=0; d<devices; d++ ) {
+        const int *v = &values[( f * devices + d ) * 3];
+        edges += engine.update( d + 1, v[0], v[1], v[2], (int64_t) f * 20000 );
+      }
+    double time = std::chrono::duration<double, std::nano>( Clock::now() - start ).count() / deviceFrames;
+    std::cout << std::setw( 8 ) << zones[k] << std::fixed << std::setprecision( 1 ) << std::setw( 12 ) << time
+              << "   (" << edges << " edges)" << std::endl;
+  }
+
+  std::vector<sensor::Quaternion> orientations = makeOrientations( frames );
+  sensor::AngleBucketer bucketer( steps );
+  sensor::AngleQuantiser<127, 127, 127> quantiser;
+
+  std::cout << "\nfrom the orientation, nanoseconds per device-frame\n"
+            << std::setw( 8 ) << "rules" << std::setw( 12 ) << "buckets" << std::setw( 15 ) << "quantiser"
+            << std::setw( 10 ) << "ratio" << std::setw( 10 ) << "edges" << std::endl;
+  static const unsigned int fewCounts[] = { 1, 2, 4, 16 };
+  for ( size_t k=0; k<sizeof( fewCounts ) / sizeof( fewCounts[0] ); k++ ) {
+    sensor::TriggerEngine bucketed( steps ), quantised( steps );
+    uint32_t random = 11;
+    for ( unsigned int i=0; i<fewCounts[k]; i++ ) {
+      random = random * 1664525u + 1013904223u;
+      sensor::TriggerEngine::Axis axis = static_cast<sensor::TriggerEngine::Axis>( ( random >> 30 ) % 3 );
+      bool below = ( ( random >> 16 ) & 1 ) != 0;
+      int threshold = 48 + (int) ( ( random >> 8 ) % 32 ), hysteresis = (int) ( random % 8 );
+      bucketed.addThreshold( axis, below, threshold, hysteresis );
+      quantised.addThreshold( axis, below, threshold, hysteresis );
+    }
+
+    size_t bucketEdges = 0, quantiserEdges = 0;
+    std::vector<uint32_t> bucketCounts( frames ), quantiserCounts( frames );
+    Clock::time_point start = Clock::now();
+    for ( size_t f=0; f<frames; f++ )
+      for ( unsigned int d=0; d<devices; d++ ) {
+        sensor::AngleBuckets b = bucketer.buckets( orientations[f * devices + d] );
+        size_t n = bucketed.update( d + 1, b.roll, b.pitch, b.yaw, (int64_t) f * 20000 );
+        bucketEdges += n;
+        bucketCounts[f] += (uint32_t) n;
+      }
+    double bucketTime = std::chrono::duration<double, std::nano>( Clock::now() - start ).count() / deviceFrames;
+
+    start = Clock::now();
+    for ( size_t f=0; f<frames; f++ )
+      for ( unsigned int d=0; d<devices; d++ ) {
+        size_t n = quantised.update( d + 1, quantiser, orientations[f * devices + d], (int64_t) f * 20000 );
+        quantiserEdges += n;
+        quantiserCounts[f] += (uint32_t) n;
+      }
+    double quantiserTime = std::chrono::duration<double, std::nano>( Clock::now() - start ).count() / deviceFrames;
+
+    bool same = bucketCounts == quantiserCounts;
+    for ( unsigned int d=1; d<=devices; d++ )
+      for ( unsigned int i=0; i<fewCounts[k]; i++ ) same = same && bucketed.state( d, i ) == quantised.state( d, i );
+    if ( !same ) mismatches++;
+
+    std::cout << std::setw( 8 ) << fewCounts[k] << std::fixed << std::setprecision( 1 ) << std::setw( 12 ) << bucketTime
+              << std::setw( 15 ) << quantiserTime << std::setw( 10 ) << bucketTime / quantiserTime
+              << std::setw( 10 ) << quantiserEdges << ( same ? "" : "  (mismatch)" ) << std::endl;
+  }
+
+  return mismatches ? 1 : 0;
+}
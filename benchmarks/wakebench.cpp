@@ -0,0 +1,121 @@
+//*****************************************//
+//  wakebench.cpp
+//
+//  Measures how often the Myo programs'
+//  main loop wakes up and how much CPU it
+//  uses, with the old polling loops
+//  (run(1) as in liveloop and instrument,
+//  run(50) and a redraw as in dj) and with
+//  sensor::EventLoop, both while the
+//  armbands are quiet and while two of
+//  them stream at full rate.
+//
+//*****************************************//
+
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <sys/resource.h>
+#include "EventLoop.h"
+#include "SyntheticSource.h"
+
+// An armband at rest that reports nothing but a pose each second.
+class QuietSource : public sensor::PacedSource
+{
+ public:
+  QuietSource( uint64_t duration ) : PacedSource( 1.0 ), next_( 0 ), duration_( duration ) {}
+
+ protected:
+  bool nextEventTime( uint64_t &timestamp )
+  {
+    timestamp = next_;
+    return next_ <= duration_;
+  }
+
+  void dispatchNext( void )
+  {
+    pose( &device_, next_, sensor::Pose::rest );
+    next_ += 1000000;
+  }
+
+ private:
+  sensor::Device device_;
+  uint64_t next_, duration_;
+};
+
+// Counts events, standing in for a program's collector.
+class Counter : public sensor::Listener
+{
+ public:
+  Counter( void ) : count( 0 ) {}
+  void onPose( sensor::Device *, uint64_t, sensor::Pose ) { count++; }
+  void onOrientationData( sensor::Device *, uint64_t, const sensor::Quaternion & ) { count++; }
+  void onEmgData( sensor::Device *, uint64_t, const int8_t * ) { count++; }
+  uint64_t count;
+};
+
+struct Usage {
+  double cpu;       // seconds of user and system time
+  long wakeups;     // voluntary context switches: each sleep the process woke from
+  int64_t wall;     // microseconds
+};
+
+static Usage usage( void )
+{
+  struct rusage r;
+  getrusage( RUSAGE_SELF, &r );
+  Usage u = { r.ru_utime.tv_sec + r.ru_stime.tv_sec + ( r.ru_utime.tv_usec + r.ru_stime.tv_usec ) / 1e6,
+              r.ru_nvcsw, sensor::steadyMicroseconds() };
+  return u;
+}
+
+enum Mode { POLL_1, POLL_50, LOOP, LOOP_REFRESH };
+static const char *modeNames[] = { "run(1) loop", "run(50) + redraw", "EventLoop", "EventLoop + 50 ms refresh" };
+
+static void measure( const std::string &sourceName, Mode mode, double seconds )
+{
+  uint64_t duration = (uint64_t) ( seconds * 1e6 );
+  sensor::Source *source;
+  if ( sourceName == "quiet" ) source = new QuietSource( duration );
+  else source = new sensor::SyntheticSource( 1.0, 2, duration );
+
+  Counter counter;
+  source->addListener( &counter );
+  unsigned long redraws = 0;
+
+  Usage before = usage();
+  if ( mode == POLL_1 )
+    while ( source->run( 1 ) ) {}
+  else if ( mode == POLL_50 )
+    while ( source->run( 50 ) ) redraws++;
+  else {
+    sensor::EventLoop loop( source );
+    if ( mode == LOOP_REFRESH ) loop.addTimer( 50000, [&redraws]() { redraws++; } );
+    loop.run();
+  }
+  Usage after = usage();
+  delete source;
+
+  double wall = ( after.wall - before.wall ) / 1e6;
+  std::cout << std::left << std::setw( 10 ) << sourceName << std::setw( 28 ) << modeNames[mode] << std::right
+            << std::fixed << std::setprecision( 1 ) << std::setw( 10 ) << counter.count / wall
+            << std::setw( 12 ) << ( after.wakeups - before.wakeups ) / wall
+            << std::setprecision( 2 ) << std::setw( 10 ) << 100.0 * ( after.cpu - before.cpu ) / wall << std::endl;
+}
+
+int main( int argc, char *argv[] )
+{
+  double seconds = 5.0;
+  if ( argc > 1 ) seconds = strtod( argv[1], 0 );
+
+  std::cout << "wakebench: " << seconds << " s per case\n\n";
+  std::cout << std::left << std::setw( 10 ) << "source" << std::setw( 28 ) << "loop" << std::right
+            << std::setw( 10 ) << "events/s" << std::setw( 12 ) << "wakeups/s" << std::setw( 10 ) << "CPU %" << std::endl;
+  const char *sources[] = { "quiet", "synthetic" };
+  for ( int s=0; s<2; s++ )
+    for ( int m=POLL_1; m<=LOOP_REFRESH; m++ )
+      measure( sources[s], static_cast<Mode>( m ), seconds );
+  return 0;
+}
@@ -0,0 +1,93 @@
+### Shared build settings for librtmidi and every program linked against it.
+###
+###   make [API="alsa jack loopback"] [PROFILE=release]
+###
+### API      one or more of core, alsa, jack and loopback.  Defaults to core
+###          on OS X, and to alsa on Linux when the ALSA headers are
+###          installed (loopback otherwise).
+### PROFILE  debug     -O0 -g
+###          release   -O3 with link-time optimisation (default)
+###          pgo-gen   release, instrumented for profile-guided optimisation
+###          pgo-use   release, optimised with the profile written by pgo-gen
+###          Use "make pgo" at the top level to run the whole PGO cycle.
+###          Only librtmidi and the Myo objects, which the training run
+###          exercises, are built with the profile (PGO_USE).
+
+TOP     := $(abspath $(dir $(lastword $(MAKEFILE_LIST))))
+UNAME   := $(shell uname -s)
+
+ifeq ($(UNAME),Darwin)
+  API     ?= core
+  LTO_AR  ?= ar
+else
+  API     ?= $(if $(wildcard /usr/include/alsa/asoundlib.h),alsa,loopback)
+  LTO_AR  ?= gcc-ar
+endif
+PROFILE ?= release
+
+# A directory can require backends of its own by setting NEEDS_API
+# before including this file.
+override API := $(sort $(API) $(NEEDS_API))
+
+CC       = g++
+DEFS     =
+LIBRARY  =
+CFLAGS   = -Wall -Wextra -std=c++11
+CFLAGS  += -I$(TOP) -I$(TOP)/include
+# Nothing here reads errno after a math call or enables floating
+# point traps.  Without these gcc will not vectorise loops that call
+# sqrt() or select between float expressions (Myo/OrientationMath.cpp).
+CFLAGS  += -fno-math-errno -fno-trapping-math
+
+ifneq ($(filter core,$(API)),)
+  DEFS    += -D__MACOSX_CORE__
+  LIBRARY += -framework CoreMIDI -framework CoreFoundation -framework CoreAudio
+endif
+ifneq ($(filter alsa,$(API)),)
+  DEFS    += -D__LINUX_ALSA__
+  LIBRARY += -lasound
+endif
+ifneq ($(filter jack,$(API)),)
+  DEFS    += -D__UNIX_JACK__
+  LIBRARY += -ljack
+endif
+ifneq ($(filter loopback,$(API)),)
+  DEFS    += -D__RTMIDI_LOOPBACK__
+endif
+LIBRARY += -lpthread
+
+# Objects for each API set and profile live in their own directory so
+# switching either one never links stale objects.  Both PGO phases
+# share a directory because the compiler keys profile data on the
+# object file path.
+empty   :=
+space   := $(empty) $(empty)
+API_TAG := $(subst $(space),-,$(strip $(API)))
+ifneq ($(filter pgo-gen pgo-use,$(PROFILE)),)
+  BUILD_TAG = pgo-$(API_TAG)
+else
+  BUILD_TAG = $(PROFILE)-$(API_TAG)
+endif
+OBJECT_PATH = $(TOP)/build/$(BUILD_TAG)
+PGO_DIR     = $(TOP)/build/pgo-data-$(API_TAG)
+RTMIDI_LIB  = $(OBJECT_PATH)/librtmidi.a
+
+IS_CLANG := $(shell $(CC) --version 2>/dev/null | grep -c clang)
+
+ifeq ($(PROFILE),debug)
+  CFLAGS += -O0 -g
+else ifeq ($(IS_CLANG),0)
+  CFLAGS += -O3 -flto=auto
+else
+  CFLAGS += -O3 -flto
+endif
+ifeq ($(PROFILE),pgo-gen)
+  CFLAGS += -fprofile-generate=$(PGO_DIR)
+endif
+ifeq ($(PROFILE),pgo-use)
+  ifeq ($(IS_CLANG),0)
+    PGO_USE = -fprofile-use=$(PGO_DIR) -fprofile-correction
+  else
+    PGO_USE = -fprofile-use=$(PGO_DIR)/default.profdata
+  endif
+endif